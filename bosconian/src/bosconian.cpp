@@ -5,6 +5,9 @@
 #include <cmath>
 #include <random>
 #include <algorithm>
+#include <cstring>
+#include "../../common/include/camera.h"
+#include "../../common/include/collision.h"
 
 // Constants
 const int SCREEN_WIDTH = 800;
@@ -21,6 +24,11 @@ const int MAX_BASES = 6;
 const int MAX_MINES = 20;
 const int MAX_ENEMIES = 5;
 const int WORLD_SIZE = 2000; // Size of the game world
+const int RADAR_CELL_SIZE = 32; // World pixels per radar texel
+const int RADAR_CELLS = (WORLD_SIZE + RADAR_CELL_SIZE - 1) / RADAR_CELL_SIZE;
+const int RADAR_SCALE = 2; // Screen pixels per radar texel
+const int RADAR_NO_CELL = -1;
+const Uint32 RADAR_EMPTY_COLOR = 0x000000A0; // RGBA8888
 
 // Game objects
 struct GameObject {
@@ -42,8 +50,16 @@ struct GameObject {
         rect.y = static_cast<int>(y);
     }
     
+    engine::Vec2 position() const {
+        return engine::Vec2(x, y);
+    }
+    
+    batch_aabb::Box box() const {
+        return batch_aabb::makeBox(rect.x, rect.y, rect.w, rect.h);
+    }
+    
     bool collidesWith(const GameObject& other) const {
-        return SDL_HasIntersection(&rect, &other.rect);
+        return engine::overlaps(box(), other.box());
     }
 };
 
@@ -179,21 +195,22 @@ struct Enemy : GameObject {
     }
 };
 
-// Camera to follow player
+// Camera to follow player: the shared engine camera, with the view kept on
+// whole pixels for the starfield and radar
 struct Camera {
+    engine::Camera view;
     int x, y;
     int width, height;
     
-    Camera() : x(0), y(0), width(SCREEN_WIDTH), height(SCREEN_HEIGHT) {}
+    Camera() : view(SCREEN_WIDTH, SCREEN_HEIGHT, WORLD_SIZE, WORLD_SIZE),
+               x(0), y(0), width(SCREEN_WIDTH), height(SCREEN_HEIGHT) {}
     
     void update(const Player& player) {
-        // Center the camera on the player
-        x = static_cast<int>(player.x + player.rect.w / 2 - width / 2);
-        y = static_cast<int>(player.y + player.rect.h / 2 - height / 2);
-        
-        // Keep the camera within the world bounds
-        x = std::max(0, std::min(x, WORLD_SIZE - width));
-        y = std::max(0, std::min(y, WORLD_SIZE - height));
+        // Center the camera on the player, kept within the world bounds
+        view.follow(engine::Vec2(player.x + player.rect.w / 2, player.y + player.rect.h / 2));
+        x = static_cast<int>(view.position().x);
+        y = static_cast<int>(view.position().y);
+        view.moveTo(engine::Vec2(x, y));
     }
     
     SDL_Rect getWorldToScreenRect(const SDL_Rect& worldRect) const {
@@ -207,9 +224,318 @@ struct Camera {
     }
     
     bool isVisible(const SDL_Rect& worldRect) const {
-        return (worldRect.x + worldRect.w > x && worldRect.x < x + width &&
-                worldRect.y + worldRect.h > y && worldRect.y < y + height);
+        return view.isVisible(worldRect.x, worldRect.y, worldRect.w, worldRect.h);
+    }
+};
+
+struct StarLayerStyle {
+    float parallax; // 1 moves with the world
+    int stars;      // per tile
+    int size;       // pixels square
+    Uint8 brightness;
+};
+
+// Far to near; the near layer matches the old star density of one 2x2 star
+// per 4000 square pixels
+const StarLayerStyle STAR_LAYER_STYLES[] = {
+    {0.25f, 24, 1, 110},
+    {0.5f, 16, 1, 180},
+    {1.0f, 16, 2, 255}
+};
+
+// Parallax starfield built from small tileable star textures, so background
+// memory stays the same however large WORLD_SIZE gets. Each layer is one
+// STAR_TILE_SIZE square tile, generated from a seed at startup and repeated
+// across the screen at an offset of the camera position times the layer's
+// parallax factor, wrapped to the tile size.
+class Starfield {
+public:
+    static const int STAR_TILE_SIZE = 256;
+    static const int LAYER_COUNT = sizeof(STAR_LAYER_STYLES) / sizeof(STAR_LAYER_STYLES[0]);
+    
+    Starfield() {
+        for (int i = 0; i < LAYER_COUNT; ++i) {
+            layers[i] = nullptr;
+        }
+    }
+    
+    ~Starfield() {
+        destroy();
+    }
+    
+    bool generate(SDL_Renderer* renderer, unsigned int seed) {
+        destroy();
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> posDist(0, STAR_TILE_SIZE - 1);
+        
+        for (int i = 0; i < LAYER_COUNT; ++i) {
+            const StarLayerStyle& style = STAR_LAYER_STYLES[i];
+            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, STAR_TILE_SIZE, STAR_TILE_SIZE, 32, SDL_PIXELFORMAT_RGBA8888);
+            if (surface == nullptr) {
+                std::cerr << "Starfield surface could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+                return false;
+            }
+            SDL_FillRect(surface, nullptr, SDL_MapRGBA(surface->format, 0, 0, 0, 0));
+            
+            // Stars on the tile edge are drawn pixel by pixel, wrapped, so
+            // the tiles join without seams
+            Uint32 color = SDL_MapRGBA(surface->format, style.brightness, style.brightness, style.brightness, 255);
+            for (int star = 0; star < style.stars; ++star) {
+                int x = posDist(gen);
+                int y = posDist(gen);
+                for (int py = 0; py < style.size; ++py) {
+                    for (int px = 0; px < style.size; ++px) {
+                        SDL_Rect pixel = {(x + px) % STAR_TILE_SIZE, (y + py) % STAR_TILE_SIZE, 1, 1};
+                        SDL_FillRect(surface, &pixel, color);
+                    }
+                }
+            }
+            
+            layers[i] = SDL_CreateTextureFromSurface(renderer, surface);
+            SDL_FreeSurface(surface);
+            if (layers[i] == nullptr) {
+                std::cerr << "Starfield texture could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+                return false;
+            }
+            SDL_SetTextureBlendMode(layers[i], SDL_BLENDMODE_BLEND);
+        }
+        return true;
+    }
+    
+    // Far layers first, so nearer stars draw over them
+    void render(SDL_Renderer* renderer, const Camera& camera) const {
+        for (int i = 0; i < LAYER_COUNT; ++i) {
+            if (layers[i] == nullptr) continue;
+            
+            int offsetX = wrap(static_cast<int>(camera.x * STAR_LAYER_STYLES[i].parallax));
+            int offsetY = wrap(static_cast<int>(camera.y * STAR_LAYER_STYLES[i].parallax));
+            for (int y = -offsetY; y < camera.height; y += STAR_TILE_SIZE) {
+                for (int x = -offsetX; x < camera.width; x += STAR_TILE_SIZE) {
+                    SDL_Rect destRect = {x, y, STAR_TILE_SIZE, STAR_TILE_SIZE};
+                    SDL_RenderCopy(renderer, layers[i], nullptr, &destRect);
+                }
+            }
+        }
+    }
+    
+    void destroy() {
+        for (int i = 0; i < LAYER_COUNT; ++i) {
+            if (layers[i] != nullptr) {
+                SDL_DestroyTexture(layers[i]);
+                layers[i] = nullptr;
+            }
+        }
+    }
+    
+private:
+    static int wrap(int offset) {
+        offset %= STAR_TILE_SIZE;
+        return offset < 0 ? offset + STAR_TILE_SIZE : offset;
+    }
+    
+    SDL_Texture* layers[LAYER_COUNT];
+};
+
+// Radar minimap of the whole world. Each RADAR_CELL_SIZE square of the world
+// is one texel of a small streaming texture, coloured by the most important
+// kind of object counted in it. The radar remembers the cell every tracked
+// object was counted in, so sync() only touches the counts of objects that
+// changed cell, appeared (activate()) or went away (destroyed, shot), and
+// upload() only streams the texels those changes dirtied.
+class Radar {
+public:
+    // In drawing priority, a base hides an enemy in the same cell
+    enum Kind {
+        KIND_BASE,
+        KIND_ENEMY,
+        KIND_MINE,
+        KIND_COUNT
+    };
+    
+    Radar() : texture(nullptr), counts(RADAR_CELLS * RADAR_CELLS), pixels(RADAR_CELLS * RADAR_CELLS, RADAR_EMPTY_COLOR), queued(RADAR_CELLS * RADAR_CELLS, false) {}
+    
+    ~Radar() {
+        destroy();
+    }
+    
+    bool init(SDL_Renderer* renderer) {
+        destroy();
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, RADAR_CELLS, RADAR_CELLS);
+        if (texture == nullptr) {
+            std::cerr << "Radar texture could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        clear();
+        return true;
+    }
+    
+    // Forgets every tracked object, for a new level
+    void clear() {
+        for (int kind = 0; kind < KIND_COUNT; ++kind) {
+            tracked[kind].clear();
+        }
+        for (size_t cell = 0; cell < counts.size(); ++cell) {
+            counts[cell] = CellCounts();
+            markDirty(static_cast<int>(cell));
+        }
+    }
+    
+    // Brings the counts of one object kind up to date with its vector. Only
+    // objects whose cell differs from the remembered one cost more than a
+    // comparison.
+    template <typename T>
+    void sync(Kind kind, const std::vector<T>& objects) {
+        std::vector<int>& cells = tracked[kind];
+        if (cells.size() < objects.size()) {
+            cells.resize(objects.size(), RADAR_NO_CELL);
+        }
+        for (size_t i = 0; i < cells.size(); ++i) {
+            int cell = (i < objects.size() && objects[i].active) ? cellOf(objects[i]) : RADAR_NO_CELL;
+            if (cell != cells[i]) {
+                move(kind, cells[i], cell);
+                cells[i] = cell;
+            }
+        }
+        cells.resize(objects.size());
     }
+    
+    // Streams the dirty texels into the texture, locking only the rectangle
+    // that bounds them
+    void upload() {
+        if (dirty.empty() || texture == nullptr) {
+            return;
+        }
+        
+        int minX = RADAR_CELLS, minY = RADAR_CELLS, maxX = -1, maxY = -1;
+        for (int cell : dirty) {
+            pixels[cell] = colorOf(cell);
+            queued[cell] = false;
+            int x = cell % RADAR_CELLS;
+            int y = cell / RADAR_CELLS;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+        dirty.clear();
+        
+        // Locked texels are write-only, so the unchanged ones inside the
+        // rectangle are copied again from the pixel mirror
+        SDL_Rect rect = {minX, minY, maxX - minX + 1, maxY - minY + 1};
+        void* data;
+        int pitch;
+        if (SDL_LockTexture(texture, &rect, &data, &pitch) != 0) {
+            std::cerr << "Radar texture could not be locked! SDL_Error: " << SDL_GetError() << std::endl;
+            return;
+        }
+        for (int y = 0; y < rect.h; ++y) {
+            std::memcpy(static_cast<Uint8*>(data) + y * pitch, &pixels[(rect.y + y) * RADAR_CELLS + rect.x], rect.w * sizeof(Uint32));
+        }
+        SDL_UnlockTexture(texture);
+    }
+    
+    // The radar texture in the bottom right corner, with the camera view and
+    // the player drawn over it
+    void render(SDL_Renderer* renderer, const Camera& camera, const Player& player) const {
+        if (texture == nullptr) {
+            return;
+        }
+        
+        const int size = RADAR_CELLS * RADAR_SCALE;
+        SDL_Rect radarRect = {SCREEN_WIDTH - size - 10, SCREEN_HEIGHT - size - 10, size, size};
+        SDL_RenderCopy(renderer, texture, nullptr, &radarRect);
+        
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawRect(renderer, &radarRect);
+        
+        SDL_Rect viewRect = {
+            radarRect.x + toRadar(camera.x),
+            radarRect.y + toRadar(camera.y),
+            toRadar(camera.width),
+            toRadar(camera.height)
+        };
+        SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255);
+        SDL_RenderDrawRect(renderer, &viewRect);
+        
+        SDL_Rect playerRect = {
+            radarRect.x + toRadar(static_cast<int>(player.x) + player.rect.w / 2) - 1,
+            radarRect.y + toRadar(static_cast<int>(player.y) + player.rect.h / 2) - 1,
+            3,
+            3
+        };
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+        SDL_RenderFillRect(renderer, &playerRect);
+    }
+    
+    void destroy() {
+        if (texture != nullptr) {
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
+    
+private:
+    struct CellCounts {
+        int count[KIND_COUNT];
+        
+        CellCounts() : count() {}
+    };
+    
+    static Uint32 kindColor(int kind) {
+        // Same colours as the object textures, in RGBA8888
+        switch (kind) {
+            case KIND_BASE: return 0xFF0000FF;
+            case KIND_ENEMY: return 0xFF00FFFF;
+            default: return 0xFFA500FF;
+        }
+    }
+    
+    static int cellOf(const GameObject& object) {
+        // Position rather than rect, which activate() leaves stale until the
+        // next update()
+        int x = std::max(0, std::min((static_cast<int>(object.x) + object.rect.w / 2) / RADAR_CELL_SIZE, RADAR_CELLS - 1));
+        int y = std::max(0, std::min((static_cast<int>(object.y) + object.rect.h / 2) / RADAR_CELL_SIZE, RADAR_CELLS - 1));
+        return y * RADAR_CELLS + x;
+    }
+    
+    static int toRadar(int world) {
+        return world * RADAR_SCALE / RADAR_CELL_SIZE;
+    }
+    
+    void move(Kind kind, int from, int to) {
+        if (from != RADAR_NO_CELL) {
+            counts[from].count[kind]--;
+            markDirty(from);
+        }
+        if (to != RADAR_NO_CELL) {
+            counts[to].count[kind]++;
+            markDirty(to);
+        }
+    }
+    
+    void markDirty(int cell) {
+        if (!queued[cell]) {
+            queued[cell] = true;
+            dirty.push_back(cell);
+        }
+    }
+    
+    Uint32 colorOf(int cell) const {
+        for (int kind = 0; kind < KIND_COUNT; ++kind) {
+            if (counts[cell].count[kind] > 0) {
+                return kindColor(kind);
+            }
+        }
+        return RADAR_EMPTY_COLOR;
+    }
+    
+    SDL_Texture* texture;
+    std::vector<CellCounts> counts;
+    std::vector<Uint32> pixels;   // mirror of the texture contents
+    std::vector<bool> queued;     // cell is in dirty
+    std::vector<int> dirty;
+    std::vector<int> tracked[KIND_COUNT]; // cell each object is counted in
 };
 
 // Game class
@@ -225,7 +551,12 @@ private:
     SDL_Texture* baseTexture;
     SDL_Texture* mineTexture;
     SDL_Texture* enemyTexture;
-    SDL_Texture* backgroundTexture;
+    
+    // Background
+    Starfield starfield;
+    
+    // Minimap
+    Radar radar;
     
     // Game objects
     Player player;
@@ -309,20 +640,14 @@ public:
         enemyTexture = SDL_CreateTextureFromSurface(renderer, surface);
         SDL_FreeSurface(surface);
         
-        // Create a starfield background
-        surface = SDL_CreateRGBSurface(0, WORLD_SIZE, WORLD_SIZE, 32, 0, 0, 0, 0);
-        SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 0, 0, 0));
-        
-        // Add stars
-        SDL_Rect starRect = {0, 0, 2, 2};
-        for (int i = 0; i < 1000; ++i) {
-            starRect.x = rand() % WORLD_SIZE;
-            starRect.y = rand() % WORLD_SIZE;
-            SDL_FillRect(surface, &starRect, SDL_MapRGB(surface->format, 255, 255, 255));
+        // Create the starfield background from a seed of this run
+        if (!starfield.generate(renderer, rng())) {
+            return false;
         }
         
-        backgroundTexture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
+        if (!radar.init(renderer)) {
+            return false;
+        }
         
         // Initialize bullets pool
         bullets.resize(100);
@@ -366,22 +691,14 @@ public:
                 base.rect.y = static_cast<int>(base.y);
                 
                 // Check distance from player
-                float dx = base.x - player.x;
-                float dy = base.y - player.y;
-                float distSq = dx * dx + dy * dy;
-                
-                if (distSq < 200 * 200) {
+                if (engine::distanceSquared(player.position(), base.position()) < 200 * 200) {
                     validPosition = false;
                     continue;
                 }
                 
                 // Check distance from other bases
                 for (const auto& otherBase : bases) {
-                    dx = base.x - otherBase.x;
-                    dy = base.y - otherBase.y;
-                    distSq = dx * dx + dy * dy;
-                    
-                    if (distSq < 200 * 200) {
+                    if (engine::distanceSquared(otherBase.position(), base.position()) < 200 * 200) {
                         validPosition = false;
                         break;
                     }
@@ -405,22 +722,14 @@ public:
                 mine.rect.y = static_cast<int>(mine.y);
                 
                 // Check distance from player
-                float dx = mine.x - player.x;
-                float dy = mine.y - player.y;
-                float distSq = dx * dx + dy * dy;
-                
-                if (distSq < 150 * 150) {
+                if (engine::distanceSquared(player.position(), mine.position()) < 150 * 150) {
                     validPosition = false;
                     continue;
                 }
                 
                 // Check distance from bases
                 for (const auto& base : bases) {
-                    dx = mine.x - base.x;
-                    dy = mine.y - base.y;
-                    distSq = dx * dx + dy * dy;
-                    
-                    if (distSq < 100 * 100) {
+                    if (engine::distanceSquared(base.position(), mine.position()) < 100 * 100) {
                         validPosition = false;
                         break;
                     }
@@ -428,11 +737,7 @@ public:
                 
                 // Check distance from other mines
                 for (const auto& otherMine : mines) {
-                    dx = mine.x - otherMine.x;
-                    dy = mine.y - otherMine.y;
-                    distSq = dx * dx + dy * dy;
-                    
-                    if (distSq < 50 * 50) {
+                    if (engine::distanceSquared(otherMine.position(), mine.position()) < 50 * 50) {
                         validPosition = false;
                         break;
                     }
@@ -447,6 +752,9 @@ public:
         enemies.resize(MAX_ENEMIES);
         lastEnemySpawnTime = SDL_GetTicks();
         
+        radar.clear();
+        syncRadar();
+        
         gameOver = false;
     }
     
@@ -604,6 +912,14 @@ public:
         
         // Check collisions
         checkCollisions();
+        
+        syncRadar();
+    }
+    
+    void syncRadar() {
+        radar.sync(Radar::KIND_BASE, bases);
+        radar.sync(Radar::KIND_ENEMY, enemies);
+        radar.sync(Radar::KIND_MINE, mines);
     }
     
     void spawnEnemy() {
@@ -612,18 +928,14 @@ public:
                 std::uniform_int_distribution<int> dist(0, WORLD_SIZE - ENEMY_SIZE);
                 
                 // Spawn away from player
-                float x, y;
-                float distSq;
+                engine::Vec2 spawn;
                 
                 do {
-                    x = dist(rng);
-                    y = dist(rng);
-                    float dx = x - player.x;
-                    float dy = y - player.y;
-                    distSq = dx * dx + dy * dy;
-                } while (distSq < 300 * 300);
+                    spawn.x = dist(rng);
+                    spawn.y = dist(rng);
+                } while (engine::distanceSquared(player.position(), spawn) < 300 * 300);
                 
-                enemy.activate(x, y);
+                enemy.activate(spawn.x, spawn.y);
                 break;
             }
         }
@@ -705,10 +1017,8 @@ public:
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
         
-        // Render background (visible portion of the world)
-        SDL_Rect srcRect = {camera.x, camera.y, camera.width, camera.height};
-        SDL_Rect destRect = {0, 0, camera.width, camera.height};
-        SDL_RenderCopy(renderer, backgroundTexture, &srcRect, &destRect);
+        // Render background
+        starfield.render(renderer, camera);
         
         // Render bases
         for (const auto& base : bases) {
@@ -785,6 +1095,10 @@ public:
             SDL_RenderFillRect(renderer, &lifeRect);
         }
         
+        // Render radar
+        radar.upload();
+        radar.render(renderer, camera, player);
+        
         if (gameOver) {
             // Display game over message
             SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
@@ -809,7 +1123,8 @@ public:
         SDL_DestroyTexture(baseTexture);
         SDL_DestroyTexture(mineTexture);
         SDL_DestroyTexture(enemyTexture);
-        SDL_DestroyTexture(backgroundTexture);
+        starfield.destroy();
+        radar.destroy();
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         IMG_Quit();
@@ -0,0 +1,143 @@
+// Micro-benchmark for batch_aabb.h against the scalar checks the games used
+// before: a branchy test on array-of-structs entities, called pair by pair
+// in a nested bullets x enemies loop.
+//
+//   make bench && ./release/aabb_bench
+//
+// Every kernel's hit masks are compared with the old loop's results before
+// anything is timed.
+
+#include "batch_aabb.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Layout of the games' entities (silkworm's Entity, seek2's GameObject)
+struct Entity {
+    float x, y;
+    int width, height;
+    bool active;
+};
+
+bool checkCollision(const Entity& a, const Entity& b) {
+    return a.x < b.x + b.width &&
+           a.x + a.width > b.x &&
+           a.y < b.y + b.height &&
+           a.y + a.height > b.y;
+}
+
+std::vector<Entity> makeEntities(size_t count, int size, std::mt19937& rng) {
+    std::uniform_real_distribution<float> x(0.0f, 800.0f), y(0.0f, 600.0f);
+    std::bernoulli_distribution active(0.9);
+    std::vector<Entity> entities(count);
+    for (Entity& entity : entities) {
+        entity.x = x(rng);
+        entity.y = y(rng);
+        entity.width = entity.height = size;
+        entity.active = active(rng);
+    }
+    return entities;
+}
+
+// Old code: every bullet against every enemy, one pair at a time
+void maskOld(const std::vector<Entity>& bullets, const std::vector<Entity>& enemies, std::vector<uint64_t>& masks, size_t words) {
+    for (size_t b = 0; b < bullets.size(); ++b) {
+        uint64_t* mask = &masks[b * words];
+        for (size_t w = 0; w < words; ++w) mask[w] = 0;
+        for (size_t e = 0; e < enemies.size(); ++e) {
+            if (enemies[e].active && checkCollision(bullets[b], enemies[e])) {
+                mask[e / 64] |= uint64_t(1) << (e % 64);
+            }
+        }
+    }
+}
+
+void maskBatched(batch_aabb::OverlapKernel kernel, const std::vector<Entity>& bullets, const std::vector<Entity>& enemies,
+                 batch_aabb::BoxArray& boxes, std::vector<uint64_t>& masks, size_t words) {
+    // The games rebuild the enemy array every frame, so that is timed too
+    boxes.clear();
+    for (const Entity& enemy : enemies) {
+        if (enemy.active) {
+            boxes.push(batch_aabb::makeBox(enemy.x, enemy.y, enemy.width, enemy.height));
+        } else {
+            boxes.pushEmpty();
+        }
+    }
+    for (size_t b = 0; b < bullets.size(); ++b) {
+        const Entity& bullet = bullets[b];
+        kernel(batch_aabb::makeBox(bullet.x, bullet.y, bullet.width, bullet.height), boxes, &masks[b * words]);
+    }
+}
+
+template <typename F>
+double nanosPerPair(F run, size_t pairs) {
+    // Repeat until the measurement covers at least 50ms
+    size_t repeats = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < repeats; ++r) run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0.05) return seconds * 1e9 / (double(repeats) * pairs);
+        repeats *= 2;
+    }
+}
+
+} // namespace
+
+int main() {
+    struct Kernel {
+        const char* name;
+        batch_aabb::OverlapKernel kernel;
+        bool available;
+    };
+    std::vector<Kernel> kernels;
+    kernels.push_back({ "scalar", batch_aabb::overlapMaskScalar, true });
+#if BATCH_AABB_SSE2
+    kernels.push_back({ "sse2", batch_aabb::overlapMaskSse2, true });
+#endif
+#if BATCH_AABB_AVX2
+    kernels.push_back({ "avx2", batch_aabb::overlapMaskAvx2, __builtin_cpu_supports("avx2") != 0 });
+#endif
+
+    std::printf("%8s %8s %12s", "bullets", "enemies", "old ns/pair");
+    for (const Kernel& k : kernels) std::printf(" %10s", k.name);
+    std::printf("  (ns per pair, speedup over old)\n");
+
+    std::mt19937 rng(1234);
+    const size_t sizes[] = { 8, 10, 20, 64, 256, 1024 };
+    bool allMatch = true;
+    for (size_t enemyCount : sizes) {
+        size_t bulletCount = 20;
+        std::vector<Entity> bullets = makeEntities(bulletCount, 8, rng);
+        std::vector<Entity> enemies = makeEntities(enemyCount, 32, rng);
+        size_t words = (enemyCount + 63) / 64;
+        std::vector<uint64_t> expected(bulletCount * words), masks(bulletCount * words);
+        batch_aabb::BoxArray boxes;
+
+        maskOld(bullets, enemies, expected, words);
+        double oldNs = nanosPerPair([&]() { maskOld(bullets, enemies, masks, words); }, bulletCount * enemyCount);
+        std::printf("%8zu %8zu %12.3f", bulletCount, enemyCount, oldNs);
+
+        for (const Kernel& k : kernels) {
+            if (!k.available) {
+                std::printf(" %10s", "n/a");
+                continue;
+            }
+            maskBatched(k.kernel, bullets, enemies, boxes, masks, words);
+            if (masks != expected) {
+                std::printf(" %10s", "MISMATCH");
+                allMatch = false;
+                continue;
+            }
+            double ns = nanosPerPair([&]() { maskBatched(k.kernel, bullets, enemies, boxes, masks, words); },
+                                     bulletCount * enemyCount);
+            std::printf(" %5.3f %3.1fx", ns, oldNs / ns);
+        }
+        std::printf("\n");
+    }
+    return allMatch ? 0 : 1;
+}
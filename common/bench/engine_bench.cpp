@@ -0,0 +1,331 @@
+// Micro-benchmark for the engine headers (vec2.h, camera.h, collision.h)
+// against the code they replace: gtav2's and newcleancode's distance()
+// through pow(), and newclass's own Vector2D::normalize() called vector by
+// vector, Camera::isVisible() called rect by rect and tile loop of
+// TileMap::checkCollision(), as they were before newclass moved onto the
+// engine headers.
+//
+//   make bench && ./release/engine_bench
+//
+// Each engine kernel's results are checked against the old code's before
+// anything is timed. The games' own hot functions are timed separately by
+// the benches under bench/games, see the readme.
+
+#include "camera.h"
+#include "collision.h"
+#include "vec2.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Old code, as it is (or was, for newclass) in the games
+
+float distanceOld(float x1, float y1, float x2, float y2) {
+    return std::sqrt(std::pow(x2 - x1, 2) + std::pow(y2 - y1, 2));
+}
+
+struct Vector2D {
+    float x, y;
+
+    float magnitude() const { return std::sqrt(x * x + y * y); }
+
+    Vector2D normalize() const {
+        float mag = magnitude();
+        if (mag > 0) {
+            Vector2D v = { x / mag, y / mag };
+            return v;
+        }
+        Vector2D zero = { 0, 0 };
+        return zero;
+    }
+};
+
+struct Rectangle {
+    float x, y, w, h;
+};
+
+struct Viewport {
+    int x, y, w, h;
+
+    bool isVisible(const Rectangle& rect) const {
+        return (rect.x + rect.w > x &&
+                rect.x < x + w &&
+                rect.y + rect.h > y &&
+                rect.y < y + h);
+    }
+};
+
+template <typename F>
+double nanosPerItem(F run, size_t items) {
+    // Repeat until the measurement covers at least 50ms
+    size_t repeats = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < repeats; ++r) run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0.05) return seconds * 1e9 / (double(repeats) * items);
+        repeats *= 2;
+    }
+}
+
+// Results are summed into this so the compiler can't drop the work
+volatile float sink;
+
+bool allMatch = true;
+
+void printHeader(const char* name, size_t items, double oldNs) {
+    std::printf("%-10s %8zu %12.3f", name, items, oldNs);
+}
+
+void printKernel(const char* name, bool matches, double ns, double oldNs) {
+    if (!matches) {
+        std::printf("  %s MISMATCH", name);
+        allMatch = false;
+        return;
+    }
+    std::printf("  %s %.3f %.1fx", name, ns, oldNs / ns);
+}
+
+struct Kernel {
+    const char* name;
+    engine::LengthKernel length;
+    engine::NormalizeKernel normalize;
+    bool available;
+};
+
+std::vector<Kernel> vectorKernels() {
+    std::vector<Kernel> kernels;
+    kernels.push_back({ "scalar", engine::lengthBatchScalar, engine::normalizeBatchScalar, true });
+#if VEC2_SSE2
+    kernels.push_back({ "sse2", engine::lengthBatchSse2, engine::normalizeBatchSse2, true });
+#endif
+#if VEC2_AVX2
+    kernels.push_back({ "avx2", engine::lengthBatchAvx2, engine::normalizeBatchAvx2, __builtin_cpu_supports("avx2") != 0 });
+#endif
+    return kernels;
+}
+
+void benchDistance(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> coord(0.0f, 4000.0f);
+    std::vector<float> x1(count), y1(count), x2(count), y2(count), expected(count), got(count);
+    for (size_t i = 0; i < count; ++i) {
+        x1[i] = coord(rng);
+        y1[i] = coord(rng);
+        x2[i] = coord(rng);
+        y2[i] = coord(rng);
+        expected[i] = distanceOld(x1[i], y1[i], x2[i], y2[i]);
+    }
+
+    double oldNs = nanosPerItem([&]() {
+        float sum = 0;
+        for (size_t i = 0; i < count; ++i) sum += distanceOld(x1[i], y1[i], x2[i], y2[i]);
+        sink = sum;
+    }, count);
+    printHeader("distance", count, oldNs);
+
+    // The old code rounds through double, so allow for the last bit or two
+    bool matches = true;
+    for (size_t i = 0; i < count; ++i) {
+        got[i] = engine::distance(x1[i], y1[i], x2[i], y2[i]);
+        if (std::fabs(got[i] - expected[i]) > 4 * FLT_EPSILON * expected[i]) matches = false;
+    }
+    double ns = nanosPerItem([&]() {
+        float sum = 0;
+        for (size_t i = 0; i < count; ++i) sum += engine::distance(x1[i], y1[i], x2[i], y2[i]);
+        sink = sum;
+    }, count);
+    printKernel("engine", matches, ns, oldNs);
+    std::printf("\n");
+}
+
+// Direction-like vectors with some exact zeros, as standing zombies have
+std::vector<Vector2D> makeVectors(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> component(-300.0f, 300.0f);
+    std::bernoulli_distribution still(0.1);
+    std::vector<Vector2D> vectors(count);
+    for (Vector2D& v : vectors) {
+        v.x = still(rng) ? 0.0f : component(rng);
+        v.y = still(rng) ? 0.0f : component(rng);
+        if (still(rng)) v.x = v.y = 0.0f;
+    }
+    return vectors;
+}
+
+void benchLength(size_t count, std::mt19937& rng) {
+    std::vector<Vector2D> vectors = makeVectors(count, rng);
+    std::vector<float> x(count), y(count), expected(count), lengths(count);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = vectors[i].x;
+        y[i] = vectors[i].y;
+        expected[i] = vectors[i].magnitude();
+    }
+
+    double oldNs = nanosPerItem([&]() {
+        for (size_t i = 0; i < count; ++i) lengths[i] = vectors[i].magnitude();
+        sink = lengths[count - 1];
+    }, count);
+    printHeader("length", count, oldNs);
+
+    for (const Kernel& k : vectorKernels()) {
+        if (!k.available) continue;
+        k.length(x.data(), y.data(), lengths.data(), count);
+        bool matches = lengths == expected;
+        double ns = nanosPerItem([&]() {
+            k.length(x.data(), y.data(), lengths.data(), count);
+            sink = lengths[count - 1];
+        }, count);
+        printKernel(k.name, matches, ns, oldNs);
+    }
+    std::printf("\n");
+}
+
+void benchNormalize(size_t count, std::mt19937& rng) {
+    std::vector<Vector2D> vectors = makeVectors(count, rng), normalized(count);
+    std::vector<float> x(count), y(count), outX(count), outY(count);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = vectors[i].x;
+        y[i] = vectors[i].y;
+    }
+
+    double oldNs = nanosPerItem([&]() {
+        for (size_t i = 0; i < count; ++i) normalized[i] = vectors[i].normalize();
+        sink = normalized[count - 1].x;
+    }, count);
+    printHeader("normalize", count, oldNs);
+
+    for (const Kernel& k : vectorKernels()) {
+        if (!k.available) continue;
+        outX = x;
+        outY = y;
+        k.normalize(outX.data(), outY.data(), count);
+        bool matches = true;
+        for (size_t i = 0; i < count; ++i) {
+            if (outX[i] != normalized[i].x || outY[i] != normalized[i].y) matches = false;
+        }
+        // Normalizing in place would leave unit vectors after the first
+        // repeat, so each run starts from a fresh copy, as the old loop does
+        double ns = nanosPerItem([&]() {
+            std::copy(x.begin(), x.end(), outX.begin());
+            std::copy(y.begin(), y.end(), outY.begin());
+            k.normalize(outX.data(), outY.data(), count);
+            sink = outX[count - 1];
+        }, count);
+        printKernel(k.name, matches, ns, oldNs);
+    }
+    std::printf("\n");
+}
+
+void benchCulling(size_t count, std::mt19937& rng) {
+    // A newclass-sized world with an 800x600 view somewhere in the middle
+    std::uniform_real_distribution<float> position(0.0f, 8192.0f);
+    std::uniform_real_distribution<float> size(16.0f, 256.0f);
+    std::vector<Rectangle> rects(count);
+    batch_aabb::BoxArray boxes;
+    for (Rectangle& rect : rects) {
+        rect.x = position(rng);
+        rect.y = position(rng);
+        rect.w = rect.h = size(rng);
+        boxes.push(batch_aabb::makeBox(rect.x, rect.y, rect.w, rect.h));
+    }
+    Viewport viewport = { 3700, 3800, 800, 600 };
+    engine::Camera camera(800, 600, 8192, 8192);
+    camera.follow(engine::Vec2(4100, 4100));
+
+    size_t words = boxes.maskWords();
+    std::vector<uint64_t> expected(words), mask(words);
+    for (size_t i = 0; i < count; ++i) {
+        if (viewport.isVisible(rects[i])) expected[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    double oldNs = nanosPerItem([&]() {
+        int visible = 0;
+        for (const Rectangle& rect : rects) visible += viewport.isVisible(rect);
+        sink = static_cast<float>(visible);
+    }, count);
+    printHeader("cull", count, oldNs);
+
+    camera.cull(boxes, mask.data());
+    bool matches = mask == expected;
+    double ns = nanosPerItem([&]() {
+        camera.cull(boxes, mask.data());
+        sink = static_cast<float>(mask[0]);
+    }, count);
+    printKernel("engine", matches, ns, oldNs);
+    std::printf("\n");
+}
+
+void benchTiles(size_t count, std::mt19937& rng) {
+    // A 256x256 grid, a fifth of it solid, probed with entity-sized boxes
+    const int tileSize = 32, tiles = 256;
+    std::vector<unsigned char> solid(tiles * tiles);
+    std::bernoulli_distribution wall(0.2);
+    for (unsigned char& tile : solid) tile = wall(rng);
+    auto isSolid = [&](int x, int y) {
+        return x < 0 || y < 0 || x >= tiles || y >= tiles || solid[y * tiles + x] != 0;
+    };
+    std::uniform_real_distribution<float> position(0.0f, float(tileSize * tiles - 64));
+    std::vector<Rectangle> rects(count);
+    for (Rectangle& rect : rects) {
+        rect.x = position(rng);
+        rect.y = position(rng);
+        rect.w = rect.h = 30.0f;
+    }
+
+    // TileMap::checkCollision() without the chunk lookup
+    auto checkCollisionOld = [&](const Rectangle& rect) {
+        int startTileX = static_cast<int>(rect.x) / tileSize;
+        int startTileY = static_cast<int>(rect.y) / tileSize;
+        int endTileX = static_cast<int>(rect.x + rect.w) / tileSize;
+        int endTileY = static_cast<int>(rect.y + rect.h) / tileSize;
+        for (int y = startTileY; y <= endTileY; ++y) {
+            for (int x = startTileX; x <= endTileX; ++x) {
+                if (isSolid(x, y)) return true;
+            }
+        }
+        return false;
+    };
+
+    double oldNs = nanosPerItem([&]() {
+        int hits = 0;
+        for (const Rectangle& rect : rects) hits += checkCollisionOld(rect);
+        sink = static_cast<float>(hits);
+    }, count);
+    printHeader("tiles", count, oldNs);
+
+    bool matches = true;
+    for (const Rectangle& rect : rects) {
+        batch_aabb::Box box = batch_aabb::makeBox(rect.x, rect.y, rect.w, rect.h);
+        if (engine::hitsSolidTile(box, tileSize, isSolid) != checkCollisionOld(rect)) matches = false;
+    }
+    double ns = nanosPerItem([&]() {
+        int hits = 0;
+        for (const Rectangle& rect : rects) {
+            hits += engine::hitsSolidTile(batch_aabb::makeBox(rect.x, rect.y, rect.w, rect.h), tileSize, isSolid);
+        }
+        sink = static_cast<float>(hits);
+    }, count);
+    printKernel("engine", matches, ns, oldNs);
+    std::printf("\n");
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-10s %8s %12s  (engine kernels: ns per item, speedup over old)\n", "kernel", "items", "old ns/item");
+
+    std::mt19937 rng(1234);
+    const size_t sizes[] = { 64, 1024, 16384 };
+    for (size_t count : sizes) benchDistance(count, rng);
+    for (size_t count : sizes) benchLength(count, rng);
+    for (size_t count : sizes) benchNormalize(count, rng);
+    for (size_t count : sizes) benchCulling(count, rng);
+    for (size_t count : sizes) benchTiles(count, rng);
+    return allMatch ? 0 : 1;
+}
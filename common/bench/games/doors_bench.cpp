@@ -0,0 +1,78 @@
+// Times wall_door_analyzer's summed-area table and findDoors() on generated
+// wall strips with doors and windows cut into them.
+//
+//   make bench-games && ./release/doors_bench
+
+// wall_door_analyzer is a tool with its own main(); pull it in under another name
+#define main wall_door_analyzer_main
+#include "../../../wall_door_analyzer/wall_door_analyzer.cpp"
+#undef main
+
+#include "game_bench.h"
+
+#include <random>
+
+namespace {
+
+void fillRect(Image image, int x0, int y0, int w, int h, int r, int g, int b, std::mt19937& rng) {
+    for (int y = y0; y < y0 + h; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            int noise = (int)(rng() % 21) - 10;
+            image.pixels[y * image.width + x] = ((Uint32)(r + noise) << 24) | ((Uint32)(g + noise) << 16) |
+                                                ((Uint32)(b + noise) << 8) | 0xFF;
+        }
+    }
+}
+
+// A grey wall with a door reaching the ground and a window above it every
+// 400 pixels
+Image makeWall(int width, int height, std::mt19937& rng) {
+    Image image = {0};
+    image.surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!image.surface) return image;
+    image.pixels = (Uint32 *)image.surface->pixels;
+    image.width = width;
+    image.height = height;
+    fillRect(image, 0, 0, width, height, WALL_COLOR_R, WALL_COLOR_G, WALL_COLOR_B, rng);
+    for (int x = 100; x + 300 < width; x += 400) {
+        fillRect(image, x, height - 200, 80, 200, 140, 80, 30, rng);
+        fillRect(image, x + 180, height / 4, 60, 50, 40, 60, 160, rng);
+    }
+    return image;
+}
+
+} // namespace
+
+int main() {
+    game_bench::printHeader("doors_bench");
+    std::mt19937 rng(1234);
+    const int widths[] = { 1024, 2048, 4096 };
+    for (int width : widths) {
+        Image wall = makeWall(width, 512, rng);
+        if (!wall.surface) {
+            printf("Unable to create a %dx512 surface: %s\n", width, SDL_GetError());
+            return 1;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "%dx512", width);
+
+        SummedAreaTable table = {};
+        double tableMicros = game_bench::microsPerCall([&]() {
+            freeSummedAreaTable(&table);
+            buildSummedAreaTable(&table, wall);
+        });
+        game_bench::printResult("buildSAT", label, tableMicros);
+
+        DoorPosition doors[MAX_DOORS];
+        int found = 0;
+        double doorMicros = game_bench::microsPerCall([&]() {
+            found = findDoors(wall, &table, doors, false);
+        });
+        snprintf(label, sizeof(label), "%dx512, %d found", width, found);
+        game_bench::printResult("findDoors", label, doorMicros);
+
+        freeSummedAreaTable(&table);
+        SDL_FreeSurface(wall.surface);
+    }
+    return 0;
+}
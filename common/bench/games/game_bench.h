@@ -0,0 +1,38 @@
+#ifndef GAME_BENCH_H
+#define GAME_BENCH_H
+
+// Timing and output shared by the game benchmarks in this directory. Each
+// benchmark is its own program because the games are single translation
+// units with their own main(), Image types and so on, which would clash
+// if they were linked together.
+
+#include <chrono>
+#include <cstdio>
+
+namespace game_bench {
+
+// Microseconds per call of run(), repeated until the measurement covers at
+// least 200ms.
+template <typename F>
+double microsPerCall(F run) {
+    size_t repeats = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < repeats; ++r) run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0.2) return seconds * 1e6 / static_cast<double>(repeats);
+        repeats *= 2;
+    }
+}
+
+inline void printHeader(const char* bench) {
+    std::printf("%-16s %-24s %14s\n", bench, "case", "us/call");
+}
+
+inline void printResult(const char* function, const char* label, double micros) {
+    std::printf("%-16s %-24s %14.2f\n", function, label, micros);
+}
+
+} // namespace game_bench
+
+#endif // GAME_BENCH_H
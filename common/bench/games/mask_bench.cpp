@@ -0,0 +1,59 @@
+// Times png_processor's createMask() on generated sprite sheets of a few
+// sizes, with the SIMD row kernel the CPU supports.
+//
+//   make bench-games && ./release/mask_bench
+
+// png_processor is a tool with its own main(); pull it in under another name
+#define main png_processor_main
+#include "../../../png_processor/png_processor.cpp"
+#undef main
+#include "../../../png_processor/atlas.cpp"
+
+#include "game_bench.h"
+
+#include <random>
+
+namespace {
+
+// Opaque noise with a transparent hole in every other 64x64 cell, so the
+// mask has both values on most rows
+Image makeSheet(int width, int height, std::mt19937& rng) {
+    Image image = {0};
+    image.surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!image.surface) return image;
+    image.pixels = (Uint32 *)image.surface->pixels;
+    image.width = width;
+    image.height = height;
+    for (int y = 0; y < height; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)image.surface->pixels + y * image.surface->pitch);
+        for (int x = 0; x < width; x++) {
+            bool hole = ((x / 64 + y / 64) % 2) && (x % 64) > 8 && (y % 64) > 8;
+            row[x] = (rng() & 0xFFFFFF00u) | (hole ? 0x00 : 0xFF);
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+int main() {
+    game_bench::printHeader("mask_bench");
+    std::mt19937 rng(1234);
+    const int sizes[] = { 256, 1024, 2048 };
+    for (int size : sizes) {
+        Image sheet = makeSheet(size, size, rng);
+        if (!sheet.surface) {
+            printf("Unable to create a %dx%d surface: %s\n", size, size, SDL_GetError());
+            return 1;
+        }
+        double micros = game_bench::microsPerCall([&]() {
+            Image mask = createMask(sheet);
+            SDL_FreeSurface(mask.surface);
+        });
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", size, size);
+        game_bench::printResult("createMask", label, micros);
+        SDL_FreeSurface(sheet.surface);
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+// Times zombie_maze's Level::generateMaze() from the first level up to the
+// larger ones, with a fixed seed so runs are comparable.
+//
+//   make bench-games && ./release/maze_bench
+
+// zombie_maze is a single file with its own main(); pull it in under another name
+#define main zombie_maze_main
+#include "../../../zombie_maze/zombie_maze.cpp"
+#undef main
+
+#include "game_bench.h"
+
+int main() {
+    game_bench::printHeader("maze_bench");
+    const int levelNumbers[] = { 1, 10, 50, 200 };
+    for (int levelNumber : levelNumbers) {
+        // The constructor generates the maze once; time the regenerations
+        Level level(levelNumber, 1234);
+        double micros = game_bench::microsPerCall([&]() {
+            level.generateMaze();
+        });
+        char label[32];
+        snprintf(label, sizeof(label), "level %d (%dx%d)", levelNumber, level.getWidth(), level.getHeight());
+        game_bench::printResult("generateMaze", label, micros);
+    }
+    return 0;
+}
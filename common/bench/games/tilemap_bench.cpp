@@ -0,0 +1,44 @@
+// Times newclass's TileMap::checkCollision() for entity-sized boxes all over
+// the world, first on a cold map where the probes generate chunks and then
+// on the same map with every chunk resident.
+//
+//   make bench-games && ./release/tilemap_bench
+//
+// Built against every newclass source except src/main.cpp.
+
+#include "TileMap.h"
+#include "game_bench.h"
+
+#include <random>
+#include <vector>
+
+int main() {
+    game_bench::printHeader("tilemap_bench");
+
+    // Headless: no textures, the map data is generated all the same
+    AtlasRegion tiles[TILE_TYPES] = {};
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(0.0f, static_cast<float>(MAP_WIDTH - TILE_SIZE));
+    const size_t probeCount = 4096;
+    std::vector<Rectangle> probes;
+    for (size_t i = 0; i < probeCount; ++i) {
+        probes.push_back(Rectangle(position(rng), position(rng), TILE_SIZE - 2, TILE_SIZE - 2));
+    }
+
+    TileMap map(tiles, MAP_WIDTH, MAP_HEIGHT, TILE_SIZE, 1234);
+    int hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Rectangle& probe : probes) hits += map.checkCollision(probe);
+    double coldMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    char label[48];
+    snprintf(label, sizeof(label), "cold, %zu chunks", map.getResidentChunkCount());
+    game_bench::printResult("checkCollision", label, coldMicros / probeCount);
+
+    double warmMicros = game_bench::microsPerCall([&]() {
+        hits = 0;
+        for (const Rectangle& probe : probes) hits += map.checkCollision(probe);
+    });
+    snprintf(label, sizeof(label), "warm, %d of %zu hit", hits, probeCount);
+    game_bench::printResult("checkCollision", label, warmMicros / probeCount);
+    return 0;
+}
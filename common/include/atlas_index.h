@@ -0,0 +1,244 @@
+#ifndef ATLAS_INDEX_H
+#define ATLAS_INDEX_H
+
+// Binary index of a texture atlas, written by png_processor --atlas and read
+// by the games.
+//
+// The file is laid out so it can be memory-mapped and used in place: a
+// Header, then the Page table, then the Sprite table, then a block of
+// NUL-terminated strings the tables point into by offset. All fields are
+// little-endian and naturally aligned. Sprites are sorted by name hash, so
+// find() is a binary search.
+//
+// A sprite's rect is where its trimmed pixels sit on its page; trimX/trimY
+// and sourceWidth/sourceHeight say where that rect was inside the original
+// image, so a game can draw it at the position the untrimmed image would
+// have had. A fully transparent image gets an empty rect.
+//
+// sourceHash and the header's optionsHash let the packer tell whether its
+// inputs have changed since the index was written.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ATLAS_INDEX_MMAP 1
+#endif
+
+namespace atlas_index {
+
+const char MAGIC[4] = { 'A', 'T', 'L', 'I' };
+const uint32_t VERSION = 1;
+const uint32_t NO_STRING = 0xFFFFFFFF;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t optionsHash; // packer settings the atlas was built with
+    uint32_t pageCount;
+    uint32_t spriteCount;
+    uint32_t pagesOffset; // byte offsets from the start of the file
+    uint32_t spritesOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+struct Page {
+    uint32_t image; // string offset of the page PNG, relative to the index
+    uint32_t mask;  // same for its mask page, or NO_STRING
+    uint16_t width, height;
+    uint32_t reserved;
+};
+
+struct Sprite {
+    uint64_t sourceHash; // hash of the input file's bytes
+    uint32_t nameHash;   // hashName() of the name
+    uint32_t name;       // string offset
+    uint16_t page;
+    uint16_t x, y, width, height;
+    uint16_t trimX, trimY;
+    uint16_t sourceWidth, sourceHeight;
+    uint16_t reserved[3];
+};
+
+static_assert(sizeof(Header) == 40 && sizeof(Page) == 16 && sizeof(Sprite) == 40, "index layout is part of the file format");
+
+// FNV-1a, 32 bits for names and 64 bits for file contents.
+inline uint32_t hashName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (; *name; ++name) {
+        hash = (hash ^ static_cast<uint8_t>(*name)) * 16777619u;
+    }
+    return hash;
+}
+
+const uint64_t HASH_SEED = 14695981039346656037ull;
+
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = HASH_SEED) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// A checked view over an index in memory. It does not own the bytes, which
+// must outlive it.
+class View {
+public:
+    View() : header(nullptr), pages(nullptr), sprites(nullptr), strings(nullptr) {}
+
+    // Checks the header and that every table and string offset stays inside
+    // the data. The view is empty, and false is returned, when it does not.
+    bool open(const void* data, size_t size) {
+        *this = View();
+        if (size < sizeof(Header)) return false;
+        const Header* h = static_cast<const Header*>(data);
+        if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION) return false;
+        if (!fits(h->pagesOffset, uint64_t(h->pageCount) * sizeof(Page), size) ||
+            !fits(h->spritesOffset, uint64_t(h->spriteCount) * sizeof(Sprite), size) ||
+            !fits(h->stringsOffset, h->stringsSize, size)) {
+            return false;
+        }
+        if (h->pagesOffset % alignof(Page) != 0 || h->spritesOffset % alignof(Sprite) != 0) return false;
+
+        const char* base = static_cast<const char*>(data);
+        const Page* p = reinterpret_cast<const Page*>(base + h->pagesOffset);
+        const Sprite* s = reinterpret_cast<const Sprite*>(base + h->spritesOffset);
+        const char* str = base + h->stringsOffset;
+        if (h->stringsSize == 0 || str[h->stringsSize - 1] != '\0') return false;
+        for (uint32_t i = 0; i < h->pageCount; ++i) {
+            if (p[i].image >= h->stringsSize) return false;
+            if (p[i].mask != NO_STRING && p[i].mask >= h->stringsSize) return false;
+        }
+        for (uint32_t i = 0; i < h->spriteCount; ++i) {
+            if (s[i].name >= h->stringsSize || s[i].page >= h->pageCount) return false;
+            if (i > 0 && s[i].nameHash < s[i - 1].nameHash) return false;
+        }
+
+        header = h;
+        pages = p;
+        sprites = s;
+        strings = str;
+        return true;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+    uint64_t optionsHash() const { return header->optionsHash; }
+
+    uint32_t pageCount() const { return header ? header->pageCount : 0; }
+    const Page& page(uint32_t i) const { return pages[i]; }
+    const char* pageImage(uint32_t i) const { return strings + pages[i].image; }
+    // nullptr when the atlas was built without masks.
+    const char* pageMask(uint32_t i) const { return pages[i].mask == NO_STRING ? nullptr : strings + pages[i].mask; }
+
+    uint32_t spriteCount() const { return header ? header->spriteCount : 0; }
+    const Sprite& sprite(uint32_t i) const { return sprites[i]; }
+    const char* spriteName(uint32_t i) const { return strings + sprites[i].name; }
+
+    // The sprite with this name, or nullptr.
+    const Sprite* find(const char* name) const {
+        uint32_t hash = hashName(name);
+        uint32_t lo = 0, hi = spriteCount();
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (sprites[mid].nameHash < hash) lo = mid + 1;
+            else hi = mid;
+        }
+        for (; lo < spriteCount() && sprites[lo].nameHash == hash; ++lo) {
+            if (std::strcmp(strings + sprites[lo].name, name) == 0) return &sprites[lo];
+        }
+        return nullptr;
+    }
+
+private:
+    static bool fits(uint64_t offset, uint64_t length, size_t size) {
+        return offset <= size && length <= size - offset;
+    }
+
+    const Header* header;
+    const Page* pages;
+    const Sprite* sprites;
+    const char* strings;
+};
+
+// A whole index file, memory-mapped where the platform allows and read into
+// memory elsewhere.
+class File {
+public:
+    File() : mapped(nullptr), mappedSize(0) {}
+    ~File() { close(); }
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    bool open(const char* path) {
+        close();
+#if ATLAS_INDEX_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                mapped = data;
+                mappedSize = static_cast<size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+        if (mapped == nullptr) return false;
+        if (!index.open(mapped, mappedSize)) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) return false;
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        if (length > 0) {
+            // uint64_t storage keeps the tables aligned
+            buffer.resize((static_cast<size_t>(length) + 7) / 8);
+            if (std::fread(buffer.data(), 1, static_cast<size_t>(length), file) != static_cast<size_t>(length)) {
+                buffer.clear();
+            }
+        }
+        std::fclose(file);
+        if (buffer.empty() || !index.open(buffer.data(), static_cast<size_t>(length))) {
+            close();
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    void close() {
+        index = View();
+#if ATLAS_INDEX_MMAP
+        if (mapped != nullptr) munmap(mapped, mappedSize);
+#endif
+        mapped = nullptr;
+        mappedSize = 0;
+        buffer.clear();
+    }
+
+    const View& view() const { return index; }
+
+private:
+    void* mapped;
+    size_t mappedSize;
+    std::vector<uint64_t> buffer;
+    View index;
+};
+
+} // namespace atlas_index
+
+#endif // ATLAS_INDEX_H
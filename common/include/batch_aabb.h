@@ -0,0 +1,233 @@
+#ifndef BATCH_AABB_H
+#define BATCH_AABB_H
+
+// Batched AABB overlap test shared by the arcade games.
+//
+// One query box is tested against a BoxArray, a structure-of-arrays of
+// N boxes stored as min/max corners, and the result is a hit bitmask, bit i
+// set when box i overlaps. The test matches the games' old scalar checks
+// exactly: boxes overlap only when they intersect with positive area, so
+// touching edges do not count.
+//
+// The kernel is AVX2 (8 boxes per step) when the CPU has it, SSE2 (4 boxes
+// per step) on any other x86, and scalar elsewhere. The arrays are padded
+// to a multiple of 8 with empty boxes that never overlap anything, so the
+// vector loops have no tail. A removed box, e.g. a dead enemy, is also
+// replaced by an empty box, which keeps indices lined up with the game's
+// own arrays.
+
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_AABB_SSE2 1
+#endif
+
+#if BATCH_AABB_SSE2 && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BATCH_AABB_AVX2 1
+#endif
+
+namespace batch_aabb {
+
+const size_t LANES = 8; // array padding, the widest kernel's step
+
+struct Box {
+    float minX, minY, maxX, maxY;
+};
+
+inline Box makeBox(float x, float y, float w, float h) {
+    Box box = { x, y, x + w, y + h };
+    return box;
+}
+
+class BoxArray {
+public:
+    BoxArray() : count(0) {}
+
+    // Empties the array, keeping its memory for the next frame.
+    void clear() { count = 0; }
+
+    // Appends a box and returns its index. Inactive objects should still be
+    // pushed with pushEmpty() so indices follow the game's arrays.
+    size_t push(const Box& box) {
+        size_t index = count++;
+        if (index % LANES == 0) startBlock(index);
+        minX[index] = box.minX;
+        minY[index] = box.minY;
+        maxX[index] = box.maxX;
+        maxY[index] = box.maxY;
+        return index;
+    }
+
+    size_t pushEmpty() {
+        size_t index = count++;
+        if (index % LANES == 0) startBlock(index);
+        return index;
+    }
+
+    // Makes box i overlap nothing from now on.
+    void remove(size_t index) {
+        minX[index] = minY[index] = FLT_MAX;
+        maxX[index] = maxY[index] = -FLT_MAX;
+    }
+
+    size_t size() const { return count; }
+    size_t paddedSize() const { return (count + LANES - 1) & ~(LANES - 1); }
+
+    // Number of 64-bit words a hit mask over this array needs.
+    size_t maskWords() const { return (count + 63) / 64; }
+
+    const float* minXData() const { return minX.data(); }
+    const float* minYData() const { return minY.data(); }
+    const float* maxXData() const { return maxX.data(); }
+    const float* maxYData() const { return maxY.data(); }
+
+private:
+    // Makes the block of LANES boxes starting at index empty. The vectors
+    // only grow, so after a clear() the blocks of earlier frames are reused
+    // and refilled here rather than resized.
+    void startBlock(size_t index) {
+        if (index == minX.size()) {
+            minX.resize(index + LANES);
+            minY.resize(index + LANES);
+            maxX.resize(index + LANES);
+            maxY.resize(index + LANES);
+        }
+        for (size_t i = index; i < index + LANES; ++i) {
+            minX[i] = minY[i] = FLT_MAX;
+            maxX[i] = maxY[i] = -FLT_MAX;
+        }
+    }
+
+    size_t count;
+    std::vector<float> minX, minY, maxX, maxY;
+};
+
+// The kernels write maskWords() words; mask bits past size() are zero.
+
+// How far a and b overlap on one axis, positive only when they do: a < b
+// is exactly b - a > 0 for floats, so one axis is one min and one compare.
+inline float axisOverlap(float queryMin, float queryMax, float boxMin, float boxMax) {
+    float left = boxMax - queryMin;
+    float right = queryMax - boxMin;
+    return left < right ? left : right;
+}
+
+inline void overlapMaskScalar(const Box& query, const BoxArray& boxes, uint64_t* mask) {
+    const float* minX = boxes.minXData();
+    const float* minY = boxes.minYData();
+    const float* maxX = boxes.maxXData();
+    const float* maxY = boxes.maxYData();
+    // Words are built in a register and stored once. Each axis is tested
+    // whole before branching: the single compares are true about half the
+    // time and mispredict, a whole axis rarely overlaps.
+    size_t count = boxes.size();
+    for (size_t base = 0; base < count; base += 64) {
+        size_t end = count - base < 64 ? count - base : 64;
+        uint64_t bits = 0;
+        for (size_t i = 0; i < end; ++i) {
+            size_t j = base + i;
+            if (axisOverlap(query.minX, query.maxX, minX[j], maxX[j]) > 0.0f &&
+                axisOverlap(query.minY, query.maxY, minY[j], maxY[j]) > 0.0f) {
+                bits |= uint64_t(1) << i;
+            }
+        }
+        mask[base / 64] = bits;
+    }
+}
+
+#if BATCH_AABB_SSE2
+inline void overlapMaskSse2(const Box& query, const BoxArray& boxes, uint64_t* mask) {
+    for (size_t word = 0; word < boxes.maskWords(); ++word) mask[word] = 0;
+    const __m128 qMinX = _mm_set1_ps(query.minX);
+    const __m128 qMinY = _mm_set1_ps(query.minY);
+    const __m128 qMaxX = _mm_set1_ps(query.maxX);
+    const __m128 qMaxY = _mm_set1_ps(query.maxY);
+    // Only the blocks holding real boxes; the rest of the padding is empty
+    size_t end = (boxes.size() + 3) & ~static_cast<size_t>(3);
+    for (size_t i = 0; i < end; i += 4) {
+        __m128 hit = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(qMinX, _mm_loadu_ps(boxes.maxXData() + i)),
+                       _mm_cmpgt_ps(qMaxX, _mm_loadu_ps(boxes.minXData() + i))),
+            _mm_and_ps(_mm_cmplt_ps(qMinY, _mm_loadu_ps(boxes.maxYData() + i)),
+                       _mm_cmpgt_ps(qMaxY, _mm_loadu_ps(boxes.minYData() + i))));
+        mask[i / 64] |= static_cast<uint64_t>(_mm_movemask_ps(hit)) << (i % 64);
+    }
+}
+#endif
+
+#if BATCH_AABB_AVX2
+__attribute__((target("avx2")))
+inline void overlapMaskAvx2(const Box& query, const BoxArray& boxes, uint64_t* mask) {
+    for (size_t word = 0; word < boxes.maskWords(); ++word) mask[word] = 0;
+    const __m256 qMinX = _mm256_set1_ps(query.minX);
+    const __m256 qMinY = _mm256_set1_ps(query.minY);
+    const __m256 qMaxX = _mm256_set1_ps(query.maxX);
+    const __m256 qMaxY = _mm256_set1_ps(query.maxY);
+    size_t end = (boxes.size() + LANES - 1) & ~(LANES - 1);
+    for (size_t i = 0; i < end; i += LANES) {
+        __m256 hit = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(qMinX, _mm256_loadu_ps(boxes.maxXData() + i), _CMP_LT_OQ),
+                          _mm256_cmp_ps(qMaxX, _mm256_loadu_ps(boxes.minXData() + i), _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(qMinY, _mm256_loadu_ps(boxes.maxYData() + i), _CMP_LT_OQ),
+                          _mm256_cmp_ps(qMaxY, _mm256_loadu_ps(boxes.minYData() + i), _CMP_GT_OQ)));
+        mask[i / 64] |= static_cast<uint64_t>(_mm256_movemask_ps(hit)) << (i % 64);
+    }
+}
+#endif
+
+typedef void (*OverlapKernel)(const Box&, const BoxArray&, uint64_t*);
+
+// Best kernel for this CPU, picked on first use.
+inline OverlapKernel bestKernel() {
+#if BATCH_AABB_AVX2
+    static const OverlapKernel kernel = __builtin_cpu_supports("avx2") ? overlapMaskAvx2 : overlapMaskSse2;
+    return kernel;
+#elif BATCH_AABB_SSE2
+    return overlapMaskSse2;
+#else
+    return overlapMaskScalar;
+#endif
+}
+
+// Fills mask (boxes.maskWords() words) with the boxes the query overlaps.
+inline void overlapMask(const Box& query, const BoxArray& boxes, uint64_t* mask) {
+    bestKernel()(query, boxes, mask);
+}
+
+// Convenience for arrays of at most 64 boxes, the common case in the games.
+inline uint64_t overlapMask64(const Box& query, const BoxArray& boxes) {
+    uint64_t mask[1] = { 0 };
+    if (boxes.size() > 0) overlapMask(query, boxes, mask);
+    return mask[0];
+}
+
+// Index of the lowest set bit, or -1 when the mask is empty.
+inline int firstHit(uint64_t mask) {
+    if (mask == 0) return -1;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+inline int firstHit(const uint64_t* mask, size_t words) {
+    for (size_t word = 0; word < words; ++word) {
+        if (mask[word] != 0) return static_cast<int>(word * 64) + firstHit(mask[word]);
+    }
+    return -1;
+}
+
+} // namespace batch_aabb
+
+#endif // BATCH_AABB_H
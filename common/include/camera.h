@@ -0,0 +1,78 @@
+#ifndef ENGINE_CAMERA_H
+#define ENGINE_CAMERA_H
+
+// A 2D camera over a bounded world: a view rectangle that follows a target
+// and stays inside the world, with world/screen conversions and culling.
+//
+// The view is centred on the target and then clamped to the world, and a
+// rect is visible only when it overlaps the view with positive area. The
+// view position is not rounded to whole pixels; the Cameras of newclass
+// and newcleancode, which wrap this one, truncate it with moveTo() after
+// each follow().
+//
+// cull() tests the view against a batch_aabb::BoxArray in one pass, so a
+// game can keep its drawables' boxes in one array and draw only the hits.
+
+#include "batch_aabb.h"
+#include "vec2.h"
+
+#include <cstdint>
+
+namespace engine {
+
+class Camera {
+public:
+    Camera(float viewWidth, float viewHeight, float worldWidth, float worldHeight)
+        : x(0.0f), y(0.0f), width(viewWidth), height(viewHeight), worldWidth(worldWidth), worldHeight(worldHeight) {}
+
+    // Centres the view on target, then keeps it inside the world. A world
+    // smaller than the view ends up pinned to its far edge, as in newclass.
+    void follow(const Vec2& target) {
+        x = target.x - width / 2;
+        y = target.y - height / 2;
+
+        if (x < 0) x = 0;
+        if (y < 0) y = 0;
+        if (x > worldWidth - width) x = worldWidth - width;
+        if (y > worldHeight - height) y = worldHeight - height;
+    }
+
+    void moveTo(const Vec2& topLeft) {
+        x = topLeft.x;
+        y = topLeft.y;
+    }
+
+    Vec2 position() const { return Vec2(x, y); }
+    float viewWidth() const { return width; }
+    float viewHeight() const { return height; }
+
+    batch_aabb::Box view() const {
+        return batch_aabb::makeBox(x, y, width, height);
+    }
+
+    Vec2 worldToScreen(const Vec2& world) const { return Vec2(world.x - x, world.y - y); }
+    Vec2 screenToWorld(const Vec2& screen) const { return Vec2(screen.x + x, screen.y + y); }
+
+    bool isVisible(const batch_aabb::Box& box) const {
+        return box.maxX > x && box.minX < x + width &&
+               box.maxY > y && box.minY < y + height;
+    }
+
+    bool isVisible(float boxX, float boxY, float boxWidth, float boxHeight) const {
+        return isVisible(batch_aabb::makeBox(boxX, boxY, boxWidth, boxHeight));
+    }
+
+    // Fills mask (boxes.maskWords() words) with the boxes in view.
+    void cull(const batch_aabb::BoxArray& boxes, uint64_t* mask) const {
+        batch_aabb::overlapMask(view(), boxes, mask);
+    }
+
+private:
+    float x, y; // top left of the view in world units
+    float width, height;
+    float worldWidth, worldHeight;
+};
+
+} // namespace engine
+
+#endif // ENGINE_CAMERA_H
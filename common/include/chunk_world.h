@@ -0,0 +1,255 @@
+#ifndef CHUNK_WORLD_H
+#define CHUNK_WORLD_H
+
+// Streamed, seeded terrain for the tile-map games, newclass and newcleancode.
+//
+// The world is cut into CHUNK_TILES square chunks whose tiles are a pure
+// function of (world seed, chunk coordinates), so a chunk can be thrown away
+// and rebuilt identically. A ChunkStore holds the resident chunks: stream()
+// asks a background thread for the chunks around the view and takes in the
+// ones it has finished, evict() drops the least recently used ones past a
+// budget, and ensure() generates a missing chunk on the spot so gameplay
+// queries never see holes. A game adds its own per-chunk state by deriving
+// from Chunk; the callbacks given to ensure(), stream() and evict() see each
+// chunk as it joins or leaves the resident set, on the calling thread.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace chunk_world {
+
+const int CHUNK_TILES = 16; // chunk edge in tiles, one uint16_t obstacle mask per row
+
+struct Chunk {
+    int cx, cy;
+    uint8_t tiles[CHUNK_TILES * CHUNK_TILES];
+    uint16_t obstacleRows[CHUNK_TILES]; // bit x of row y set for obstacle tiles
+    uint32_t lastUsed;
+    bool pinned; // edited by the game, never evicted so the edit survives
+
+    bool isObstacle(int localX, int localY) const {
+        return (obstacleRows[localY] >> localX) & 1;
+    }
+};
+
+// Mixes the world seed with chunk coordinates. salt 0 is the terrain; the
+// games use other salts for what they place per chunk.
+inline uint32_t chunkSeed(uint32_t worldSeed, int cx, int cy, uint32_t salt) {
+    uint32_t h = worldSeed ^ static_cast<uint32_t>(cx) * 0x9E3779B1u ^ static_cast<uint32_t>(cy) * 0x85EBCA77u ^ salt * 0xC2B2AE3Du;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// Terrain of one chunk: 1% obstacleTile, 9% tile 1, the rest tile 0.
+inline void generate(uint32_t worldSeed, int cx, int cy, uint8_t obstacleTile, Chunk& chunk) {
+    std::mt19937 gen(chunkSeed(worldSeed, cx, cy, 0));
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+
+    chunk.cx = cx;
+    chunk.cy = cy;
+    chunk.lastUsed = 0;
+    chunk.pinned = false;
+
+    for (int y = 0; y < CHUNK_TILES; ++y) {
+        uint16_t obstacles = 0;
+        for (int x = 0; x < CHUNK_TILES; ++x) {
+            float prob = probDist(gen);
+            uint8_t tile = 0;
+            if (prob < 0.01f) {
+                tile = obstacleTile;
+                obstacles |= static_cast<uint16_t>(1u << x);
+            } else if (prob < 0.1f) {
+                tile = 1;
+            }
+            chunk.tiles[y * CHUNK_TILES + x] = tile;
+        }
+        chunk.obstacleRows[y] = obstacles;
+    }
+}
+
+// Resident chunks of type T, which derives from Chunk and is default
+// constructible. Everything but the generation thread runs on the game's
+// main thread.
+template <typename T>
+class ChunkStore {
+public:
+    ChunkStore(uint32_t worldSeed, uint8_t obstacleTile) :
+        worldSeed(worldSeed), obstacleTile(obstacleTile),
+        lastLookup(nullptr), useStamp(0), stopping(false) {
+        streamer = std::thread(&ChunkStore::streamerLoop, this);
+    }
+
+    ~ChunkStore() {
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            stopping = true;
+        }
+        streamWake.notify_all();
+        streamer.join();
+    }
+
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    size_t size() const { return resident.size(); }
+
+    // Advances once per stream() call; a chunk's lastUsed is the stamp of
+    // the last call that wanted it.
+    uint32_t stamp() const { return useStamp; }
+
+    T* find(int cx, int cy) {
+        if (lastLookup && lastLookup->cx == cx && lastLookup->cy == cy) {
+            return lastLookup;
+        }
+
+        auto it = resident.find(chunkKey(cx, cy));
+        if (it == resident.end()) return nullptr;
+        lastLookup = it->second.get();
+        return lastLookup;
+    }
+
+    // find(), but a missing chunk is generated right here, with onAdd(T&)
+    // called for it.
+    template <typename OnAdd>
+    T* ensure(int cx, int cy, OnAdd onAdd) {
+        T* chunk = find(cx, cy);
+        if (!chunk) {
+            std::unique_ptr<T> generated(new T);
+            generate(worldSeed, cx, cy, obstacleTile, *generated);
+            chunk = generated.get();
+            resident[chunkKey(cx, cy)] = std::move(generated);
+            lastLookup = chunk;
+            onAdd(*chunk);
+        }
+        chunk->lastUsed = useStamp;
+        return chunk;
+    }
+
+    // Takes in the chunks the streamer has finished, calling onAdd(T&) for
+    // each, and asks it for the chunks of the given range that are still
+    // missing. Call once per update with the range about to be shown.
+    template <typename OnAdd>
+    void stream(int minX, int minY, int maxX, int maxY, OnAdd onAdd) {
+        ++useStamp;
+
+        bool requested = false;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            for (auto& chunk : finished) {
+                uint64_t key = chunkKey(chunk->cx, chunk->cy);
+                pending.erase(key);
+                // A synchronous ensure() may already have built the same chunk.
+                if (resident.find(key) == resident.end()) {
+                    T& added = *chunk;
+                    resident[key] = std::move(chunk);
+                    onAdd(added);
+                }
+            }
+            finished.clear();
+
+            for (int cy = minY; cy <= maxY; ++cy) {
+                for (int cx = minX; cx <= maxX; ++cx) {
+                    T* chunk = find(cx, cy);
+                    if (chunk) {
+                        chunk->lastUsed = useStamp;
+                        continue;
+                    }
+                    uint64_t key = chunkKey(cx, cy);
+                    if (pending.insert(key).second) {
+                        requests.push_back(key);
+                        requested = true;
+                    }
+                }
+            }
+        }
+        if (requested) streamWake.notify_one();
+    }
+
+    // Drops the least recently used chunks outside the given range until at
+    // most budget remain, calling onRemove(T&) for each before it goes.
+    // Pinned chunks are never dropped.
+    template <typename OnRemove>
+    void evict(int minX, int minY, int maxX, int maxY, size_t budget, OnRemove onRemove) {
+        if (resident.size() <= budget) return;
+
+        std::vector<std::pair<uint32_t, uint64_t>> candidates;
+        for (auto& entry : resident) {
+            const T& chunk = *entry.second;
+            bool wanted = chunk.cx >= minX && chunk.cx <= maxX && chunk.cy >= minY && chunk.cy <= maxY;
+            if (!wanted && !chunk.pinned) {
+                candidates.push_back({ chunk.lastUsed, entry.first });
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        size_t excess = resident.size() - budget;
+        for (size_t i = 0; i < candidates.size() && i < excess; ++i) {
+            auto it = resident.find(candidates[i].second);
+            onRemove(*it->second);
+            resident.erase(it);
+        }
+        lastLookup = nullptr;
+    }
+
+    template <typename F>
+    void forEach(F f) {
+        for (auto& entry : resident) f(*entry.second);
+    }
+
+private:
+    uint32_t worldSeed;
+    uint8_t obstacleTile;
+
+    std::unordered_map<uint64_t, std::unique_ptr<T>> resident;
+    T* lastLookup;
+    uint32_t useStamp;
+
+    // Generation requests and results shared with the streaming thread.
+    std::thread streamer;
+    std::mutex streamMutex;
+    std::condition_variable streamWake;
+    std::deque<uint64_t> requests;
+    std::vector<std::unique_ptr<T>> finished;
+    std::unordered_set<uint64_t> pending;
+    bool stopping;
+
+    static uint64_t chunkKey(int cx, int cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    void streamerLoop() {
+        std::unique_lock<std::mutex> lock(streamMutex);
+        while (true) {
+            streamWake.wait(lock, [this]() { return stopping || !requests.empty(); });
+            if (stopping) return;
+
+            uint64_t key = requests.front();
+            requests.pop_front();
+            lock.unlock();
+
+            std::unique_ptr<T> chunk(new T);
+            generate(worldSeed, static_cast<int>(key >> 32), static_cast<int>(static_cast<uint32_t>(key)), obstacleTile, *chunk);
+
+            lock.lock();
+            finished.push_back(std::move(chunk));
+        }
+    }
+};
+
+} // namespace chunk_world
+
+#endif // CHUNK_WORLD_H
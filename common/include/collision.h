@@ -0,0 +1,95 @@
+#ifndef ENGINE_COLLISION_H
+#define ENGINE_COLLISION_H
+
+// Collision primitives shared by the games: boxes, points, circles and tile
+// grids. Boxes are batch_aabb::Box, so a single test here and a batched
+// overlapMask() over a BoxArray always agree.
+//
+// As in batch_aabb, boxes overlap only with positive area; touching edges do
+// not count. Circles are the same: touching circles do not overlap.
+
+#include "batch_aabb.h"
+#include "vec2.h"
+
+namespace engine {
+
+using batch_aabb::Box;
+
+constexpr bool overlaps(const Box& a, const Box& b) {
+    return a.minX < b.maxX && a.maxX > b.minX &&
+           a.minY < b.maxY && a.maxY > b.minY;
+}
+
+// Half-open: a point on the min edges is inside, one on the max edges isn't.
+constexpr bool contains(const Box& box, const Vec2& point) {
+    return point.x >= box.minX && point.x < box.maxX &&
+           point.y >= box.minY && point.y < box.maxY;
+}
+
+constexpr Vec2 center(const Box& box) {
+    return Vec2((box.minX + box.maxX) * 0.5f, (box.minY + box.maxY) * 0.5f);
+}
+
+constexpr bool circlesOverlap(const Vec2& a, float radiusA, const Vec2& b, float radiusB) {
+    return distanceSquared(a, b) < (radiusA + radiusB) * (radiusA + radiusB);
+}
+
+constexpr float clampf(float value, float low, float high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+// Measured from the point of the box nearest the circle's centre.
+constexpr bool circleOverlapsBox(const Vec2& centre, float radius, const Box& box) {
+    return distanceSquared(centre, Vec2(clampf(centre.x, box.minX, box.maxX),
+                                        clampf(centre.y, box.minY, box.maxY))) < radius * radius;
+}
+
+// The shortest move that takes a out of b, along one axis: zero when they
+// do not overlap. Added to a's position it leaves the boxes touching.
+inline Vec2 separation(const Box& a, const Box& b) {
+    if (!overlaps(a, b)) return Vec2();
+    float left = b.minX - a.maxX;  // negative: push a left
+    float right = b.maxX - a.minX; // positive: push a right
+    float up = b.minY - a.maxY;
+    float down = b.maxY - a.minY;
+    float dx = -left < right ? left : right;
+    float dy = -up < down ? up : down;
+    if (dx * dx < dy * dy) return Vec2(dx, 0.0f);
+    return Vec2(0.0f, dy);
+}
+
+// Inclusive range of tiles a box covers on a grid of tileSize squares, with
+// the same rounding as newclass's TileMap::checkCollision(): coordinates are
+// truncated, and a box ending exactly on a tile edge covers that next tile.
+struct TileSpan {
+    int firstX, firstY, lastX, lastY;
+};
+
+inline TileSpan tilesCovered(const Box& box, int tileSize) {
+    TileSpan span = {
+        static_cast<int>(box.minX) / tileSize,
+        static_cast<int>(box.minY) / tileSize,
+        static_cast<int>(box.maxX) / tileSize,
+        static_cast<int>(box.maxY) / tileSize,
+    };
+    return span;
+}
+
+// True when isSolid(tileX, tileY) holds for any tile the box covers. Tiles
+// are visited row by row and the search stops at the first solid one.
+// Inline so the tile size folds into the caller's division as it did in the
+// loop this replaced.
+template <typename IsSolid>
+inline bool hitsSolidTile(const Box& box, int tileSize, const IsSolid& isSolid) {
+    TileSpan span = tilesCovered(box, tileSize);
+    for (int y = span.firstY; y <= span.lastY; ++y) {
+        for (int x = span.firstX; x <= span.lastX; ++x) {
+            if (isSolid(x, y)) return true;
+        }
+    }
+    return false;
+}
+
+} // namespace engine
+
+#endif // ENGINE_COLLISION_H
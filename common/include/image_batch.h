@@ -0,0 +1,290 @@
+#ifndef IMAGE_BATCH_H
+#define IMAGE_BATCH_H
+
+// Batch plumbing shared by the image tools, png_processor, 2img_mask and
+// wall_door_analyzer.
+//
+// listInputs() collects a batch's input files from a directory (every .png
+// in it, in name order) or from a list file (one path per line, blank lines
+// and # comments skipped). runWorkers() runs a worker function on a pool of
+// SDL threads; the workers share the jobs between them, typically by taking
+// the next index from an SDL_atomic_t until the batch runs out. Batch puts
+// the two together for tools that turn each input into one output file.
+//
+// maskRowKernel() is the alpha threshold behind the tools' masks: one row of
+// RGBA8888 pixels to opaque white where alpha is non-zero and transparent
+// elsewhere, with SSE2 and AVX2 versions.
+
+#include <SDL2/SDL.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMAGE_BATCH_SSE2 1
+#endif
+
+#if IMAGE_BATCH_SSE2 && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define IMAGE_BATCH_AVX2 1
+#endif
+
+namespace image_batch {
+
+const int PATH_LENGTH = 1024;
+
+typedef struct {
+    char **paths;
+    int count;
+    int capacity;
+} FileList;
+
+inline bool hasPngExtension(const char *name) {
+    size_t length = strlen(name);
+    return length > 4 && SDL_strcasecmp(name + length - 4, ".png") == 0;
+}
+
+inline int comparePaths(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+inline bool addPath(FileList *list, const char *path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        char **paths = (char **)realloc(list->paths, capacity * sizeof(char *));
+        if (!paths) {
+            printf("Out of memory listing the inputs\n");
+            return false;
+        }
+        list->paths = paths;
+        list->capacity = capacity;
+    }
+    list->paths[list->count++] = strdup(path);
+    return true;
+}
+
+inline void freeFileList(FileList *list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->paths[i]);
+    }
+    free(list->paths);
+    list->paths = NULL;
+    list->count = list->capacity = 0;
+}
+
+inline bool listInputs(FileList *list, const char *source) {
+    DIR *dir = opendir(source);
+    if (dir) {
+        bool ok = true;
+        struct dirent *entry;
+        while (ok && (entry = readdir(dir)) != NULL) {
+            if (!hasPngExtension(entry->d_name)) {
+                continue;
+            }
+            char path[PATH_LENGTH];
+            if (snprintf(path, sizeof(path), "%s/%s", source, entry->d_name) >= (int)sizeof(path)) {
+                printf("Input path too long for %s\n", entry->d_name);
+                ok = false;
+                break;
+            }
+            ok = addPath(list, path);
+        }
+        closedir(dir);
+        if (ok && list->count > 1) {
+            qsort(list->paths, list->count, sizeof(char *), comparePaths);
+        }
+        return ok;
+    }
+
+    FILE *file = fopen(source, "r");
+    if (!file) {
+        printf("Could not open %s as a directory or a file list\n", source);
+        return false;
+    }
+    bool ok = true;
+    char line[PATH_LENGTH];
+    while (ok && fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        ok = addPath(list, line);
+    }
+    fclose(file);
+    return ok;
+}
+
+// Runs worker(data) on threadCount threads, clamped to 1..jobCount, and
+// waits for them all. If no thread can be started the worker runs on the
+// calling thread instead. Returns the number of threads the work ran on.
+inline int runWorkers(SDL_ThreadFunction worker, void *data, int jobCount, int threadCount, const char *name) {
+    if (threadCount > jobCount) threadCount = jobCount;
+    if (threadCount < 1) threadCount = 1;
+
+    int started = 0;
+    SDL_Thread **threads = (SDL_Thread **)malloc(threadCount * sizeof(SDL_Thread *));
+    if (threads) {
+        for (int i = 0; i < threadCount; i++) {
+            threads[i] = SDL_CreateThread(worker, name, data);
+            if (!threads[i]) {
+                printf("Could not start worker thread: %s\n", SDL_GetError());
+                break;
+            }
+            started++;
+        }
+    }
+
+    if (started == 0) {
+        worker(data);
+    }
+    for (int i = 0; i < started; i++) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    free(threads);
+    return started ? started : 1;
+}
+
+// A batch of inputs, each with an output of the same file name in the
+// output directory. Workers take the next unclaimed job from nextJob until
+// the batch runs out.
+typedef bool (*ProcessFunction)(const char *inputFile, const char *outputFile);
+
+typedef struct {
+    FileList inputs;
+    char **outputs;
+    int count;
+    ProcessFunction process;
+    SDL_atomic_t nextJob;
+    SDL_atomic_t failed;
+} Batch;
+
+inline void freeBatch(Batch *batch) {
+    for (int i = 0; i < batch->count; i++) {
+        free(batch->outputs[i]);
+    }
+    free(batch->outputs);
+    batch->outputs = NULL;
+    batch->count = 0;
+    freeFileList(&batch->inputs);
+}
+
+// Fills the batch from a directory or a list file, see listInputs()
+inline bool buildBatch(Batch *batch, const char *source, const char *outputDir) {
+    if (!listInputs(&batch->inputs, source)) {
+        return false;
+    }
+    if (batch->inputs.count == 0) {
+        return true;
+    }
+
+    batch->outputs = (char **)malloc(batch->inputs.count * sizeof(char *));
+    if (!batch->outputs) {
+        printf("Out of memory building the batch\n");
+        return false;
+    }
+    for (int i = 0; i < batch->inputs.count; i++) {
+        const char *inputFile = batch->inputs.paths[i];
+        const char *name = strrchr(inputFile, '/');
+        name = name ? name + 1 : inputFile;
+        char outputFile[PATH_LENGTH];
+        if (snprintf(outputFile, sizeof(outputFile), "%s/%s", outputDir, name) >= (int)sizeof(outputFile)) {
+            printf("Output path too long for %s\n", inputFile);
+            return false;
+        }
+        batch->outputs[batch->count++] = strdup(outputFile);
+    }
+    return true;
+}
+
+inline int batchWorker(void *data) {
+    Batch *batch = (Batch *)data;
+    for (;;) {
+        int job = SDL_AtomicAdd(&batch->nextJob, 1);
+        if (job >= batch->count) {
+            return 0;
+        }
+        if (!batch->process(batch->inputs.paths[job], batch->outputs[job])) {
+            SDL_AtomicAdd(&batch->failed, 1);
+        }
+    }
+}
+
+// Runs process on every job of the batch on a pool of threads. Every worker
+// does its own decode, work and encode, so while one thread is inside libpng
+// reading a file another is compressing the previous result. Returns the
+// number of files that failed.
+inline int runBatch(Batch *batch, ProcessFunction process, int threadCount, const char *name) {
+    batch->process = process;
+    Uint32 start = SDL_GetTicks();
+    int threads = runWorkers(batchWorker, batch, batch->count, threadCount, name);
+
+    int failed = SDL_AtomicGet(&batch->failed);
+    printf("Processed %d of %d images on %d threads in %u ms\n",
+           batch->count - failed, batch->count, threads, SDL_GetTicks() - start);
+    return failed;
+}
+
+// Mask kernels for SDL_PIXELFORMAT_RGBA8888 rows. In that layout alpha is
+// the low byte of each pixel, and the mask's white and transparent are all
+// ones and all zeros, so a mask pixel is just "alpha != 0" widened to 32 bits.
+// The vector kernels do 16 (SSE2) or 32 (AVX2) pixels per step and leave the
+// tail to the scalar one.
+inline void maskRowScalar(const Uint32 *src, Uint32 *dst, int count) {
+    for (int x = 0; x < count; x++) {
+        dst[x] = (src[x] & 0xFF) ? 0xFFFFFFFF : 0;
+    }
+}
+
+#if IMAGE_BATCH_SSE2
+inline void maskRowSse2(const Uint32 *src, Uint32 *dst, int count) {
+    const __m128i alpha = _mm_set1_epi32(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        for (int i = 0; i < 16; i += 4) {
+            __m128i pixels = _mm_loadu_si128((const __m128i *)(src + x + i));
+            __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(pixels, alpha), zero);
+            _mm_storeu_si128((__m128i *)(dst + x + i), _mm_andnot_si128(clear, _mm_cmpeq_epi32(zero, zero)));
+        }
+    }
+    maskRowScalar(src + x, dst + x, count - x);
+}
+#endif
+
+#if IMAGE_BATCH_AVX2
+__attribute__((target("avx2")))
+inline void maskRowAvx2(const Uint32 *src, Uint32 *dst, int count) {
+    const __m256i alpha = _mm256_set1_epi32(0xFF);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_cmpeq_epi32(zero, zero);
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        for (int i = 0; i < 32; i += 8) {
+            __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + x + i));
+            __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, alpha), zero);
+            _mm256_storeu_si256((__m256i *)(dst + x + i), _mm256_andnot_si256(clear, ones));
+        }
+    }
+    maskRowScalar(src + x, dst + x, count - x);
+}
+#endif
+
+typedef void (*MaskRowKernel)(const Uint32 *, Uint32 *, int);
+
+// Best kernel for this CPU, picked on first use
+inline MaskRowKernel maskRowKernel() {
+#if IMAGE_BATCH_AVX2
+    static const MaskRowKernel kernel = __builtin_cpu_supports("avx2") ? maskRowAvx2 : maskRowSse2;
+    return kernel;
+#elif IMAGE_BATCH_SSE2
+    return maskRowSse2;
+#else
+    return maskRowScalar;
+#endif
+}
+
+} // namespace image_batch
+
+#endif // IMAGE_BATCH_H
@@ -0,0 +1,317 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Asynchronous logging shared by newclass and newcleancode. Call sites pack
+// their arguments in binary form into a lock-free ring owned by the calling
+// thread; a background writer thread does all formatting and file I/O.
+// Records below LOG_MIN_LEVEL or outside LOG_CATEGORY_MASK are removed at
+// compile time, arguments included.
+//
+// Messages use "{}" placeholders, filled in order:
+//     LOG_DEBUG(LOG_CAT_ZOMBIE, "Zombie spawned at ({}, {})", pos.x, pos.y);
+//
+// Header only: the logger's state lives in function-local statics, so every
+// translation unit of a game shares one writer and one set of rings.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum LogLevel {
+    LOG_LEVEL_TRACE,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR
+};
+
+enum LogCategory {
+    LOG_CAT_GAME,
+    LOG_CAT_PLAYER,
+    LOG_CAT_ZOMBIE,
+    LOG_CAT_ITEM,
+    LOG_CAT_TILEMAP,
+    LOG_CAT_RENDER,
+    LOG_CAT_UI,
+    LOG_CAT_COUNT
+};
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#ifndef LOG_CATEGORY_MASK
+#define LOG_CATEGORY_MASK 0xFFFFFFFFu
+#endif
+
+#define LOG_ENABLED(level, category) \
+    ((level) >= LOG_MIN_LEVEL && ((LOG_CATEGORY_MASK) & (1u << (category))) != 0)
+
+#define LOG_AT(level, category, ...) \
+    do { \
+        if (LOG_ENABLED(level, category)) Log::write(level, category, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_TRACE(category, ...) LOG_AT(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define LOG_INFO(category, ...)  LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOG_WARN(category, ...)  LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+
+struct LogArg {
+    enum Type : uint8_t { INT, UINT, FLOAT, STRING };
+    static const int STRING_CAPACITY = 24;
+
+    Type type;
+    union {
+        long long i;
+        unsigned long long u;
+        double f;
+        char s[STRING_CAPACITY];
+    };
+};
+
+struct LogRecord {
+    static const int MAX_ARGS = 6;
+
+    uint64_t timestamp;
+    const char* format; // must be a string literal, only the pointer is stored
+    uint8_t level;
+    uint8_t category;
+    uint8_t argCount;
+    LogArg args[MAX_ARGS];
+};
+
+namespace Log {
+
+namespace detail {
+
+// Single-producer/single-consumer ring: the owning thread advances head, the
+// writer thread advances tail. A full ring drops the record instead of
+// blocking the game.
+struct Ring {
+    static const uint32_t CAPACITY = 8192;
+
+    LogRecord records[CAPACITY];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+};
+
+struct State {
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<bool> running{false};
+    std::atomic<unsigned long long> dropped{0};
+    std::thread writerThread;
+    FILE* output = nullptr;
+};
+
+inline State& state() {
+    static State instance;
+    return instance;
+}
+
+struct ThreadState {
+    Ring* ring = nullptr;
+    uint32_t pendingHead = 0;
+};
+
+inline ThreadState& threadState() {
+    thread_local ThreadState instance;
+    return instance;
+}
+
+inline uint64_t nowMicros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline Ring* acquireRing() {
+    ThreadState& thread = threadState();
+    if (!thread.ring) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.registryMutex);
+        s.rings.push_back(std::unique_ptr<Ring>(new Ring));
+        thread.ring = s.rings.back().get();
+    }
+    return thread.ring;
+}
+
+inline void formatArg(std::string& out, const LogArg& arg) {
+    char buffer[32];
+    switch (arg.type) {
+        case LogArg::INT: snprintf(buffer, sizeof(buffer), "%lld", arg.i); break;
+        case LogArg::UINT: snprintf(buffer, sizeof(buffer), "%llu", arg.u); break;
+        case LogArg::FLOAT: snprintf(buffer, sizeof(buffer), "%g", arg.f); break;
+        case LogArg::STRING: out += arg.s; return;
+    }
+    out += buffer;
+}
+
+inline void formatRecord(std::string& line, const LogRecord& record, uint64_t startTime) {
+    static const char* const LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+    static const char* const CATEGORY_NAMES[] = { "game", "player", "zombie", "item", "tilemap", "render", "ui" };
+
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "[%10.3f] %-5s %-7s ",
+             (record.timestamp - startTime) / 1000.0, LEVEL_NAMES[record.level], CATEGORY_NAMES[record.category]);
+    line = prefix;
+
+    int next = 0;
+    for (const char* p = record.format; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}') {
+            if (next < record.argCount) formatArg(line, record.args[next++]);
+            ++p;
+        } else {
+            line += *p;
+        }
+    }
+    line += '\n';
+}
+
+// Drains every registered ring once; returns the number of records written.
+inline size_t drainRings(std::string& line, uint64_t startTime) {
+    State& s = state();
+    std::vector<Ring*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(s.registryMutex);
+        for (auto& ring : s.rings) snapshot.push_back(ring.get());
+    }
+
+    size_t written = 0;
+    for (Ring* ring : snapshot) {
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        while (tail != head) {
+            formatRecord(line, ring->records[tail & (Ring::CAPACITY - 1)], startTime);
+            fwrite(line.data(), 1, line.size(), s.output);
+            ++tail;
+            ++written;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    return written;
+}
+
+inline void writerLoop(uint64_t startTime) {
+    State& s = state();
+    std::string line;
+    line.reserve(256);
+
+    while (s.running.load(std::memory_order_acquire)) {
+        if (drainRings(line, startTime) == 0) {
+            fflush(s.output);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    drainRings(line, startTime);
+    fflush(s.output);
+}
+
+} // namespace detail
+
+// Starts the writer thread; records logged before start() are dropped.
+inline bool start(const char* path) {
+    detail::State& s = detail::state();
+    if (s.running.load()) return true;
+
+    s.output = fopen(path, "w");
+    if (!s.output) return false;
+
+    s.running.store(true, std::memory_order_release);
+    s.writerThread = std::thread(detail::writerLoop, detail::nowMicros());
+    return true;
+}
+
+inline void stop() {
+    detail::State& s = detail::state();
+    if (!s.running.exchange(false)) return;
+
+    s.writerThread.join();
+    if (s.dropped.load() > 0) {
+        fprintf(s.output, "%llu log records dropped (ring full)\n", s.dropped.load());
+    }
+    fclose(s.output);
+    s.output = nullptr;
+}
+
+inline bool isRunning() {
+    return detail::state().running.load(std::memory_order_relaxed);
+}
+
+inline unsigned long long droppedCount() {
+    return detail::state().dropped.load();
+}
+
+inline LogRecord* beginRecord() {
+    detail::State& s = detail::state();
+    if (!s.running.load(std::memory_order_relaxed)) return nullptr;
+
+    detail::Ring* ring = detail::acquireRing();
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail >= detail::Ring::CAPACITY) {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    detail::threadState().pendingHead = head;
+    LogRecord* record = &ring->records[head & (detail::Ring::CAPACITY - 1)];
+    record->timestamp = detail::nowMicros();
+    return record;
+}
+
+inline void commitRecord() {
+    detail::ThreadState& thread = detail::threadState();
+    thread.ring->head.store(thread.pendingHead + 1, std::memory_order_release);
+}
+
+inline void pack(LogArg& arg, bool v) { arg.type = LogArg::INT; arg.i = v ? 1 : 0; }
+inline void pack(LogArg& arg, int v) { arg.type = LogArg::INT; arg.i = v; }
+inline void pack(LogArg& arg, long v) { arg.type = LogArg::INT; arg.i = v; }
+inline void pack(LogArg& arg, long long v) { arg.type = LogArg::INT; arg.i = v; }
+inline void pack(LogArg& arg, unsigned v) { arg.type = LogArg::UINT; arg.u = v; }
+inline void pack(LogArg& arg, unsigned long v) { arg.type = LogArg::UINT; arg.u = v; }
+inline void pack(LogArg& arg, unsigned long long v) { arg.type = LogArg::UINT; arg.u = v; }
+inline void pack(LogArg& arg, double v) { arg.type = LogArg::FLOAT; arg.f = v; }
+inline void pack(LogArg& arg, const char* v) {
+    arg.type = LogArg::STRING;
+    std::strncpy(arg.s, v ? v : "(null)", LogArg::STRING_CAPACITY - 1);
+    arg.s[LogArg::STRING_CAPACITY - 1] = '\0';
+}
+inline void pack(LogArg& arg, const std::string& v) { pack(arg, v.c_str()); }
+
+inline void packAll(LogRecord&) {}
+
+template <typename T, typename... Rest>
+inline void packAll(LogRecord& record, const T& first, const Rest&... rest) {
+    if (record.argCount < LogRecord::MAX_ARGS) {
+        pack(record.args[record.argCount++], first);
+    }
+    packAll(record, rest...);
+}
+
+template <typename... Args>
+inline void write(LogLevel level, LogCategory category, const char* format, const Args&... args) {
+    LogRecord* record = beginRecord();
+    if (!record) return;
+
+    record->format = format;
+    record->level = static_cast<uint8_t>(level);
+    record->category = static_cast<uint8_t>(category);
+    record->argCount = 0;
+    packAll(*record, args...);
+    commitRecord();
+}
+
+} // namespace Log
+
+#endif // LOG_H
@@ -0,0 +1,146 @@
+#ifndef SECTION_FILE_H
+#define SECTION_FILE_H
+
+// Flat binary files made of one header followed by arrays of plain records,
+// used by newcleancode's saves and myplayform's levels.
+//
+// Each array is a Section in the header: its offset from the start of the
+// file and its record count. Sections start 8-byte aligned, so a loader maps
+// the file and reads the records in place. The writer lays the sections out
+// with a Layout, copies the header and the records into one buffer with
+// copySection(), and writes that. The reader opens the file as a MappedFile,
+// checks each section with fits() before trusting it, and gets at the
+// records through records().
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SECTION_FILE_MMAP 1
+#endif
+
+namespace section_file {
+
+const uint32_t ALIGNMENT = 8;
+
+struct Section {
+    uint32_t offset; // bytes from the start of the file
+    uint32_t count;
+};
+
+inline uint32_t align(uint32_t offset) {
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// Places sections one after another behind a header of headerSize bytes.
+// size() is the file size once every section has been placed.
+class Layout {
+public:
+    explicit Layout(size_t headerSize) : offset(align(static_cast<uint32_t>(headerSize))) {}
+
+    void place(Section& section, size_t count, size_t recordSize) {
+        section.offset = offset;
+        section.count = static_cast<uint32_t>(count);
+        offset = align(offset + static_cast<uint32_t>(count * recordSize));
+    }
+
+    uint32_t size() const { return offset; }
+
+private:
+    uint32_t offset;
+};
+
+// Copies a section's records into a file image sized by its Layout.
+inline void copySection(std::vector<char>& buffer, const Section& section, const void* data, size_t recordSize) {
+    if (section.count > 0) memcpy(buffer.data() + section.offset, data, section.count * recordSize);
+}
+
+// True when the section is aligned and lies inside a file of fileSize bytes.
+inline bool fits(const Section& section, size_t recordSize, size_t fileSize) {
+    uint64_t end = section.offset + static_cast<uint64_t>(section.count) * recordSize;
+    return section.offset % ALIGNMENT == 0 && end <= fileSize;
+}
+
+// Read-only view of a whole file. It is memory-mapped where the platform
+// allows and read into one buffer elsewhere.
+class MappedFile {
+public:
+    MappedFile() : data(nullptr), size(0), mapping(nullptr) {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#if SECTION_FILE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                mapping = mapped;
+                size = static_cast<size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+        if (mapping == nullptr) return false;
+        data = static_cast<const char*>(mapping);
+#else
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        if (length > 0) {
+            // uint64_t storage keeps the sections aligned
+            buffer.resize((static_cast<size_t>(length) + 7) / 8);
+            if (std::fread(buffer.data(), 1, static_cast<size_t>(length), file) != static_cast<size_t>(length)) {
+                buffer.clear();
+            }
+        }
+        std::fclose(file);
+        if (buffer.empty()) return false;
+        data = reinterpret_cast<const char*>(buffer.data());
+        size = static_cast<size_t>(length);
+#endif
+        return true;
+    }
+
+    void close() {
+#if SECTION_FILE_MMAP
+        if (mapping != nullptr) munmap(mapping, size);
+#endif
+        mapping = nullptr;
+        buffer.clear();
+        data = nullptr;
+        size = 0;
+    }
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    const char* data;
+    size_t size;
+    void* mapping;
+    std::vector<uint64_t> buffer;
+};
+
+// The records of a section that fits() the file.
+template <typename T>
+const T* records(const MappedFile& file, const Section& section) {
+    return reinterpret_cast<const T*>(file.getData() + section.offset);
+}
+
+} // namespace section_file
+
+#endif // SECTION_FILE_H
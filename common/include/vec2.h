@@ -0,0 +1,200 @@
+#ifndef ENGINE_VEC2_H
+#define ENGINE_VEC2_H
+
+// 2D vector math shared by the games. newclass's Vector2D is this Vec2; the
+// other games still carry their own Vector2D/Vector2 structs and distance()
+// helpers, which this replaces as they move over.
+//
+// Vec2 is a plain pair of floats; everything that doesn't need a square root
+// is constexpr. normalize() returns the zero vector for a zero-length input,
+// as the games' versions did, instead of dividing by zero.
+//
+// lengthBatch() and normalizeBatch() work on a structure-of-arrays of N
+// vectors, e.g. every zombie's velocity, and give bit-for-bit the same
+// results as length() and normalize() on each element. The kernel is AVX2
+// (8 vectors per step) when the CPU has it, SSE2 (4 per step) on any other
+// x86, and scalar elsewhere; the arrays need no padding or alignment.
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VEC2_SSE2 1
+#endif
+
+#if VEC2_SSE2 && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define VEC2_AVX2 1
+#endif
+
+namespace engine {
+
+struct Vec2 {
+    float x, y;
+
+    constexpr Vec2() : x(0.0f), y(0.0f) {}
+    constexpr Vec2(float x, float y) : x(x), y(y) {}
+
+    constexpr Vec2 operator+(const Vec2& v) const { return Vec2(x + v.x, y + v.y); }
+    constexpr Vec2 operator-(const Vec2& v) const { return Vec2(x - v.x, y - v.y); }
+    constexpr Vec2 operator-() const { return Vec2(-x, -y); }
+    constexpr Vec2 operator*(float scalar) const { return Vec2(x * scalar, y * scalar); }
+    constexpr Vec2 operator/(float scalar) const { return Vec2(x / scalar, y / scalar); }
+    constexpr bool operator==(const Vec2& v) const { return x == v.x && y == v.y; }
+    constexpr bool operator!=(const Vec2& v) const { return !(*this == v); }
+
+    Vec2& operator+=(const Vec2& v) {
+        x += v.x;
+        y += v.y;
+        return *this;
+    }
+
+    Vec2& operator-=(const Vec2& v) {
+        x -= v.x;
+        y -= v.y;
+        return *this;
+    }
+
+    Vec2& operator*=(float scalar) {
+        x *= scalar;
+        y *= scalar;
+        return *this;
+    }
+};
+
+constexpr Vec2 operator*(float scalar, const Vec2& v) { return v * scalar; }
+
+constexpr float dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+
+// z of the 3D cross product; positive when b is counter-clockwise from a.
+constexpr float cross(const Vec2& a, const Vec2& b) { return a.x * b.y - a.y * b.x; }
+
+constexpr float lengthSquared(const Vec2& v) { return v.x * v.x + v.y * v.y; }
+
+constexpr float distanceSquared(const Vec2& a, const Vec2& b) { return lengthSquared(b - a); }
+
+// Prefer comparing distanceSquared() against a squared radius where only
+// "closer than" matters; it skips the square root.
+inline float length(const Vec2& v) { return std::sqrt(lengthSquared(v)); }
+
+inline float distance(const Vec2& a, const Vec2& b) { return length(b - a); }
+
+// Drop-in for the games' distance(x1, y1, x2, y2), which went through pow().
+inline float distance(float x1, float y1, float x2, float y2) { return distance(Vec2(x1, y1), Vec2(x2, y2)); }
+
+inline Vec2 normalize(const Vec2& v) {
+    float len = length(v);
+    if (len > 0.0f) return Vec2(v.x / len, v.y / len);
+    return Vec2();
+}
+
+constexpr Vec2 lerp(const Vec2& a, const Vec2& b, float t) { return a + (b - a) * t; }
+
+// Batched kernels. lengths gets n lengths; the normalize kernels rewrite
+// x and y in place.
+
+inline void lengthBatchScalar(const float* x, const float* y, float* lengths, size_t n) {
+    for (size_t i = 0; i < n; ++i) lengths[i] = length(Vec2(x[i], y[i]));
+}
+
+inline void normalizeBatchScalar(float* x, float* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        Vec2 v = normalize(Vec2(x[i], y[i]));
+        x[i] = v.x;
+        y[i] = v.y;
+    }
+}
+
+#if VEC2_SSE2
+inline void lengthBatchSse2(const float* x, const float* y, float* lengths, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        _mm_storeu_ps(lengths + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy))));
+    }
+    lengthBatchScalar(x + i, y + i, lengths + i, n - i);
+}
+
+inline void normalizeBatchSse2(float* x, float* y, size_t n) {
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+        // Zero-length lanes divide 0 by 0; the mask turns their NaN into 0
+        __m128 nonZero = _mm_cmpgt_ps(len, zero);
+        _mm_storeu_ps(x + i, _mm_and_ps(nonZero, _mm_div_ps(vx, len)));
+        _mm_storeu_ps(y + i, _mm_and_ps(nonZero, _mm_div_ps(vy, len)));
+    }
+    normalizeBatchScalar(x + i, y + i, n - i);
+}
+#endif
+
+#if VEC2_AVX2
+__attribute__((target("avx2")))
+inline void lengthBatchAvx2(const float* x, const float* y, float* lengths, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(lengths + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy))));
+    }
+    lengthBatchSse2(x + i, y + i, lengths + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline void normalizeBatchAvx2(float* x, float* y, size_t n) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+        __m256 nonZero = _mm256_cmp_ps(len, zero, _CMP_GT_OQ);
+        _mm256_storeu_ps(x + i, _mm256_and_ps(nonZero, _mm256_div_ps(vx, len)));
+        _mm256_storeu_ps(y + i, _mm256_and_ps(nonZero, _mm256_div_ps(vy, len)));
+    }
+    normalizeBatchSse2(x + i, y + i, n - i);
+}
+#endif
+
+typedef void (*LengthKernel)(const float*, const float*, float*, size_t);
+typedef void (*NormalizeKernel)(float*, float*, size_t);
+
+// Best kernels for this CPU, picked on first use.
+inline LengthKernel bestLengthKernel() {
+#if VEC2_AVX2
+    static const LengthKernel kernel = __builtin_cpu_supports("avx2") ? lengthBatchAvx2 : lengthBatchSse2;
+    return kernel;
+#elif VEC2_SSE2
+    return lengthBatchSse2;
+#else
+    return lengthBatchScalar;
+#endif
+}
+
+inline NormalizeKernel bestNormalizeKernel() {
+#if VEC2_AVX2
+    static const NormalizeKernel kernel = __builtin_cpu_supports("avx2") ? normalizeBatchAvx2 : normalizeBatchSse2;
+    return kernel;
+#elif VEC2_SSE2
+    return normalizeBatchSse2;
+#else
+    return normalizeBatchScalar;
+#endif
+}
+
+inline void lengthBatch(const float* x, const float* y, float* lengths, size_t n) {
+    bestLengthKernel()(x, y, lengths, n);
+}
+
+inline void normalizeBatch(float* x, float* y, size_t n) {
+    bestNormalizeKernel()(x, y, n);
+}
+
+} // namespace engine
+
+#endif // ENGINE_VEC2_H
@@ -4,6 +4,9 @@
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <algorithm>
+#include <string>
+#include <cstring>
 
 // Constants
 const int SCREEN_WIDTH = 800;
@@ -11,6 +14,8 @@ const int SCREEN_HEIGHT = 600;
 const float PLAYER_SPEED = 3.0f;
 const float VEHICLE_SPEED = 5.0f;
 const float VEHICLE_ROTATION_SPEED = 2.5f;
+const float LATE_LATCH_MARGIN_MS = 2.0f;   // slack left before the predicted vsync
+const Uint32 LATENCY_REPORT_MS = 5000;     // how often latency percentiles are logged
 
 // Game object base class
 class GameObject {
@@ -171,6 +176,60 @@ public:
     Vehicle* getCurrentVehicle() const { return currentVehicle; }
 };
 
+// Input-to-present latency: the time from SDL queueing a keyboard event to
+// the return of the SDL_RenderPresent of the first frame that sampled it.
+// With vsync the present returns at about the flip, which is as close to
+// the photons as the game can see. Keeps the last SAMPLE_COUNT samples.
+class LatencyTracker {
+public:
+    static const int SAMPLE_COUNT = 256;
+    
+    LatencyTracker() : next(0), total(0) {}
+    
+    // An event with this SDL timestamp was read by the current frame
+    void inputSampled(Uint32 eventTimestamp) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        Uint32 age = SDL_GetTicks() - eventTimestamp; // ms since SDL queued it
+        Uint64 ageCounts = static_cast<Uint64>(age) * SDL_GetPerformanceFrequency() / 1000;
+        pending.push_back(ageCounts < now ? now - ageCounts : 0);
+    }
+    
+    // Call right after SDL_RenderPresent
+    void framePresented() {
+        Uint64 now = SDL_GetPerformanceCounter();
+        double countsPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+        for (Uint64 eventTime : pending) {
+            float ms = static_cast<float>((now - eventTime) / countsPerMs);
+            if (samples.size() < SAMPLE_COUNT) {
+                samples.push_back(ms);
+            } else {
+                samples[next] = ms;
+            }
+            next = (next + 1) % SAMPLE_COUNT;
+            total++;
+        }
+        pending.clear();
+    }
+    
+    // fraction 0.5 for the median; 0 without samples
+    float percentile(float fraction) const {
+        if (samples.empty()) return 0.0f;
+        std::vector<float> sorted(samples);
+        size_t rank = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        return sorted[rank];
+    }
+    
+    size_t getSampleCount() const { return samples.size(); }
+    size_t getTotalSamples() const { return total; }
+    
+private:
+    std::vector<Uint64> pending; // performance counter at each event, this frame
+    std::vector<float> samples;  // ring of latencies in ms
+    size_t next;
+    size_t total;
+};
+
 // Game class
 class Game {
 private:
@@ -190,6 +249,19 @@ private:
     
     int cameraX, cameraY;
     
+    // Latency measurement and late latching. In late-latch mode steering is
+    // read once more right before rendering, after waiting until just
+    // enough time is left to render before the next vsync.
+    LatencyTracker latency;
+    bool vsync;
+    bool lateLatch;
+    bool showLatency;
+    Uint32 latchedThrough;   // newest event timestamp already sampled by a late latch
+    Uint32 lastLatencyReport;
+    Uint64 lastPresent;      // performance counter after the last present
+    float refreshMs;
+    float renderMs;          // smoothed time to draw a frame before presenting
+    
     bool checkCollision(const SDL_Rect& a, const SDL_Rect& b) {
         return (a.x < b.x + b.w &&
                 a.x + a.w > b.x &&
@@ -198,7 +270,9 @@ private:
     }
     
 public:
-    Game() : window(nullptr), renderer(nullptr), isRunning(false), lastTime(0), cameraX(0), cameraY(0) {}
+    Game() : window(nullptr), renderer(nullptr), isRunning(false), lastTime(0), cameraX(0), cameraY(0),
+             vsync(false), lateLatch(false), showLatency(false), latchedThrough(0), lastLatencyReport(0),
+             lastPresent(0), refreshMs(1000.0f / 60), renderMs(0) {}
     
     ~Game() {
         cleanup();
@@ -222,12 +296,22 @@ public:
             return false;
         }
         
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
         if (!renderer) {
             std::cout << "Renderer could not be created! SDL Error: " << SDL_GetError() << std::endl;
             return false;
         }
         
+        // Frame pacing comes from vsync when the driver grants it
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0) {
+            vsync = (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+        }
+        SDL_DisplayMode mode;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0) {
+            refreshMs = 1000.0f / mode.refresh_rate;
+        }
+        
         // Load textures - In a real game, you'd have proper textures
         SDL_Surface* tempSurface = SDL_CreateRGBSurface(0, 32, 32, 32, 0, 0, 0, 0);
         SDL_FillRect(tempSurface, NULL, SDL_MapRGB(tempSurface->format, 255, 0, 0));
@@ -272,8 +356,22 @@ public:
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
                 isRunning = false;
-            } else if (e.type == SDL_KEYDOWN && e.key.repeat == 0) {
-                if (e.key.keysym.sym == SDLK_e) {
+            }
+            
+            // Key events shape this frame's input unless a late latch
+            // already read them last frame
+            if ((e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) && e.key.repeat == 0 &&
+                e.key.timestamp > latchedThrough) {
+                latency.inputSampled(e.key.timestamp);
+            }
+            
+            if (e.type == SDL_KEYDOWN && e.key.repeat == 0) {
+                if (e.key.keysym.sym == SDLK_F3) {
+                    showLatency = !showLatency;
+                } else if (e.key.keysym.sym == SDLK_F4) {
+                    lateLatch = !lateLatch;
+                    std::cout << "Late latch " << (lateLatch ? "on" : "off") << std::endl;
+                } else if (e.key.keysym.sym == SDLK_e) {
                     // Toggle vehicle entry/exit
                     if (player->isInVehicle()) {
                         player->exitVehicle();
@@ -315,10 +413,9 @@ public:
                 vehicle->brake();
             }
             
-            if (keystate[SDL_SCANCODE_A]) {
-                vehicle->turn(-VEHICLE_ROTATION_SPEED);
-            } else if (keystate[SDL_SCANCODE_D]) {
-                vehicle->turn(VEHICLE_ROTATION_SPEED);
+            // With late latch, steering is read in latchInput() instead
+            if (!lateLatch) {
+                steer(vehicle, keystate);
             }
         } else {
             // Player controls
@@ -333,6 +430,81 @@ public:
         }
     }
     
+    void steer(Vehicle* vehicle, const Uint8* keystate) {
+        if (keystate[SDL_SCANCODE_A]) {
+            vehicle->turn(-VEHICLE_ROTATION_SPEED);
+        } else if (keystate[SDL_SCANCODE_D]) {
+            vehicle->turn(VEHICLE_ROTATION_SPEED);
+        }
+    }
+    
+    // Waits until only the expected render time (plus a margin) is left
+    // before the next vsync, then samples steering again so the frame shows
+    // the newest input. Key events that arrived meanwhile stay queued for
+    // the next handleEvents(), which skips them for latency.
+    void latchInput() {
+        if (vsync && lastPresent != 0) {
+            double countsPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+            Uint64 latchAt = lastPresent + static_cast<Uint64>((refreshMs - renderMs - LATE_LATCH_MARGIN_MS) * countsPerMs);
+            Uint64 now = SDL_GetPerformanceCounter();
+            if (latchAt > now) {
+                double waitMs = (latchAt - now) / countsPerMs;
+                if (waitMs > 1.0) SDL_Delay(static_cast<Uint32>(waitMs - 1.0));
+                while (SDL_GetPerformanceCounter() < latchAt) {
+                    // spin off the last partial millisecond
+                }
+            }
+        }
+        
+        SDL_PumpEvents();
+        SDL_Event queued[32];
+        int count = SDL_PeepEvents(queued, 32, SDL_PEEKEVENT, SDL_KEYDOWN, SDL_KEYUP);
+        for (int i = 0; i < count; i++) {
+            if (queued[i].key.repeat == 0 && queued[i].key.timestamp > latchedThrough) {
+                latency.inputSampled(queued[i].key.timestamp);
+                latchedThrough = queued[i].key.timestamp;
+            }
+        }
+        
+        if (player->isInVehicle()) {
+            steer(player->getCurrentVehicle(), SDL_GetKeyboardState(NULL));
+        }
+    }
+    
+    // Logs latency percentiles every LATENCY_REPORT_MS
+    void reportLatency() {
+        Uint32 now = SDL_GetTicks();
+        if (now - lastLatencyReport < LATENCY_REPORT_MS || latency.getSampleCount() == 0) return;
+        lastLatencyReport = now;
+        
+        std::cout << "Input latency over " << latency.getSampleCount() << " events: p50 "
+                  << latency.percentile(0.5f) << " ms, p95 " << latency.percentile(0.95f)
+                  << " ms, p99 " << latency.percentile(0.99f) << " ms (vsync "
+                  << (vsync ? "on" : "off") << ", late latch " << (lateLatch ? "on" : "off")
+                  << ", render " << renderMs << " ms)" << std::endl;
+    }
+    
+    // Bars for p50, p95 and p99 at 4 pixels per millisecond, with a tick at
+    // one refresh interval
+    void renderLatencyOverlay() {
+        const float percentiles[3] = {0.5f, 0.95f, 0.99f};
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+        SDL_Rect panel = {10, 10, 300, 44};
+        SDL_RenderFillRect(renderer, &panel);
+        
+        for (int i = 0; i < 3; i++) {
+            int length = std::min(290, static_cast<int>(latency.percentile(percentiles[i]) * 4));
+            SDL_Rect bar = {15, 15 + i * 12, length, 8};
+            SDL_SetRenderDrawColor(renderer, lateLatch ? 80 : 230, 230, 80, 255);
+            SDL_RenderFillRect(renderer, &bar);
+        }
+        
+        int tick = 15 + static_cast<int>(refreshMs * 4);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawLine(renderer, tick, 12, tick, 52);
+    }
+    
     void update() {
         Uint32 currentTime = SDL_GetTicks();
         float deltaTime = (currentTime - lastTime) / 10.0f; // Scale for smoother movement
@@ -392,6 +564,7 @@ public:
     }
     
     void render() {
+        Uint64 renderStart = SDL_GetPerformanceCounter();
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
         
@@ -414,18 +587,37 @@ public:
             player->render(renderer, cameraX, cameraY);
         }
         
+        if (showLatency) {
+            renderLatencyOverlay();
+        }
+        
+        float drawMs = static_cast<float>((SDL_GetPerformanceCounter() - renderStart) * 1000.0 / SDL_GetPerformanceFrequency());
+        renderMs = renderMs == 0 ? drawMs : renderMs * 0.9f + drawMs * 0.1f;
+        
         SDL_RenderPresent(renderer);
+        lastPresent = SDL_GetPerformanceCounter();
+        latency.framePresented();
     }
     
     void run() {
         while (isRunning) {
             handleEvents();
             update();
+            if (lateLatch) {
+                latchInput();
+            }
             render();
-            SDL_Delay(16); // ~60 FPS
+            reportLatency();
+            
+            // Vsync already paces the loop
+            if (!vsync) {
+                SDL_Delay(16); // ~60 FPS
+            }
         }
     }
     
+    void setLateLatch(bool enabled) { lateLatch = enabled; }
+    
     void cleanup() {
         if (playerTexture) SDL_DestroyTexture(playerTexture);
         if (vehicleTexture) SDL_DestroyTexture(vehicleTexture);
@@ -443,6 +635,12 @@ public:
 int main(int argc, char* argv[]) {
     Game game;
     
+    // --late-latch starts with late input sampling on (F4 toggles it, F3
+    // shows the latency overlay)
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--late-latch") == 0) game.setLateLatch(true);
+    }
+    
     if (!game.initialize()) {
         std::cout << "Failed to initialize game!" << std::endl;
         return -1;
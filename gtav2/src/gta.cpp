@@ -17,6 +17,15 @@
 #include <algorithm>
 #include <random>
 #include <ctime>
+#include <utility>
+#include <cstdint>
+#include <queue>
+#include <functional>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "../../common/include/vec2.h"
+#include "../../common/include/camera.h"
 
 // Constants
 const int SCREEN_WIDTH = 800;
@@ -29,6 +38,11 @@ const float CAR_DECELERATION = 0.05f;
 const float CAR_TURN_SPEED = 3.0f;
 const int MAP_WIDTH = 50;
 const int MAP_HEIGHT = 50;
+const int NPC_COUNT = 100;
+const int CAR_COUNT = 150;
+const int POLICE_CAR_COUNT = 10;
+const float CAR_TURN_CHANCE = 1.0f / 101;   // per frame, for driverless cars
+const float NPC_WANDER_CHANCE = 2.0f / 101; // per frame, for new NPC directions
 
 // Game states
 enum GameState {
@@ -44,6 +58,14 @@ enum TileType {
     TILE_WATER
 };
 
+// Tileset source rect per TileType, in enum order
+constexpr SDL_Rect TILE_SOURCE_RECTS[] = {
+    {0, 0, TILE_SIZE, TILE_SIZE},             // TILE_ROAD
+    {TILE_SIZE, 0, TILE_SIZE, TILE_SIZE},     // TILE_GRASS
+    {TILE_SIZE * 2, 0, TILE_SIZE, TILE_SIZE}, // TILE_BUILDING
+    {TILE_SIZE * 3, 0, TILE_SIZE, TILE_SIZE}  // TILE_WATER
+};
+
 // Entity types
 enum EntityType {
     ENTITY_PLAYER,
@@ -52,41 +74,82 @@ enum EntityType {
     ENTITY_POLICE_CAR
 };
 
-// Utility functions
-float distance(float x1, float y1, float x2, float y2) {
-    return sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2));
+// Stateless hash of a counter (murmur3 finalizer). Random choices keyed on a
+// tile index cost O(1) each and do not depend on the order tiles are
+// visited in.
+uint32_t hashCounter(uint32_t counter, uint32_t salt) {
+    uint32_t h = counter * 0x9E3779B9u + salt;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
 }
 
-// Vector2 struct for positions and velocities
-struct Vector2 {
-    float x, y;
+// One bit per tile, set where movement is blocked (buildings and water).
+// Rows are packed 64 tiles to a word, so a span of a row is tested with a
+// mask per word instead of tile by tile.
+class TileBitmap {
+public:
+    static const int WORDS_PER_ROW = (MAP_WIDTH + 63) / 64;
     
-    Vector2() : x(0), y(0) {}
-    Vector2(float x, float y) : x(x), y(y) {}
+    TileBitmap() : rows(MAP_HEIGHT * WORDS_PER_ROW, 0) {}
     
-    Vector2 operator+(const Vector2& other) const {
-        return Vector2(x + other.x, y + other.y);
+    void build(const std::vector<std::vector<TileType>>& map) {
+        std::fill(rows.begin(), rows.end(), 0);
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            for (int x = 0; x < MAP_WIDTH; x++) {
+                if (map[y][x] == TILE_BUILDING || map[y][x] == TILE_WATER) {
+                    rows[y * WORDS_PER_ROW + x / 64] |= 1ULL << (x % 64);
+                }
+            }
+        }
     }
     
-    Vector2 operator-(const Vector2& other) const {
-        return Vector2(x - other.x, y - other.y);
+    bool isSolid(int x, int y) const {
+        if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT) return false;
+        return (rows[y * WORDS_PER_ROW + x / 64] >> (x % 64)) & 1;
     }
     
-    Vector2 operator*(float scalar) const {
-        return Vector2(x * scalar, y * scalar);
+    // Any solid tile in columns x0..x1 of rows y0..y1, inclusive; tiles off
+    // the map are not solid
+    bool anySolid(int x0, int y0, int x1, int y1) const {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, MAP_WIDTH - 1);
+        y1 = std::min(y1, MAP_HEIGHT - 1);
+        if (x0 > x1 || y0 > y1) return false;
+        
+        for (int word = x0 / 64; word <= x1 / 64; word++) {
+            int low = std::max(x0 - word * 64, 0);
+            int high = std::min(x1 - word * 64, 63);
+            uint64_t mask = (high == 63 ? ~0ULL : (1ULL << (high + 1)) - 1) & (~0ULL << low);
+            for (int y = y0; y <= y1; y++) {
+                if (rows[y * WORDS_PER_ROW + word] & mask) return true;
+            }
+        }
+        return false;
     }
     
-    float magnitude() const {
-        return sqrt(x * x + y * y);
-    }
+private:
+    std::vector<uint64_t> rows;
+};
+
+// Positions and velocities are the shared engine vector; length(),
+// normalize() and distance() are free functions in namespace engine
+typedef engine::Vec2 Vector2;
+
+// Box centred on an entity and turned with it; (cosine, sine) runs along
+// its width
+struct OrientedBox {
+    float centerX, centerY;
+    float cosine, sine;
+    float halfWidth, halfHeight;
     
-    Vector2 normalized() const {
-        float mag = magnitude();
-        if (mag > 0) {
-            return Vector2(x / mag, y / mag);
-        }
-        return Vector2(0, 0);
-    }
+    // Half size of the axis-aligned box around it
+    float extentX() const { return std::fabs(cosine) * halfWidth + std::fabs(sine) * halfHeight; }
+    float extentY() const { return std::fabs(sine) * halfWidth + std::fabs(cosine) * halfHeight; }
 };
 
 // Forward declarations
@@ -94,23 +157,20 @@ class Entity;
 class Vehicle;
 class Game;
 
-// Camera class to handle viewport
+// Camera class to handle viewport, the shared engine camera over the map
 class Camera {
 public:
-    Vector2 position;
-    
-    Camera() : position(0, 0) {}
+    Camera() : view(SCREEN_WIDTH, SCREEN_HEIGHT, MAP_WIDTH * TILE_SIZE, MAP_HEIGHT * TILE_SIZE) {}
     
+    // Centres the view on entityPos, clamped to the map
     SDL_Rect getViewport(const Vector2& entityPos) {
-        position.x = entityPos.x - SCREEN_WIDTH / 2;
-        position.y = entityPos.y - SCREEN_HEIGHT / 2;
-        
-        // Clamp camera to map boundaries
-        position.x = std::max(0.0f, std::min(position.x, (MAP_WIDTH * TILE_SIZE) - SCREEN_WIDTH + 0.0f));
-        position.y = std::max(0.0f, std::min(position.y, (MAP_HEIGHT * TILE_SIZE) - SCREEN_HEIGHT + 0.0f));
-        
+        view.follow(entityPos);
+        Vector2 position = view.position();
         return {(int)position.x, (int)position.y, SCREEN_WIDTH, SCREEN_HEIGHT};
     }
+    
+private:
+    engine::Camera view;
 };
 
 // Base entity class
@@ -118,25 +178,42 @@ class Entity {
 protected:
     SDL_Texture* texture;
     Vector2 position;
+    Vector2 previousPosition; // before this frame's move, restored on collision
     Vector2 velocity;
     float rotation;
     float speed;
     int width, height;
     bool collidable;
+    bool simulated; // false while TrafficLod moves it as a road agent
     EntityType type;
     
 public:
     Entity(SDL_Texture* tex, float x, float y, int w, int h, EntityType t, bool collide = true) :
-        texture(tex), position(x, y), velocity(0, 0), rotation(0), speed(0),
-        width(w), height(h), collidable(collide), type(t) {}
+        texture(tex), position(x, y), previousPosition(x, y), velocity(0, 0), rotation(0), speed(0),
+        width(w), height(h), collidable(collide), simulated(true), type(t) {}
     
     virtual ~Entity() {}
     
-    virtual void update(float deltaTime, const std::vector<std::shared_ptr<Entity>>& entities, const std::vector<std::vector<TileType>>& map) {
+    // Moves the entity; collisions with other entities are resolved after
+    // everything has moved, through onCollision()
+    virtual void update(float deltaTime, const TileBitmap& /*solids*/) {
         // Basic movement
+        previousPosition = position;
         position = position + velocity * deltaTime;
     }
     
+    // Decision-making, called by AiScheduler at a rate that depends on the
+    // distance to the player; elapsedFrames have passed since the last call
+    virtual void think(int /*elapsedFrames*/, std::mt19937& /*rng*/) {}
+    
+    // Whether touching other should stop this entity
+    virtual bool reactsTo(const Entity& /*other*/) const { return true; }
+    
+    // Called by CollisionWorld for each overlapping entity this reacts to
+    virtual void onCollision(Entity& /*other*/) {
+        position = previousPosition;
+    }
+    
     virtual void render(SDL_Renderer* renderer, const SDL_Rect& camera) {
         SDL_Rect destRect = {
             (int)(position.x - camera.x - width / 2),
@@ -152,40 +229,25 @@ public:
         }
     }
     
-    bool checkCollision(const Entity& other) const {
-        if (!collidable || !other.collidable) return false;
-        
-        return distance(position.x, position.y, other.position.x, other.position.y) < 
-               (width + other.width) / 2.5f;
+    virtual bool isCollidable() const { return collidable && simulated; }
+    
+    bool isSimulated() const { return simulated; }
+    void setSimulated(bool value) { simulated = value; }
+    
+    OrientedBox getBounds() const {
+        float radians = rotation * M_PI / 180.0f;
+        return {position.x, position.y, std::cos(radians), std::sin(radians), width / 2.0f, height / 2.0f};
     }
     
-    bool checkTileCollision(const std::vector<std::vector<TileType>>& map) const {
+    bool checkTileCollision(const TileBitmap& solids) const {
         if (!collidable) return false;
         
-        // Get surrounding tiles
-        int tileX = (int)(position.x / TILE_SIZE);
-        int tileY = (int)(position.y / TILE_SIZE);
-        
-        for (int y = tileY - 1; y <= tileY + 1; y++) {
-            for (int x = tileX - 1; x <= tileX + 1; x++) {
-                if (x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT) {
-                    if (map[y][x] == TILE_BUILDING || map[y][x] == TILE_WATER) {
-                        float tileLeft = x * TILE_SIZE;
-                        float tileTop = y * TILE_SIZE;
-                        
-                        // Simple AABB collision
-                        if (position.x + width / 2 > tileLeft && 
-                            position.x - width / 2 < tileLeft + TILE_SIZE &&
-                            position.y + height / 2 > tileTop && 
-                            position.y - height / 2 < tileTop + TILE_SIZE) {
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-        
-        return false;
+        // Tiles the entity's box overlaps, edges touching excluded
+        int minX = (int)std::floor((position.x - width / 2) / TILE_SIZE);
+        int minY = (int)std::floor((position.y - height / 2) / TILE_SIZE);
+        int maxX = (int)std::ceil((position.x + width / 2) / TILE_SIZE) - 1;
+        int maxY = (int)std::ceil((position.y + height / 2) / TILE_SIZE) - 1;
+        return solids.anySolid(minX, minY, maxX, maxY);
     }
     
     // Getters
@@ -208,29 +270,22 @@ private:
     float deceleration;
     float turnSpeed;
     bool occupied;
+    bool bounced; // already bounced off an entity this frame
     
 public:
     Vehicle(SDL_Texture* tex, float x, float y, int w, int h, EntityType t) :
         Entity(tex, x, y, w, h, t), currentSpeed(0), maxSpeed(CAR_MAX_SPEED),
         acceleration(CAR_ACCELERATION), deceleration(CAR_DECELERATION),
-        turnSpeed(CAR_TURN_SPEED), occupied(false) {}
+        turnSpeed(CAR_TURN_SPEED), occupied(false), bounced(false) {}
     
-    void update(float deltaTime, const std::vector<std::shared_ptr<Entity>>& entities, const std::vector<std::vector<TileType>>& map) override {
+    void update(float deltaTime, const TileBitmap& solids) override {
         // Save old position for collision resolution
-        Vector2 oldPosition = position;
+        previousPosition = position;
+        bounced = false;
         
         if (!occupied) {
-            // AI car behavior when not occupied
-            // Simple car AI: follow roads and make random turns
+            // AI car behavior when not occupied; turns are decided in think()
             currentSpeed = maxSpeed * 0.5f;
-            
-            // Random direction changes occasionally
-            static std::mt19937 rng(std::time(nullptr));
-            std::uniform_int_distribution<int> turnDist(0, 100);
-            if (turnDist(rng) < 1) {
-                std::uniform_int_distribution<int> angleDist(0, 3);
-                rotation = angleDist(rng) * 90.0f;
-            }
         }
         
         // Apply physics
@@ -242,22 +297,31 @@ public:
         position = position + velocity;
         
         // Check collisions with map
-        if (checkTileCollision(map)) {
-            position = oldPosition;
+        if (checkTileCollision(solids)) {
+            position = previousPosition;
             rotation += 180.0f; // Turn around if we hit something
             if (rotation >= 360.0f) rotation -= 360.0f;
         }
+    }
+    
+    // Simple car AI: random turns now and then, as likely over elapsedFrames
+    // as when rolled every frame
+    void think(int elapsedFrames, std::mt19937& rng) override {
+        if (occupied) return;
         
-        // Check collisions with other entities
-        for (const auto& entity : entities) {
-            if (entity.get() != this && checkCollision(*entity)) {
-                position = oldPosition;
-                currentSpeed *= -0.5f; // Bounce back a bit
-                break;
-            }
+        if (std::bernoulli_distribution(1 - std::pow(1 - CAR_TURN_CHANCE, elapsedFrames))(rng)) {
+            std::uniform_int_distribution<int> angleDist(0, 3);
+            rotation = angleDist(rng) * 90.0f;
         }
     }
     
+    void onCollision(Entity& /*other*/) override {
+        if (bounced) return;
+        bounced = true;
+        position = previousPosition;
+        currentSpeed *= -0.5f; // Bounce back a bit
+    }
+    
     void accelerate() {
         currentSpeed += acceleration;
         if (currentSpeed > maxSpeed) currentSpeed = maxSpeed;
@@ -307,7 +371,7 @@ public:
         speed = PLAYER_SPEED;
     }
     
-    void update(float deltaTime, const std::vector<std::shared_ptr<Entity>>& entities, const std::vector<std::vector<TileType>>& map) override {
+    void update(float deltaTime, const TileBitmap& solids) override {
         if (currentVehicle) {
             // If in a vehicle, position matches the vehicle
             position = currentVehicle->getPosition();
@@ -316,43 +380,42 @@ public:
         }
         
         // Save old position for collision resolution
-        Vector2 oldPosition = position;
+        previousPosition = position;
         
         // Move character
         position = position + velocity * speed;
         
         // Check collisions with map
-        if (checkTileCollision(map)) {
-            position = oldPosition;
-        }
-        
-        // Check collisions with other entities
-        for (const auto& entity : entities) {
-            if (entity.get() != this && entity->getType() != ENTITY_PLAYER && 
-                entity->getType() != ENTITY_NPC && checkCollision(*entity)) {
-                position = oldPosition;
-                break;
-            }
+        if (checkTileCollision(solids)) {
+            position = previousPosition;
         }
+    }
+    
+    // Simple AI: wander around, picking a new direction now and then
+    void think(int elapsedFrames, std::mt19937& rng) override {
+        if (isPlayer || currentVehicle) return;
         
-        // If not player, apply some AI behavior
-        if (!isPlayer) {
-            // Simple AI: wander around
-            static std::mt19937 rng(std::time(nullptr));
-            std::uniform_int_distribution<int> moveDist(0, 100);
+        if (std::bernoulli_distribution(1 - std::pow(1 - NPC_WANDER_CHANCE, elapsedFrames))(rng)) {
+            std::uniform_int_distribution<int> dirDist(0, 3);
+            int dir = dirDist(rng);
             
-            if (moveDist(rng) < 2) {
-                std::uniform_int_distribution<int> dirDist(0, 3);
-                int dir = dirDist(rng);
-                
-                if (dir == 0) velocity = Vector2(1, 0);
-                else if (dir == 1) velocity = Vector2(-1, 0);
-                else if (dir == 2) velocity = Vector2(0, 1);
-                else velocity = Vector2(0, -1);
-            }
+            if (dir == 0) velocity = Vector2(1, 0);
+            else if (dir == 1) velocity = Vector2(-1, 0);
+            else if (dir == 2) velocity = Vector2(0, 1);
+            else velocity = Vector2(0, -1);
         }
     }
     
+    // Characters walk through each other but not through vehicles
+    bool reactsTo(const Entity& other) const override {
+        return other.getType() != ENTITY_PLAYER && other.getType() != ENTITY_NPC;
+    }
+    
+    // A character in a vehicle moves with it and is no obstacle of its own
+    bool isCollidable() const override {
+        return Entity::isCollidable() && !currentVehicle;
+    }
+    
     void enterVehicle(std::shared_ptr<Vehicle> vehicle) {
         if (!vehicle || vehicle->isOccupied()) return;
         
@@ -373,21 +436,521 @@ public:
     }
     
     void setVelocity(const Vector2& vel) {
-        velocity = vel.normalized();
+        velocity = engine::normalize(vel);
     }
     
     bool isInVehicle() const { return currentVehicle != nullptr; }
     std::shared_ptr<Vehicle> getVehicle() const { return currentVehicle; }
 };
 
+// Entity-entity collision detection.
+//
+// Broadphase is sweep and prune on x. The proxies stay sorted by the left
+// edge of their bounding box from frame to frame, so the insertion sort in
+// update() only moves entities that overtook a neighbour, and sweeping the
+// sorted list yields the pairs whose bounding boxes overlap. Narrowphase is
+// a separating axis test on the rotated boxes, four pairs at a time with
+// SSE2 and one at a time for the remainder.
+class CollisionWorld {
+public:
+    typedef std::pair<Entity*, Entity*> Contact;
+    
+    void add(Entity* entity) {
+        proxies.push_back({entity, 0, 0, 0, 0});
+    }
+    
+    void remove(Entity* entity) {
+        proxies.erase(std::remove_if(proxies.begin(), proxies.end(),
+                                     [entity](const Proxy& proxy) { return proxy.entity == entity; }),
+                      proxies.end());
+    }
+    
+    // Every touching pair after this frame's movement, each once, with the
+    // entity that reacts to the other first
+    const std::vector<Contact>& update() {
+        // Refresh the boxes, then restore x order
+        for (Proxy& proxy : proxies) {
+            OrientedBox box = proxy.entity->getBounds();
+            float ex = box.extentX(), ey = box.extentY();
+            proxy.minX = box.centerX - ex;
+            proxy.maxX = box.centerX + ex;
+            proxy.minY = box.centerY - ey;
+            proxy.maxY = box.centerY + ey;
+        }
+        for (size_t i = 1; i < proxies.size(); i++) {
+            Proxy moving = proxies[i];
+            size_t j = i;
+            for (; j > 0 && proxies[j - 1].minX > moving.minX; j--) {
+                proxies[j] = proxies[j - 1];
+            }
+            proxies[j] = moving;
+        }
+        
+        // Sweep: everything starting before this proxy ends overlaps it on x
+        first.clear();
+        second.clear();
+        pairs.clear();
+        for (size_t i = 0; i < proxies.size(); i++) {
+            const Proxy& a = proxies[i];
+            if (!a.entity->isCollidable()) continue;
+            for (size_t j = i + 1; j < proxies.size() && proxies[j].minX <= a.maxX; j++) {
+                const Proxy& b = proxies[j];
+                if (b.minY > a.maxY || b.maxY < a.minY || !b.entity->isCollidable()) continue;
+                
+                bool aReacts = a.entity->reactsTo(*b.entity);
+                if (!aReacts && !b.entity->reactsTo(*a.entity)) continue;
+                first.push(a.entity->getBounds());
+                second.push(b.entity->getBounds());
+                pairs.push_back(aReacts ? Contact(a.entity, b.entity) : Contact(b.entity, a.entity));
+            }
+        }
+        
+        contacts.clear();
+        size_t i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 <= pairs.size(); i += 4) {
+            int mask = overlapMask4(i);
+            for (int lane = 0; lane < 4; lane++) {
+                if (mask & (1 << lane)) contacts.push_back(pairs[i + lane]);
+            }
+        }
+#endif
+        for (; i < pairs.size(); i++) {
+            if (overlaps(i)) contacts.push_back(pairs[i]);
+        }
+        return contacts;
+    }
+    
+    // Pairs that reached the narrowphase in the last update()
+    size_t getCandidateCount() const { return pairs.size(); }
+    
+private:
+    struct Proxy {
+        Entity* entity;
+        float minX, maxX, minY, maxY;
+    };
+    
+    // One side of the candidate pairs, one array per box field
+    struct BoxLanes {
+        std::vector<float> x, y, c, s, hw, hh;
+        
+        void clear() {
+            x.clear(); y.clear(); c.clear(); s.clear(); hw.clear(); hh.clear();
+        }
+        
+        void push(const OrientedBox& box) {
+            x.push_back(box.centerX);
+            y.push_back(box.centerY);
+            c.push_back(box.cosine);
+            s.push_back(box.sine);
+            hw.push_back(box.halfWidth);
+            hh.push_back(box.halfHeight);
+        }
+    };
+    
+    // In 2D only the angle between the boxes matters: with C and S the
+    // absolute cosine and sine of it, the half size of one box along an axis
+    // of the other is hw * C + hh * S or hw * S + hh * C. The boxes overlap
+    // unless the centre offset projected on one of the four axes is longer
+    // than both half sizes along it.
+    bool overlaps(size_t i) const {
+        float dx = second.x[i] - first.x[i];
+        float dy = second.y[i] - first.y[i];
+        float ac = first.c[i], as = first.s[i], bc = second.c[i], bs = second.s[i];
+        float ahw = first.hw[i], ahh = first.hh[i], bhw = second.hw[i], bhh = second.hh[i];
+        float C = std::fabs(ac * bc + as * bs);
+        float S = std::fabs(ac * bs - as * bc);
+        
+        if (std::fabs(dx * ac + dy * as) > ahw + bhw * C + bhh * S) return false;
+        if (std::fabs(dy * ac - dx * as) > ahh + bhw * S + bhh * C) return false;
+        if (std::fabs(dx * bc + dy * bs) > bhw + ahw * C + ahh * S) return false;
+        if (std::fabs(dy * bc - dx * bs) > bhh + ahw * S + ahh * C) return false;
+        return true;
+    }
+    
+#if defined(__SSE2__)
+    // overlaps() for pairs i..i+3, one bit per overlapping pair
+    int overlapMask4(size_t i) const {
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        __m128 ac = _mm_loadu_ps(&first.c[i]), as = _mm_loadu_ps(&first.s[i]);
+        __m128 bc = _mm_loadu_ps(&second.c[i]), bs = _mm_loadu_ps(&second.s[i]);
+        __m128 ahw = _mm_loadu_ps(&first.hw[i]), ahh = _mm_loadu_ps(&first.hh[i]);
+        __m128 bhw = _mm_loadu_ps(&second.hw[i]), bhh = _mm_loadu_ps(&second.hh[i]);
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&second.x[i]), _mm_loadu_ps(&first.x[i]));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&second.y[i]), _mm_loadu_ps(&first.y[i]));
+        
+        __m128 C = _mm_andnot_ps(signBit, _mm_add_ps(_mm_mul_ps(ac, bc), _mm_mul_ps(as, bs)));
+        __m128 S = _mm_andnot_ps(signBit, _mm_sub_ps(_mm_mul_ps(ac, bs), _mm_mul_ps(as, bc)));
+        
+        __m128 projA1 = _mm_andnot_ps(signBit, _mm_add_ps(_mm_mul_ps(dx, ac), _mm_mul_ps(dy, as)));
+        __m128 projA2 = _mm_andnot_ps(signBit, _mm_sub_ps(_mm_mul_ps(dy, ac), _mm_mul_ps(dx, as)));
+        __m128 projB1 = _mm_andnot_ps(signBit, _mm_add_ps(_mm_mul_ps(dx, bc), _mm_mul_ps(dy, bs)));
+        __m128 projB2 = _mm_andnot_ps(signBit, _mm_sub_ps(_mm_mul_ps(dy, bc), _mm_mul_ps(dx, bs)));
+        
+        __m128 reachA1 = _mm_add_ps(ahw, _mm_add_ps(_mm_mul_ps(bhw, C), _mm_mul_ps(bhh, S)));
+        __m128 reachA2 = _mm_add_ps(ahh, _mm_add_ps(_mm_mul_ps(bhw, S), _mm_mul_ps(bhh, C)));
+        __m128 reachB1 = _mm_add_ps(bhw, _mm_add_ps(_mm_mul_ps(ahw, C), _mm_mul_ps(ahh, S)));
+        __m128 reachB2 = _mm_add_ps(bhh, _mm_add_ps(_mm_mul_ps(ahw, S), _mm_mul_ps(ahh, C)));
+        
+        __m128 separated = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(projA1, reachA1), _mm_cmpgt_ps(projA2, reachA2)),
+                                     _mm_or_ps(_mm_cmpgt_ps(projB1, reachB1), _mm_cmpgt_ps(projB2, reachB2)));
+        return ~_mm_movemask_ps(separated) & 0xF;
+    }
+#endif
+    
+    std::vector<Proxy> proxies;  // sorted by minX after update()
+    BoxLanes first, second;      // boxes of the candidate pairs
+    std::vector<Contact> pairs;  // candidate pairs, reacting entity first
+    std::vector<Contact> contacts;
+};
+
+// Road network extracted from the TILE_ROAD tiles. Nodes sit on the road
+// tiles where a road branches, bends or ends; every straight run between
+// two nodes is an edge with one lane per direction.
+class RoadGraph {
+public:
+    struct Lane {
+        int from, to;   // node indices
+        int reverse;    // the lane running the other way
+        float length;   // in pixels, between node tile centres
+        float dirX, dirY;
+    };
+    
+    void build(const std::vector<std::vector<TileType>>& map) {
+        nodes.clear();
+        lanes.clear();
+        nodeAtTile.assign(MAP_WIDTH * MAP_HEIGHT, -1);
+        laneAtTile.assign(MAP_WIDTH * MAP_HEIGHT, -1);
+        
+        auto isRoad = [&map](int x, int y) {
+            return x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT && map[y][x] == TILE_ROAD;
+        };
+        
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            for (int x = 0; x < MAP_WIDTH; x++) {
+                if (!isRoad(x, y)) continue;
+                bool horizontal = isRoad(x - 1, y) && isRoad(x + 1, y);
+                bool vertical = isRoad(x, y - 1) && isRoad(x, y + 1);
+                int neighbours = isRoad(x - 1, y) + isRoad(x + 1, y) + isRoad(x, y - 1) + isRoad(x, y + 1);
+                if (neighbours == 2 && (horizontal || vertical)) continue; // straight road
+                
+                nodeAtTile[y * MAP_WIDTH + x] = static_cast<int>(nodes.size());
+                nodes.push_back({x, y, std::vector<int>()});
+            }
+        }
+        
+        // Walk east and south from every node; the opposite walks would find
+        // the same runs again
+        const int stepX[2] = {1, 0};
+        const int stepY[2] = {0, 1};
+        for (int from = 0; from < static_cast<int>(nodes.size()); from++) {
+            for (int d = 0; d < 2; d++) {
+                int x = nodes[from].tileX + stepX[d];
+                int y = nodes[from].tileY + stepY[d];
+                int tiles = 1;
+                std::vector<int> run;
+                while (isRoad(x, y) && nodeAtTile[y * MAP_WIDTH + x] < 0) {
+                    run.push_back(y * MAP_WIDTH + x);
+                    x += stepX[d];
+                    y += stepY[d];
+                    tiles++;
+                }
+                if (!isRoad(x, y)) continue;
+                
+                int to = nodeAtTile[y * MAP_WIDTH + x];
+                int forward = static_cast<int>(lanes.size());
+                float length = static_cast<float>(tiles * TILE_SIZE);
+                lanes.push_back({from, to, forward + 1, length, static_cast<float>(stepX[d]), static_cast<float>(stepY[d])});
+                lanes.push_back({to, from, forward, length, static_cast<float>(-stepX[d]), static_cast<float>(-stepY[d])});
+                nodes[from].outgoing.push_back(forward);
+                nodes[to].outgoing.push_back(forward + 1);
+                for (int tile : run) {
+                    laneAtTile[tile] = forward;
+                }
+            }
+        }
+    }
+    
+    // Point along a lane, shifted sideOffset pixels to the right of travel
+    Vector2 lanePoint(int lane, float along, float sideOffset) const {
+        const Lane& l = lanes[lane];
+        const Node& from = nodes[l.from];
+        float x = (from.tileX + 0.5f) * TILE_SIZE + l.dirX * along - l.dirY * sideOffset;
+        float y = (from.tileY + 0.5f) * TILE_SIZE + l.dirY * along + l.dirX * sideOffset;
+        return Vector2(x, y);
+    }
+    
+    float laneHeading(int lane) const {
+        return std::atan2(lanes[lane].dirY, lanes[lane].dirX) * 180.0f / M_PI;
+    }
+    
+    // The lane position closest to pos, preferring the lane that runs the
+    // way heading (degrees) points. lane is -1 when there is no road.
+    void nearestLane(const Vector2& pos, float heading, int& lane, float& along) const {
+        lane = -1;
+        along = 0;
+        int tileX = std::max(0, std::min(MAP_WIDTH - 1, (int)(pos.x / TILE_SIZE)));
+        int tileY = std::max(0, std::min(MAP_HEIGHT - 1, (int)(pos.y / TILE_SIZE)));
+        float radians = heading * M_PI / 180.0f;
+        float headX = std::cos(radians), headY = std::sin(radians);
+        
+        int forward = laneAtTile[tileY * MAP_WIDTH + tileX];
+        if (forward >= 0) {
+            const Lane& l = lanes[forward];
+            const Node& from = nodes[l.from];
+            float offset = (tileX - from.tileX) * l.dirX + (tileY - from.tileY) * l.dirY;
+            along = offset * TILE_SIZE;
+            lane = forward;
+            if (l.dirX * headX + l.dirY * headY < 0) {
+                lane = l.reverse;
+                along = l.length - along;
+            }
+            return;
+        }
+        
+        // On a node tile or off the road: start from the nearest node
+        int node = nodeAtTile[tileY * MAP_WIDTH + tileX];
+        if (node < 0) {
+            float best = 0;
+            for (int i = 0; i < static_cast<int>(nodes.size()); i++) {
+                if (nodes[i].outgoing.empty()) continue;
+                float dx = (nodes[i].tileX + 0.5f) * TILE_SIZE - pos.x;
+                float dy = (nodes[i].tileY + 0.5f) * TILE_SIZE - pos.y;
+                if (node < 0 || dx * dx + dy * dy < best) {
+                    node = i;
+                    best = dx * dx + dy * dy;
+                }
+            }
+        }
+        if (node < 0) return;
+        
+        float bestDot = -2;
+        for (int candidate : nodes[node].outgoing) {
+            float dot = lanes[candidate].dirX * headX + lanes[candidate].dirY * headY;
+            if (dot > bestDot) {
+                lane = candidate;
+                bestDot = dot;
+            }
+        }
+    }
+    
+    // Lane to take at the end of lane; turning back only at dead ends
+    int nextLane(int lane, std::mt19937& rng) const {
+        const Node& node = nodes[lanes[lane].to];
+        int choices = static_cast<int>(node.outgoing.size()) - 1;
+        if (choices <= 0) return lanes[lane].reverse;
+        
+        int pick = std::uniform_int_distribution<int>(0, choices - 1)(rng);
+        for (int candidate : node.outgoing) {
+            if (candidate == lanes[lane].reverse) continue;
+            if (pick-- == 0) return candidate;
+        }
+        return lanes[lane].reverse;
+    }
+    
+    const Lane& getLane(int lane) const { return lanes[lane]; }
+    int getNodeCount() const { return static_cast<int>(nodes.size()); }
+    int getLaneCount() const { return static_cast<int>(lanes.size()); }
+    
+private:
+    struct Node {
+        int tileX, tileY;
+        std::vector<int> outgoing; // lanes leaving this node
+    };
+    
+    std::vector<Node> nodes;
+    std::vector<Lane> lanes;
+    std::vector<int> nodeAtTile; // node per tile, -1 for none
+    std::vector<int> laneAtTile; // east- or southbound lane through a straight road tile, -1 for none
+};
+
+// Level of detail for NPCs and free vehicles. Near the camera view they get
+// their full update() and collisions. Further out they become agents on
+// the RoadGraph that only advance along their lane, every LOD_TICK_FRAMES
+// frames, and they return to full simulation at their lane position when
+// the view comes within LOD_RANGE. The agents are split into
+// LOD_TICK_FRAMES groups and one group is processed per frame, so the cost
+// stays flat however many there are.
+class TrafficLod {
+public:
+    static const int LOD_TICK_FRAMES = 8;
+    static const int LOD_RANGE = TILE_SIZE * 2;        // promote within this of the view
+    static const int LOD_HYSTERESIS = TILE_SIZE;       // extra distance before demoting again
+    
+    explicit TrafficLod(const RoadGraph& roads) : roads(roads), frame(0), rng(std::time(nullptr)) {}
+    
+    void addVehicle(Vehicle* vehicle) {
+        agents.push_back({vehicle, vehicle, CAR_MAX_SPEED * 0.5f, TILE_SIZE / 4.0f, -1, 0});
+    }
+    
+    void addPedestrian(Character* character) {
+        agents.push_back({character, nullptr, PLAYER_SPEED, TILE_SIZE * 0.4f, -1, 0});
+    }
+    
+    void update(const SDL_Rect& view) {
+        frame++;
+        for (size_t i = frame % LOD_TICK_FRAMES; i < agents.size(); i += LOD_TICK_FRAMES) {
+            Agent& agent = agents[i];
+            if (agent.lane < 0) {
+                if (!agent.entity->isSimulated()) agent.entity->setSimulated(true);
+                if (outsideView(agent.entity->getPosition(), view, LOD_RANGE + LOD_HYSTERESIS) &&
+                    !(agent.vehicle && agent.vehicle->isOccupied())) {
+                    demote(agent);
+                }
+                continue;
+            }
+            
+            advance(agent, agent.speed * LOD_TICK_FRAMES);
+            if (!outsideView(agent.entity->getPosition(), view, LOD_RANGE)) {
+                promote(agent);
+            }
+        }
+    }
+    
+    int getAgentCount() const {
+        int count = 0;
+        for (const Agent& agent : agents) {
+            if (agent.lane >= 0) count++;
+        }
+        return count;
+    }
+    
+private:
+    struct Agent {
+        Entity* entity;
+        Vehicle* vehicle;  // nullptr for pedestrians
+        float speed;       // pixels per frame
+        float sideOffset;  // right of the lane centre line
+        int lane;          // -1 while fully simulated
+        float along;
+    };
+    
+    static bool outsideView(const Vector2& pos, const SDL_Rect& view, int margin) {
+        return pos.x < view.x - margin || pos.x > view.x + view.w + margin ||
+               pos.y < view.y - margin || pos.y > view.y + view.h + margin;
+    }
+    
+    void demote(Agent& agent) {
+        roads.nearestLane(agent.entity->getPosition(), agent.entity->getRotation(), agent.lane, agent.along);
+        if (agent.lane < 0) return; // no roads, stays simulated
+        agent.entity->setSimulated(false);
+        place(agent);
+    }
+    
+    void promote(Agent& agent) {
+        agent.lane = -1;
+        agent.entity->setSimulated(true);
+    }
+    
+    void advance(Agent& agent, float distance) {
+        agent.along += distance;
+        while (agent.along >= roads.getLane(agent.lane).length) {
+            agent.along -= roads.getLane(agent.lane).length;
+            agent.lane = roads.nextLane(agent.lane, rng);
+        }
+        place(agent);
+    }
+    
+    void place(const Agent& agent) {
+        agent.entity->setPosition(roads.lanePoint(agent.lane, agent.along, agent.sideOffset));
+        if (agent.vehicle) agent.entity->setRotation(roads.laneHeading(agent.lane));
+    }
+    
+    const RoadGraph& roads;
+    std::vector<Agent> agents;
+    unsigned int frame;
+    std::mt19937 rng;
+};
+
+// Time-slices NPC and traffic decisions. Each agent thinks at an interval
+// set by its distance to the player: every frame up close, every
+// MID_INTERVAL or FAR_INTERVAL frames further out, with each importance
+// level halving the interval. Due agents are served oldest first, at most
+// AI_BUDGET of them per frame, and the rest stay due until the next frame.
+// Agents start on staggered frames so the ones sharing an interval do not
+// all come due together. Road agents of TrafficLod are rescheduled without
+// thinking.
+class AiScheduler {
+public:
+    static const int AI_BUDGET = 48;              // think() calls per frame
+    static const int NEAR_RANGE = TILE_SIZE * 8;  // thinks every frame within this
+    static const int MID_RANGE = TILE_SIZE * 16;
+    static const int MID_INTERVAL = 4;
+    static const int FAR_INTERVAL = 16;
+    
+    struct Stats {
+        int thinks;      // think() calls in the last frame
+        int maxLateness; // frames the most overdue of them waited past its turn
+    };
+    
+    AiScheduler() : frame(0), rng(std::time(nullptr)) {
+        stats = {0, 0};
+    }
+    
+    void add(Entity* entity, int importance = 0) {
+        int index = static_cast<int>(agents.size());
+        agents.push_back({entity, importance, frame});
+        due.push({frame + 1 + index % FAR_INTERVAL, index});
+    }
+    
+    void update(const Vector2& playerPos) {
+        frame++;
+        stats = {0, 0};
+        while (!due.empty() && due.top().first <= frame && stats.thinks < AI_BUDGET) {
+            unsigned int dueFrame = due.top().first;
+            int index = due.top().second;
+            due.pop();
+            
+            Agent& agent = agents[index];
+            if (agent.entity->isSimulated()) {
+                agent.entity->think(static_cast<int>(frame - agent.lastThink), rng);
+                stats.thinks++;
+                stats.maxLateness = std::max(stats.maxLateness, static_cast<int>(frame - dueFrame));
+            }
+            agent.lastThink = frame;
+            due.push({frame + interval(agent, playerPos), index});
+        }
+    }
+    
+    const Stats& getStats() const { return stats; }
+    
+private:
+    struct Agent {
+        Entity* entity;
+        int importance;
+        unsigned int lastThink;
+    };
+    
+    static int interval(const Agent& agent, const Vector2& playerPos) {
+        Vector2 pos = agent.entity->getPosition();
+        float dist = engine::distance(pos, playerPos);
+        int frames = dist < NEAR_RANGE ? 1 : dist < MID_RANGE ? MID_INTERVAL : FAR_INTERVAL;
+        return std::max(1, frames >> agent.importance);
+    }
+    
+    typedef std::pair<unsigned int, int> DueEntry; // frame, agent index
+    
+    std::vector<Agent> agents;
+    std::priority_queue<DueEntry, std::vector<DueEntry>, std::greater<DueEntry>> due;
+    unsigned int frame;
+    std::mt19937 rng;
+    Stats stats;
+};
+
 // World/map generation
 class World {
 private:
+    static const uint32_t BUILDING_SALT = 0x6275696C; // keys the building hash
+    
     std::vector<std::vector<TileType>> map;
+    TileBitmap solids;
+    RoadGraph roads;
     
 public:
     World() : map(MAP_HEIGHT, std::vector<TileType>(MAP_WIDTH, TILE_GRASS)) {
         generateMap();
+        solids.build(map);
+        roads.build(map);
     }
     
     void generateMap() {
@@ -415,11 +978,8 @@ public:
                 if (map[y][x] == TILE_GRASS) {
                     if ((y > 1 && y < MAP_HEIGHT - 2) && (x > 1 && x < MAP_WIDTH - 2)) {
                         if ((y % 8 > 1 && y % 8 < 7) && (x % 8 > 1 && x % 8 < 7)) {
-                            // Random building size
-                            std::mt19937 rng(y * MAP_WIDTH + x);
-                            std::uniform_int_distribution<int> buildingDist(0, 10);
-                            
-                            if (buildingDist(rng) < 7) {
+                            // Random building size, a 7 in 11 chance per tile
+                            if (hashCounter(y * MAP_WIDTH + x, BUILDING_SALT) % 11 < 7) {
                                 map[y][x] = TILE_BUILDING;
                             }
                         }
@@ -453,22 +1013,6 @@ public:
         // Render visible tiles
         for (int y = startY; y < endY; y++) {
             for (int x = startX; x < endX; x++) {
-                SDL_Rect srcRect;
-                switch (map[y][x]) {
-                    case TILE_ROAD:
-                        srcRect = {0, 0, TILE_SIZE, TILE_SIZE};
-                        break;
-                    case TILE_GRASS:
-                        srcRect = {TILE_SIZE, 0, TILE_SIZE, TILE_SIZE};
-                        break;
-                    case TILE_BUILDING:
-                        srcRect = {TILE_SIZE * 2, 0, TILE_SIZE, TILE_SIZE};
-                        break;
-                    case TILE_WATER:
-                        srcRect = {TILE_SIZE * 3, 0, TILE_SIZE, TILE_SIZE};
-                        break;
-                }
-                
                 SDL_Rect destRect = {
                     (int)(x * TILE_SIZE - camera.x),
                     (int)(y * TILE_SIZE - camera.y),
@@ -476,7 +1020,7 @@ public:
                     TILE_SIZE
                 };
                 
-                SDL_RenderCopy(renderer, tileset, &srcRect, &destRect);
+                SDL_RenderCopy(renderer, tileset, &TILE_SOURCE_RECTS[map[y][x]], &destRect);
             }
         }
     }
@@ -484,6 +1028,14 @@ public:
     const std::vector<std::vector<TileType>>& getMap() const {
         return map;
     }
+    
+    const TileBitmap& getSolids() const {
+        return solids;
+    }
+    
+    const RoadGraph& getRoads() const {
+        return roads;
+    }
 };
 
 // Main game class
@@ -506,6 +1058,15 @@ private:
     std::vector<std::shared_ptr<Entity>> entities;
     World world;
     Camera camera;
+    CollisionWorld collisions;
+    TrafficLod traffic;
+    AiScheduler ai;
+    
+    // AI budget report, toggled with F2
+    bool showAiStats;
+    int aiThinks;
+    int aiPeakThinks;
+    int aiStatFrames;
     
     // Input handling
     const Uint8* keyboardState;
@@ -517,7 +1078,8 @@ private:
     
 public:
     Game() : window(nullptr), renderer(nullptr), running(false),
-             state(STATE_WALKING), keyboardState(nullptr), lastFrameTime(0) {}
+             state(STATE_WALKING), traffic(world.getRoads()), showAiStats(false),
+             aiThinks(0), aiPeakThinks(0), aiStatFrames(0), keyboardState(nullptr), lastFrameTime(0) {}
     
     ~Game() {
         cleanup();
@@ -570,25 +1132,39 @@ public:
         player = std::make_shared<Character>(playerTexture, MAP_WIDTH * TILE_SIZE / 2, MAP_HEIGHT * TILE_SIZE / 2, true);
         entities.push_back(player);
         
-        // Add some NPCs
-        for (int i = 0; i < 20; i++) {
+        // Add some NPCs; the ones out of view turn into road agents within
+        // the first few frames
+        for (int i = 0; i < NPC_COUNT; i++) {
             int x = (rand() % (MAP_WIDTH - 4) + 2) * TILE_SIZE;
             int y = (rand() % (MAP_HEIGHT - 4) + 2) * TILE_SIZE;
-            entities.push_back(std::make_shared<Character>(npcTexture, x, y, false));
+            auto npc = std::make_shared<Character>(npcTexture, x, y, false);
+            traffic.addPedestrian(npc.get());
+            ai.add(npc.get());
+            entities.push_back(npc);
         }
         
         // Add some vehicles
-        for (int i = 0; i < 15; i++) {
+        for (int i = 0; i < CAR_COUNT; i++) {
             int x = (rand() % (MAP_WIDTH - 4) + 2) * TILE_SIZE;
             int y = (rand() % (MAP_HEIGHT - 4) + 2) * TILE_SIZE;
-            entities.push_back(std::make_shared<Vehicle>(carTexture, x, y, 48, 24, ENTITY_CAR));
+            auto car = std::make_shared<Vehicle>(carTexture, x, y, 48, 24, ENTITY_CAR);
+            traffic.addVehicle(car.get());
+            ai.add(car.get());
+            entities.push_back(car);
         }
         
         // Add some police cars
-        for (int i = 0; i < 5; i++) {
+        for (int i = 0; i < POLICE_CAR_COUNT; i++) {
             int x = (rand() % (MAP_WIDTH - 4) + 2) * TILE_SIZE;
             int y = (rand() % (MAP_HEIGHT - 4) + 2) * TILE_SIZE;
-            entities.push_back(std::make_shared<Vehicle>(policeCarTexture, x, y, 48, 24, ENTITY_POLICE_CAR));
+            auto car = std::make_shared<Vehicle>(policeCarTexture, x, y, 48, 24, ENTITY_POLICE_CAR);
+            traffic.addVehicle(car.get());
+            ai.add(car.get(), 1); // police react sooner
+            entities.push_back(car);
+        }
+        
+        for (const auto& entity : entities) {
+            collisions.add(entity.get());
         }
         
         running = true;
@@ -622,6 +1198,8 @@ private:
             } else if (event.type == SDL_KEYDOWN) {
                 if (event.key.keysym.sym == SDLK_ESCAPE) {
                     running = false;
+                } else if (event.key.keysym.sym == SDLK_F2) {
+                    showAiStats = !showAiStats;
                 } else if (event.key.keysym.sym == SDLK_f) {
                     // Enter/exit vehicle
                     if (state == STATE_WALKING) {
@@ -630,8 +1208,7 @@ private:
                             if ((entity->getType() == ENTITY_CAR || entity->getType() == ENTITY_POLICE_CAR) &&
                                 dynamic_cast<Vehicle*>(entity.get()) &&
                                 !dynamic_cast<Vehicle*>(entity.get())->isOccupied() &&
-                                distance(player->getPosition().x, player->getPosition().y,
-                                         entity->getPosition().x, entity->getPosition().y) < 60) {
+                                engine::distance(player->getPosition(), entity->getPosition()) < 60) {
                                 
                                 player->enterVehicle(std::dynamic_pointer_cast<Vehicle>(entity));
                                 state = STATE_DRIVING;
@@ -700,12 +1277,45 @@ private:
         // Use a fixed time step for more consistent simulation
         const float fixedDeltaTime = 1.0f / FPS;
         
-        // Update all entities with the fixed time step
+        // Swap entities between full simulation and road agents
+        traffic.update(camera.getViewport(player->getPosition()));
+        
+        // Decisions for the agents whose turn it is, then physics for all
+        ai.update(player->getPosition());
+        reportAiStats();
+        
+        // Update all fully simulated entities with the fixed time step
         for (auto& entity : entities) {
-            entity->update(fixedDeltaTime, entities, world.getMap());
+            if (entity->isSimulated()) {
+                entity->update(fixedDeltaTime, world.getSolids());
+            }
+        }
+        
+        // Then let every entity react to what it ran into
+        for (const CollisionWorld::Contact& contact : collisions.update()) {
+            contact.first->onCollision(*contact.second);
+            if (contact.second->reactsTo(*contact.first)) {
+                contact.second->onCollision(*contact.first);
+            }
         }
     }
     
+    // Once a second while enabled, logs how much of the AI budget was used
+    void reportAiStats() {
+        const AiScheduler::Stats& stats = ai.getStats();
+        aiThinks += stats.thinks;
+        aiPeakThinks = std::max(aiPeakThinks, stats.thinks);
+        if (++aiStatFrames < FPS) return;
+        
+        if (showAiStats) {
+            float average = static_cast<float>(aiThinks) / aiStatFrames;
+            std::cout << "AI: " << average << "/" << AiScheduler::AI_BUDGET << " thinks per frame ("
+                      << (int)(100 * average / AiScheduler::AI_BUDGET) << "% of budget), peak "
+                      << aiPeakThinks << ", most late " << stats.maxLateness << " frames" << std::endl;
+        }
+        aiThinks = aiPeakThinks = aiStatFrames = 0;
+    }
+    
     void render() {
         // Clear screen
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
@@ -743,6 +1353,19 @@ private:
         SDL_Rect statusRect = {10, 10, 200, 30};
         SDL_RenderFillRect(renderer, &statusRect);
         
+        // AI budget use of the last frame, red once agents wait past their turn
+        if (showAiStats) {
+            const AiScheduler::Stats& stats = ai.getStats();
+            SDL_Rect budgetRect = {statusRect.x, statusRect.y + statusRect.h + 4,
+                                   statusRect.w * stats.thinks / AiScheduler::AI_BUDGET, 6};
+            if (stats.maxLateness > 0) {
+                SDL_SetRenderDrawColor(renderer, 220, 40, 40, 255);
+            } else {
+                SDL_SetRenderDrawColor(renderer, 40, 220, 40, 255);
+            }
+            SDL_RenderFillRect(renderer, &budgetRect);
+        }
+        
         // Actual text rendering would require SDL_ttf, which isn't included in this example
     }
     
@@ -5,8 +5,18 @@
 #include <cmath>
 #include <string>
 #include <map>
-#include <functional>
 #include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "../common/include/vec2.h"
+#include "../common/include/collision.h"
+#ifndef _WIN32
+#include "../common/include/section_file.h"
+#endif
 
 // Constants
 const int SCREEN_WIDTH = 800;
@@ -16,6 +26,9 @@ const float JUMP_FORCE = -12.0f;
 const int PLAYER_SPEED = 5;
 const int SEARCH_TIME = 5000; // 5 seconds in milliseconds
 const int ARMOR_PIECES_FOR_UPGRADE = 5;
+const int COLLISION_CELL_SIZE = 64; // Collision grid cell size in pixels
+const char* const LEVEL_DIRECTORY = "levels/";
+const int LEVEL_RANDOM_ARMOR = -1; // Armor item that rolls its piece at load
 
 // Forward declarations
 class GameObject;
@@ -48,25 +61,22 @@ enum class ItemType {
     HEALTH
 };
 
-// Simple Vector2 class for positions and velocities
-struct Vector2 {
+// Positions and velocities are the shared engine vector
+typedef engine::Vec2 Vector2;
+
+// Axis-aligned box with float position, for collision queries. Kept as
+// position and size for the sweep; overlap tests go through the engine's
+// corner boxes.
+struct AABB {
     float x, y;
+    float w, h;
     
-    Vector2() : x(0), y(0) {}
-    Vector2(float x, float y) : x(x), y(y) {}
-    
-    Vector2 operator+(const Vector2& other) const {
-        return Vector2(x + other.x, y + other.y);
-    }
-    
-    Vector2 operator-(const Vector2& other) const {
-        return Vector2(x - other.x, y - other.y);
+    engine::Box Corners() const {
+        return batch_aabb::makeBox(x, y, w, h);
     }
     
-    Vector2& operator+=(const Vector2& other) {
-        x += other.x;
-        y += other.y;
-        return *this;
+    bool Overlaps(const AABB& other) const {
+        return engine::overlaps(Corners(), other.Corners());
     }
 };
 
@@ -120,13 +130,18 @@ public:
         };
     }
     
+    AABB GetBounds() const {
+        return {position.x, position.y, static_cast<float>(width), static_cast<float>(height)};
+    }
+    
     bool CheckCollision(const GameObject* other) const {
         if (!active || !other->active) return false;
         
         SDL_Rect a = GetRect();
         SDL_Rect b = other->GetRect();
         
-        return SDL_HasIntersection(&a, &b);
+        return engine::overlaps(batch_aabb::makeBox(a.x, a.y, a.w, a.h),
+                                batch_aabb::makeBox(b.x, b.y, b.w, b.h));
     }
 };
 
@@ -169,52 +184,7 @@ public:
     
     void Update(float deltaTime) override;
     
-    void Render(SDL_Renderer* renderer) override {
-        GameObject::Render(renderer);
-        
-        // Render health bar
-        SDL_Rect healthBar = {
-            static_cast<int>(position.x),
-            static_cast<int>(position.y - 10),
-            width,
-            5
-        };
-        
-        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-        SDL_RenderFillRect(renderer, &healthBar);
-        
-        healthBar.w = static_cast<int>((float)health / maxHealth * width);
-        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-        SDL_RenderFillRect(renderer, &healthBar);
-        
-        // Render search progress if searching
-        if (isSearching && currentSearchItem) {
-            const int radius = 15;
-            const int centerX = static_cast<int>(currentSearchItem->position.x + currentSearchItem->width / 2);
-            const int centerY = static_cast<int>(currentSearchItem->position.y + currentSearchItem->height / 2);
-            
-            // Draw background circle
-            SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255);
-            for (int w = 0; w < radius * 2; w++) {
-                for (int h = 0; h < radius * 2; h++) {
-                    int dx = radius - w;
-                    int dy = radius - h;
-                    if ((dx*dx + dy*dy) <= (radius * radius)) {
-                        SDL_RenderDrawPoint(renderer, centerX + dx, centerY + dy);
-                    }
-                }
-            }
-            
-            // Draw progress arc
-            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-            float angle = searchProgress * 2 * M_PI;
-            for (float a = 0; a < angle; a += 0.01f) {
-                int x = static_cast<int>(centerX + cos(a) * radius);
-                int y = static_cast<int>(centerY + sin(a) * radius);
-                SDL_RenderDrawPoint(renderer, x, y);
-            }
-        }
-    }
+    void Render(SDL_Renderer* renderer) override;
     
     void Jump() {
         if (isOnGround) {
@@ -314,6 +284,228 @@ public:
     }
 };
 
+// Kinds of static level geometry held by the collision grid
+enum class ColliderType {
+    PLATFORM,
+    LADDER
+};
+
+// First contact found by a swept query
+struct SweepHit {
+    float time;             // fraction of the motion before contact, 0 to 1
+    float normalX, normalY; // face of the collider that was hit
+    AABB box;               // the collider
+    int index;              // index into Game's platforms or ladders
+};
+
+// Static collision structure for one level, built in LoadLevel. Platforms
+// and ladders are copied into a flat array and their ids bucketed into a
+// uniform grid of COLLISION_CELL_SIZE cells, so a query only looks at the
+// geometry in the cells it passes through. Sweep() is continuous: it finds
+// the time of impact of a moving box over its whole motion, so a fast
+// projectile cannot skip over a thin platform between two frames.
+class CollisionGrid {
+public:
+    CollisionGrid() : originX(0), originY(0), cols(0), rows(0), queryStamp(0) {}
+    
+    void Build(const std::vector<Platform>& platforms, const std::vector<Ladder>& ladders) {
+        colliders.clear();
+        for (size_t i = 0; i < platforms.size(); ++i) {
+            colliders.push_back({platforms[i].GetBounds(), ColliderType::PLATFORM, static_cast<int>(i)});
+        }
+        for (size_t i = 0; i < ladders.size(); ++i) {
+            colliders.push_back({ladders[i].GetBounds(), ColliderType::LADDER, static_cast<int>(i)});
+        }
+        stamps.assign(colliders.size(), 0);
+        queryStamp = 0;
+        
+        if (colliders.empty()) {
+            cols = rows = 0;
+            cellStart.assign(1, 0);
+            cellIds.clear();
+            return;
+        }
+        
+        float minX = colliders[0].box.x, minY = colliders[0].box.y;
+        float maxX = minX, maxY = minY;
+        for (const Collider& collider : colliders) {
+            minX = std::min(minX, collider.box.x);
+            minY = std::min(minY, collider.box.y);
+            maxX = std::max(maxX, collider.box.x + collider.box.w);
+            maxY = std::max(maxY, collider.box.y + collider.box.h);
+        }
+        originX = minX;
+        originY = minY;
+        cols = static_cast<int>((maxX - minX) / COLLISION_CELL_SIZE) + 1;
+        rows = static_cast<int>((maxY - minY) / COLLISION_CELL_SIZE) + 1;
+        
+        // Count, then fill, so each cell's ids are contiguous in cellIds
+        cellStart.assign(cols * rows + 1, 0);
+        for (const Collider& collider : colliders) {
+            int minCol, minRow, maxCol, maxRow;
+            CellRange(collider.box, minCol, minRow, maxCol, maxRow);
+            for (int row = minRow; row <= maxRow; ++row) {
+                for (int col = minCol; col <= maxCol; ++col) {
+                    cellStart[row * cols + col + 1]++;
+                }
+            }
+        }
+        for (int cell = 0; cell < cols * rows; ++cell) {
+            cellStart[cell + 1] += cellStart[cell];
+        }
+        cellIds.assign(cellStart.back(), 0);
+        std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (size_t id = 0; id < colliders.size(); ++id) {
+            int minCol, minRow, maxCol, maxRow;
+            CellRange(colliders[id].box, minCol, minRow, maxCol, maxRow);
+            for (int row = minRow; row <= maxRow; ++row) {
+                for (int col = minCol; col <= maxCol; ++col) {
+                    cellIds[fill[row * cols + col]++] = static_cast<int>(id);
+                }
+            }
+        }
+    }
+    
+    // Earliest platform the box hits while moving by (dx, dy). Platforms are
+    // solid from above and the sides; unless solidUnderside is set, a box
+    // rising into one from below passes through, so the player can jump up
+    // onto it. Platforms the box already overlaps are ignored so it can
+    // leave them.
+    bool Sweep(const AABB& box, float dx, float dy, bool solidUnderside, SweepHit& hit) {
+        bool found = false;
+        hit.time = 1.0f;
+        VisitCells(box, dx, dy, [&](const Collider& collider) {
+            if (collider.type != ColliderType::PLATFORM) return;
+            
+            float time, normalX, normalY;
+            if (!SweptAABB(box, dx, dy, collider.box, time, normalX, normalY)) return;
+            if (normalY > 0 && !solidUnderside) return;
+            if (found && time >= hit.time) return;
+            
+            found = true;
+            hit.time = time;
+            hit.normalX = normalX;
+            hit.normalY = normalY;
+            hit.box = collider.box;
+            hit.index = collider.index;
+        });
+        return found;
+    }
+    
+    // Whether the box overlaps any collider of the given type
+    bool Overlaps(const AABB& box, ColliderType type) {
+        bool found = false;
+        VisitCells(box, 0, 0, [&](const Collider& collider) {
+            if (!found && collider.type == type && box.Overlaps(collider.box)) {
+                found = true;
+            }
+        });
+        return found;
+    }
+    
+    // Time of impact of box a moving by (dx, dy) against the static box b,
+    // by the slab method on the Minkowski difference. Touching counts as a
+    // contact at time 0, starting out overlapping does not count at all.
+    static bool SweptAABB(const AABB& a, float dx, float dy, const AABB& b,
+                          float& time, float& normalX, float& normalY) {
+        float entryX, exitX, entryY, exitY;
+        if (!SlabTimes(a.x, a.w, dx, b.x, b.w, entryX, exitX)) return false;
+        if (!SlabTimes(a.y, a.h, dy, b.y, b.h, entryY, exitY)) return false;
+        
+        float entry = std::max(entryX, entryY);
+        float exit = std::min(exitX, exitY);
+        if (entry >= exit || entry < 0.0f || entry > 1.0f) return false;
+        
+        time = entry;
+        normalX = normalY = 0.0f;
+        if (entryX > entryY) {
+            normalX = dx > 0 ? -1.0f : 1.0f;
+        } else {
+            normalY = dy > 0 ? -1.0f : 1.0f;
+        }
+        return true;
+    }
+    
+private:
+    struct Collider {
+        AABB box;
+        ColliderType type;
+        int index;
+    };
+    
+    std::vector<Collider> colliders;
+    std::vector<int> cellStart; // cols * rows + 1 offsets into cellIds
+    std::vector<int> cellIds;
+    std::vector<unsigned> stamps; // last query that visited each collider
+    float originX, originY;
+    int cols, rows;
+    unsigned queryStamp;
+    
+    // Entry and exit time on one axis; false when the boxes never overlap
+    // on it
+    static bool SlabTimes(float a, float aSize, float delta, float b, float bSize,
+                          float& entry, float& exit) {
+        if (delta == 0.0f) {
+            if (a + aSize <= b || a >= b + bSize) return false;
+            entry = -std::numeric_limits<float>::infinity();
+            exit = std::numeric_limits<float>::infinity();
+        } else if (delta > 0.0f) {
+            entry = (b - (a + aSize)) / delta;
+            exit = (b + bSize - a) / delta;
+        } else {
+            entry = (b + bSize - a) / delta;
+            exit = (b - (a + aSize)) / delta;
+        }
+        return true;
+    }
+    
+    void CellRange(const AABB& box, int& minCol, int& minRow, int& maxCol, int& maxRow) const {
+        minCol = std::max(0, static_cast<int>(std::floor((box.x - originX) / COLLISION_CELL_SIZE)));
+        minRow = std::max(0, static_cast<int>(std::floor((box.y - originY) / COLLISION_CELL_SIZE)));
+        maxCol = std::min(cols - 1, static_cast<int>(std::floor((box.x + box.w - originX) / COLLISION_CELL_SIZE)));
+        maxRow = std::min(rows - 1, static_cast<int>(std::floor((box.y + box.h - originY) / COLLISION_CELL_SIZE)));
+    }
+    
+    // Calls visit once for every collider in the cells the box covers along
+    // its motion. The motion is cut into slices no longer than a cell and
+    // only the cells under each slice's bounds are visited, so a long
+    // diagonal move does not scan the whole rectangle it spans.
+    template <typename Visitor>
+    void VisitCells(const AABB& box, float dx, float dy, Visitor visit) {
+        if (colliders.empty()) return;
+        if (++queryStamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            queryStamp = 1;
+        }
+        
+        float length = std::max(std::fabs(dx), std::fabs(dy));
+        int slices = std::max(1, static_cast<int>(std::ceil(length / COLLISION_CELL_SIZE)));
+        for (int slice = 0; slice < slices; ++slice) {
+            float t0 = static_cast<float>(slice) / slices;
+            float t1 = static_cast<float>(slice + 1) / slices;
+            AABB bounds;
+            bounds.x = box.x + std::min(dx * t0, dx * t1);
+            bounds.y = box.y + std::min(dy * t0, dy * t1);
+            bounds.w = box.w + std::fabs(dx) / slices;
+            bounds.h = box.h + std::fabs(dy) / slices;
+            
+            int minCol, minRow, maxCol, maxRow;
+            CellRange(bounds, minCol, minRow, maxCol, maxRow);
+            for (int row = minRow; row <= maxRow; ++row) {
+                for (int col = minCol; col <= maxCol; ++col) {
+                    int cell = row * cols + col;
+                    for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                        int id = cellIds[i];
+                        if (stamps[id] == queryStamp) continue;
+                        stamps[id] = queryStamp;
+                        visit(colliders[id]);
+                    }
+                }
+            }
+        }
+    }
+};
+
 // Projectile class
 class Projectile : public GameObject {
 public:
@@ -424,15 +616,18 @@ public:
     ArmorType armorType;
     int amount;
     bool searched;
-    std::function<void(Player*, ItemType, ArmorType, int)> onSearchComplete;
     
-    SearchableItem(float x, float y, ItemType itemType, int amt) : 
+    // armorPiece is an ArmorType, or LEVEL_RANDOM_ARMOR to roll one
+    SearchableItem(float x, float y, ItemType itemType, int amt, int armorPiece = LEVEL_RANDOM_ARMOR) : 
         GameObject(x, y, 24, 24),
         type(itemType),
+        armorType(ArmorType::HEAD),
         amount(amt),
         searched(false) {
-        // For armor, randomly assign a piece type
-        if (type == ItemType::ARMOR) {
+        if (type == ItemType::ARMOR && armorPiece != LEVEL_RANDOM_ARMOR) {
+            armorType = static_cast<ArmorType>(armorPiece);
+        } else if (type == ItemType::ARMOR) {
+            // For armor, randomly assign a piece type
             int randType = rand() % 5;
             switch(randType) {
                 case 0: armorType = ArmorType::HEAD; break;
@@ -473,14 +668,183 @@ public:
     }
     
     void Complete(Player* player) {
-        if (onSearchComplete) {
-            onSearchComplete(player, type, armorType, amount);
+        switch (type) {
+            case ItemType::AMMO:
+                player->ammo += amount;
+                break;
+            case ItemType::HEALTH:
+                player->health += amount;
+                if (player->health > player->maxHealth) {
+                    player->health = player->maxHealth;
+                }
+                break;
+            case ItemType::ARMOR:
+                player->AddArmorPiece(armorType);
+                break;
         }
         searched = true;
         active = false;
     }
 };
 
+// Level file layout. A level is a common/include/section_file.h file: one
+// header followed by flat arrays of the records below, which LoadLevel maps
+// and reads in place. Level files are built offline from the
+// text form in levels/ with --convert. Bump LEVEL_VERSION whenever a record
+// changes.
+const char LEVEL_MAGIC[4] = { 'M', 'P', 'L', 'V' };
+const uint32_t LEVEL_VERSION = 1;
+
+typedef section_file::Section LevelSection;
+
+struct BoxRecord {
+    float x, y;
+    int32_t w, h;
+};
+
+struct EnemyRecord {
+    float x, y;
+    int32_t health;
+    int32_t padding;
+};
+
+struct ItemRecord {
+    float x, y;
+    int32_t type;      // ItemType
+    int32_t amount;
+    int32_t armorType; // ArmorType, or LEVEL_RANDOM_ARMOR
+    int32_t padding;
+};
+
+struct LevelHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    float playerX, playerY;
+    uint32_t padding;
+    LevelSection platforms;
+    LevelSection ladders;
+    LevelSection enemies;
+    LevelSection items;
+};
+
+// Checks a mapped level before anything is read from it: magic, version,
+// that every section is aligned and inside the file, and that item types
+// are known.
+const LevelHeader* ValidateLevel(const section_file::MappedFile& file) {
+    if (file.getSize() < sizeof(LevelHeader)) return nullptr;
+    
+    const LevelHeader* header = reinterpret_cast<const LevelHeader*>(file.getData());
+    if (memcmp(header->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0) return nullptr;
+    if (header->version != LEVEL_VERSION) {
+        std::cout << "Level version " << header->version << " is not supported" << std::endl;
+        return nullptr;
+    }
+    if (header->fileSize != file.getSize()) return nullptr;
+    
+    const LevelSection* sections[] = { &header->platforms, &header->ladders, &header->enemies, &header->items };
+    const size_t recordSizes[] = { sizeof(BoxRecord), sizeof(BoxRecord), sizeof(EnemyRecord), sizeof(ItemRecord) };
+    for (int i = 0; i < 4; ++i) {
+        if (!section_file::fits(*sections[i], recordSizes[i], file.getSize())) return nullptr;
+    }
+    
+    const ItemRecord* items = section_file::records<ItemRecord>(file, header->items);
+    for (uint32_t i = 0; i < header->items.count; ++i) {
+        if (items[i].type < static_cast<int32_t>(ItemType::AMMO) || items[i].type > static_cast<int32_t>(ItemType::HEALTH)) return nullptr;
+        if (items[i].armorType < LEVEL_RANDOM_ARMOR || items[i].armorType > static_cast<int32_t>(ArmorType::FEET)) return nullptr;
+    }
+    return header;
+}
+
+// Offline converter from the text level form (see levels/level1.txt) to a
+// level file. Reports the first bad line and writes nothing on error.
+bool ConvertLevel(const std::string& textPath, const std::string& levelPath) {
+    std::ifstream text(textPath);
+    if (!text) {
+        std::cout << "Could not open level source " << textPath << std::endl;
+        return false;
+    }
+    
+    LevelHeader header = {};
+    memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.version = LEVEL_VERSION;
+    std::vector<BoxRecord> platforms, ladders;
+    std::vector<EnemyRecord> enemies;
+    std::vector<ItemRecord> items;
+    
+    const char* const itemNames[] = { "ammo", "armor", "health" };
+    const char* const armorNames[] = { "head", "chest", "legs", "arms", "feet" };
+    
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(text, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        
+        std::istringstream fields(line);
+        std::string kind;
+        if (!(fields >> kind)) continue;
+        
+        bool valid = false;
+        if (kind == "player") {
+            valid = static_cast<bool>(fields >> header.playerX >> header.playerY);
+        } else if (kind == "platform" || kind == "ladder") {
+            BoxRecord box;
+            valid = static_cast<bool>(fields >> box.x >> box.y >> box.w >> box.h) && box.w > 0 && box.h > 0;
+            (kind == "platform" ? platforms : ladders).push_back(box);
+        } else if (kind == "enemy") {
+            EnemyRecord enemy = {};
+            valid = static_cast<bool>(fields >> enemy.x >> enemy.y >> enemy.health) && enemy.health > 0;
+            enemies.push_back(enemy);
+        } else if (kind == "item") {
+            ItemRecord item = {};
+            std::string typeName, armorName;
+            valid = static_cast<bool>(fields >> typeName >> item.x >> item.y >> item.amount);
+            item.type = -1;
+            for (int i = 0; i < 3; ++i) {
+                if (typeName == itemNames[i]) item.type = i;
+            }
+            item.armorType = LEVEL_RANDOM_ARMOR;
+            if (fields >> armorName) {
+                for (int i = 0; i < 5; ++i) {
+                    if (armorName == armorNames[i]) item.armorType = i;
+                }
+                valid = valid && item.armorType != LEVEL_RANDOM_ARMOR &&
+                        item.type == static_cast<int32_t>(ItemType::ARMOR);
+            }
+            valid = valid && item.type >= 0;
+            items.push_back(item);
+        }
+        
+        if (!valid) {
+            std::cout << textPath << ":" << lineNumber << ": bad level line: " << line << std::endl;
+            return false;
+        }
+    }
+    
+    section_file::Layout layout(sizeof(LevelHeader));
+    layout.place(header.platforms, platforms.size(), sizeof(BoxRecord));
+    layout.place(header.ladders, ladders.size(), sizeof(BoxRecord));
+    layout.place(header.enemies, enemies.size(), sizeof(EnemyRecord));
+    layout.place(header.items, items.size(), sizeof(ItemRecord));
+    header.fileSize = layout.size();
+    
+    std::vector<char> buffer(header.fileSize, 0);
+    memcpy(buffer.data(), &header, sizeof(header));
+    section_file::copySection(buffer, header.platforms, platforms.data(), sizeof(BoxRecord));
+    section_file::copySection(buffer, header.ladders, ladders.data(), sizeof(BoxRecord));
+    section_file::copySection(buffer, header.enemies, enemies.data(), sizeof(EnemyRecord));
+    section_file::copySection(buffer, header.items, items.data(), sizeof(ItemRecord));
+    
+    std::ofstream file(levelPath, std::ios::binary);
+    if (!file || !file.write(buffer.data(), buffer.size())) {
+        std::cout << "Could not write level " << levelPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
 // Game class to manage everything
 class Game {
 private:
@@ -489,17 +853,22 @@ private:
     GameState state;
     
     std::shared_ptr<Player> player;
-    std::vector<std::shared_ptr<Platform>> platforms;
-    std::vector<std::shared_ptr<Ladder>> ladders;
-    std::vector<std::shared_ptr<Enemy>> enemies;
+    // Level objects live in contiguous arrays for the whole level; enemies
+    // and items are deactivated rather than erased, so Player's
+    // currentSearchItem stays valid
+    std::vector<Platform> platforms;
+    std::vector<Ladder> ladders;
+    std::vector<Enemy> enemies;
     std::vector<std::shared_ptr<Projectile>> projectiles;
-    std::vector<std::shared_ptr<SearchableItem>> searchItems;
+    std::vector<SearchableItem> searchItems;
+    CollisionGrid levelGrid;
     
     Uint32 lastFrameTime;
     float deltaTime;
     
     void HandleCollisions();
-    void LoadLevel(int levelNum);
+    void MoveThroughLevel(GameObject& object, bool& landed, bool& hitWall);
+    bool LoadLevel(int levelNum);
     
 public:
     Game() : window(nullptr), renderer(nullptr), state(GameState::RUNNING), lastFrameTime(0), deltaTime(0) {}
@@ -539,7 +908,9 @@ public:
         
         // Initialize game
         lastFrameTime = SDL_GetTicks();
-        LoadLevel(1);
+        if (!LoadLevel(1)) {
+            return false;
+        }
         
         return true;
     }
@@ -618,8 +989,8 @@ public:
             if (spacePressed && !player->isSearching) {
                 // Check if player is near a searchable item
                 for (auto& item : searchItems) {
-                    if (item->active && !item->searched && player->CheckCollision(item.get())) {
-                        player->StartSearching(item.get());
+                    if (item.active && !item.searched && player->CheckCollision(&item)) {
+                        player->StartSearching(&item);
                         break;
                     }
                 }
@@ -631,12 +1002,7 @@ public:
                 if (player->UpdateSearching()) {
                     // Search completed
                     if (player->currentSearchItem) {
-                        for (auto& item : searchItems) {
-                            if (item.get() == player->currentSearchItem) {
-                                item->Complete(player.get());
-                                break;
-                            }
-                        }
+                        player->currentSearchItem->Complete(player.get());
                     }
                 }
             }
@@ -646,8 +1012,8 @@ public:
         if (player) player->Update(deltaTime);
         
         for (auto& enemy : enemies) {
-            if (enemy->active) {
-                enemy->Update(deltaTime, player.get(), projectiles);
+            if (enemy.active) {
+                enemy.Update(deltaTime, player.get(), projectiles);
             }
         }
         
@@ -670,33 +1036,13 @@ public:
             projectiles.end()
         );
         
-        // Clean up inactive enemies
-        enemies.erase(
-            std::remove_if(
-                enemies.begin(),
-                enemies.end(),
-                [](const std::shared_ptr<Enemy>& e) { return !e->active; }
-            ),
-            enemies.end()
-        );
-        
-        // Clean up searched items
-        searchItems.erase(
-            std::remove_if(
-                searchItems.begin(),
-                searchItems.end(),
-                [](const std::shared_ptr<SearchableItem>& s) { return !s->active; }
-            ),
-            searchItems.end()
-        );
-        
         // Check game over condition
         if (player && !player->active) {
             // TODO: Handle game over
         }
         
         // Check if level is cleared (all enemies defeated)
-        if (enemies.empty()) {
+        if (std::none_of(enemies.begin(), enemies.end(), [](const Enemy& e) { return e.active; })) {
             // TODO: Load next level
         }
     }
@@ -708,16 +1054,16 @@ public:
         
         // Render all game objects
         for (auto& platform : platforms) {
-            platform->Render(renderer);
+            platform.Render(renderer);
         }
         
         for (auto& ladder : ladders) {
-            ladder->Render(renderer);
+            ladder.Render(renderer);
         }
         
         for (auto& item : searchItems) {
-            if (item->active) {
-                item->Render(renderer);
+            if (item.active) {
+                item.Render(renderer);
             }
         }
         
@@ -728,8 +1074,8 @@ public:
         }
         
         for (auto& enemy : enemies) {
-            if (enemy->active) {
-                enemy->Render(renderer);
+            if (enemy.active) {
+                enemy.Render(renderer);
             }
         }
         
@@ -830,6 +1176,55 @@ bool Player::UpdateSearching() {
     return false;
 }
 
+// Implementation of Player's Render method, out of line because it reads
+// the SearchableItem being searched
+void Player::Render(SDL_Renderer* renderer) {
+    GameObject::Render(renderer);
+    
+    // Render health bar
+    SDL_Rect healthBar = {
+        static_cast<int>(position.x),
+        static_cast<int>(position.y - 10),
+        width,
+        5
+    };
+    
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    SDL_RenderFillRect(renderer, &healthBar);
+    
+    healthBar.w = static_cast<int>((float)health / maxHealth * width);
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+    SDL_RenderFillRect(renderer, &healthBar);
+    
+    // Render search progress if searching
+    if (isSearching && currentSearchItem) {
+        const int radius = 15;
+        const int centerX = static_cast<int>(currentSearchItem->position.x + currentSearchItem->width / 2);
+        const int centerY = static_cast<int>(currentSearchItem->position.y + currentSearchItem->height / 2);
+        
+        // Draw background circle
+        SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255);
+        for (int w = 0; w < radius * 2; w++) {
+            for (int h = 0; h < radius * 2; h++) {
+                int dx = radius - w;
+                int dy = radius - h;
+                if ((dx*dx + dy*dy) <= (radius * radius)) {
+                    SDL_RenderDrawPoint(renderer, centerX + dx, centerY + dy);
+                }
+            }
+        }
+        
+        // Draw progress arc
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+        float angle = searchProgress * 2 * M_PI;
+        for (float a = 0; a < angle; a += 0.01f) {
+            int x = static_cast<int>(centerX + cos(a) * radius);
+            int y = static_cast<int>(centerY + sin(a) * radius);
+            SDL_RenderDrawPoint(renderer, x, y);
+        }
+    }
+}
+
 // Implementation of Player's Shoot method
 void Player::Shoot() {
     if (ammo <= 0) return;
@@ -879,63 +1274,75 @@ void Enemy::Update(float deltaTime, Player* player, std::vector<std::shared_ptr<
     position += velocity;
 }
 
+// Implementation of Game's MoveThroughLevel method
+// Replays the object's last move, already applied by its Update, as a sweep
+// through the level grid. On contact the object stops at the face it hit,
+// snapped exactly so the next sweep sees it touching rather than
+// overlapping, and slides on along the other axis.
+void Game::MoveThroughLevel(GameObject& object, bool& landed, bool& hitWall) {
+    landed = false;
+    hitWall = false;
+    
+    float dx = object.velocity.x;
+    float dy = object.velocity.y;
+    object.position.x -= dx;
+    object.position.y -= dy;
+    
+    // One contact per axis at most
+    for (int pass = 0; pass < 2; ++pass) {
+        SweepHit hit;
+        if (!levelGrid.Sweep(object.GetBounds(), dx, dy, false, hit)) break;
+        
+        object.position.x += dx * hit.time;
+        object.position.y += dy * hit.time;
+        dx *= 1.0f - hit.time;
+        dy *= 1.0f - hit.time;
+        
+        if (hit.normalX != 0) {
+            object.position.x = hit.normalX < 0 ? hit.box.x - object.width : hit.box.x + hit.box.w;
+            object.velocity.x = 0;
+            dx = 0;
+            hitWall = true;
+        } else {
+            object.position.y = hit.box.y - object.height;
+            object.velocity.y = 0;
+            dy = 0;
+            landed = true;
+        }
+    }
+    
+    object.position.x += dx;
+    object.position.y += dy;
+}
+
 // Implementation of Game's HandleCollisions method
 void Game::HandleCollisions() {
     if (!player || !player->active) return;
     
     // Player-Platform collisions
-    player->isOnGround = false;
-    for (auto& platform : platforms) {
-        if (player->CheckCollision(platform.get())) {
-            // Check if landing on top of platform
-            if (player->velocity.y > 0 && 
-                player->position.y + player->height - player->velocity.y <= platform->position.y) {
-                player->position.y = platform->position.y - player->height;
-                player->velocity.y = 0;
-                player->isOnGround = true;
-            }
-            // Check for horizontal collision
-            else if (player->velocity.x != 0) {
-                player->position.x -= player->velocity.x;
-            }
-        }
-    }
+    bool hitWall;
+    MoveThroughLevel(*player, player->isOnGround, hitWall);
     
     // Player-Ladder collisions
-    for (auto& ladder : ladders) {
-        if (player->CheckCollision(ladder.get())) {
-            player->isOnLadder = true;
-            break;
-        }
+    if (levelGrid.Overlaps(player->GetBounds(), ColliderType::LADDER)) {
+        player->isOnLadder = true;
     }
     
     // Enemy-Platform collisions
     for (auto& enemy : enemies) {
-        if (!enemy->active) continue;
+        if (!enemy.active) continue;
         
-        bool enemyOnGround = false;
-        for (auto& platform : platforms) {
-            if (enemy->CheckCollision(platform.get())) {  // Missing closing parenthesis and .get() call
-                // Check if landing on top of platform
-                if (enemy->velocity.y > 0 && 
-                    enemy->position.y + enemy->height - enemy->velocity.y <= platform->position.y) {
-                    enemy->position.y = platform->position.y - enemy->height;
-                    enemy->velocity.y = 0;
-                    enemyOnGround = true;
-                }
-                // Check for horizontal collision
-                else if (enemy->velocity.x != 0) {
-                    enemy->position.x -= enemy->velocity.x;
-                    enemy->moveDirection *= -1; // Reverse direction
-                }
-            }
+        bool enemyOnGround;
+        MoveThroughLevel(enemy, enemyOnGround, hitWall);
+        if (hitWall) {
+            enemy.moveDirection *= -1; // Reverse direction
         }
         
         // Apply gravity if not on ground
         if (!enemyOnGround) {
-            enemy->velocity.y += GRAVITY;
+            enemy.velocity.y += GRAVITY;
         } else {
-            enemy->velocity.y = 0;
+            enemy.velocity.y = 0;
         }
     }
     
@@ -943,16 +1350,17 @@ void Game::HandleCollisions() {
     for (auto& proj : projectiles) {
         if (!proj->active) continue;
         
-        // Check projectile-platform collisions
-        for (auto& platform : platforms) {
-            if (proj->CheckCollision(platform.get())) {
-                proj->active = false;
-                break;
-            }
+        // Check projectile-platform collisions over the whole move, so a fast
+        // projectile cannot pass through a thin platform
+        AABB start = proj->GetBounds();
+        start.x -= proj->velocity.x;
+        start.y -= proj->velocity.y;
+        SweepHit hit;
+        if (levelGrid.Sweep(start, proj->velocity.x, proj->velocity.y, true, hit)) {
+            proj->active = false;
+            continue;
         }
         
-        if (!proj->active) continue;
-        
         // Check projectile-player collisions (enemy projectiles)
         if (!proj->fromPlayer && player->active && proj->CheckCollision(player.get())) {
             player->TakeDamage(proj->damage);
@@ -963,8 +1371,8 @@ void Game::HandleCollisions() {
         // Check projectile-enemy collisions (player projectiles)
         if (proj->fromPlayer) {
             for (auto& enemy : enemies) {
-                if (enemy->active && proj->CheckCollision(enemy.get())) {
-                    enemy->TakeDamage(proj->damage);
+                if (enemy.active && proj->CheckCollision(&enemy)) {
+                    enemy.TakeDamage(proj->damage);
                     proj->active = false;
                     break;
                 }
@@ -973,7 +1381,24 @@ void Game::HandleCollisions() {
     }
 }
 // Implementation of Game's LoadLevel method
-void Game::LoadLevel(int levelNum) {
+// Maps levels/level<n>.lvl and copies its records into the level arrays.
+// The arrays keep their capacity across levels, so a switch between levels
+// of similar size allocates little more than the player.
+bool Game::LoadLevel(int levelNum) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    std::string path = std::string(LEVEL_DIRECTORY) + "level" + std::to_string(levelNum) + ".lvl";
+    
+    section_file::MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Could not open level " << path << std::endl;
+        return false;
+    }
+    const LevelHeader* header = ValidateLevel(file);
+    if (!header) {
+        std::cout << "Level " << path << " is corrupt" << std::endl;
+        return false;
+    }
+    
     // Clear previous level
     platforms.clear();
     ladders.clear();
@@ -982,59 +1407,57 @@ void Game::LoadLevel(int levelNum) {
     searchItems.clear();
     
     // Create player
-    player = std::make_shared<Player>(100, 400);
-    
-    // Create platforms
-    platforms.push_back(std::make_shared<Platform>(0, 500, 800, 20));  // Ground
-    platforms.push_back(std::make_shared<Platform>(100, 400, 200, 20)); // Platform 1
-    platforms.push_back(std::make_shared<Platform>(400, 350, 200, 20)); // Platform 2
-    platforms.push_back(std::make_shared<Platform>(200, 250, 200, 20)); // Platform 3
-    
-    // Create ladders
-    ladders.push_back(std::make_shared<Ladder>(150, 400, 30, 100)); // Ground to Platform 1
-    ladders.push_back(std::make_shared<Ladder>(450, 350, 30, 150)); // Platform 2 to Ground
-    ladders.push_back(std::make_shared<Ladder>(250, 250, 30, 150)); // Platform 3 to Platform 1
-    
-    // Create enemies
-    enemies.push_back(std::make_shared<Enemy>(300, 368, 50)); // On Platform 1
-    enemies.push_back(std::make_shared<Enemy>(500, 318, 75)); // On Platform 2
-    enemies.push_back(std::make_shared<Enemy>(300, 218, 100)); // On Platform 3
-    
-    // Create searchable items
-    // Ammo items
-    searchItems.push_back(std::make_shared<SearchableItem>(150, 376, ItemType::AMMO, 10));
-    searchItems.push_back(std::make_shared<SearchableItem>(550, 326, ItemType::AMMO, 15));
-    
-    // Health items
-    searchItems.push_back(std::make_shared<SearchableItem>(200, 376, ItemType::HEALTH, 20));
-    searchItems.push_back(std::make_shared<SearchableItem>(350, 226, ItemType::HEALTH, 30));
-    
-    // Armor items
-    searchItems.push_back(std::make_shared<SearchableItem>(250, 376, ItemType::ARMOR, 0));
-    searchItems.push_back(std::make_shared<SearchableItem>(450, 326, ItemType::ARMOR, 0));
-    searchItems.push_back(std::make_shared<SearchableItem>(250, 226, ItemType::ARMOR, 0));
-    searchItems.push_back(std::make_shared<SearchableItem>(350, 476, ItemType::ARMOR, 0));
-    searchItems.push_back(std::make_shared<SearchableItem>(550, 476, ItemType::ARMOR, 0));
-    
-    // Set up callback for search items
-    for (auto& item : searchItems) {
-        item->onSearchComplete = [](Player* player, ItemType type, ArmorType armorType, int amount) {
-            if (type == ItemType::AMMO) {
-                player->ammo += amount;
-            } else if (type == ItemType::HEALTH) {
-                player->health += amount;
-                if (player->health > player->maxHealth) {
-                    player->health = player->maxHealth;
-                }
-            } else if (type == ItemType::ARMOR) {
-                player->AddArmorPiece(armorType);
-            }
-        };
+    player = std::make_shared<Player>(header->playerX, header->playerY);
+    
+    // Reserved up front: the level objects are copied, not moved, on a
+    // reallocation
+    const BoxRecord* platformRecords = section_file::records<BoxRecord>(file, header->platforms);
+    platforms.reserve(header->platforms.count);
+    for (uint32_t i = 0; i < header->platforms.count; ++i) {
+        const BoxRecord& r = platformRecords[i];
+        platforms.emplace_back(r.x, r.y, r.w, r.h);
+    }
+    
+    const BoxRecord* ladderRecords = section_file::records<BoxRecord>(file, header->ladders);
+    ladders.reserve(header->ladders.count);
+    for (uint32_t i = 0; i < header->ladders.count; ++i) {
+        const BoxRecord& r = ladderRecords[i];
+        ladders.emplace_back(r.x, r.y, r.w, r.h);
+    }
+    
+    // Bucket the static geometry for collision queries
+    levelGrid.Build(platforms, ladders);
+    
+    const EnemyRecord* enemyRecords = section_file::records<EnemyRecord>(file, header->enemies);
+    enemies.reserve(header->enemies.count);
+    for (uint32_t i = 0; i < header->enemies.count; ++i) {
+        const EnemyRecord& r = enemyRecords[i];
+        enemies.emplace_back(r.x, r.y, r.health);
     }
+    
+    const ItemRecord* itemRecords = section_file::records<ItemRecord>(file, header->items);
+    searchItems.reserve(header->items.count);
+    for (uint32_t i = 0; i < header->items.count; ++i) {
+        const ItemRecord& r = itemRecords[i];
+        searchItems.emplace_back(r.x, r.y, static_cast<ItemType>(r.type), r.amount, r.armorType);
+    }
+    
+    double micros = (SDL_GetPerformanceCounter() - start) * 1000000.0 / SDL_GetPerformanceFrequency();
+    std::cout << "Loaded level " << levelNum << " in " << micros << "us" << std::endl;
+    return true;
 }
 
 // Main function
 int main(int argc, char* argv[]) {
+    // Offline level conversion: --convert <level.txt> <level.lvl>
+    if (argc > 1 && std::string(argv[1]) == "--convert") {
+        if (argc != 4) {
+            std::cout << "Usage: " << argv[0] << " --convert <level.txt> <level.lvl>" << std::endl;
+            return -1;
+        }
+        return ConvertLevel(argv[2], argv[3]) ? 0 : -1;
+    }
+    
     Game game;
     
     if (!game.Initialize()) {
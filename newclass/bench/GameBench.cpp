@@ -0,0 +1,139 @@
+// Headless simulation benchmark: runs Game::update() back to back with no
+// window or renderer and prints the results as one JSON object on stdout.
+//
+//   release/GameBench [--ticks N] [--zombies N] [--items N] [--seed N] [--threads N]
+//                     [--replay FILE]
+//
+// --replay runs a session recorded with `game --record FILE`: the seed and
+// setup come from the recording and --ticks defaults to its length.
+
+#include "Game.h"
+#include "MemoryStats.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+    std::atomic<size_t> allocationCount{0};
+    std::atomic<size_t> allocationBytes{0};
+
+    void* countedAlloc(size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        void* ptr = std::malloc(size ? size : 1);
+        if (!ptr) throw std::bad_alloc();
+        return ptr;
+    }
+
+    bool readArg(int argc, char* argv[], int& i, const char* name, long& value) {
+        if (std::strcmp(argv[i], name) != 0 || i + 1 >= argc) return false;
+        value = std::strtol(argv[++i], nullptr, 10);
+        return true;
+    }
+
+    bool readArg(int argc, char* argv[], int& i, const char* name, const char*& value) {
+        if (std::strcmp(argv[i], name) != 0 || i + 1 >= argc) return false;
+        value = argv[++i];
+        return true;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+}
+
+// Every heap allocation in the process goes through these, so the counts
+// cover the game code and the standard containers it uses.
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+int main(int argc, char* argv[]) {
+    long ticks = 0, zombieCount = 1000, itemCount = 200, seed = 1, threads = 0;
+    const char* replayPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (readArg(argc, argv, i, "--ticks", ticks) ||
+            readArg(argc, argv, i, "--zombies", zombieCount) ||
+            readArg(argc, argv, i, "--items", itemCount) ||
+            readArg(argc, argv, i, "--seed", seed) ||
+            readArg(argc, argv, i, "--threads", threads) ||
+            readArg(argc, argv, i, "--replay", replayPath)) {
+            continue;
+        }
+        std::cerr << "Unknown or incomplete argument: " << argv[i] << std::endl;
+        return 1;
+    }
+    bool ticksGiven = ticks != 0;
+
+    Game game;
+    HeadlessConfig config = { static_cast<unsigned int>(seed), static_cast<int>(zombieCount),
+                              static_cast<int>(itemCount), true,
+                              static_cast<int>(threads) };
+    if (!game.initHeadless(config)) {
+        std::cerr << "Headless game initialization failed!" << std::endl;
+        return 1;
+    }
+    if (replayPath) {
+        if (!game.startReplay(replayPath)) {
+            std::cerr << "Could not load recording " << replayPath << std::endl;
+            return 1;
+        }
+        if (!ticksGiven) ticks = game.getReplayTicks();
+    } else if (!ticksGiven) {
+        ticks = 10000;
+    }
+    if (ticks <= 0) {
+        std::cerr << "--ticks must be positive" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> tickMicros(ticks);
+    std::vector<MemoryStats::CategoryStats> memoryStart, memoryEnd;
+    MemoryStats::collect(memoryStart);
+    size_t startAllocations = allocationCount.load();
+    size_t startBytes = allocationBytes.load();
+
+    auto runStart = std::chrono::steady_clock::now();
+    for (long i = 0; i < ticks; ++i) {
+        auto tickStart = std::chrono::steady_clock::now();
+        game.update();
+        auto tickEnd = std::chrono::steady_clock::now();
+        tickMicros[i] = std::chrono::duration<double, std::micro>(tickEnd - tickStart).count();
+    }
+    double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    size_t allocations = allocationCount.load() - startAllocations;
+    size_t bytes = allocationBytes.load() - startBytes;
+    MemoryStats::collect(memoryEnd);
+
+    std::sort(tickMicros.begin(), tickMicros.end());
+
+    std::printf("{\"ticks\": %ld, \"zombies_start\": %ld, \"zombies_end\": %zu, \"items_end\": %zu, "
+                "\"seed\": %ld, \"threads\": %d, \"checksum\": \"%016llx\", "
+                "\"total_s\": %.6f, \"ticks_per_sec\": %.1f, "
+                "\"tick_us\": {\"p50\": %.2f, \"p99\": %.2f, \"max\": %.2f}, "
+                "\"allocations\": %zu, \"allocations_per_tick\": %.3f, \"allocated_bytes\": %zu, \"memory\": {",
+                ticks, zombieCount, game.getZombieCount(), game.getItemCount(),
+                seed, game.getThreadCount(), static_cast<unsigned long long>(game.getStateChecksum()),
+                totalSeconds, ticks / totalSeconds,
+                percentile(tickMicros, 0.50), percentile(tickMicros, 0.99), tickMicros.back(),
+                allocations, static_cast<double>(allocations) / ticks, bytes);
+    for (size_t i = 0; i < memoryEnd.size(); ++i) {
+        const MemoryStats::CategoryStats& stats = memoryEnd[i];
+        std::printf("%s\"%s\": {\"live_bytes\": %zu, \"peak_bytes\": %zu, \"allocations_per_tick\": %.3f}",
+                    i ? ", " : "", stats.name, stats.liveBytes, stats.peakBytes,
+                    static_cast<double>(stats.allocations - memoryStart[i].allocations) / ticks);
+    }
+    std::printf("}}\n");
+    return 0;
+}
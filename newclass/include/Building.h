@@ -4,22 +4,27 @@
 #include "Entity.h"
 #include "Item.h"
 #include "Inventory.h"
+#include "MemoryStats.h"
 
 class Building : public Entity {
 private:
-    std::vector<Item*> items;
+    // Stored items live in Game's item pool; stale handles resolve to nullptr.
+    TrackedVector<ItemHandle, MEM_BUILDING_ITEMS> items;
     bool isPlayerHome;
     Rectangle entrance;
     Rectangle interior;
     Inventory storage;
 
 public:
-    Building(Vector2D pos, SDL_Texture* tex, int w, int h);
+    Building(Vector2D pos, const AtlasRegion& sprite, int w, int h);
+    ~Building();
+    Building(const Building&) = delete;
+    Building& operator=(const Building&) = delete;
     bool isAtEntrance(const Vector2D& pos) const;
     bool isInside(const Vector2D& pos) const;
-    void addItem(Item* item);
-    Item* getItem(int index);
-    std::vector<Item*>& getItems();
+    void addItem(ItemHandle item);
+    ItemHandle getItem(int index);
+    TrackedVector<ItemHandle, MEM_BUILDING_ITEMS>& getItems();
     bool isHomeBase() const;
     void setHomeBase(bool home);
     Inventory& getStorage();
@@ -4,11 +4,13 @@
 #include "Common.h"
 #include "Vector2D.h"
 #include "Rectangle.h"
+#include "../../common/include/camera.h"
 
+// The shared engine camera, with the view kept on whole pixels as it was
+// when the viewport was an SDL_Rect.
 class Camera {
 private:
-    SDL_Rect viewport;
-    int mapWidth, mapHeight;
+    engine::Camera view;
 
 public:
     Camera(int mapWidth, int mapHeight);
@@ -10,18 +10,39 @@
 #include <string>
 #include <random>
 #include <memory>
+#include <functional>
 
 // Constants
 const int SCREEN_WIDTH = 1920;
 const int SCREEN_HEIGHT = 1080;
-const int MAP_WIDTH = 2000;
-const int MAP_HEIGHT = 2000;
 const int TILE_SIZE = 32;
+const int TILE_TYPES = 3; // terrain tiles in the atlas, the last one is the obstacle
+const int WORLD_CHUNK_TILES = 16; // chunk edge in tiles, one Uint16 obstacle mask per row
+const int WORLD_CHUNK_PIXELS = WORLD_CHUNK_TILES * TILE_SIZE;
+const int WORLD_CHUNKS = 128; // world edge in chunks
+const int MAP_WIDTH = WORLD_CHUNKS * WORLD_CHUNK_PIXELS;
+const int MAP_HEIGHT = WORLD_CHUNKS * WORLD_CHUNK_PIXELS;
+const int CHUNK_PRELOAD_MARGIN = 2; // chunks requested beyond the view on each side
+const int MAX_RESIDENT_CHUNKS = 512;
+const int MAX_BAKED_CHUNKS = 40; // chunk textures kept on the GPU
+const int SPAWN_RADIUS = 1500; // zombies and loose items appear this close to the player
 const int PLAYER_SPEED = 5;
 const int MAX_FPS = 60;
 const int FRAME_DELAY = 1000 / MAX_FPS;
+const int SIM_RATE = 60; // fixed simulation steps per second
+const double SIM_STEP_MS = 1000.0 / SIM_RATE;
+const int MAX_SIM_STEPS_PER_FRAME = 5; // catch-up cap after a long frame
+const int ZOMBIE_POOL_RESERVE = 512; // covers several night waves without regrowing
+const int ITEM_POOL_RESERVE = 256;
+const int FLOW_FIELD_TILES = 128; // flow field window edge, centred on the player
+const int FLOW_FIELD_CELLS_PER_STEP = 4096; // search budget, a quarter of the window
 const int DAY_NIGHT_CYCLE_DURATION = 600000; // 10 minutes in milliseconds
 const float DAY_RATIO = 0.7f; // 70% day, 30% night
+const int TWILIGHT_DURATION = 30000; // dusk and dawn fades in milliseconds
+const int LIGHT_MAP_SCALE = 2; // light map is this many times smaller per axis
+const int MAX_LIGHTS = 64; // lights composited per frame
+const int ATLAS_PAGE_SIZE = 1024; // edge of one atlas texture; images that don't fit open a second page
+const int ATLAS_PADDING = 1; // colour-extended border around each atlas image
 
 // Enums
 enum GameState {
@@ -44,6 +65,8 @@ enum ItemType {
     AMMO
 };
 
+const int ITEM_TYPE_COUNT = AMMO + 1;
+
 enum ZombieType {
     NORMAL,
     RUNNER,
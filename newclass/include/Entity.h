@@ -5,10 +5,15 @@
 #include "Vector2D.h"
 #include "Rectangle.h"
 #include "Camera.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+
+class SpatialGrid;
 
 class Entity {
 protected:
     Vector2D position;
+    Vector2D previousPosition;
     Vector2D velocity;
     Rectangle collider;
     SDL_Texture* texture;
@@ -16,15 +21,26 @@ protected:
     SDL_Rect destRect;
     bool active;
 
+    SpatialGrid* grid;
+    int gridMinX, gridMinY, gridMaxX, gridMaxY;
+    Uint32 gridQueryStamp;
+    friend class SpatialGrid;
+
 public:
-    Entity(Vector2D pos, SDL_Texture* tex, int w, int h);
+    // The sprite region is stretched over the w x h collider.
+    Entity(Vector2D pos, const AtlasRegion& sprite, int w, int h);
     virtual ~Entity();
     virtual void update();
-    virtual void render(SDL_Renderer* renderer, const Camera& camera);
+    // Queues the sprite on the batch. alpha is the fraction of a simulation
+    // step elapsed since the last update; the entity is drawn between its
+    // previous and current position.
+    virtual void render(SpriteBatch& batch, const Camera& camera, int layer, float alpha = 1.0f);
 
     void updateCollider();
     bool isActive() const;
     void setActive(bool a);
+    void savePreviousState();
+    Vector2D getInterpolatedPosition(float alpha) const;
     Vector2D getPosition() const;
     void setPosition(const Vector2D& pos);
     Vector2D getVelocity() const;
@@ -0,0 +1,59 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include "Common.h"
+#include "Rectangle.h"
+#include "Vector2D.h"
+
+class TileMap;
+
+// Breadth-first distance field over a square window of tiles centred on the
+// target's tile. Each reachable tile stores the direction to its cheapest
+// neighbour, so any number of zombies sample their steering in O(1). The
+// search restarts only when the target changes tile and can be spread over
+// several updates; zombies keep following the last published field until the
+// new one is done. Outside the window zombies steer at the target directly.
+class FlowField {
+private:
+    int cols, rows;
+    int tileSize;
+    const TileMap* map;
+    std::vector<Rectangle> blockedAreas;
+    int originX, originY;       // world tile of the window corner being searched
+    int publishedX, publishedY; // and of the field zombies currently sample
+    int targetX, targetY;
+    std::vector<Uint8> blocked;
+    std::vector<Uint16> cost;
+    std::vector<Uint8> directions;
+    std::vector<int> frontier;
+    size_t frontierHead;
+    int targetTile;
+    bool published;
+    bool searching;
+
+    void buildWindow();
+    void startSearch(int tx, int ty);
+    void expand(size_t maxCells);
+    void publish();
+
+public:
+    FlowField(int windowTiles = FLOW_FIELD_TILES, int tileSize = TILE_SIZE);
+
+    // Passability comes from the map's obstacle tiles plus every area given
+    // to blockArea() (buildings). Each window is read fresh when a search
+    // starts; changing either forces a new search.
+    void setMap(const TileMap* tileMap);
+    void blockArea(const Rectangle& area);
+    void clearBlockedAreas();
+
+    // Call once per simulation step. maxCells bounds the search work done in
+    // this call, 0 finishes the search immediately.
+    void update(const Vector2D& target, size_t maxCells = 0);
+
+    // Unit steering direction from the tile under point. Returns false when
+    // there is no field there: outside the window, unreachable, or already in
+    // the target tile, where callers should steer at the target directly.
+    bool sample(float x, float y, float& dirX, float& dirY) const;
+};
+
+#endif // FLOWFIELD_H
@@ -4,15 +4,34 @@
 #include "Common.h"
 #include "Camera.h"
 #include "Player.h"
-#include "Zombie.h"
+#include "ZombiePool.h"
 #include "Building.h"
 #include "Item.h"
 #include "TileMap.h"
 #include "UIManager.h"
+#include "SpatialGrid.h"
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "LightMap.h"
+#include "TextureAtlas.h"
+#include "Random.h"
+#include "InputRecorder.h"
+
+// Parameters for running the simulation without a window or renderer, used
+// by the GameBench target. The seed also fixes the world: terrain and every
+// chunk's buildings derive from it.
+struct HeadlessConfig {
+    unsigned int seed;
+    int zombies;
+    int items;
+    bool invulnerablePlayer; // keeps long runs from ending at GAME_OVER
+    int threads;             // job system threads, 0 for one per core
+};
 
 class Game {
 private:
     bool running;
+    bool invulnerablePlayer;
     SDL_Window* window;
     SDL_Renderer* renderer;
     GameState gameState;
@@ -20,33 +39,64 @@ private:
     Uint32 gameTime;
     Uint32 lastFrameTime;
     Uint32 lastTimeUpdate;
+    Uint64 simTick;
     Camera camera;
 
-    SDL_Texture* playerTexture;
-    SDL_Texture* zombieTextures[4];
-    SDL_Texture* buildingTextures[3];
-    SDL_Texture* itemTextures[8];
-    SDL_Texture* tilesetTexture;
-    SDL_Texture* uiTextures[2];
+    TextureAtlas atlas;
+    AtlasRegion playerSprite;
+    AtlasRegion zombieSprites[4];
+    AtlasRegion buildingSprites[3];
+    AtlasRegion itemSprites[8];
+    AtlasRegion tileSprites[TILE_TYPES];
+    AtlasRegion uiSprites[2];
     TTF_Font* font;
 
+    SpatialGrid buildingGrid;
+    SpatialGrid itemGrid;
+    FlowField flowField;
+    std::vector<Entity*> nearbyBuildings;
+    std::vector<Entity*> nearbyEntities;
+    std::vector<int> nearbyZombies;
+
     std::unique_ptr<Player> player;
-    std::vector<std::unique_ptr<Zombie>> zombies;
+    ZombiePool zombies;
     std::vector<std::unique_ptr<Building>> buildings;
-    std::vector<std::unique_ptr<Item>> items;
+    // Every item, on the ground or stored in a building, lives in itemPool;
+    // items lists the ones lying in the world.
+    ItemPool itemPool;
+    std::vector<ItemHandle> items;
     std::unique_ptr<TileMap> tileMap;
     std::unique_ptr<UIManager> uiManager;
+    std::unique_ptr<SpriteBatch> spriteBatch;
+    std::unique_ptr<LightMap> lightMap;
+    std::unique_ptr<JobSystem> jobs;
 
-    std::mt19937 rng;
+    RandomService random;
+    Uint32 worldSeed;
+    // One flag per world chunk, set once its buildings have been placed.
+    // Buildings are kept for the rest of the game, only terrain is streamed.
+    std::vector<Uint8> populatedChunks;
     Uint32 lastZombieSpawn;
     Uint32 zombieSpawnInterval;
+    int setupZombieCount;
+    int setupItemCount;
 
-    SDL_Texture* createColorTexture(int width, int height, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
-    void setupGame();
-    void createBuildings();
-    void createItemInBuilding(Building& building);
+    // Key presses and held movement gathered by handleEvents(); update()
+    // turns them into the step's InputFrame, or takes it from a replay.
+    InputRecorder input;
+    std::vector<SDL_Keycode> pendingKeys;
+    Uint8 heldMovement;
+    InputFrame currentInput;
+
+    void setupGame(int zombieCount = 10, int itemCount = 20);
+    Rectangle getStreamView() const;
+    void populateChunksAround(const Rectangle& view);
+    void populateChunk(int cx, int cy);
+    void createItemInBuilding(Building& building, std::mt19937& gen);
     void spawnZombie();
     void spawnItem();
+    void renderLighting(float alpha);
+    void applyInput();
     void handleMainMenuKeys(SDL_Keycode key);
     void handleGameplayKeys(SDL_Keycode key);
     void handleInventoryKeys(SDL_Keycode key);
@@ -64,14 +114,33 @@ public:
     Game();
     ~Game();
     bool init(const char* title, int xpos, int ypos, int width, int height, bool fullscreen);
+    bool initHeadless(const HeadlessConfig& config);
     bool loadMedia();
+    // Writes the packed atlas as a prebuilt one for later startups.
+    bool saveAtlas() const;
     void handleEvents();
     void handleKeyDown(SDL_Keycode key);
+    // Advances the simulation by exactly one SIM_STEP_MS step.
     void update();
-    void render();
+    // alpha in [0, 1] interpolates entities between the last two steps.
+    void render(float alpha = 1.0f);
     void clean();
     bool isRunning() const;
-    void capFrameRate(Uint32 frameStart);
+    Uint32 getSimTime() const;
+    size_t getZombieCount() const;
+    size_t getItemCount() const;
+    int getThreadCount() const;
+    // Hash of the simulated state (player, zombies, items) for comparing runs.
+    Uint64 getStateChecksum() const;
+
+    // Record/replay of player input. startRecording() notes the master seed
+    // and the current setup, so call it before the first update().
+    // startReplay() rebuilds that setup and then feeds the recorded frames
+    // to update() until they run out.
+    bool startRecording(const std::string& path);
+    bool stopRecording();
+    bool startReplay(const std::string& path);
+    Uint32 getReplayTicks() const;
 };
 
 #endif // GAME_H
@@ -0,0 +1,58 @@
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+#include "Common.h"
+
+// Player input for one simulation step.
+struct InputFrame {
+    Uint8 movement;                // MovementBits held during the step
+    std::vector<SDL_Keycode> keys; // key presses handled at the start of the step
+};
+
+// Everything needed to rebuild the recorded session's starting state.
+struct RecordingHeader {
+    char magic[4];
+    Uint32 version;
+    Uint32 seed; // RandomService master seed
+    Sint32 zombies;
+    Sint32 items;
+    Uint32 ticks;
+};
+
+// Records the input of a session step by step, or plays a recording back.
+// Combined with the master seed this reproduces a session exactly, which is
+// what lets GameBench rerun a real play session as a fixed workload.
+// Frames are kept in memory and written when recording stops; a frame is a
+// movement byte, a key count byte and the key codes.
+class InputRecorder {
+private:
+    enum Mode {
+        IDLE,
+        RECORDING,
+        REPLAYING
+    };
+
+    Mode mode;
+    std::string path;
+    RecordingHeader header;
+    std::vector<Uint8> frames;
+    size_t readPos;
+
+public:
+    InputRecorder();
+
+    bool startRecording(const std::string& file, Uint32 seed, int zombies, int items);
+    void record(const InputFrame& frame);
+    bool stopRecording();
+
+    bool load(const std::string& file);
+    // Fills frame with the next recorded step; false once the recording
+    // has run out.
+    bool next(InputFrame& frame);
+
+    bool isRecording() const;
+    bool isReplaying() const;
+    const RecordingHeader& getHeader() const;
+};
+
+#endif // INPUTRECORDER_H
@@ -6,8 +6,14 @@
 
 class Inventory {
 private:
-    std::map<ItemType, int> items;
+    // Counts indexed directly by ItemType, with the running total kept so
+    // capacity checks don't walk the array.
+    int items[ITEM_TYPE_COUNT];
+    int totalItems;
     int capacity;
+    std::function<void()> onChange;
+
+    void notifyChanged();
 
 public:
     Inventory(int cap = 20);
@@ -16,6 +22,9 @@ public:
     int getItemCount(ItemType type) const;
     int getTotalItems() const;
     void transferTo(Inventory& other, ItemType type, int amount);
+
+    // Called after every change to the counts.
+    void setChangeListener(std::function<void()> listener);
 };
 
 #endif // INVENTORY_H
@@ -2,6 +2,7 @@
 #define ITEM_H
 
 #include "Entity.h"
+#include "ObjectPool.h"
 
 class Item : public Entity {
 private:
@@ -10,10 +11,13 @@ private:
     std::string name;
 
 public:
-    Item(Vector2D pos, SDL_Texture* tex, ItemType t, int val, const std::string& n);
+    Item(Vector2D pos, const AtlasRegion& sprite, ItemType t, int val, const std::string& n);
     ItemType getType() const;
     int getValue() const;
     std::string getName() const;
 };
 
+typedef PoolHandle<Item> ItemHandle;
+typedef ObjectPool<Item> ItemPool;
+
 #endif // ITEM_H
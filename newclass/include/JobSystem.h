@@ -0,0 +1,94 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Number of jobs still outstanding for a batch. Every job submitted against a
+// counter decrements it when it finishes; wait() returns once it reaches zero.
+struct JobCounter {
+    std::atomic<int> pending{0};
+};
+
+// A unit of work: fn(context, begin, end). Plain data, so queuing a job never
+// allocates.
+struct Job {
+    void (*fn)(void* context, size_t begin, size_t end);
+    void* context;
+    size_t begin, end;
+    JobCounter* counter;
+};
+
+// Small work-stealing scheduler. Each thread, the submitting one included,
+// owns a deque: it pushes and pops at the back, idle threads steal from the
+// front of the others. A thread waiting on a counter keeps running jobs
+// instead of blocking, so nested waits cannot deadlock.
+class JobSystem {
+private:
+    // Ring buffer deque; it only reallocates when a burst outgrows it, so
+    // steady-state submission never touches the heap.
+    struct Queue {
+        std::mutex mutex;
+        std::vector<Job> ring;
+        size_t head = 0, tail = 0; // front at head, back before tail
+
+        bool empty() const { return head == tail; }
+        void pushBack(const Job& job);
+        Job popBack();
+        Job popFront();
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queuedJobs;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    int currentQueue() const;
+    bool popOrSteal(int self, Job& job);
+    void execute(Job& job);
+    void workerLoop(int index);
+
+public:
+    // threadCount includes the calling thread; 0 picks one per hardware core.
+    // With a single thread every job runs inline on submit.
+    explicit JobSystem(int threadCount = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int getThreadCount() const;
+
+    void submit(const Job& job);
+    void wait(JobCounter& counter);
+
+    // Splits [0, count) into ranges of grain items and runs body(begin, end)
+    // for each, returning when all are done. The ranges depend only on count
+    // and grain, never on the thread count.
+    template<typename F>
+    void parallelFor(size_t count, size_t grain, F&& body) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+
+        auto thunk = [](void* context, size_t begin, size_t end) {
+            (*static_cast<typename std::remove_reference<F>::type*>(context))(begin, end);
+        };
+
+        JobCounter counter;
+        counter.pending.store(static_cast<int>((count + grain - 1) / grain), std::memory_order_relaxed);
+        for (size_t begin = 0; begin < count; begin += grain) {
+            size_t end = begin + grain < count ? begin + grain : count;
+            submit({ thunk, &body, begin, end, &counter });
+        }
+        wait(counter);
+    }
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,59 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include "Common.h"
+
+// Night lighting. Lights are drawn additively into a render target at
+// 1/LIGHT_MAP_SCALE of the screen size, cleared to the ambient colour, and
+// the result is multiplied over the finished scene with one stretched copy.
+// All lights share one sprite texture and go out in a single geometry call,
+// so a lit frame costs the same three draws however many lights there are.
+class LightMap {
+private:
+    struct Light {
+        float x, y;       // screen position of the light's origin
+        float size;       // glow radius or cone length
+        float dirX, dirY; // cone direction, unused for glows
+        bool cone;
+        SDL_Color color;
+    };
+
+    SDL_Renderer* renderer;
+    SDL_Texture* target;
+    SDL_Texture* lightTexture;
+    int width, height;
+    std::vector<Light> lights;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    int drawCalls;
+
+    bool createLightTexture();
+    void addQuad(const Light& light);
+    void drawFallback();
+
+public:
+    LightMap(SDL_Renderer* renderer, int screenWidth, int screenHeight);
+    ~LightMap();
+    LightMap(const LightMap&) = delete;
+    LightMap& operator=(const LightMap&) = delete;
+
+    // Scene brightness at a point of the day/night cycle: full daylight,
+    // fading to the night colour over TWILIGHT_DURATION at dusk and back
+    // at dawn.
+    static SDL_Color ambientFor(Uint32 cycleTime);
+    static bool isDaylight(const SDL_Color& ambient);
+
+    // Positions are in screen pixels. Lights past MAX_LIGHTS in a frame are
+    // dropped, so queue the important ones first.
+    void addGlow(float x, float y, float radius, SDL_Color color);
+    void addCone(float x, float y, float length, float dirX, float dirY, SDL_Color color);
+
+    // Composites the queued lights over the current render target and
+    // clears the queue. Does nothing in daylight.
+    void render(const SDL_Color& ambient);
+
+    // Draws issued by the last render(): 0 in daylight, otherwise 2 or 3.
+    int getDrawCalls() const;
+};
+
+#endif // LIGHTMAP_H
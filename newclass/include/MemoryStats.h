@@ -0,0 +1,86 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <SDL2/SDL.h>
+#include <memory>
+#include <vector>
+
+// Subsystems whose memory is accounted separately. The texture categories
+// are GPU memory estimated as width x height x bytes per pixel.
+enum MemoryCategory {
+    MEM_ENTITIES,       // zombie arrays, pooled items, buildings
+    MEM_BUILDING_ITEMS, // item lists stored in buildings
+    MEM_TILEMAP,        // resident terrain chunks
+    MEM_CHUNK_TEXTURES, // baked terrain chunks
+    MEM_ASSET_TEXTURES, // texture atlas pages from loadMedia
+    MEM_UI_TEXTURES,    // glyph atlas, cached text and the HUD target
+    MEM_LIGHT_TEXTURES, // light map target and light sprites
+    MEM_CATEGORY_COUNT
+};
+
+// Live, peak and allocation counters per MemoryCategory, read by the
+// profiler overlay and GameBench. Heap memory is counted through
+// TrackedAllocator or explicit allocated()/freed() pairs, textures through
+// textureCreated()/textureDestroyed(). The counters are atomic, so the
+// tile streamer and job threads can allocate too.
+namespace MemoryStats {
+    struct CategoryStats {
+        const char* name;
+        bool vram;
+        size_t liveBytes;
+        size_t peakBytes;
+        size_t allocations;      // since startup
+        size_t frameAllocations; // during the last completed frame
+    };
+
+    void allocated(MemoryCategory category, size_t bytes);
+    void freed(MemoryCategory category, size_t bytes);
+
+    // Call textureDestroyed() before SDL_DestroyTexture; both ignore nullptr.
+    size_t textureBytes(SDL_Texture* texture);
+    void textureCreated(MemoryCategory category, SDL_Texture* texture);
+    void textureDestroyed(MemoryCategory category, SDL_Texture* texture);
+
+    // Closes the per-frame allocation count; called once per frame or tick.
+    void endFrame();
+
+    CategoryStats get(MemoryCategory category);
+    void collect(std::vector<CategoryStats>& out);
+}
+
+// Standard allocator that charges every allocation to a category.
+template<typename T, MemoryCategory CATEGORY>
+class TrackedAllocator {
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef TrackedAllocator<U, CATEGORY> other;
+    };
+
+    TrackedAllocator() noexcept {}
+    template<typename U>
+    TrackedAllocator(const TrackedAllocator<U, CATEGORY>&) noexcept {}
+
+    T* allocate(size_t count) {
+        T* ptr = std::allocator<T>().allocate(count);
+        MemoryStats::allocated(CATEGORY, count * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        MemoryStats::freed(CATEGORY, count * sizeof(T));
+        std::allocator<T>().deallocate(ptr, count);
+    }
+};
+
+template<typename T, typename U, MemoryCategory CATEGORY>
+bool operator==(const TrackedAllocator<T, CATEGORY>&, const TrackedAllocator<U, CATEGORY>&) { return true; }
+template<typename T, typename U, MemoryCategory CATEGORY>
+bool operator!=(const TrackedAllocator<T, CATEGORY>&, const TrackedAllocator<U, CATEGORY>&) { return false; }
+
+template<typename T, MemoryCategory CATEGORY>
+using TrackedVector = std::vector<T, TrackedAllocator<T, CATEGORY>>;
+
+#endif // MEMORYSTATS_H
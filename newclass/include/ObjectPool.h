@@ -0,0 +1,114 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include "Common.h"
+#include "MemoryStats.h"
+#include <new>
+
+// Reference to a pooled object. The generation is bumped every time a slot
+// is released, so a handle kept past its object's destruction resolves to
+// nullptr instead of to whatever reused the slot.
+template<typename T>
+struct PoolHandle {
+    Uint32 index;
+    Uint32 generation;
+
+    PoolHandle() : index(0xFFFFFFFFu), generation(0) {}
+    PoolHandle(Uint32 i, Uint32 g) : index(i), generation(g) {}
+
+    bool operator==(const PoolHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+// Fixed-block pool. Objects are constructed in place inside blocks of
+// BLOCK_SIZE slots that are never moved or freed until the pool goes away,
+// so pointers stay valid while the object lives (the spatial grid relies on
+// this) and released slots are reused through a free list without touching
+// the heap. A new block is only allocated when every slot is in use. Block
+// memory is charged to CATEGORY in MemoryStats.
+template<typename T, MemoryCategory CATEGORY = MEM_ENTITIES, int BLOCK_SIZE = 64>
+class ObjectPool {
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        Uint32 generation;
+        bool alive;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    std::vector<Uint32> freeSlots;
+    size_t liveCount;
+
+    Slot& slot(Uint32 index) const { return blocks[index / BLOCK_SIZE][index % BLOCK_SIZE]; }
+    T* object(Slot& s) const { return reinterpret_cast<T*>(s.storage); }
+
+    void addBlock() {
+        Uint32 first = static_cast<Uint32>(blocks.size() * BLOCK_SIZE);
+        blocks.emplace_back(new Slot[BLOCK_SIZE]);
+        MemoryStats::allocated(CATEGORY, sizeof(Slot) * BLOCK_SIZE);
+        for (int i = BLOCK_SIZE - 1; i >= 0; --i) {
+            blocks.back()[i].generation = 0;
+            blocks.back()[i].alive = false;
+            freeSlots.push_back(first + i);
+        }
+    }
+
+public:
+    ObjectPool() : liveCount(0) {}
+    ~ObjectPool() {
+        clear();
+        MemoryStats::freed(CATEGORY, sizeof(Slot) * BLOCK_SIZE * blocks.size());
+    }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Preallocates blocks so the first count objects never hit the allocator.
+    void reserve(size_t count) {
+        freeSlots.reserve(count);
+        while (blocks.size() * BLOCK_SIZE < count) addBlock();
+    }
+
+    template<typename... Args>
+    PoolHandle<T> create(Args&&... args) {
+        if (freeSlots.empty()) addBlock();
+
+        Uint32 index = freeSlots.back();
+        freeSlots.pop_back();
+        Slot& s = slot(index);
+        new (s.storage) T(std::forward<Args>(args)...);
+        s.alive = true;
+        ++liveCount;
+        return PoolHandle<T>(index, s.generation);
+    }
+
+    void destroy(PoolHandle<T> handle) {
+        if (!get(handle)) return;
+
+        Slot& s = slot(handle.index);
+        object(s)->~T();
+        s.alive = false;
+        ++s.generation;
+        --liveCount;
+        freeSlots.push_back(handle.index);
+    }
+
+    // Destroys every live object; blocks stay allocated for reuse.
+    void clear() {
+        for (Uint32 i = 0; i < blocks.size() * BLOCK_SIZE; ++i) {
+            Slot& s = slot(i);
+            if (s.alive) destroy(PoolHandle<T>(i, s.generation));
+        }
+    }
+
+    T* get(PoolHandle<T> handle) const {
+        if (handle.index >= blocks.size() * BLOCK_SIZE) return nullptr;
+        Slot& s = slot(handle.index);
+        if (!s.alive || s.generation != handle.generation) return nullptr;
+        return object(s);
+    }
+
+    size_t size() const { return liveCount; }
+    size_t capacity() const { return blocks.size() * BLOCK_SIZE; }
+};
+
+#endif // OBJECTPOOL_H
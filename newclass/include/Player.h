@@ -5,6 +5,14 @@
 #include "Inventory.h"
 #include "Building.h" // Forward declaration won’t suffice due to pointer usage
 
+// Movement keys held during a simulation step.
+enum MovementBits {
+    MOVE_UP = 1,
+    MOVE_DOWN = 2,
+    MOVE_LEFT = 4,
+    MOVE_RIGHT = 8
+};
+
 class Player : public Entity {
 private:
     int health;
@@ -15,11 +23,15 @@ private:
     Inventory inventory;
     Building* homeBase;
     bool isInside;
+    std::function<void()> onChange;
+
+    void notifyChanged();
 
 public:
-    Player(Vector2D pos, SDL_Texture* tex);
+    Player(Vector2D pos, const AtlasRegion& sprite);
     void update() override;
-    void handleInput(const Uint8* keystates);
+    static Uint8 movementFromKeys(const Uint8* keystates);
+    void handleInput(Uint8 movement);
     void takeDamage(int amount);
     void heal(int amount);
 
@@ -37,6 +49,10 @@ public:
     void upgradeWeapon(int amount);
     void upgradeArmor(int amount);
     void upgradeMaxHealth(int amount);
+
+    // Called whenever something the HUD shows changes: health, inventory
+    // counts, home base or inside state.
+    void setChangeListener(std::function<void()> listener);
 };
 
 #endif // PLAYER_H
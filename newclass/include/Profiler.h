@@ -0,0 +1,76 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// Frame profiler. PROFILE_SCOPE("name") times the rest of the enclosing block
+// with the performance counter; nested scopes form a tree per frame, and the
+// last PROFILER_HISTORY frames are kept in a ring for the overlay and dumps.
+// Only the thread calling beginFrame() records. Scopes compile to nothing
+// unless PROFILER_ENABLED is non-zero, which by default follows NDEBUG.
+//
+//     void Game::update() {
+//         PROFILE_SCOPE("Game::update");
+//         ...
+//     }
+
+#ifndef PROFILER_ENABLED
+#ifdef NDEBUG
+#define PROFILER_ENABLED 0
+#else
+#define PROFILER_ENABLED 1
+#endif
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) do {} while (0)
+#endif
+
+namespace Profiler {
+    const int HISTORY = 300;
+    const int MAX_SCOPES_PER_FRAME = 64;
+
+    // One row per distinct scope path seen in the history, in tree order.
+    // Times are per frame: a scope entered several times in one frame (a
+    // fixed-step update running twice) counts as the sum.
+    struct ScopeStats {
+        const char* name;
+        int depth;
+        int parent;
+        double averageMs;
+        double maxMs;
+        int frames;
+    };
+
+    void beginFrame();
+    void endFrame();
+
+    int beginScope(const char* name);
+    void endScope(int scope);
+
+    void collectStats(std::vector<ScopeStats>& out);
+    // Frame times oldest first, at most HISTORY entries.
+    void collectFrameTimes(std::vector<float>& out);
+
+    // Writes every scope of every frame in the ring as CSV.
+    bool dumpToFile(const char* path);
+}
+
+class ProfileScope {
+private:
+    int scope;
+
+public:
+    explicit ProfileScope(const char* name) : scope(Profiler::beginScope(name)) {}
+    ~ProfileScope() { Profiler::endScope(scope); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,31 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "Common.h"
+
+// Systems that draw random numbers, each from its own stream.
+enum RandomStream {
+    RNG_TERRAIN,
+    RNG_SPAWN,
+    RNG_AI,
+    RNG_STREAM_COUNT
+};
+
+// One master seed split into an independent generator per system, so an
+// extra draw in one system never shifts the numbers another one sees. A run
+// is reproduced by reseeding with getSeed() of the original.
+class RandomService {
+private:
+    Uint32 seed;
+    std::mt19937 streams[RNG_STREAM_COUNT];
+
+public:
+    // Seeds from std::random_device; call reseed() for a fixed run.
+    RandomService();
+
+    void reseed(Uint32 masterSeed);
+    Uint32 getSeed() const;
+    std::mt19937& get(RandomStream stream);
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,40 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include "Common.h"
+#include "Rectangle.h"
+#include "Vector2D.h"
+
+class Entity;
+
+// Uniform grid over the map. Each entity is stored in every cell its collider
+// overlaps; entities that move call update() (via Entity::updateCollider) and
+// only touch the grid when their covered cell range actually changes.
+class SpatialGrid {
+private:
+    int cellSize;
+    int cols, rows;
+    std::vector<std::vector<Entity*>> cells;
+    Uint32 queryStamp;
+
+    void cellRange(const Rectangle& rect, int& minX, int& minY, int& maxX, int& maxY) const;
+    void addToCells(Entity* entity, int minX, int minY, int maxX, int maxY);
+    void removeFromCells(Entity* entity, int minX, int minY, int maxX, int maxY);
+
+public:
+    SpatialGrid(int worldWidth, int worldHeight, int cellSize = TILE_SIZE);
+    ~SpatialGrid();
+
+    void insert(Entity* entity);
+    void remove(Entity* entity);
+    void update(Entity* entity);
+    void clear();
+
+    // Appends every entity registered in a cell the area touches. This is a
+    // candidate set, callers still do the exact test; each entity is reported
+    // once even when it spans several cells.
+    void query(const Rectangle& area, std::vector<Entity*>& out);
+    void queryPoint(const Vector2D& point, std::vector<Entity*>& out);
+};
+
+#endif // SPATIALGRID_H
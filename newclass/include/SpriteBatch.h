@@ -0,0 +1,45 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "Common.h"
+
+// Draw order of world sprites; lower layers are drawn first.
+enum RenderLayer {
+    LAYER_BUILDINGS,
+    LAYER_ITEMS,
+    LAYER_ZOMBIES,
+    LAYER_PLAYER
+};
+
+// Collects textured quads for a frame and draws them sorted by layer, then
+// texture, with one SDL_RenderGeometry call per run of the same texture.
+// Sprites sharing a layer and texture keep their submission order.
+class SpriteBatch {
+private:
+    struct Sprite {
+        SDL_Texture* texture;
+        SDL_Rect src;
+        SDL_Rect dst;
+        int layer;
+        Uint32 order;
+    };
+
+    SDL_Renderer* renderer;
+    std::vector<Sprite> sprites;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    int drawCalls;
+
+    void drawRun(size_t begin, size_t end);
+
+public:
+    explicit SpriteBatch(SDL_Renderer* renderer);
+
+    void draw(SDL_Texture* texture, const SDL_Rect& src, const SDL_Rect& dst, int layer);
+    void flush();
+
+    // Geometry calls issued by the last flush().
+    int getDrawCalls() const;
+};
+
+#endif // SPRITEBATCH_H
@@ -0,0 +1,54 @@
+#ifndef TEXTRENDERER_H
+#define TEXTRENDERER_H
+
+#include "Common.h"
+#include <list>
+#include <unordered_map>
+
+// Draws UI text without touching SDL_ttf per frame. Printable ASCII is baked
+// once into a glyph atlas and strings are drawn as one SDL_RenderGeometry
+// batch of quads; labels whose text never changes can instead go through a
+// small LRU cache of fully rendered (text, color) textures.
+class TextRenderer {
+private:
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+    static const int ATLAS_WIDTH = 512;
+
+    struct Glyph {
+        SDL_Rect src;
+        int advance;
+    };
+
+    struct CachedText {
+        std::string key;
+        SDL_Texture* texture;
+        int w, h;
+    };
+
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    SDL_Texture* atlas;
+    int atlasWidth, atlasHeight;
+    Glyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    size_t cacheCapacity;
+    std::list<CachedText> cache;
+    std::unordered_map<std::string, std::list<CachedText>::iterator> cacheLookup;
+
+    bool buildAtlas();
+    const Glyph& glyphFor(char c) const;
+
+public:
+    TextRenderer(SDL_Renderer* ren, TTF_Font* f, size_t cacheCapacity = 64);
+    ~TextRenderer();
+
+    void drawText(const std::string& text, int x, int y, SDL_Color color);
+    void drawCached(const std::string& text, int x, int y, SDL_Color color);
+    void clearCache();
+};
+
+#endif // TEXTRENDERER_H
@@ -0,0 +1,66 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include "Common.h"
+#include <unordered_map>
+
+// A named image inside an atlas page. Headless runs have no renderer and
+// get empty regions, texture nullptr.
+struct AtlasRegion {
+    SDL_Texture* texture;
+    SDL_Rect rect;
+};
+
+// Packs every sprite the game draws into one or two ATLAS_PAGE_SIZE textures
+// so sprite batches rarely switch texture.
+//
+// Images are declared with addImage() and then either loaded from a prebuilt
+// atlas or packed at runtime onto shelves, tallest first. A prebuilt atlas is
+// a metadata text file next to its page images:
+//
+//   page <index> <image file, relative to the metadata file>
+//   <name> <page> <x> <y> <w> <h>
+//
+// It is only used when it describes every declared image; save() writes the
+// current atlas, loaded or runtime-packed, in that format.
+class TextureAtlas {
+private:
+    struct Image {
+        std::string name;
+        int width, height;
+        SDL_Color color;
+    };
+
+    struct Placement {
+        int page;
+        SDL_Rect rect;
+    };
+
+    std::vector<Image> images;
+    std::vector<SDL_Texture*> pages;
+    std::vector<SDL_Surface*> pageSurfaces; // kept after pack() or load() for save()
+    std::unordered_map<std::string, Placement> placements;
+
+    bool place(std::vector<int>& pageHeights);
+    bool upload(SDL_Renderer* renderer);
+
+public:
+    TextureAtlas();
+    ~TextureAtlas();
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Declares a solid-colour image; names are unique.
+    void addImage(const std::string& name, int width, int height, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+
+    bool load(SDL_Renderer* renderer, const std::string& metaPath);
+    bool pack(SDL_Renderer* renderer);
+    bool save(const std::string& metaPath) const;
+    // Releases the pages; declared images are kept.
+    void clear();
+
+    AtlasRegion find(const std::string& name) const;
+    int getPageCount() const;
+};
+
+#endif // TEXTUREATLAS_H
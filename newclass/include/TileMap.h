@@ -4,21 +4,60 @@
 #include "Common.h"
 #include "Camera.h"
 #include "Rectangle.h"
+#include "TextureAtlas.h"
+#include "../../common/include/chunk_world.h"
 
+static_assert(WORLD_CHUNK_TILES == chunk_world::CHUNK_TILES, "one Uint16 obstacle mask per chunk row");
+
+// Streaming terrain on a common/include/chunk_world.h ChunkStore. Chunks
+// around the view are generated on the store's background thread and the
+// least recently used ones past MAX_RESIDENT_CHUNKS are evicted; chunks
+// edited through setTile are pinned. Gameplay queries never see holes: a
+// query into a chunk that hasn't arrived yet generates it on the spot.
+// Ground is baked into one render target per visible chunk, with at most
+// MAX_BAKED_CHUNKS textures alive.
 class TileMap {
 private:
-    std::vector<std::vector<int>> map;
-    SDL_Texture* tileset;
-    std::vector<SDL_Rect> tileRects;
+    static const int CHUNK_TILES = WORLD_CHUNK_TILES;
+    static const Uint8 OBSTACLE_TILE = TILE_TYPES - 1;
+
+    struct Chunk : chunk_world::Chunk {
+        SDL_Texture* texture = nullptr;
+        bool textureDirty = true;
+        Uint32 lastRendered = 0;
+    };
+
+    AtlasRegion tileSprites[TILE_TYPES];
     int mapWidth, mapHeight;
     int tileSize;
+    int cols, rows;
+    int chunkCols, chunkRows;
+    int bakedCount;
+    mutable chunk_world::ChunkStore<Chunk> chunks;
+
+    Chunk* ensureChunk(int cx, int cy) const;
+    void releaseTextures();
+    void drawTiles(SDL_Renderer* renderer, const Chunk& chunk, int offsetX, int offsetY);
+    bool bakeChunk(SDL_Renderer* renderer, Chunk& chunk);
 
 public:
-    TileMap(SDL_Texture* tiles, int width, int height, int tileSize);
-    void generateTerrain();
+    // tiles holds one atlas region per tile type.
+    TileMap(const AtlasRegion tiles[], int width, int height, int tileSize, Uint32 seed);
+    ~TileMap();
+    TileMap(const TileMap&) = delete;
+    TileMap& operator=(const TileMap&) = delete;
+
+    // Call once per update with the area the camera is about to show.
+    void stream(const Rectangle& view);
     void render(SDL_Renderer* renderer, const Camera& camera);
+    int getTile(int x, int y) const;
+    void setTile(int x, int y, int tile);
     bool isObstacle(int x, int y) const;
+    // Like isObstacle() but never generates: tiles in chunks that haven't
+    // streamed in yet report as obstacles.
+    bool isResidentObstacle(int x, int y) const;
     bool checkCollision(const Rectangle& rect) const;
+    size_t getResidentChunkCount() const;
 };
 
 #endif // TILEMAP_H
@@ -3,31 +3,50 @@
 
 #include "Common.h"
 #include "Player.h"
+#include "TextRenderer.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
 
 class UIManager {
 private:
     SDL_Renderer* renderer;
     TTF_Font* font;
-    SDL_Texture* hpBarTexture;
-    SDL_Texture* inventoryTexture;
+    AtlasRegion hpBarSprite;
+    AtlasRegion inventorySprite;
     GameState& gameState;
     Player& player;
     TimeOfDay& timeOfDay;
+    TextRenderer textRenderer;
+    // The gameplay HUD is drawn into this screen-sized target only when
+    // marked dirty by a player, inventory or time-of-day change and is
+    // otherwise put on screen with one copy.
+    SDL_Texture* hudTexture;
+    bool hudDirty;
+    bool showProfiler;
+    std::vector<Profiler::ScopeStats> profileStats;
+    std::vector<float> frameTimes;
+    std::vector<MemoryStats::CategoryStats> memoryStats;
 
     void renderHealthBar();
     void renderInventoryPreview();
     void renderTimeOfDay();
+    void renderHud();
     void renderGameplay();
     void renderInventoryScreen();
     void renderCraftingScreen();
     void renderPauseScreen();
     void renderGameOverScreen();
     void renderMainMenu();
+    void renderProfiler();
 
 public:
-    UIManager(SDL_Renderer* ren, TTF_Font* f, SDL_Texture* hpBar, SDL_Texture* invTex, GameState& state, Player& p, TimeOfDay& time);
+    UIManager(SDL_Renderer* ren, TTF_Font* f, const AtlasRegion& hpBar, const AtlasRegion& invPanel, GameState& state, Player& p, TimeOfDay& time);
+    ~UIManager();
     void renderText(const std::string& text, int x, int y, SDL_Color color);
+    void renderLabel(const std::string& text, int x, int y, SDL_Color color);
     void render();
+    void toggleProfiler();
+    void invalidateHud();
 };
 
 #endif // UIMANAGER_H
@@ -1,20 +1,10 @@
 #ifndef VECTOR2D_H
 #define VECTOR2D_H
 
-struct Vector2D {
-    float x;
-    float y;
+#include "../../common/include/vec2.h"
 
-    Vector2D();
-    Vector2D(float x, float y);
-
-    Vector2D& operator+=(const Vector2D& v);
-    Vector2D operator+(const Vector2D& v) const;
-    Vector2D operator-(const Vector2D& v) const;
-    Vector2D operator*(float scalar) const;
-
-    float magnitude() const;
-    Vector2D normalize() const;
-};
+// The shared engine vector; length() and normalize() are free functions in
+// namespace engine.
+typedef engine::Vec2 Vector2D;
 
 #endif // VECTOR2D_H
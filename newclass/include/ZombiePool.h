@@ -0,0 +1,100 @@
+#ifndef ZOMBIEPOOL_H
+#define ZOMBIEPOOL_H
+
+#include "Common.h"
+#include "Camera.h"
+#include "Rectangle.h"
+#include "FlowField.h"
+#include "TextureAtlas.h"
+#include "SpriteBatch.h"
+#include "MemoryStats.h"
+
+class JobSystem;
+class Player;
+
+struct ZombieStats {
+    int health;
+    int damage;
+    float speed;
+    float detectionRange;
+    float attackRange;
+    Uint32 attackCooldown;
+};
+
+// Indexed by ZombieType.
+constexpr ZombieStats ZOMBIE_STATS[] = {
+    { 50, 10, 2.0f, 200.0f, 40.0f, 1000 },  // NORMAL
+    { 30,  5, 3.5f, 250.0f, 35.0f,  800 },  // RUNNER
+    { 100, 15, 1.5f, 150.0f, 45.0f, 1500 }, // TANK
+    { 40, 30, 2.5f, 180.0f, 50.0f,    0 }   // EXPLODER
+};
+
+enum ZombieState : Uint8 {
+    ZOMBIE_ACTIVE,
+    ZOMBIE_FROZEN, // inside a building, skipped by the update
+    ZOMBIE_DEAD
+};
+
+// Structure-of-arrays storage for the horde. Every field lives in its own
+// contiguous array so updateAll() streams through memory and the pursue math
+// runs four zombies per SSE instruction. Dead zombies are swap-removed, so
+// slot indices are only stable between calls to removeDead().
+class ZombiePool {
+private:
+    template<typename T>
+    using EntityArray = TrackedVector<T, MEM_ENTITIES>;
+
+    EntityArray<float> posX, posY;
+    EntityArray<float> prevX, prevY;
+    EntityArray<float> velX, velY;
+    EntityArray<float> speed;
+    EntityArray<float> detectionRangeSq;
+    EntityArray<float> attackRangeSq;
+    EntityArray<float> distSq;
+    EntityArray<int> health;
+    EntityArray<Uint32> lastAttackTime;
+    EntityArray<int> attackDamage; // attack intent from the last update, 0 for none
+    EntityArray<Uint8> type;
+    EntityArray<Uint8> state;
+    std::vector<int> attacks;
+    Uint32 wanderSeed;
+
+    void steer(size_t begin, size_t end, float targetX, float targetY);
+    void updateRange(size_t begin, size_t end, float targetX, float targetY, Uint32 now, const FlowField* flow);
+
+public:
+    ZombiePool();
+    void reserve(size_t count);
+    void clear();
+    // Seeds the idle wander pattern; the same seed gives the same walk.
+    void setWanderSeed(Uint32 seed);
+
+    int spawn(const Vector2D& pos, ZombieType t);
+    void savePreviousState();
+    // With a flow field, chasing zombies follow it around obstacles and only
+    // steer straight at the player once they share a tile or lose the field.
+    // With a job system the slots are updated in parallel ranges; the result
+    // is identical to the serial run.
+    void updateAll(const Player& player, Uint32 now, const FlowField* flow = nullptr, JobSystem* jobs = nullptr);
+    void removeDead();
+
+    // Damage of every attack landed during the last updateAll(), in slot order.
+    const std::vector<int>& getAttacks() const;
+
+    void collectOverlapping(const Rectangle& rect, std::vector<int>& out) const;
+    void render(SpriteBatch& batch, const Camera& camera, const AtlasRegion sprites[], float alpha = 1.0f) const;
+
+    Uint64 checksum() const;
+    size_t size() const;
+    Vector2D getPosition(int index) const;
+    void setPosition(int index, const Vector2D& pos);
+    Rectangle getCollider(int index) const;
+    ZombieType getType(int index) const;
+    int getHealth(int index) const;
+    bool isActive(int index) const;
+    ZombieState getState(int index) const;
+    void setFrozen(int index, bool frozen);
+    void takeDamage(int index, int amount);
+};
+
+#endif // ZOMBIEPOOL_H
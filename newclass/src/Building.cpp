@@ -1,7 +1,7 @@
 #include "Building.h"
 
-Building::Building(Vector2D pos, SDL_Texture* tex, int w, int h) :
-    Entity(pos, tex, w, h), isPlayerHome(false) {
+Building::Building(Vector2D pos, const AtlasRegion& sprite, int w, int h) :
+    Entity(pos, sprite, w, h), isPlayerHome(false) {
     entrance.x = position.x + w / 2 - TILE_SIZE / 2;
     entrance.y = position.y + h - TILE_SIZE;
     entrance.w = TILE_SIZE;
@@ -11,6 +11,11 @@ Building::Building(Vector2D pos, SDL_Texture* tex, int w, int h) :
     interior.y = position.y;
     interior.w = w;
     interior.h = h;
+    MemoryStats::allocated(MEM_ENTITIES, sizeof(Building));
+}
+
+Building::~Building() {
+    MemoryStats::freed(MEM_ENTITIES, sizeof(Building));
 }
 
 bool Building::isAtEntrance(const Vector2D& pos) const {
@@ -21,20 +26,20 @@ bool Building::isInside(const Vector2D& pos) const {
     return interior.contains(pos.x, pos.y);
 }
 
-void Building::addItem(Item* item) {
+void Building::addItem(ItemHandle item) {
     items.push_back(item);
 }
 
-Item* Building::getItem(int index) {
+ItemHandle Building::getItem(int index) {
     if (index >= 0 && index < items.size()) {
-        Item* item = items[index];
+        ItemHandle item = items[index];
         items.erase(items.begin() + index);
         return item;
     }
-    return nullptr;
+    return ItemHandle();
 }
 
-std::vector<Item*>& Building::getItems() {
+TrackedVector<ItemHandle, MEM_BUILDING_ITEMS>& Building::getItems() {
     return items;
 }
 
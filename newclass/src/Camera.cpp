@@ -1,37 +1,29 @@
 #include "Camera.h"
 
-Camera::Camera(int mapWidth, int mapHeight) : mapWidth(mapWidth), mapHeight(mapHeight) {
-    viewport.x = 0;
-    viewport.y = 0;
-    viewport.w = SCREEN_WIDTH;
-    viewport.h = SCREEN_HEIGHT;
+Camera::Camera(int mapWidth, int mapHeight) : view(SCREEN_WIDTH, SCREEN_HEIGHT, mapWidth, mapHeight) {
 }
 
 void Camera::update(const Vector2D& target) {
-    viewport.x = static_cast<int>(target.x - SCREEN_WIDTH / 2);
-    viewport.y = static_cast<int>(target.y - SCREEN_HEIGHT / 2);
-
-    if (viewport.x < 0) viewport.x = 0;
-    if (viewport.y < 0) viewport.y = 0;
-    if (viewport.x > mapWidth - viewport.w) viewport.x = mapWidth - viewport.w;
-    if (viewport.y > mapHeight - viewport.h) viewport.y = mapHeight - viewport.h;
+    view.follow(target);
+    Vector2D position = view.position();
+    view.moveTo(Vector2D(static_cast<int>(position.x), static_cast<int>(position.y)));
 }
 
 SDL_Rect Camera::getViewport() const {
+    Vector2D position = view.position();
+    SDL_Rect viewport = { static_cast<int>(position.x), static_cast<int>(position.y),
+                          static_cast<int>(view.viewWidth()), static_cast<int>(view.viewHeight()) };
     return viewport;
 }
 
 bool Camera::isVisible(const Rectangle& rect) const {
-    return (rect.x + rect.w > viewport.x &&
-            rect.x < viewport.x + viewport.w &&
-            rect.y + rect.h > viewport.y &&
-            rect.y < viewport.y + viewport.h);
+    return view.isVisible(rect.x, rect.y, rect.w, rect.h);
 }
 
 Vector2D Camera::worldToScreen(const Vector2D& worldPos) const {
-    return Vector2D(worldPos.x - viewport.x, worldPos.y - viewport.y);
+    return view.worldToScreen(worldPos);
 }
 
 Vector2D Camera::screenToWorld(const Vector2D& screenPos) const {
-    return Vector2D(screenPos.x + viewport.x, screenPos.y + viewport.y);
+    return view.screenToWorld(screenPos);
 }
@@ -1,11 +1,10 @@
 #include "Entity.h"
+#include "SpatialGrid.h"
+#include "../../common/include/log.h"
 
-Entity::Entity(Vector2D pos, SDL_Texture* tex, int w, int h) :
-    position(pos), velocity(0, 0), texture(tex), active(true) {
-    srcRect.x = 0;
-    srcRect.y = 0;
-    srcRect.w = w;
-    srcRect.h = h;
+Entity::Entity(Vector2D pos, const AtlasRegion& sprite, int w, int h) :
+    position(pos), previousPosition(pos), velocity(0, 0), texture(sprite.texture), srcRect(sprite.rect), active(true),
+    grid(nullptr), gridMinX(0), gridMinY(0), gridMaxX(0), gridMaxY(0), gridQueryStamp(0) {
     destRect.w = w;
     destRect.h = h;
     collider.w = w;
@@ -13,36 +12,45 @@ Entity::Entity(Vector2D pos, SDL_Texture* tex, int w, int h) :
     updateCollider();
 }
 
-Entity::~Entity() {}
+Entity::~Entity() {
+    if (grid) grid->remove(this);
+}
 
 void Entity::update() {
     position += velocity;
     updateCollider();
 }
 
-void Entity::render(SDL_Renderer* renderer, const Camera& camera) {
+void Entity::render(SpriteBatch& batch, const Camera& camera, int layer, float alpha) {
     if (!active || !texture) {
         if (!texture) {
-            std::cout << "Warning: Entity at (" << position.x << ", " << position.y << ") has nullptr texture." << std::endl;
+            LOG_WARN(LOG_CAT_RENDER, "Entity at ({}, {}) has nullptr texture.", position.x, position.y);
         }
         return;
     }
 
-    Vector2D screenPos = camera.worldToScreen(position);
+    Vector2D screenPos = camera.worldToScreen(getInterpolatedPosition(alpha));
     destRect.x = static_cast<int>(screenPos.x);
     destRect.y = static_cast<int>(screenPos.y);
 
-    SDL_RenderCopy(renderer, texture, &srcRect, &destRect);
+    batch.draw(texture, srcRect, destRect, layer);
 }
 
 void Entity::updateCollider() {
     collider.x = position.x;
     collider.y = position.y;
+    if (grid) grid->update(this);
 }
 
 bool Entity::isActive() const { return active; }
 void Entity::setActive(bool a) { active = a; }
 
+void Entity::savePreviousState() { previousPosition = position; }
+
+Vector2D Entity::getInterpolatedPosition(float alpha) const {
+    return previousPosition + (position - previousPosition) * alpha;
+}
+
 Vector2D Entity::getPosition() const { return position; }
 void Entity::setPosition(const Vector2D& pos) { position = pos; updateCollider(); }
 
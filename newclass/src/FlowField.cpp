@@ -0,0 +1,177 @@
+#include "FlowField.h"
+#include "TileMap.h"
+#include "Profiler.h"
+
+namespace {
+    const Uint8 NO_DIRECTION = 8;
+    const Uint16 UNREACHED = 0xFFFF;
+
+    // Eight neighbours, orthogonal first so ties favour straight moves.
+    const int DIR_X[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    const int DIR_Y[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+    const float DIAGONAL = 0.70710678f;
+    const float DIR_UNIT_X[8] = { 1.0f, -1.0f, 0.0f, 0.0f, DIAGONAL, DIAGONAL, -DIAGONAL, -DIAGONAL };
+    const float DIR_UNIT_Y[8] = { 0.0f, 0.0f, 1.0f, -1.0f, DIAGONAL, -DIAGONAL, DIAGONAL, -DIAGONAL };
+}
+
+FlowField::FlowField(int windowTiles, int tileSize) :
+    cols(windowTiles), rows(windowTiles), tileSize(tileSize), map(nullptr),
+    originX(0), originY(0), publishedX(0), publishedY(0), targetX(-1), targetY(-1),
+    frontierHead(0), targetTile(-1), published(false), searching(false) {
+    blocked.assign(cols * rows, 0);
+    cost.assign(cols * rows, UNREACHED);
+    directions.assign(cols * rows, NO_DIRECTION);
+    frontier.reserve(cols * rows);
+}
+
+void FlowField::setMap(const TileMap* tileMap) {
+    map = tileMap;
+    published = false;
+    searching = false;
+    targetX = targetY = -1;
+}
+
+void FlowField::blockArea(const Rectangle& area) {
+    blockedAreas.push_back(area);
+    targetX = targetY = -1;
+}
+
+void FlowField::clearBlockedAreas() {
+    blockedAreas.clear();
+    targetX = targetY = -1;
+}
+
+void FlowField::update(const Vector2D& target, size_t maxCells) {
+    PROFILE_SCOPE("FlowField::update");
+    if (!map || target.x < 0.0f || target.y < 0.0f) return;
+
+    int tx = static_cast<int>(target.x) / tileSize;
+    int ty = static_cast<int>(target.y) / tileSize;
+    if (tx != targetX || ty != targetY) {
+        startSearch(tx, ty);
+    }
+    if (searching) {
+        expand(maxCells);
+    }
+}
+
+// Fills the blocked mask for the window at the current origin. Tiles outside
+// the world or in chunks not streamed in yet report as obstacles, so the
+// search never leaves the world and never generates terrain on this thread.
+void FlowField::buildWindow() {
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            blocked[y * cols + x] = map->isResidentObstacle(originX + x, originY + y) ? 1 : 0;
+        }
+    }
+
+    int windowLeft = originX * tileSize;
+    int windowTop = originY * tileSize;
+    Rectangle window(windowLeft, windowTop, cols * tileSize, rows * tileSize);
+    for (const Rectangle& area : blockedAreas) {
+        if (!area.intersects(window)) continue;
+
+        int minX = std::max(0, (static_cast<int>(area.x) - windowLeft) / tileSize);
+        int minY = std::max(0, (static_cast<int>(area.y) - windowTop) / tileSize);
+        int maxX = std::min(cols - 1, (static_cast<int>(area.x + area.w - 1) - windowLeft) / tileSize);
+        int maxY = std::min(rows - 1, (static_cast<int>(area.y + area.h - 1) - windowTop) / tileSize);
+        for (int y = minY; y <= maxY; ++y) {
+            for (int x = minX; x <= maxX; ++x) {
+                blocked[y * cols + x] = 1;
+            }
+        }
+    }
+}
+
+void FlowField::startSearch(int tx, int ty) {
+    targetX = tx;
+    targetY = ty;
+    originX = tx - cols / 2;
+    originY = ty - rows / 2;
+    buildWindow();
+
+    std::fill(cost.begin(), cost.end(), UNREACHED);
+    frontier.clear();
+    frontierHead = 0;
+
+    // The target tile itself may be blocked (player standing in a doorway),
+    // it is still the seed so neighbouring open tiles lead to it.
+    targetTile = (ty - originY) * cols + (tx - originX);
+    cost[targetTile] = 0;
+    frontier.push_back(targetTile);
+    searching = true;
+}
+
+void FlowField::expand(size_t maxCells) {
+    size_t processed = 0;
+    while (frontierHead < frontier.size()) {
+        if (maxCells != 0 && processed == maxCells) return;
+
+        int tile = frontier[frontierHead++];
+        int x = tile % cols;
+        int y = tile / cols;
+        Uint16 next = cost[tile] + 1;
+
+        for (int d = 0; d < 4; ++d) {
+            int nx = x + DIR_X[d];
+            int ny = y + DIR_Y[d];
+            if (nx < 0 || ny < 0 || nx >= cols || ny >= rows) continue;
+
+            int neighbour = ny * cols + nx;
+            if (blocked[neighbour] || cost[neighbour] != UNREACHED) continue;
+            cost[neighbour] = next;
+            frontier.push_back(neighbour);
+        }
+        ++processed;
+    }
+
+    publish();
+    searching = false;
+}
+
+// Turns the finished distance field into per-tile directions. Diagonals are
+// only taken when both orthogonal tiles are open so zombies don't try to
+// squeeze between two obstacles touching at a corner.
+void FlowField::publish() {
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            int tile = y * cols + x;
+            Uint8 best = NO_DIRECTION;
+            Uint16 bestCost = cost[tile];
+
+            if (bestCost != UNREACHED && tile != targetTile) {
+                for (int d = 0; d < 8; ++d) {
+                    int nx = x + DIR_X[d];
+                    int ny = y + DIR_Y[d];
+                    if (nx < 0 || ny < 0 || nx >= cols || ny >= rows) continue;
+                    if (d >= 4 && (blocked[y * cols + nx] || blocked[ny * cols + x])) continue;
+
+                    Uint16 neighbourCost = cost[ny * cols + nx];
+                    if (neighbourCost < bestCost) {
+                        bestCost = neighbourCost;
+                        best = static_cast<Uint8>(d);
+                    }
+                }
+            }
+            directions[tile] = best;
+        }
+    }
+    publishedX = originX;
+    publishedY = originY;
+    published = true;
+}
+
+bool FlowField::sample(float x, float y, float& dirX, float& dirY) const {
+    if (!published || x < 0.0f || y < 0.0f) return false;
+
+    int tx = static_cast<int>(x) / tileSize - publishedX;
+    int ty = static_cast<int>(y) / tileSize - publishedY;
+    if (tx < 0 || ty < 0 || tx >= cols || ty >= rows) return false;
+
+    Uint8 d = directions[ty * cols + tx];
+    if (d == NO_DIRECTION) return false;
+
+    dirX = DIR_UNIT_X[d];
+    dirY = DIR_UNIT_Y[d];
+    return true;
+}
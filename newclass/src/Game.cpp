@@ -1,18 +1,53 @@
 #include "Game.h"
+#include "../../common/include/log.h"
+#include "Profiler.h"
 #include <stdio.h>
+#include <cstring>
 #include <algorithm>
 
+namespace {
+    // Every sprite the game draws; loadMedia() puts them all in one atlas.
+    struct SpriteImage {
+        const char* name;
+        int width, height;
+        Uint8 r, g, b, a;
+    };
+
+    const SpriteImage SPRITE_IMAGES[] = {
+        { "player", TILE_SIZE, TILE_SIZE, 0, 0, 255, 255 },
+        { "zombie_normal", TILE_SIZE, TILE_SIZE, 0, 255, 0, 255 },
+        { "zombie_runner", TILE_SIZE, TILE_SIZE, 255, 255, 0, 255 },
+        { "zombie_tank", TILE_SIZE, TILE_SIZE, 255, 128, 0, 255 },
+        { "zombie_exploder", TILE_SIZE, TILE_SIZE, 255, 0, 0, 255 },
+        { "building_small", TILE_SIZE * 4, TILE_SIZE * 3, 128, 128, 128, 255 },
+        { "building_medium", TILE_SIZE * 6, TILE_SIZE * 4, 150, 150, 150, 255 },
+        { "building_large", TILE_SIZE * 8, TILE_SIZE * 6, 170, 170, 170, 255 },
+        { "item_weapon", TILE_SIZE, TILE_SIZE, 192, 192, 0, 255 },
+        { "item_armor", TILE_SIZE, TILE_SIZE, 192, 0, 192, 255 },
+        { "item_health", TILE_SIZE, TILE_SIZE, 255, 0, 0, 255 },
+        { "item_wood", TILE_SIZE, TILE_SIZE, 139, 69, 19, 255 },
+        { "item_metal", TILE_SIZE, TILE_SIZE, 169, 169, 169, 255 },
+        { "item_food", TILE_SIZE, TILE_SIZE, 0, 128, 0, 255 },
+        { "item_cloth", TILE_SIZE, TILE_SIZE, 255, 255, 255, 255 },
+        { "item_ammo", TILE_SIZE, TILE_SIZE, 255, 215, 0, 255 },
+        { "tile_grass", TILE_SIZE, TILE_SIZE, 100, 150, 100, 255 },
+        { "tile_grass_light", TILE_SIZE, TILE_SIZE, 120, 170, 120, 255 },
+        { "tile_rock", TILE_SIZE, TILE_SIZE, 100, 100, 100, 255 },
+        { "ui_health_bar", 200, 30, 255, 0, 0, 255 },
+        { "ui_panel", 400, 300, 50, 50, 50, 200 }
+    };
+
+    // Prebuilt atlas, used instead of packing at startup when present.
+    const char* const ATLAS_METADATA = "assets/atlas.txt";
+}
+
 Game::Game() :
-    running(true), window(nullptr), renderer(nullptr), gameState(GAMEPLAY),
-    timeOfDay(DAY), gameTime(0), lastFrameTime(0), lastTimeUpdate(0),
+    running(true), invulnerablePlayer(false), window(nullptr), renderer(nullptr), gameState(GAMEPLAY),
+    timeOfDay(DAY), gameTime(0), lastFrameTime(0), lastTimeUpdate(0), simTick(0),
     camera(MAP_WIDTH, MAP_HEIGHT), lastZombieSpawn(0), zombieSpawnInterval(5000),
-    playerTexture(nullptr), tilesetTexture(nullptr), font(nullptr) {
-    std::random_device rd;
-    rng = std::mt19937(rd());
-    for (int i = 0; i < 4; ++i) zombieTextures[i] = nullptr;
-    for (int i = 0; i < 3; ++i) buildingTextures[i] = nullptr;
-    for (int i = 0; i < 8; ++i) itemTextures[i] = nullptr;
-    for (int i = 0; i < 2; ++i) uiTextures[i] = nullptr;
+    playerSprite(), zombieSprites(), buildingSprites(), itemSprites(), tileSprites(), uiSprites(), font(nullptr),
+    buildingGrid(MAP_WIDTH, MAP_HEIGHT, WORLD_CHUNK_PIXELS), itemGrid(MAP_WIDTH, MAP_HEIGHT, WORLD_CHUNK_PIXELS / 2),
+    worldSeed(0), setupZombieCount(0), setupItemCount(0), heldMovement(0) {
 }
 
 Game::~Game() {
@@ -27,7 +62,7 @@ bool Game::init(const char* title, int xpos, int ypos, int width, int height, bo
         std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
         return false;
     }
-    std::cout << "SDL initialized successfully" << std::endl;
+    LOG_INFO(LOG_CAT_GAME, "SDL initialized successfully");
 
     if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
         std::cerr << "SDL_image initialization failed: " << IMG_GetError() << std::endl;
@@ -50,75 +85,63 @@ bool Game::init(const char* title, int xpos, int ypos, int width, int height, bo
         std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
         return false;
     }
-    std::cout << "Game initialized - Window: " << width << "x" << height
-              << ", Fullscreen: " << (fullscreen ? "Yes" : "No") << std::endl;
+    spriteBatch = std::make_unique<SpriteBatch>(renderer);
+    lightMap = std::make_unique<LightMap>(renderer, width, height);
+    jobs = std::make_unique<JobSystem>();
+
+    LOG_INFO(LOG_CAT_GAME, "Game initialized - Window: {}x{}, Fullscreen: {}",
+             width, height, fullscreen ? "Yes" : "No");
 
     running = true;
     return loadMedia();
 }
 
+bool Game::initHeadless(const HeadlessConfig& config) {
+    random.reseed(config.seed);
+    invulnerablePlayer = config.invulnerablePlayer;
+    jobs = std::make_unique<JobSystem>(config.threads);
+
+    setupGame(config.zombies, config.items);
+    gameState = GAMEPLAY;
+    running = true;
+    LOG_INFO(LOG_CAT_GAME, "Headless game initialized - seed {}", config.seed);
+    return true;
+}
+
 bool Game::loadMedia() {
-    playerTexture = createColorTexture(TILE_SIZE, TILE_SIZE, 0, 0, 255, 255);
-    if (!playerTexture) return false;
-
-    zombieTextures[NORMAL] = createColorTexture(TILE_SIZE, TILE_SIZE, 0, 255, 0, 255);
-    if (!zombieTextures[NORMAL]) return false;
-    zombieTextures[RUNNER] = createColorTexture(TILE_SIZE, TILE_SIZE, 255, 255, 0, 255);
-    if (!zombieTextures[RUNNER]) return false;
-    zombieTextures[TANK] = createColorTexture(TILE_SIZE, TILE_SIZE, 255, 128, 0, 255);
-    if (!zombieTextures[TANK]) return false;
-    zombieTextures[EXPLODER] = createColorTexture(TILE_SIZE, TILE_SIZE, 255, 0, 0, 255);
-    if (!zombieTextures[EXPLODER]) return false;
-
-    buildingTextures[0] = createColorTexture(TILE_SIZE * 4, TILE_SIZE * 3, 128, 128, 128, 255);
-    if (!buildingTextures[0]) return false;
-    buildingTextures[1] = createColorTexture(TILE_SIZE * 6, TILE_SIZE * 4, 150, 150, 150, 255);
-    if (!buildingTextures[1]) return false;
-    buildingTextures[2] = createColorTexture(TILE_SIZE * 8, TILE_SIZE * 6, 170, 170, 170, 255);
-    if (!buildingTextures[2]) return false;
-
-    itemTextures[WEAPON] = createColorTexture(TILE_SIZE, TILE_SIZE, 192, 192, 0, 255);
-    if (!itemTextures[WEAPON]) return false;
-    itemTextures[ARMOR] = createColorTexture(TILE_SIZE, TILE_SIZE, 192, 0, 192, 255);
-    if (!itemTextures[ARMOR]) return false;
-    itemTextures[HEALTH] = createColorTexture(TILE_SIZE, TILE_SIZE, 255, 0, 0, 255);
-    if (!itemTextures[HEALTH]) return false;
-    itemTextures[RESOURCE_WOOD] = createColorTexture(TILE_SIZE, TILE_SIZE, 139, 69, 19, 255);
-    if (!itemTextures[RESOURCE_WOOD]) return false;
-    itemTextures[RESOURCE_METAL] = createColorTexture(TILE_SIZE, TILE_SIZE, 169, 169, 169, 255);
-    if (!itemTextures[RESOURCE_METAL]) return false;
-    itemTextures[RESOURCE_FOOD] = createColorTexture(TILE_SIZE, TILE_SIZE, 0, 128, 0, 255);
-    if (!itemTextures[RESOURCE_FOOD]) return false;
-    itemTextures[RESOURCE_CLOTH] = createColorTexture(TILE_SIZE, TILE_SIZE, 255, 255, 255, 255);
-    if (!itemTextures[RESOURCE_CLOTH]) return false;
-    itemTextures[AMMO] = createColorTexture(TILE_SIZE, TILE_SIZE, 255, 215, 0, 255);
-    if (!itemTextures[AMMO]) return false;
-
-    tilesetTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, TILE_SIZE * 3, TILE_SIZE);
-    if (!tilesetTexture) {
-        std::cerr << "Tileset texture creation failed: " << SDL_GetError() << std::endl;
+    PROFILE_SCOPE("Game::loadMedia");
+    for (const SpriteImage& image : SPRITE_IMAGES) {
+        atlas.addImage(image.name, image.width, image.height, image.r, image.g, image.b, image.a);
+    }
+    if (!atlas.load(renderer, ATLAS_METADATA) && !atlas.pack(renderer)) {
         return false;
     }
 
-    SDL_SetRenderTarget(renderer, tilesetTexture);
-    SDL_Rect rect = { 0, 0, TILE_SIZE, TILE_SIZE };
-    SDL_SetRenderDrawColor(renderer, 100, 150, 100, 255);
-    SDL_RenderFillRect(renderer, &rect);
+    playerSprite = atlas.find("player");
+    zombieSprites[NORMAL] = atlas.find("zombie_normal");
+    zombieSprites[RUNNER] = atlas.find("zombie_runner");
+    zombieSprites[TANK] = atlas.find("zombie_tank");
+    zombieSprites[EXPLODER] = atlas.find("zombie_exploder");
 
-    rect.x = TILE_SIZE;
-    SDL_SetRenderDrawColor(renderer, 120, 170, 120, 255);
-    SDL_RenderFillRect(renderer, &rect);
+    buildingSprites[0] = atlas.find("building_small");
+    buildingSprites[1] = atlas.find("building_medium");
+    buildingSprites[2] = atlas.find("building_large");
 
-    rect.x = TILE_SIZE * 2;
-    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-    SDL_RenderFillRect(renderer, &rect);
+    itemSprites[WEAPON] = atlas.find("item_weapon");
+    itemSprites[ARMOR] = atlas.find("item_armor");
+    itemSprites[HEALTH] = atlas.find("item_health");
+    itemSprites[RESOURCE_WOOD] = atlas.find("item_wood");
+    itemSprites[RESOURCE_METAL] = atlas.find("item_metal");
+    itemSprites[RESOURCE_FOOD] = atlas.find("item_food");
+    itemSprites[RESOURCE_CLOTH] = atlas.find("item_cloth");
+    itemSprites[AMMO] = atlas.find("item_ammo");
 
-    SDL_SetRenderTarget(renderer, nullptr);
+    tileSprites[0] = atlas.find("tile_grass");
+    tileSprites[1] = atlas.find("tile_grass_light");
+    tileSprites[2] = atlas.find("tile_rock");
 
-    uiTextures[0] = createColorTexture(200, 30, 255, 0, 0, 255);
-    if (!uiTextures[0]) return false;
-    uiTextures[1] = createColorTexture(400, 300, 50, 50, 50, 200);
-    if (!uiTextures[1]) return false;
+    uiSprites[0] = atlas.find("ui_health_bar");
+    uiSprites[1] = atlas.find("ui_panel");
 
     font = TTF_OpenFont("arial.ttf", 24);
     if (!font) {
@@ -131,117 +154,139 @@ bool Game::loadMedia() {
     return true;
 }
 
-SDL_Texture* Game::createColorTexture(int width, int height, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
-    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
-    if (!texture) {
-        std::cerr << "Texture creation failed: " << SDL_GetError() << std::endl;
-        return nullptr;
+bool Game::saveAtlas() const {
+    if (!atlas.save(ATLAS_METADATA)) {
+        return false;
     }
-
-    SDL_SetRenderTarget(renderer, texture);
-    SDL_SetRenderDrawColor(renderer, r, g, b, a);
-    SDL_Rect rect = { 0, 0, width, height };
-    SDL_RenderFillRect(renderer, &rect);
-    SDL_SetRenderTarget(renderer, nullptr);
-
-    return texture;
+    LOG_INFO(LOG_CAT_GAME, "Texture atlas written to {}", ATLAS_METADATA);
+    return true;
 }
 
-void Game::setupGame() {
-    player = std::make_unique<Player>(Vector2D(MAP_WIDTH / 2, MAP_HEIGHT / 2), playerTexture);
-    std::cout << "New game setup - Player spawned at ("
-              << MAP_WIDTH / 2 << ", " << MAP_HEIGHT / 2 << ")" << std::endl;
-
-    tileMap = std::make_unique<TileMap>(tilesetTexture, MAP_WIDTH, MAP_HEIGHT, TILE_SIZE);
-
-    createBuildings();
-
-    for (int i = 0; i < 10; ++i) {
+void Game::setupGame(int zombieCount, int itemCount) {
+    player = std::make_unique<Player>(Vector2D(MAP_WIDTH / 2, MAP_HEIGHT / 2), playerSprite);
+    LOG_INFO(LOG_CAT_GAME, "New game setup - Player spawned at ({}, {})", MAP_WIDTH / 2, MAP_HEIGHT / 2);
+
+    setupZombieCount = zombieCount;
+    setupItemCount = itemCount;
+    worldSeed = random.get(RNG_TERRAIN)();
+    zombies.setWanderSeed(random.get(RNG_AI)());
+    tileMap = std::make_unique<TileMap>(tileSprites, MAP_WIDTH, MAP_HEIGHT, TILE_SIZE, worldSeed);
+
+    // A restart reuses the pools: the previous level's objects are released,
+    // their storage is kept.
+    zombies.clear();
+    items.clear();
+    itemPool.clear();
+    buildings.clear();
+    zombies.reserve(std::max(zombieCount, ZOMBIE_POOL_RESERVE));
+    itemPool.reserve(std::max(itemCount, ITEM_POOL_RESERVE));
+    items.reserve(std::max(itemCount, ITEM_POOL_RESERVE));
+
+    populatedChunks.assign(WORLD_CHUNKS * WORLD_CHUNKS, 0);
+    flowField.setMap(tileMap.get());
+    flowField.clearBlockedAreas();
+
+    // Buildings around the start have to exist before anything spawns so
+    // nothing lands inside one.
+    Rectangle view = getStreamView();
+    populateChunksAround(view);
+    tileMap->stream(view);
+
+    for (int i = 0; i < zombieCount; ++i) {
         spawnZombie();
     }
 
-    for (int i = 0; i < 20; ++i) {
+    for (int i = 0; i < itemCount; ++i) {
         spawnItem();
     }
 
-    uiManager = std::make_unique<UIManager>(renderer, font, uiTextures[0], uiTextures[1], gameState, *player, timeOfDay);
+    uiManager = std::make_unique<UIManager>(renderer, font, uiSprites[0], uiSprites[1], gameState, *player, timeOfDay);
 
     gameTime = 0;
-    lastFrameTime = SDL_GetTicks();
+    lastFrameTime = getSimTime();
     lastTimeUpdate = lastFrameTime;
     lastZombieSpawn = lastFrameTime;
 
     gameState = GAMEPLAY;
     timeOfDay = DAY;
 
-    std::cout << "Game setup complete - Zombies: " << zombies.size()
-              << ", Items: " << items.size() << ", Buildings: "
-              << buildings.size() << std::endl;
+    LOG_INFO(LOG_CAT_GAME, "Game setup complete - World seed: {}, Zombies: {}, Items: {}, Buildings: {}",
+             worldSeed, zombies.size(), items.size(), buildings.size());
 }
 
-void Game::createBuildings() {
-    std::uniform_int_distribution<int> xPosDist(TILE_SIZE * 5, MAP_WIDTH - TILE_SIZE * 10);
-    std::uniform_int_distribution<int> yPosDist(TILE_SIZE * 5, MAP_HEIGHT - TILE_SIZE * 10);
-    std::uniform_int_distribution<int> buildingTypeDist(0, 2);
-
-    for (int i = 0; i < 15; ++i) {
-        int type = buildingTypeDist(rng);
-        int width, height;
+// Screen-sized area centred on the player, the part of the world the next
+// frames can show.
+Rectangle Game::getStreamView() const {
+    Rectangle playerRect = player->getCollider();
+    return Rectangle(playerRect.x + playerRect.w / 2 - SCREEN_WIDTH / 2,
+                     playerRect.y + playerRect.h / 2 - SCREEN_HEIGHT / 2,
+                     SCREEN_WIDTH, SCREEN_HEIGHT);
+}
 
-        switch (type) {
-            case 0: width = TILE_SIZE * 4; height = TILE_SIZE * 3; break;
-            case 1: width = TILE_SIZE * 6; height = TILE_SIZE * 4; break;
-            case 2: width = TILE_SIZE * 8; height = TILE_SIZE * 6; break;
+// Populates every chunk within one chunk of the view. Chunks are filled from
+// their own seed, so the order they are reached in doesn't matter.
+void Game::populateChunksAround(const Rectangle& view) {
+    int minX = std::max(0, static_cast<int>(view.x) / WORLD_CHUNK_PIXELS - 1);
+    int minY = std::max(0, static_cast<int>(view.y) / WORLD_CHUNK_PIXELS - 1);
+    int maxX = std::min(WORLD_CHUNKS - 1, static_cast<int>(view.x + view.w) / WORLD_CHUNK_PIXELS + 1);
+    int maxY = std::min(WORLD_CHUNKS - 1, static_cast<int>(view.y + view.h) / WORLD_CHUNK_PIXELS + 1);
+
+    for (int cy = minY; cy <= maxY; ++cy) {
+        for (int cx = minX; cx <= maxX; ++cx) {
+            Uint8& populated = populatedChunks[cy * WORLD_CHUNKS + cx];
+            if (!populated) {
+                populateChunk(cx, cy);
+                populated = 1;
+            }
         }
+    }
+}
 
-        bool validPosition = false;
-        Vector2D pos;
-
-        int attempts = 0;
-        while (!validPosition && attempts < 20) {
-            validPosition = true;
-            pos.x = xPosDist(rng);
-            pos.y = yPosDist(rng);
-
-            Rectangle newRect(pos.x, pos.y, width, height);
-
-            for (const auto& building : buildings) {
-                Rectangle existingRect = building->getCollider();
-                existingRect.x -= TILE_SIZE * 2;
-                existingRect.y -= TILE_SIZE * 2;
-                existingRect.w += TILE_SIZE * 4;
-                existingRect.h += TILE_SIZE * 4;
+// Most chunks get one building. It stays two tiles clear of the chunk edge,
+// which keeps the old spacing between buildings without looking at the
+// neighbours.
+void Game::populateChunk(int cx, int cy) {
+    std::mt19937 chunkRng(chunk_world::chunkSeed(worldSeed, cx, cy, 1));
+    std::uniform_int_distribution<int> chanceDist(0, 99);
+    if (chanceDist(chunkRng) >= 60) return;
 
-                if (existingRect.intersects(newRect)) {
-                    validPosition = false;
-                    break;
-                }
-            }
+    std::uniform_int_distribution<int> buildingTypeDist(0, 2);
+    int type = buildingTypeDist(chunkRng);
+    int width, height;
 
-            attempts++;
-        }
+    switch (type) {
+        case 0: width = TILE_SIZE * 4; height = TILE_SIZE * 3; break;
+        case 1: width = TILE_SIZE * 6; height = TILE_SIZE * 4; break;
+        default: width = TILE_SIZE * 8; height = TILE_SIZE * 6; break;
+    }
 
-        if (validPosition) {
-            auto building = std::make_unique<Building>(pos, buildingTextures[type], width, height);
+    int margin = TILE_SIZE * 2;
+    std::uniform_int_distribution<int> xPosDist(margin, WORLD_CHUNK_PIXELS - margin - width);
+    std::uniform_int_distribution<int> yPosDist(margin, WORLD_CHUNK_PIXELS - margin - height);
+    Vector2D pos(cx * WORLD_CHUNK_PIXELS + xPosDist(chunkRng), cy * WORLD_CHUNK_PIXELS + yPosDist(chunkRng));
 
-            std::uniform_int_distribution<int> itemCountDist(1, 5);
-            int itemCount = itemCountDist(rng);
+    auto building = std::make_unique<Building>(pos, buildingSprites[type], width, height);
 
-            for (int j = 0; j < itemCount; ++j) {
-                createItemInBuilding(*building);
-            }
+    std::uniform_int_distribution<int> itemCountDist(1, 5);
+    int itemCount = itemCountDist(chunkRng);
 
-            buildings.push_back(std::move(building));
-        }
+    for (int j = 0; j < itemCount; ++j) {
+        createItemInBuilding(*building, chunkRng);
     }
+
+    flowField.blockArea(building->getCollider());
+    buildingGrid.insert(building.get());
+    buildings.push_back(std::move(building));
+    LOG_TRACE(LOG_CAT_GAME, "Chunk ({}, {}) populated - building type {} at ({}, {})",
+              cx, cy, type, pos.x, pos.y);
 }
 
-void Game::createItemInBuilding(Building& building) {
+void Game::createItemInBuilding(Building& building, std::mt19937& gen) {
     std::uniform_int_distribution<int> itemTypeDist(0, 7);
     std::uniform_int_distribution<int> valueDist(1, 5);
 
-    ItemType type = static_cast<ItemType>(itemTypeDist(rng));
-    int value = valueDist(rng);
+    ItemType type = static_cast<ItemType>(itemTypeDist(gen));
+    int value = valueDist(gen);
     std::string name;
 
     switch (type) {
@@ -255,29 +300,33 @@ void Game::createItemInBuilding(Building& building) {
         case AMMO: name = "Ammo"; break;
     }
 
-    Item* item = new Item(Vector2D(0, 0), itemTextures[type], type, value, name);
-    building.addItem(item);
+    building.addItem(itemPool.create(Vector2D(0, 0), itemSprites[type], type, value, name));
 }
 
 void Game::spawnZombie() {
-    std::uniform_real_distribution<float> xPosDist(0, MAP_WIDTH - TILE_SIZE);
-    std::uniform_real_distribution<float> yPosDist(0, MAP_HEIGHT - TILE_SIZE);
+    std::mt19937& spawnRng = random.get(RNG_SPAWN);
+    Vector2D playerPos = player->getPosition();
+    std::uniform_real_distribution<float> xPosDist(std::max(0.0f, playerPos.x - SPAWN_RADIUS),
+                                                   std::min<float>(MAP_WIDTH - TILE_SIZE, playerPos.x + SPAWN_RADIUS));
+    std::uniform_real_distribution<float> yPosDist(std::max(0.0f, playerPos.y - SPAWN_RADIUS),
+                                                   std::min<float>(MAP_HEIGHT - TILE_SIZE, playerPos.y + SPAWN_RADIUS));
     std::uniform_int_distribution<int> typeDist(0, 3);
 
-    Vector2D playerPos = player->getPosition();
     Vector2D pos;
     bool validPosition = false;
 
     while (!validPosition) {
-        pos.x = xPosDist(rng);
-        pos.y = yPosDist(rng);
+        pos.x = xPosDist(spawnRng);
+        pos.y = yPosDist(spawnRng);
 
         float dist = distance(pos.x, pos.y, playerPos.x, playerPos.y);
         if (dist > 300) {
             validPosition = true;
 
-            for (const auto& building : buildings) {
-                if (building->isInside(pos)) {
+            nearbyBuildings.clear();
+            buildingGrid.queryPoint(pos, nearbyBuildings);
+            for (Entity* building : nearbyBuildings) {
+                if (static_cast<Building*>(building)->isInside(pos)) {
                     validPosition = false;
                     break;
                 }
@@ -289,52 +338,55 @@ void Game::spawnZombie() {
 
     if (timeOfDay == NIGHT) {
         std::uniform_int_distribution<int> nightTypeDist(0, 10);
-        int roll = nightTypeDist(rng);
+        int roll = nightTypeDist(spawnRng);
 
         if (roll < 4) type = NORMAL;
         else if (roll < 7) type = RUNNER;
         else if (roll < 9) type = TANK;
         else type = EXPLODER;
     } else {
-        type = static_cast<ZombieType>(typeDist(rng));
+        type = static_cast<ZombieType>(typeDist(spawnRng));
     }
 
-    zombies.push_back(std::make_unique<Zombie>(pos, zombieTextures[type], type));
-    std::cout << "Zombie spawned - Type: " << type << " at ("
-              << pos.x << ", " << pos.y << "), Total zombies: "
-              << zombies.size() << std::endl;
+    zombies.spawn(pos, type);
+    LOG_DEBUG(LOG_CAT_ZOMBIE, "Zombie spawned - Type: {} at ({}, {}), Total zombies: {}",
+              type, pos.x, pos.y, zombies.size());
 }
 
 void Game::spawnItem() {
-    std::uniform_real_distribution<float> xPosDist(TILE_SIZE, MAP_WIDTH - TILE_SIZE * 2);
-    std::uniform_real_distribution<float> yPosDist(TILE_SIZE, MAP_HEIGHT - TILE_SIZE * 2);
+    std::mt19937& spawnRng = random.get(RNG_SPAWN);
+    Vector2D playerPos = player->getPosition();
+    std::uniform_real_distribution<float> xPosDist(std::max<float>(TILE_SIZE, playerPos.x - SPAWN_RADIUS),
+                                                   std::min<float>(MAP_WIDTH - TILE_SIZE * 2, playerPos.x + SPAWN_RADIUS));
+    std::uniform_real_distribution<float> yPosDist(std::max<float>(TILE_SIZE, playerPos.y - SPAWN_RADIUS),
+                                                   std::min<float>(MAP_HEIGHT - TILE_SIZE * 2, playerPos.y + SPAWN_RADIUS));
     std::uniform_int_distribution<int> itemTypeDist(0, 7);
     std::uniform_int_distribution<int> valueDist(1, 5);
 
-    ItemType type = static_cast<ItemType>(itemTypeDist(rng));
+    ItemType type = static_cast<ItemType>(itemTypeDist(spawnRng));
 
     if (timeOfDay == NIGHT) {
         std::uniform_int_distribution<int> nightTypeDist(0, 10);
-        int roll = nightTypeDist(rng);
+        int roll = nightTypeDist(spawnRng);
 
         if (roll < 3) {
-            type = static_cast<ItemType>(itemTypeDist(rng));
+            type = static_cast<ItemType>(itemTypeDist(spawnRng));
         } else if (roll < 6) {
             std::uniform_int_distribution<int> valuableTypeDist(0, 2);
-            int valuableType = valuableTypeDist(rng);
+            int valuableType = valuableTypeDist(spawnRng);
             if (valuableType == 0) type = WEAPON;
             else if (valuableType == 1) type = ARMOR;
             else type = AMMO;
         } else {
             std::uniform_int_distribution<int> veryValuableTypeDist(0, 2);
-            int veryValuableType = veryValuableTypeDist(rng);
+            int veryValuableType = veryValuableTypeDist(spawnRng);
             if (veryValuableType == 0) type = WEAPON;
             else if (veryValuableType == 1) type = ARMOR;
             else type = HEALTH;
         }
     }
 
-    int value = valueDist(rng);
+    int value = valueDist(spawnRng);
     if (timeOfDay == NIGHT) value = value * 2;
 
     std::string name;
@@ -353,8 +405,8 @@ void Game::spawnItem() {
     bool validPosition = false;
 
     while (!validPosition) {
-        pos.x = xPosDist(rng);
-        pos.y = yPosDist(rng);
+        pos.x = xPosDist(spawnRng);
+        pos.y = yPosDist(spawnRng);
 
         validPosition = true;
 
@@ -363,18 +415,23 @@ void Game::spawnItem() {
             continue;
         }
 
-        for (const auto& building : buildings) {
-            if (building->isInside(pos)) {
+        nearbyBuildings.clear();
+        buildingGrid.queryPoint(pos, nearbyBuildings);
+        for (Entity* building : nearbyBuildings) {
+            if (static_cast<Building*>(building)->isInside(pos)) {
                 validPosition = false;
                 break;
             }
         }
     }
 
-    items.push_back(std::make_unique<Item>(pos, itemTextures[type], type, value, name));
+    ItemHandle handle = itemPool.create(pos, itemSprites[type], type, value, name);
+    items.push_back(handle);
+    itemGrid.insert(itemPool.get(handle));
 }
 
 void Game::handleEvents() {
+    PROFILE_SCOPE("Game::handleEvents");
     SDL_Event event;
 
     while (SDL_PollEvent(&event)) {
@@ -384,7 +441,11 @@ void Game::handleEvents() {
                 break;
 
             case SDL_KEYDOWN:
-                handleKeyDown(event.key.keysym.sym);
+                pendingKeys.push_back(event.key.keysym.sym);
+                break;
+
+            case SDL_RENDER_TARGETS_RESET:
+                uiManager->invalidateHud();
                 break;
 
             default:
@@ -392,9 +453,28 @@ void Game::handleEvents() {
         }
     }
 
+    heldMovement = Player::movementFromKeys(SDL_GetKeyboardState(nullptr));
+}
+
+void Game::applyInput() {
+    currentInput.keys.clear();
+    if (input.isReplaying()) {
+        if (!input.next(currentInput)) {
+            currentInput.movement = 0;
+        }
+    } else {
+        currentInput.movement = heldMovement;
+        currentInput.keys.swap(pendingKeys);
+        if (input.isRecording()) {
+            input.record(currentInput);
+        }
+    }
+
+    for (SDL_Keycode key : currentInput.keys) {
+        handleKeyDown(key);
+    }
     if (gameState == GAMEPLAY) {
-        const Uint8* keystates = SDL_GetKeyboardState(nullptr);
-        player->handleInput(keystates);
+        player->handleInput(currentInput.movement);
     }
 }
 
@@ -447,11 +527,22 @@ void Game::handleGameplayKeys(SDL_Keycode key) {
         case SDLK_e:
             handleInteraction();
             break;
+        case SDLK_F3:
+            uiManager->toggleProfiler();
+            break;
+        case SDLK_F4:
+            if (Profiler::dumpToFile("profile.csv")) {
+                LOG_INFO(LOG_CAT_GAME, "Profiler history written to profile.csv");
+            }
+            break;
         case SDLK_h:
             if (player->getIsInside()) {
-                for (auto& building : buildings) {
+                nearbyBuildings.clear();
+                buildingGrid.queryPoint(player->getPosition(), nearbyBuildings);
+                for (Entity* entity : nearbyBuildings) {
+                    Building* building = static_cast<Building*>(entity);
                     if (building->isInside(player->getPosition())) {
-                        player->setHomeBase(building.get());
+                        player->setHomeBase(building);
                         building->setHomeBase(true);
                         break;
                     }
@@ -521,21 +612,25 @@ void Game::handleGameOverKeys(SDL_Keycode key) {
 void Game::handleInteraction() {
     bool enteredBuilding = false;
 
-    for (auto& building : buildings) {
+    nearbyBuildings.clear();
+    buildingGrid.queryPoint(player->getPosition(), nearbyBuildings);
+
+    for (Entity* entity : nearbyBuildings) {
+        Building* building = static_cast<Building*>(entity);
         if (building->isAtEntrance(player->getPosition())) {
             player->setIsInside(!player->getIsInside());
             enteredBuilding = true;
-            std::cout << "Player " << (player->getIsInside() ? "entered" : "exited")
-                      << " building at (" << building->getPosition().x
-                      << ", " << building->getPosition().y << ")" << std::endl;
+            LOG_DEBUG(LOG_CAT_PLAYER, "Player {} building at ({}, {})",
+                      player->getIsInside() ? "entered" : "exited",
+                      building->getPosition().x, building->getPosition().y);
             break;
         }
     }
 
     if (!enteredBuilding && player->getIsInside()) {
         bool stillInside = false;
-        for (auto& building : buildings) {
-            if (building->isInside(player->getPosition())) {
+        for (Entity* entity : nearbyBuildings) {
+            if (static_cast<Building*>(entity)->isInside(player->getPosition())) {
                 stillInside = true;
                 break;
             }
@@ -547,30 +642,46 @@ void Game::handleInteraction() {
     }
 
     if (!player->getIsInside()) {
-        for (auto it = items.begin(); it != items.end(); ) {
-            if ((*it)->checkCollision(*player)) {
-                bool added = player->getInventory().addItem(**it);
-                std::cout << "Item pickup attempted: " << (*it)->getName()
-                          << " - Success: " << (added ? "Yes" : "No") << std::endl;
+        nearbyEntities.clear();
+        itemGrid.query(player->getCollider(), nearbyEntities);
+
+        bool pickedUp = false;
+        for (Entity* entity : nearbyEntities) {
+            Item* item = static_cast<Item*>(entity);
+            if (item->checkCollision(*player)) {
+                bool added = player->getInventory().addItem(*item);
+                LOG_DEBUG(LOG_CAT_ITEM, "Item pickup attempted: {} - Success: {}",
+                          item->getName(), added ? "Yes" : "No");
                 if (added) {
-                    it = items.erase(it);
-                } else {
-                    ++it;
+                    item->setActive(false);
+                    pickedUp = true;
                 }
-            } else {
-                ++it;
             }
         }
+
+        if (pickedUp) {
+            items.erase(
+                std::remove_if(items.begin(), items.end(),
+                    [this](ItemHandle handle) {
+                        Item* item = itemPool.get(handle);
+                        if (item && item->isActive()) return false;
+                        itemPool.destroy(handle);
+                        return true;
+                    }),
+                items.end()
+            );
+        }
     } else {
-        for (auto& building : buildings) {
+        for (Entity* entity : nearbyBuildings) {
+            Building* building = static_cast<Building*>(entity);
             if (building->isInside(player->getPosition())) {
                 auto& buildingItems = building->getItems();
                 if (!buildingItems.empty()) {
-                    Item* item = buildingItems.front();
-                    bool added = player->getInventory().addItem(*item);
+                    Item* item = itemPool.get(buildingItems.front());
+                    bool added = !item || player->getInventory().addItem(*item);
                     if (added) {
+                        itemPool.destroy(buildingItems.front());
                         buildingItems.erase(buildingItems.begin());
-                        delete item;
                     }
                 }
                 break;
@@ -620,7 +731,7 @@ void Game::craftHealthPack() {
     if (inv.getItemCount(RESOURCE_FOOD) >= 5 && inv.getItemCount(RESOURCE_CLOTH) >= 2) {
         inv.useItem(RESOURCE_FOOD, 5);
         inv.useItem(RESOURCE_CLOTH, 2);
-        inv.addItem(Item(Vector2D(0, 0), itemTextures[HEALTH], HEALTH, 1, "Health Pack"));
+        inv.addItem(Item(Vector2D(0, 0), itemSprites[HEALTH], HEALTH, 1, "Health Pack"));
     }
 }
 
@@ -629,25 +740,26 @@ void Game::craftAmmo() {
     if (inv.getItemCount(RESOURCE_METAL) >= 3 && inv.getItemCount(RESOURCE_WOOD) >= 2) {
         inv.useItem(RESOURCE_METAL, 3);
         inv.useItem(RESOURCE_WOOD, 2);
-        inv.addItem(Item(Vector2D(0, 0), itemTextures[AMMO], AMMO, 10, "Ammo"));
+        inv.addItem(Item(Vector2D(0, 0), itemSprites[AMMO], AMMO, 10, "Ammo"));
     }
 }
 
 void Game::update() {
-    Uint32 currentTime = SDL_GetTicks();
+    PROFILE_SCOPE("Game::update");
+    applyInput();
+    ++simTick;
+    Uint32 currentTime = getSimTime();
     Uint32 deltaTime = currentTime - lastFrameTime;
 
-    std::cout << "Game update - Time: " << gameTime
-              << "ms, Delta: " << deltaTime << "ms" << std::endl;
+    LOG_TRACE(LOG_CAT_GAME, "Game update - Time: {}ms, Delta: {}ms", gameTime, deltaTime);
 
     lastFrameTime = currentTime;
 
     if (gameState != GAMEPLAY) {
-        printf("gamestate=%d, gameplay=%d\n", gameState, GAMEPLAY);
+        LOG_TRACE(LOG_CAT_GAME, "gamestate={}, gameplay={}", gameState, GAMEPLAY);
         return;
     }
 
-    printf("about to run gametime += deltatime");
     gameTime += deltaTime;
 
     if (currentTime - lastTimeUpdate > 1000) {
@@ -656,14 +768,16 @@ void Game::update() {
 
         if (newTimeOfDay != timeOfDay) {
             timeOfDay = newTimeOfDay;
+            uiManager->invalidateHud();
 
             if (timeOfDay == NIGHT) {
-                int nightSpawnCount = 10 + rand() % 10;
+                std::mt19937& spawnRng = random.get(RNG_SPAWN);
+                int nightSpawnCount = std::uniform_int_distribution<int>(10, 19)(spawnRng);
                 for (int i = 0; i < nightSpawnCount; ++i) {
                     spawnZombie();
                 }
 
-                int nightItemCount = 5 + rand() % 5;
+                int nightItemCount = std::uniform_int_distribution<int>(5, 9)(spawnRng);
                 for (int i = 0; i < nightItemCount; ++i) {
                     spawnItem();
                 }
@@ -673,20 +787,27 @@ void Game::update() {
         lastTimeUpdate = currentTime;
     }
 
-    printf("before player update");
+    player->savePreviousState();
+    zombies.savePreviousState();
     player->update();
-    printf("After player update");
+
+    Rectangle view = getStreamView();
+    populateChunksAround(view);
+    tileMap->stream(view);
 
     bool inBuilding = false;
 
-    for (auto& building : buildings) {
+    nearbyBuildings.clear();
+    buildingGrid.query(player->getCollider(), nearbyBuildings);
+
+    for (Entity* building : nearbyBuildings) {
         if (player->getIsInside()) {
-            if (building->isInside(player->getPosition())) {
+            if (static_cast<Building*>(building)->isInside(player->getPosition())) {
                 inBuilding = true;
             }
         } else {
             if (player->checkCollision(*building)) {
-                Vector2D pushDirection = (player->getPosition() - building->getPosition()).normalize();
+                Vector2D pushDirection = engine::normalize(player->getPosition() - building->getPosition());
                 player->setPosition(player->getPosition() + pushDirection * 5.0f);
             }
         }
@@ -696,47 +817,61 @@ void Game::update() {
         player->setIsInside(false);
     }
 
-    for (auto& zombie : zombies) {
-        if (zombie->isActive()) {
-            bool zombieInBuilding = false;
-            for (auto& building : buildings) {
-                if (building->isInside(zombie->getPosition())) {
-                    zombieInBuilding = true;
-                    break;
-                }
+    for (size_t i = 0; i < zombies.size(); ++i) {
+        if (!zombies.isActive(i)) continue;
+
+        Vector2D zombiePos = zombies.getPosition(i);
+        bool zombieInBuilding = false;
+        nearbyBuildings.clear();
+        buildingGrid.queryPoint(zombiePos, nearbyBuildings);
+        for (Entity* building : nearbyBuildings) {
+            if (static_cast<Building*>(building)->isInside(zombiePos)) {
+                zombieInBuilding = true;
+                break;
             }
+        }
+        zombies.setFrozen(i, zombieInBuilding);
+    }
 
-            if (!zombieInBuilding) {
-                zombie->update(*player);
+    Rectangle playerRect = player->getCollider();
+    flowField.update(Vector2D(playerRect.x + playerRect.w / 2, playerRect.y + playerRect.h / 2),
+                     FLOW_FIELD_CELLS_PER_STEP);
+    zombies.updateAll(*player, currentTime, &flowField, jobs.get());
+    if (!invulnerablePlayer) {
+        for (int damage : zombies.getAttacks()) {
+            player->takeDamage(damage);
+        }
+    }
 
-                for (auto& building : buildings) {
-                    if (zombie->checkCollision(*building)) {
-                        Vector2D pushDirection = (zombie->getPosition() - building->getPosition()).normalize();
-                        zombie->setPosition(zombie->getPosition() + pushDirection * 3.0f);
-                    }
-                }
+    for (size_t i = 0; i < zombies.size(); ++i) {
+        if (zombies.getState(i) != ZOMBIE_ACTIVE) continue;
+
+        Rectangle zombieRect = zombies.getCollider(i);
+        nearbyBuildings.clear();
+        buildingGrid.query(zombieRect, nearbyBuildings);
+        for (Entity* building : nearbyBuildings) {
+            if (zombieRect.intersects(building->getCollider())) {
+                Vector2D pushDirection = engine::normalize(zombies.getPosition(i) - building->getPosition());
+                zombies.setPosition(i, zombies.getPosition(i) + pushDirection * 3.0f);
+                zombieRect = zombies.getCollider(i);
             }
         }
     }
 
-    for (auto& zombie : zombies) {
-        if (zombie->isActive() && !player->getIsInside()) {
-            if (zombie->checkCollision(*player)) {
-                if (player->getInventory().getItemCount(AMMO) > 0) {
-                    zombie->takeDamage(player->getWeaponPower() * 2);
-                    player->getInventory().useItem(AMMO, 1);
-                } else {
-                    zombie->takeDamage(player->getWeaponPower());
-                }
+    if (!player->getIsInside()) {
+        nearbyZombies.clear();
+        zombies.collectOverlapping(player->getCollider(), nearbyZombies);
+        for (int index : nearbyZombies) {
+            if (player->getInventory().getItemCount(AMMO) > 0) {
+                zombies.takeDamage(index, player->getWeaponPower() * 2);
+                player->getInventory().useItem(AMMO, 1);
+            } else {
+                zombies.takeDamage(index, player->getWeaponPower());
             }
         }
     }
 
-    zombies.erase(
-        std::remove_if(zombies.begin(), zombies.end(),
-            [](const std::unique_ptr<Zombie>& z) { return !z->isActive(); }),
-        zombies.end()
-    );
+    zombies.removeDead();
 
     if (currentTime - lastZombieSpawn > zombieSpawnInterval) {
         int spawnCount = (timeOfDay == DAY) ? 1 : 3;
@@ -746,7 +881,7 @@ void Game::update() {
         lastZombieSpawn = currentTime;
     }
 
-    if (rand() % 100 < 1) {
+    if (std::uniform_int_distribution<int>(0, 99)(random.get(RNG_SPAWN)) < 1) {
         spawnItem();
     }
 
@@ -757,13 +892,12 @@ void Game::update() {
 
     if (player->getHealth() <= 0) {
         gameState = GAME_OVER;
-        std::cout << "Game Over - Player health depleted" << std::endl;
+        LOG_INFO(LOG_CAT_GAME, "Game Over - Player health depleted");
     }
-
-    camera.update(player->getPosition());
 }
 
-void Game::render() {
+void Game::render(float alpha) {
+    PROFILE_SCOPE("Game::render");
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
 
@@ -773,14 +907,40 @@ void Game::render() {
         return;
     }
 
-    SDL_Rect viewport = camera.getViewport();
+    camera.update(player->getInterpolatedPosition(alpha));
     tileMap->render(renderer, camera);
 
-    for (auto& building : buildings) {
-        if (camera.isVisible(building->getCollider())) {
-            building->render(renderer, camera);
+    {
+        PROFILE_SCOPE("Entities");
+        SDL_Rect viewport = camera.getViewport();
+        nearbyBuildings.clear();
+        buildingGrid.query(Rectangle(viewport.x, viewport.y, viewport.w, viewport.h), nearbyBuildings);
+        for (Entity* building : nearbyBuildings) {
+            if (camera.isVisible(building->getCollider())) {
+                building->render(*spriteBatch, camera, LAYER_BUILDINGS);
+            }
+        }
+
+        for (ItemHandle handle : items) {
+            Item* item = itemPool.get(handle);
+            if (item && camera.isVisible(item->getCollider())) {
+                item->render(*spriteBatch, camera, LAYER_ITEMS);
+            }
+        }
 
-            if (building->isHomeBase()) {
+        zombies.render(*spriteBatch, camera, zombieSprites, alpha);
+
+        if (!player->getIsInside()) {
+            player->render(*spriteBatch, camera, LAYER_PLAYER, alpha);
+        }
+
+        spriteBatch->flush();
+
+        // Outlines sit just outside the building, so drawing them after the
+        // whole batch only differs where a sprite overlaps the border.
+        for (Entity* entity : nearbyBuildings) {
+            Building* building = static_cast<Building*>(entity);
+            if (building->isHomeBase() && camera.isVisible(building->getCollider())) {
                 Vector2D screenPos = camera.worldToScreen(building->getPosition());
                 SDL_Rect outlineRect = {
                     static_cast<int>(screenPos.x) - 2,
@@ -795,33 +955,60 @@ void Game::render() {
         }
     }
 
-    for (auto& item : items) {
-        if (camera.isVisible(item->getCollider())) {
-            item->render(renderer, camera);
-        }
-    }
+    renderLighting(alpha);
+    uiManager->render();
 
-    for (auto& zombie : zombies) {
-        if (zombie->isActive() && camera.isVisible(zombie->getCollider())) {
-            zombie->render(renderer, camera);
-        }
+    PROFILE_SCOPE("SDL_RenderPresent");
+    SDL_RenderPresent(renderer);
+}
+
+// Queues the player's lights first so they survive the MAX_LIGHTS cap, then
+// a window glow for each building on screen (nearbyBuildings still holds the
+// visible ones from the entity pass).
+void Game::renderLighting(float alpha) {
+    SDL_Color ambient = LightMap::ambientFor(gameTime % DAY_NIGHT_CYCLE_DURATION);
+    if (LightMap::isDaylight(ambient)) {
+        lightMap->render(ambient);
+        return;
     }
 
+    Vector2D playerCentre = camera.worldToScreen(player->getInterpolatedPosition(alpha)) +
+                            Vector2D(player->getCollider().w / 2, player->getCollider().h / 2);
+    const SDL_Color flashlight = { 255, 245, 220, 255 };
+    float dirX = 0.0f, dirY = 0.0f;
+    switch (player->getFacing()) {
+        case UP: dirY = -1.0f; break;
+        case DOWN: dirY = 1.0f; break;
+        case LEFT: dirX = -1.0f; break;
+        default: dirX = 1.0f; break;
+    }
     if (!player->getIsInside()) {
-        player->render(renderer, camera);
+        lightMap->addCone(playerCentre.x, playerCentre.y, 480.0f, dirX, dirY, flashlight);
+    }
+    lightMap->addGlow(playerCentre.x, playerCentre.y, 96.0f, flashlight);
+
+    const SDL_Color window = { 255, 190, 110, 255 };
+    const SDL_Color home = { 200, 255, 170, 255 };
+    for (Entity* entity : nearbyBuildings) {
+        Building* building = static_cast<Building*>(entity);
+        Rectangle rect = building->getCollider();
+        if (!camera.isVisible(rect)) continue;
+
+        Vector2D centre = camera.worldToScreen(Vector2D(rect.x + rect.w / 2, rect.y + rect.h / 2));
+        lightMap->addGlow(centre.x, centre.y, std::max(rect.w, rect.h) * 0.8f,
+                          building->isHomeBase() ? home : window);
     }
 
-    // uiManager->render();
-    SDL_RenderPresent(renderer);
+    lightMap->render(ambient);
 }
 
 void Game::clean() {
-    if (playerTexture) SDL_DestroyTexture(playerTexture);
-    for (int i = 0; i < 4; ++i) if (zombieTextures[i]) SDL_DestroyTexture(zombieTextures[i]);
-    for (int i = 0; i < 3; ++i) if (buildingTextures[i]) SDL_DestroyTexture(buildingTextures[i]);
-    for (int i = 0; i < 8; ++i) if (itemTextures[i]) SDL_DestroyTexture(itemTextures[i]);
-    if (tilesetTexture) SDL_DestroyTexture(tilesetTexture);
-    for (int i = 0; i < 2; ++i) if (uiTextures[i]) SDL_DestroyTexture(uiTextures[i]);
+    // Everything holding renderer textures goes before the renderer itself
+    atlas.clear();
+    uiManager.reset();
+    tileMap.reset();
+    spriteBatch.reset();
+    lightMap.reset();
     if (font) TTF_CloseFont(font);
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
@@ -835,9 +1022,63 @@ bool Game::isRunning() const {
     return running;
 }
 
-void Game::capFrameRate(Uint32 frameStart) {
-    Uint32 frameTime = SDL_GetTicks() - frameStart;
-    if (frameTime < FRAME_DELAY) {
-        SDL_Delay(FRAME_DELAY - frameTime);
+Uint32 Game::getSimTime() const {
+    return static_cast<Uint32>(simTick * 1000 / SIM_RATE);
+}
+
+size_t Game::getZombieCount() const {
+    return zombies.size();
+}
+
+size_t Game::getItemCount() const {
+    return items.size();
+}
+
+int Game::getThreadCount() const {
+    return jobs ? jobs->getThreadCount() : 1;
+}
+
+Uint64 Game::getStateChecksum() const {
+    Uint64 hash = zombies.checksum();
+    Vector2D playerPos = player->getPosition();
+    Uint64 words[3] = { 0, static_cast<Uint64>(player->getHealth()), items.size() };
+    std::memcpy(&words[0], &playerPos.x, sizeof(float));
+    std::memcpy(reinterpret_cast<char*>(&words[0]) + sizeof(float), &playerPos.y, sizeof(float));
+    for (Uint64 word : words) {
+        hash = (hash ^ word) * 1099511628211ull;
     }
+    return hash;
+}
+
+bool Game::startRecording(const std::string& path) {
+    return input.startRecording(path, random.getSeed(), setupZombieCount, setupItemCount);
+}
+
+bool Game::stopRecording() {
+    return input.stopRecording();
+}
+
+bool Game::startReplay(const std::string& path) {
+    if (!input.load(path)) {
+        return false;
+    }
+    const RecordingHeader& header = input.getHeader();
+    random.reseed(header.seed);
+    simTick = 0;
+    gameTime = 0;
+    lastFrameTime = 0;
+    lastTimeUpdate = 0;
+    lastZombieSpawn = 0;
+    timeOfDay = DAY;
+    invulnerablePlayer = false;
+    gameState = GAMEPLAY;
+    pendingKeys.clear();
+    heldMovement = 0;
+    setupGame(header.zombies, header.items);
+    LOG_INFO(LOG_CAT_GAME, "Replaying {} ({} steps, seed {})", path, header.ticks, header.seed);
+    return true;
+}
+
+Uint32 Game::getReplayTicks() const {
+    return input.isReplaying() ? input.getHeader().ticks : 0;
 }
@@ -0,0 +1,128 @@
+#include "InputRecorder.h"
+#include "../../common/include/log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    const char RECORDING_MAGIC[4] = { 'Z', 'R', 'E', 'C' };
+    const Uint32 RECORDING_VERSION = 1;
+    const size_t MAX_KEYS_PER_FRAME = 255;
+}
+
+InputRecorder::InputRecorder() : mode(IDLE), readPos(0) {
+    std::memset(&header, 0, sizeof(header));
+}
+
+bool InputRecorder::startRecording(const std::string& file, Uint32 seed, int zombies, int items) {
+    if (mode != IDLE) return false;
+
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    header.version = RECORDING_VERSION;
+    header.seed = seed;
+    header.zombies = zombies;
+    header.items = items;
+    header.ticks = 0;
+    path = file;
+    frames.clear();
+    mode = RECORDING;
+    LOG_INFO(LOG_CAT_GAME, "Recording input to {} - seed {}", path.c_str(), seed);
+    return true;
+}
+
+void InputRecorder::record(const InputFrame& frame) {
+    if (mode != RECORDING) return;
+
+    size_t keyCount = std::min(frame.keys.size(), MAX_KEYS_PER_FRAME);
+    frames.push_back(frame.movement);
+    frames.push_back(static_cast<Uint8>(keyCount));
+    for (size_t i = 0; i < keyCount; ++i) {
+        Sint32 key = frame.keys[i];
+        const Uint8* bytes = reinterpret_cast<const Uint8*>(&key);
+        frames.insert(frames.end(), bytes, bytes + sizeof(key));
+    }
+    ++header.ticks;
+}
+
+bool InputRecorder::stopRecording() {
+    if (mode != RECORDING) return false;
+    mode = IDLE;
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   (frames.empty() || std::fwrite(frames.data(), frames.size(), 1, file) == 1);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "Writing input recording " << path << " failed" << std::endl;
+        return false;
+    }
+    LOG_INFO(LOG_CAT_GAME, "Input recording saved - {} ticks", header.ticks);
+    return true;
+}
+
+bool InputRecorder::load(const std::string& file) {
+    FILE* input = std::fopen(file.c_str(), "rb");
+    if (!input) {
+        std::cerr << "Could not open input recording " << file << std::endl;
+        return false;
+    }
+
+    bool valid = std::fread(&header, sizeof(header), 1, input) == 1 &&
+                 std::memcmp(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) == 0 &&
+                 header.version == RECORDING_VERSION;
+    frames.clear();
+    if (valid) {
+        Uint8 buffer[4096];
+        size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), input)) > 0) {
+            frames.insert(frames.end(), buffer, buffer + count);
+        }
+    }
+    std::fclose(input);
+
+    if (!valid) {
+        std::cerr << "Input recording " << file << " is damaged or from another version" << std::endl;
+        return false;
+    }
+    path = file;
+    readPos = 0;
+    mode = REPLAYING;
+    return true;
+}
+
+bool InputRecorder::next(InputFrame& frame) {
+    frame.movement = 0;
+    frame.keys.clear();
+    if (mode != REPLAYING || readPos + 2 > frames.size()) return false;
+
+    frame.movement = frames[readPos];
+    size_t keyCount = frames[readPos + 1];
+    readPos += 2;
+    if (readPos + keyCount * sizeof(Sint32) > frames.size()) {
+        readPos = frames.size();
+        return false;
+    }
+    for (size_t i = 0; i < keyCount; ++i) {
+        Sint32 key;
+        std::memcpy(&key, &frames[readPos], sizeof(key));
+        frame.keys.push_back(key);
+        readPos += sizeof(key);
+    }
+    return true;
+}
+
+bool InputRecorder::isRecording() const {
+    return mode == RECORDING;
+}
+
+bool InputRecorder::isReplaying() const {
+    return mode == REPLAYING;
+}
+
+const RecordingHeader& InputRecorder::getHeader() const {
+    return header;
+}
@@ -0,0 +1,143 @@
+#include "JobSystem.h"
+
+namespace {
+    // Queue index of the current thread: 0 for the thread that owns the
+    // JobSystem, 1..N for its workers.
+    thread_local int threadQueue = 0;
+}
+
+void JobSystem::Queue::pushBack(const Job& job) {
+    if (tail - head == ring.size()) {
+        std::vector<Job> grown(ring.empty() ? 64 : ring.size() * 2);
+        for (size_t i = head; i != tail; ++i) {
+            grown[i - head] = ring[i % ring.size()];
+        }
+        tail -= head;
+        head = 0;
+        ring.swap(grown);
+    }
+    ring[tail++ % ring.size()] = job;
+}
+
+Job JobSystem::Queue::popBack() {
+    return ring[--tail % ring.size()];
+}
+
+Job JobSystem::Queue::popFront() {
+    return ring[head++ % ring.size()];
+}
+
+JobSystem::JobSystem(int threadCount) : queuedJobs(0), stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) threadCount = 1;
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int JobSystem::getThreadCount() const {
+    return static_cast<int>(queues.size());
+}
+
+int JobSystem::currentQueue() const {
+    return threadQueue < static_cast<int>(queues.size()) ? threadQueue : 0;
+}
+
+void JobSystem::submit(const Job& job) {
+    if (workers.empty()) {
+        Job inlineJob = job;
+        execute(inlineJob);
+        return;
+    }
+
+    Queue& queue = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.pushBack(job);
+    }
+    {
+        // Taking the sleep lock orders this against a worker that has just
+        // checked for work and is about to block.
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedJobs.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+bool JobSystem::popOrSteal(int self, Job& job) {
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.empty()) {
+            job = own.popBack();
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    const int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Queue& victim = *queues[(self + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.empty()) {
+            job = victim.popFront();
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Job& job) {
+    job.fn(job.context, job.begin, job.end);
+    if (job.counter) {
+        job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    const int self = currentQueue();
+    Job job;
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        if (popOrSteal(self, job)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(int index) {
+    threadQueue = index;
+    Job job;
+
+    while (true) {
+        if (popOrSteal(index, job)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() {
+            return stopping.load() || queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping.load()) return;
+    }
+}
@@ -0,0 +1,231 @@
+#include "LightMap.h"
+#include "../../common/include/log.h"
+#include "MemoryStats.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // The light texture holds two cells side by side: a round glow and a
+    // cone opening towards +x from the middle of its left edge.
+    const int LIGHT_SPRITE_SIZE = 128;
+    const float CONE_HALF_ANGLE = 0.5f; // radians
+    const double RADIANS_TO_DEGREES = 57.29577951308232;
+
+    const SDL_Color DAY_AMBIENT = { 255, 255, 255, 255 };
+    const SDL_Color NIGHT_AMBIENT = { 40, 45, 80, 255 };
+
+    Uint8 lerp(Uint8 a, Uint8 b, float t) {
+        return static_cast<Uint8>(a + (b - a) * t);
+    }
+}
+
+LightMap::LightMap(SDL_Renderer* renderer, int screenWidth, int screenHeight) :
+    renderer(renderer), target(nullptr), lightTexture(nullptr),
+    width(screenWidth / LIGHT_MAP_SCALE), height(screenHeight / LIGHT_MAP_SCALE), drawCalls(0) {
+    lights.reserve(MAX_LIGHTS);
+    vertices.reserve(MAX_LIGHTS * 4);
+    indices.reserve(MAX_LIGHTS * 6);
+
+    target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!target) {
+        std::cerr << "Light map creation failed: " << SDL_GetError() << std::endl;
+        return;
+    }
+    MemoryStats::textureCreated(MEM_LIGHT_TEXTURES, target);
+    SDL_SetTextureBlendMode(target, SDL_BLENDMODE_MOD);
+    // Stretching the small target up is what softens the light edges.
+    SDL_SetTextureScaleMode(target, SDL_ScaleModeLinear);
+
+    if (!createLightTexture()) {
+        std::cerr << "Light sprite creation failed: " << SDL_GetError() << std::endl;
+    }
+}
+
+LightMap::~LightMap() {
+    MemoryStats::textureDestroyed(MEM_LIGHT_TEXTURES, target);
+    MemoryStats::textureDestroyed(MEM_LIGHT_TEXTURES, lightTexture);
+    if (target) SDL_DestroyTexture(target);
+    if (lightTexture) SDL_DestroyTexture(lightTexture);
+}
+
+bool LightMap::createLightTexture() {
+    const int textureWidth = LIGHT_SPRITE_SIZE * 2;
+    std::vector<Uint8> pixels(textureWidth * LIGHT_SPRITE_SIZE * 4, 255);
+    const float half = LIGHT_SPRITE_SIZE * 0.5f;
+
+    for (int y = 0; y < LIGHT_SPRITE_SIZE; ++y) {
+        for (int x = 0; x < LIGHT_SPRITE_SIZE; ++x) {
+            float dx = (x + 0.5f - half) / half;
+            float dy = (y + 0.5f - half) / half;
+            float glow = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+            pixels[(y * textureWidth + x) * 4 + 3] = static_cast<Uint8>(glow * glow * 255.0f);
+
+            float along = (x + 0.5f) / LIGHT_SPRITE_SIZE;
+            float across = (y + 0.5f - half) / LIGHT_SPRITE_SIZE;
+            float angle = std::atan2(std::fabs(across), along);
+            float edge = std::min(1.0f, std::max(0.0f, (CONE_HALF_ANGLE - angle) / (CONE_HALF_ANGLE * 0.5f)));
+            float cone = std::max(0.0f, 1.0f - along) * edge;
+            pixels[(y * textureWidth + LIGHT_SPRITE_SIZE + x) * 4 + 3] = static_cast<Uint8>(cone * 255.0f);
+        }
+    }
+
+    lightTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                     textureWidth, LIGHT_SPRITE_SIZE);
+    if (!lightTexture) return false;
+    MemoryStats::textureCreated(MEM_LIGHT_TEXTURES, lightTexture);
+    SDL_UpdateTexture(lightTexture, nullptr, pixels.data(), textureWidth * 4);
+    SDL_SetTextureBlendMode(lightTexture, SDL_BLENDMODE_ADD);
+    return true;
+}
+
+SDL_Color LightMap::ambientFor(Uint32 cycleTime) {
+    const Uint32 dusk = static_cast<Uint32>(DAY_NIGHT_CYCLE_DURATION * DAY_RATIO);
+    const Uint32 dawn = DAY_NIGHT_CYCLE_DURATION - TWILIGHT_DURATION;
+
+    float night;
+    if (cycleTime < dusk - TWILIGHT_DURATION) {
+        night = 0.0f;
+    } else if (cycleTime < dusk) {
+        night = static_cast<float>(cycleTime - (dusk - TWILIGHT_DURATION)) / TWILIGHT_DURATION;
+    } else if (cycleTime < dawn) {
+        night = 1.0f;
+    } else {
+        night = 1.0f - static_cast<float>(cycleTime - dawn) / TWILIGHT_DURATION;
+    }
+
+    SDL_Color ambient = {
+        lerp(DAY_AMBIENT.r, NIGHT_AMBIENT.r, night),
+        lerp(DAY_AMBIENT.g, NIGHT_AMBIENT.g, night),
+        lerp(DAY_AMBIENT.b, NIGHT_AMBIENT.b, night),
+        255
+    };
+    return ambient;
+}
+
+bool LightMap::isDaylight(const SDL_Color& ambient) {
+    return ambient.r == 255 && ambient.g == 255 && ambient.b == 255;
+}
+
+void LightMap::addGlow(float x, float y, float radius, SDL_Color color) {
+    if (lights.size() >= static_cast<size_t>(MAX_LIGHTS)) return;
+    lights.push_back({ x, y, radius, 0.0f, 0.0f, false, color });
+}
+
+void LightMap::addCone(float x, float y, float length, float dirX, float dirY, SDL_Color color) {
+    if (lights.size() >= static_cast<size_t>(MAX_LIGHTS)) return;
+    lights.push_back({ x, y, length, dirX, dirY, true, color });
+}
+
+void LightMap::addQuad(const Light& light) {
+    const float scale = 1.0f / LIGHT_MAP_SCALE;
+    float x = light.x * scale;
+    float y = light.y * scale;
+    float size = light.size * scale;
+
+    // Corners as (along, across) offsets from the light origin, with the
+    // matching u range in the light texture.
+    float corners[4][2];
+    float u0, u1;
+    float axisX = 1.0f, axisY = 0.0f;
+    if (light.cone) {
+        const float c[4][2] = { { 0.0f, -0.5f }, { 1.0f, -0.5f }, { 1.0f, 0.5f }, { 0.0f, 0.5f } };
+        std::copy(&c[0][0], &c[0][0] + 8, &corners[0][0]);
+        u0 = 0.5f;
+        u1 = 1.0f;
+        axisX = light.dirX;
+        axisY = light.dirY;
+    } else {
+        const float c[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+        std::copy(&c[0][0], &c[0][0] + 8, &corners[0][0]);
+        u0 = 0.0f;
+        u1 = 0.5f;
+    }
+    const float us[4] = { u0, u1, u1, u0 };
+    const float vs[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    int base = static_cast<int>(vertices.size());
+    for (int i = 0; i < 4; ++i) {
+        float along = corners[i][0] * size;
+        float across = corners[i][1] * size;
+        SDL_Vertex vertex;
+        vertex.position.x = x + axisX * along - axisY * across;
+        vertex.position.y = y + axisY * along + axisX * across;
+        vertex.color = light.color;
+        vertex.tex_coord.x = us[i];
+        vertex.tex_coord.y = vs[i];
+        vertices.push_back(vertex);
+    }
+
+    indices.push_back(base);
+    indices.push_back(base + 1);
+    indices.push_back(base + 2);
+    indices.push_back(base);
+    indices.push_back(base + 2);
+    indices.push_back(base + 3);
+}
+
+// Renderer without geometry support: one copy per light, cones rotated
+// about their origin.
+void LightMap::drawFallback() {
+    const float scale = 1.0f / LIGHT_MAP_SCALE;
+    for (const Light& light : lights) {
+        SDL_SetTextureColorMod(lightTexture, light.color.r, light.color.g, light.color.b);
+        int size = static_cast<int>(light.size * scale);
+        int x = static_cast<int>(light.x * scale);
+        int y = static_cast<int>(light.y * scale);
+
+        if (light.cone) {
+            SDL_Rect src = { LIGHT_SPRITE_SIZE, 0, LIGHT_SPRITE_SIZE, LIGHT_SPRITE_SIZE };
+            SDL_Rect dst = { x, y - size / 2, size, size };
+            SDL_Point pivot = { 0, size / 2 };
+            double angle = std::atan2(light.dirY, light.dirX) * RADIANS_TO_DEGREES;
+            SDL_RenderCopyEx(renderer, lightTexture, &src, &dst, angle, &pivot, SDL_FLIP_NONE);
+        } else {
+            SDL_Rect src = { 0, 0, LIGHT_SPRITE_SIZE, LIGHT_SPRITE_SIZE };
+            SDL_Rect dst = { x - size, y - size, size * 2, size * 2 };
+            SDL_RenderCopy(renderer, lightTexture, &src, &dst);
+        }
+    }
+    SDL_SetTextureColorMod(lightTexture, 255, 255, 255);
+}
+
+void LightMap::render(const SDL_Color& ambient) {
+    PROFILE_SCOPE("LightMap::render");
+    drawCalls = 0;
+    if (!target || !lightTexture || isDaylight(ambient)) {
+        lights.clear();
+        return;
+    }
+
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, target);
+    SDL_SetRenderDrawColor(renderer, ambient.r, ambient.g, ambient.b, 255);
+    SDL_RenderClear(renderer);
+    ++drawCalls;
+
+    if (!lights.empty()) {
+        vertices.clear();
+        indices.clear();
+        for (const Light& light : lights) {
+            addQuad(light);
+        }
+
+        ++drawCalls;
+        if (SDL_RenderGeometry(renderer, lightTexture, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size())) != 0) {
+            drawFallback();
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    SDL_RenderCopy(renderer, target, nullptr, nullptr);
+    ++drawCalls;
+
+    LOG_TRACE(LOG_CAT_RENDER, "Light map composited {} lights in {} draw calls", lights.size(), drawCalls);
+    lights.clear();
+}
+
+int LightMap::getDrawCalls() const {
+    return drawCalls;
+}
@@ -0,0 +1,88 @@
+#include "MemoryStats.h"
+#include <atomic>
+
+namespace {
+    struct Counters {
+        std::atomic<size_t> liveBytes{0};
+        std::atomic<size_t> peakBytes{0};
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> frameAllocations{0};
+        size_t frameStart = 0; // allocations at the last endFrame()
+    };
+
+    Counters counters[MEM_CATEGORY_COUNT];
+
+    const char* const CATEGORY_NAMES[MEM_CATEGORY_COUNT] = {
+        "entities",
+        "building_items",
+        "tilemap",
+        "chunk_textures",
+        "asset_textures",
+        "ui_textures",
+        "light_textures"
+    };
+
+    bool isVram(MemoryCategory category) {
+        return category >= MEM_CHUNK_TEXTURES;
+    }
+}
+
+namespace MemoryStats {
+    void allocated(MemoryCategory category, size_t bytes) {
+        Counters& c = counters[category];
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t live = c.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = c.peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    void freed(MemoryCategory category, size_t bytes) {
+        counters[category].liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t textureBytes(SDL_Texture* texture) {
+        if (!texture) return 0;
+        Uint32 format = 0;
+        int width = 0, height = 0;
+        if (SDL_QueryTexture(texture, &format, nullptr, &width, &height) != 0) return 0;
+        int bytesPerPixel = SDL_BYTESPERPIXEL(format);
+        if (bytesPerPixel == 0) bytesPerPixel = 4;
+        return static_cast<size_t>(width) * height * bytesPerPixel;
+    }
+
+    void textureCreated(MemoryCategory category, SDL_Texture* texture) {
+        if (texture) allocated(category, textureBytes(texture));
+    }
+
+    void textureDestroyed(MemoryCategory category, SDL_Texture* texture) {
+        if (texture) freed(category, textureBytes(texture));
+    }
+
+    void endFrame() {
+        for (Counters& c : counters) {
+            size_t total = c.allocations.load(std::memory_order_relaxed);
+            c.frameAllocations.store(total - c.frameStart, std::memory_order_relaxed);
+            c.frameStart = total;
+        }
+    }
+
+    CategoryStats get(MemoryCategory category) {
+        const Counters& c = counters[category];
+        CategoryStats stats;
+        stats.name = CATEGORY_NAMES[category];
+        stats.vram = isVram(category);
+        stats.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+        stats.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+        stats.allocations = c.allocations.load(std::memory_order_relaxed);
+        stats.frameAllocations = c.frameAllocations.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void collect(std::vector<CategoryStats>& out) {
+        out.clear();
+        for (int i = 0; i < MEM_CATEGORY_COUNT; ++i) {
+            out.push_back(get(static_cast<MemoryCategory>(i)));
+        }
+    }
+}
@@ -1,13 +1,15 @@
 #include "Player.h"
+#include "../../common/include/log.h"
 
-Player::Player(Vector2D pos, SDL_Texture* tex) :
-    Entity(pos, tex, TILE_SIZE, TILE_SIZE),
+Player::Player(Vector2D pos, const AtlasRegion& sprite) :
+    Entity(pos, sprite, TILE_SIZE, TILE_SIZE),
     health(100), maxHealth(100), armor(0), weaponPower(10),
-    facing(DOWN), homeBase(nullptr), isInside(false) {}
+    facing(DOWN), homeBase(nullptr), isInside(false) {
+    inventory.setChangeListener([this]() { notifyChanged(); });
+}
 
 void Player::update() {
-    std::cout << "Player position before update: ("
-              << position.x << ", " << position.y << ")" << std::endl;
+    LOG_TRACE(LOG_CAT_PLAYER, "Player position before update: ({}, {})", position.x, position.y);
 
     Entity::update();
 
@@ -16,33 +18,41 @@ void Player::update() {
     if (position.x > MAP_WIDTH - collider.w) position.x = MAP_WIDTH - collider.w;
     if (position.y > MAP_HEIGHT - collider.h) position.y = MAP_HEIGHT - collider.h;
 
-    std::cout << "Player position after update: ("
-              << position.x << ", " << position.y << "), Health: "
-              << health << "/" << maxHealth << std::endl;
+    LOG_TRACE(LOG_CAT_PLAYER, "Player position after update: ({}, {}), Health: {}/{}",
+              position.x, position.y, health, maxHealth);
+}
+
+Uint8 Player::movementFromKeys(const Uint8* keystates) {
+    Uint8 movement = 0;
+    if (keystates[SDL_SCANCODE_W]) movement |= MOVE_UP;
+    if (keystates[SDL_SCANCODE_S]) movement |= MOVE_DOWN;
+    if (keystates[SDL_SCANCODE_A]) movement |= MOVE_LEFT;
+    if (keystates[SDL_SCANCODE_D]) movement |= MOVE_RIGHT;
+    return movement;
 }
 
-void Player::handleInput(const Uint8* keystates) {
+void Player::handleInput(Uint8 movement) {
     velocity = Vector2D(0, 0);
 
-    if (keystates[SDL_SCANCODE_W]) {
+    if (movement & MOVE_UP) {
         velocity.y = -PLAYER_SPEED;
         facing = UP;
     }
-    if (keystates[SDL_SCANCODE_S]) {
+    if (movement & MOVE_DOWN) {
         velocity.y = PLAYER_SPEED;
         facing = DOWN;
     }
-    if (keystates[SDL_SCANCODE_A]) {
+    if (movement & MOVE_LEFT) {
         velocity.x = -PLAYER_SPEED;
         facing = LEFT;
     }
-    if (keystates[SDL_SCANCODE_D]) {
+    if (movement & MOVE_RIGHT) {
         velocity.x = PLAYER_SPEED;
         facing = RIGHT;
     }
 
     if (velocity.x != 0 && velocity.y != 0) {
-        velocity = velocity.normalize() * PLAYER_SPEED;
+        velocity = engine::normalize(velocity) * PLAYER_SPEED;
     }
 }
 
@@ -50,10 +60,12 @@ void Player::takeDamage(int amount) {
     int actualDamage = std::max(1, amount - armor / 10);
     health -= actualDamage;
     if (health < 0) health = 0;
+    notifyChanged();
 }
 
 void Player::heal(int amount) {
     health = std::min(health + amount, maxHealth);
+    notifyChanged();
 }
 
 int Player::getHealth() const { return health; }
@@ -65,9 +77,29 @@ Inventory& Player::getInventory() { return inventory; }
 Building* Player::getHomeBase() const { return homeBase; }
 bool Player::getIsInside() const { return isInside; }
 
-void Player::setHomeBase(Building* building) { homeBase = building; }
-void Player::setIsInside(bool inside) { isInside = inside; }
+void Player::setHomeBase(Building* building) {
+    homeBase = building;
+    notifyChanged();
+}
+
+void Player::setIsInside(bool inside) {
+    if (isInside == inside) return;
+    isInside = inside;
+    notifyChanged();
+}
 
 void Player::upgradeWeapon(int amount) { weaponPower += amount; }
 void Player::upgradeArmor(int amount) { armor += amount; }
-void Player::upgradeMaxHealth(int amount) { maxHealth += amount; health = std::min(health + amount, maxHealth); }
+void Player::upgradeMaxHealth(int amount) {
+    maxHealth += amount;
+    health = std::min(health + amount, maxHealth);
+    notifyChanged();
+}
+
+void Player::setChangeListener(std::function<void()> listener) {
+    onChange = std::move(listener);
+}
+
+void Player::notifyChanged() {
+    if (onChange) onChange();
+}
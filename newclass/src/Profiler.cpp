@@ -0,0 +1,180 @@
+#include "Profiler.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    struct ScopeRecord {
+        const char* name;
+        int parent;
+        int depth;
+        Uint64 start;
+        Uint64 elapsed;
+    };
+
+    struct FrameRecord {
+        Uint64 start;
+        Uint64 elapsed;
+        int scopeCount;
+        ScopeRecord scopes[Profiler::MAX_SCOPES_PER_FRAME];
+    };
+
+    FrameRecord frames[Profiler::HISTORY];
+    long long framesRecorded = 0;
+    FrameRecord* currentFrame = nullptr;
+    int openScope = -1;
+    double ticksToMs = 0.0;
+
+    thread_local bool recordingThread = false;
+
+    double toMs(Uint64 ticks) {
+        return ticks * ticksToMs;
+    }
+
+    int storedFrames() {
+        return framesRecorded < Profiler::HISTORY ? static_cast<int>(framesRecorded) : Profiler::HISTORY;
+    }
+
+    // Ring slot of the n-th stored frame, oldest first.
+    const FrameRecord& storedFrame(int n) {
+        long long first = framesRecorded - storedFrames();
+        return frames[(first + n) % Profiler::HISTORY];
+    }
+
+    void appendSubtree(const std::vector<Profiler::ScopeStats>& stats, int node, int newParent,
+                       std::vector<Profiler::ScopeStats>& out) {
+        int index = static_cast<int>(out.size());
+        out.push_back(stats[node]);
+        out.back().parent = newParent;
+        for (size_t i = 0; i < stats.size(); ++i) {
+            if (stats[i].parent == node) appendSubtree(stats, static_cast<int>(i), index, out);
+        }
+    }
+}
+
+namespace Profiler {
+
+void beginFrame() {
+    if (ticksToMs == 0.0) {
+        ticksToMs = 1000.0 / SDL_GetPerformanceFrequency();
+    }
+    recordingThread = true;
+
+    currentFrame = &frames[framesRecorded % HISTORY];
+    currentFrame->scopeCount = 0;
+    currentFrame->elapsed = 0;
+    currentFrame->start = SDL_GetPerformanceCounter();
+    openScope = -1;
+}
+
+void endFrame() {
+    if (!currentFrame) return;
+
+    currentFrame->elapsed = SDL_GetPerformanceCounter() - currentFrame->start;
+    currentFrame = nullptr;
+    ++framesRecorded;
+}
+
+int beginScope(const char* name) {
+    if (!recordingThread || !currentFrame || currentFrame->scopeCount == MAX_SCOPES_PER_FRAME) {
+        return -1;
+    }
+
+    int index = currentFrame->scopeCount++;
+    ScopeRecord& scope = currentFrame->scopes[index];
+    scope.name = name;
+    scope.parent = openScope;
+    scope.depth = openScope < 0 ? 0 : currentFrame->scopes[openScope].depth + 1;
+    scope.elapsed = 0;
+    scope.start = SDL_GetPerformanceCounter();
+    openScope = index;
+    return index;
+}
+
+void endScope(int scope) {
+    if (scope < 0 || !recordingThread || !currentFrame || scope >= currentFrame->scopeCount) return;
+
+    ScopeRecord& record = currentFrame->scopes[scope];
+    record.elapsed = SDL_GetPerformanceCounter() - record.start;
+    openScope = record.parent;
+}
+
+void collectStats(std::vector<ScopeStats>& out) {
+    // Scopes are matched across frames by name under the same parent row.
+    // Rows are appended on first sight and put back in tree order at the end.
+    std::vector<ScopeStats> stats;
+    std::vector<double> frameSum;
+    int rowOf[MAX_SCOPES_PER_FRAME];
+
+    for (int n = 0; n < storedFrames(); ++n) {
+        const FrameRecord& frame = storedFrame(n);
+        for (int s = 0; s < frame.scopeCount; ++s) {
+            const ScopeRecord& scope = frame.scopes[s];
+            int parentRow = scope.parent < 0 ? -1 : rowOf[scope.parent];
+
+            int row = -1;
+            for (size_t i = 0; i < stats.size(); ++i) {
+                if (stats[i].parent == parentRow &&
+                    (stats[i].name == scope.name || std::strcmp(stats[i].name, scope.name) == 0)) {
+                    row = static_cast<int>(i);
+                    break;
+                }
+            }
+            if (row < 0) {
+                row = static_cast<int>(stats.size());
+                stats.push_back({ scope.name, scope.depth, parentRow, 0.0, 0.0, 0 });
+                frameSum.push_back(-1.0);
+            }
+
+            rowOf[s] = row;
+            frameSum[row] = (frameSum[row] < 0.0 ? 0.0 : frameSum[row]) + toMs(scope.elapsed);
+        }
+
+        for (size_t i = 0; i < stats.size(); ++i) {
+            if (frameSum[i] < 0.0) continue;
+            stats[i].averageMs += frameSum[i];
+            if (frameSum[i] > stats[i].maxMs) stats[i].maxMs = frameSum[i];
+            ++stats[i].frames;
+            frameSum[i] = -1.0;
+        }
+    }
+
+    for (ScopeStats& row : stats) {
+        row.averageMs /= row.frames;
+    }
+
+    out.clear();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        if (stats[i].parent < 0) appendSubtree(stats, static_cast<int>(i), -1, out);
+    }
+}
+
+void collectFrameTimes(std::vector<float>& out) {
+    out.clear();
+    for (int n = 0; n < storedFrames(); ++n) {
+        out.push_back(static_cast<float>(toMs(storedFrame(n).elapsed)));
+    }
+}
+
+bool dumpToFile(const char* path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open profile dump " << path << std::endl;
+        return false;
+    }
+
+    file << "frame,scope,parent,depth,name,start_ms,duration_ms\n";
+    long long first = framesRecorded - storedFrames();
+    for (int n = 0; n < storedFrames(); ++n) {
+        const FrameRecord& frame = storedFrame(n);
+        file << first + n << ",-1,-1,-1,frame,0," << toMs(frame.elapsed) << "\n";
+        for (int s = 0; s < frame.scopeCount; ++s) {
+            const ScopeRecord& scope = frame.scopes[s];
+            file << first + n << "," << s << "," << scope.parent << "," << scope.depth << ","
+                 << scope.name << "," << toMs(scope.start - frame.start) << "," << toMs(scope.elapsed) << "\n";
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,34 @@
+#include "Random.h"
+
+namespace {
+    // splitmix32 finaliser: neighbouring stream indices give unrelated seeds.
+    Uint32 mixSeed(Uint32 seed, Uint32 stream) {
+        Uint32 h = seed + (stream + 1) * 0x9E3779B9u;
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+}
+
+RandomService::RandomService() : seed(0) {
+    std::random_device rd;
+    reseed(rd());
+}
+
+void RandomService::reseed(Uint32 masterSeed) {
+    seed = masterSeed;
+    for (int i = 0; i < RNG_STREAM_COUNT; ++i) {
+        streams[i].seed(mixSeed(masterSeed, static_cast<Uint32>(i)));
+    }
+}
+
+Uint32 RandomService::getSeed() const {
+    return seed;
+}
+
+std::mt19937& RandomService::get(RandomStream stream) {
+    return streams[stream];
+}
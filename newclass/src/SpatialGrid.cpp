@@ -0,0 +1,105 @@
+#include "SpatialGrid.h"
+#include "Entity.h"
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(int worldWidth, int worldHeight, int cellSize) :
+    cellSize(cellSize), queryStamp(0) {
+    cols = (worldWidth + cellSize - 1) / cellSize;
+    rows = (worldHeight + cellSize - 1) / cellSize;
+    cells.resize(cols * rows);
+}
+
+SpatialGrid::~SpatialGrid() {
+    clear();
+}
+
+void SpatialGrid::cellRange(const Rectangle& rect, int& minX, int& minY, int& maxX, int& maxY) const {
+    minX = std::max(0, std::min(cols - 1, static_cast<int>(rect.x) / cellSize));
+    minY = std::max(0, std::min(rows - 1, static_cast<int>(rect.y) / cellSize));
+    maxX = std::max(0, std::min(cols - 1, static_cast<int>(rect.x + rect.w) / cellSize));
+    maxY = std::max(0, std::min(rows - 1, static_cast<int>(rect.y + rect.h) / cellSize));
+}
+
+void SpatialGrid::addToCells(Entity* entity, int minX, int minY, int maxX, int maxY) {
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            cells[y * cols + x].push_back(entity);
+        }
+    }
+}
+
+void SpatialGrid::removeFromCells(Entity* entity, int minX, int minY, int maxX, int maxY) {
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            std::vector<Entity*>& cell = cells[y * cols + x];
+            auto it = std::find(cell.begin(), cell.end(), entity);
+            if (it != cell.end()) {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+void SpatialGrid::insert(Entity* entity) {
+    if (entity->grid == this) return;
+    if (entity->grid) entity->grid->remove(entity);
+
+    cellRange(entity->collider, entity->gridMinX, entity->gridMinY, entity->gridMaxX, entity->gridMaxY);
+    addToCells(entity, entity->gridMinX, entity->gridMinY, entity->gridMaxX, entity->gridMaxY);
+    entity->grid = this;
+}
+
+void SpatialGrid::remove(Entity* entity) {
+    if (entity->grid != this) return;
+
+    removeFromCells(entity, entity->gridMinX, entity->gridMinY, entity->gridMaxX, entity->gridMaxY);
+    entity->grid = nullptr;
+}
+
+void SpatialGrid::update(Entity* entity) {
+    if (entity->grid != this) return;
+
+    int minX, minY, maxX, maxY;
+    cellRange(entity->collider, minX, minY, maxX, maxY);
+    if (minX == entity->gridMinX && minY == entity->gridMinY &&
+        maxX == entity->gridMaxX && maxY == entity->gridMaxY) {
+        return;
+    }
+
+    removeFromCells(entity, entity->gridMinX, entity->gridMinY, entity->gridMaxX, entity->gridMaxY);
+    addToCells(entity, minX, minY, maxX, maxY);
+    entity->gridMinX = minX;
+    entity->gridMinY = minY;
+    entity->gridMaxX = maxX;
+    entity->gridMaxY = maxY;
+}
+
+void SpatialGrid::clear() {
+    for (auto& cell : cells) {
+        for (Entity* entity : cell) {
+            entity->grid = nullptr;
+        }
+        cell.clear();
+    }
+}
+
+void SpatialGrid::query(const Rectangle& area, std::vector<Entity*>& out) {
+    int minX, minY, maxX, maxY;
+    cellRange(area, minX, minY, maxX, maxY);
+
+    ++queryStamp;
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            for (Entity* entity : cells[y * cols + x]) {
+                if (entity->gridQueryStamp == queryStamp) continue;
+                entity->gridQueryStamp = queryStamp;
+                out.push_back(entity);
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryPoint(const Vector2D& point, std::vector<Entity*>& out) {
+    query(Rectangle(point.x, point.y, 0, 0), out);
+}
@@ -0,0 +1,83 @@
+#include "SpriteBatch.h"
+#include "../../common/include/log.h"
+#include "Profiler.h"
+#include <algorithm>
+
+SpriteBatch::SpriteBatch(SDL_Renderer* renderer) : renderer(renderer), drawCalls(0) {}
+
+void SpriteBatch::draw(SDL_Texture* texture, const SDL_Rect& src, const SDL_Rect& dst, int layer) {
+    if (!texture) return;
+    sprites.push_back({ texture, src, dst, layer, static_cast<Uint32>(sprites.size()) });
+}
+
+void SpriteBatch::flush() {
+    PROFILE_SCOPE("SpriteBatch::flush");
+    drawCalls = 0;
+
+    std::sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture != b.texture) return a.texture < b.texture;
+        return a.order < b.order;
+    });
+
+    size_t begin = 0;
+    while (begin < sprites.size()) {
+        size_t end = begin + 1;
+        while (end < sprites.size() && sprites[end].texture == sprites[begin].texture &&
+               sprites[end].layer == sprites[begin].layer) {
+            ++end;
+        }
+        drawRun(begin, end);
+        begin = end;
+    }
+
+    LOG_TRACE(LOG_CAT_RENDER, "Sprite batch flushed {} sprites in {} draw calls", sprites.size(), drawCalls);
+    sprites.clear();
+}
+
+void SpriteBatch::drawRun(size_t begin, size_t end) {
+    SDL_Texture* texture = sprites[begin].texture;
+    int textureWidth = 0, textureHeight = 0;
+    SDL_QueryTexture(texture, nullptr, nullptr, &textureWidth, &textureHeight);
+    if (textureWidth <= 0 || textureHeight <= 0) return;
+
+    const float invW = 1.0f / textureWidth;
+    const float invH = 1.0f / textureHeight;
+    const SDL_Color white = { 255, 255, 255, 255 };
+
+    vertices.clear();
+    indices.clear();
+    for (size_t i = begin; i < end; ++i) {
+        const Sprite& sprite = sprites[i];
+        float x0 = static_cast<float>(sprite.dst.x), y0 = static_cast<float>(sprite.dst.y);
+        float x1 = x0 + sprite.dst.w, y1 = y0 + sprite.dst.h;
+        float u0 = sprite.src.x * invW, v0 = sprite.src.y * invH;
+        float u1 = (sprite.src.x + sprite.src.w) * invW, v1 = (sprite.src.y + sprite.src.h) * invH;
+
+        int base = static_cast<int>(vertices.size());
+        vertices.push_back({ { x0, y0 }, white, { u0, v0 } });
+        vertices.push_back({ { x1, y0 }, white, { u1, v0 } });
+        vertices.push_back({ { x1, y1 }, white, { u1, v1 } });
+        vertices.push_back({ { x0, y1 }, white, { u0, v1 } });
+
+        indices.push_back(base);
+        indices.push_back(base + 1);
+        indices.push_back(base + 2);
+        indices.push_back(base);
+        indices.push_back(base + 2);
+        indices.push_back(base + 3);
+    }
+
+    ++drawCalls;
+    if (SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size())) != 0) {
+        // Renderer without geometry support: same order, one copy per sprite.
+        for (size_t i = begin; i < end; ++i) {
+            SDL_RenderCopy(renderer, texture, &sprites[i].src, &sprites[i].dst);
+        }
+    }
+}
+
+int SpriteBatch::getDrawCalls() const {
+    return drawCalls;
+}
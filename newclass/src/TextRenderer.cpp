@@ -0,0 +1,174 @@
+#include "TextRenderer.h"
+#include "MemoryStats.h"
+
+TextRenderer::TextRenderer(SDL_Renderer* ren, TTF_Font* f, size_t cacheCapacity) :
+    renderer(ren), font(f), atlas(nullptr), atlasWidth(0), atlasHeight(0), cacheCapacity(cacheCapacity) {
+    for (auto& glyph : glyphs) {
+        glyph.src = { 0, 0, 0, 0 };
+        glyph.advance = 0;
+    }
+
+    if (font && !buildAtlas()) {
+        std::cerr << "Failed to build glyph atlas: " << SDL_GetError() << std::endl;
+    }
+}
+
+TextRenderer::~TextRenderer() {
+    clearCache();
+    if (atlas) {
+        MemoryStats::textureDestroyed(MEM_UI_TEXTURES, atlas);
+        SDL_DestroyTexture(atlas);
+    }
+}
+
+bool TextRenderer::buildAtlas() {
+    SDL_Color white = { 255, 255, 255, 255 };
+    std::vector<SDL_Surface*> surfaces(LAST_GLYPH - FIRST_GLYPH + 1, nullptr);
+
+    // Shelf-pack the glyphs left to right, starting a new row when full.
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (int c = FIRST_GLYPH; c <= LAST_GLYPH; ++c) {
+        Glyph& glyph = glyphs[c - FIRST_GLYPH];
+        TTF_GlyphMetrics(font, static_cast<Uint16>(c), nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+
+        SDL_Surface* surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), white);
+        if (!surface) continue;
+
+        if (penX + surface->w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+
+        glyph.src = { penX, penY, surface->w, surface->h };
+        penX += surface->w + 1;
+        rowHeight = std::max(rowHeight, surface->h);
+        surfaces[c - FIRST_GLYPH] = surface;
+    }
+
+    atlasWidth = ATLAS_WIDTH;
+    atlasHeight = penY + rowHeight;
+
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (sheet) {
+        SDL_FillRect(sheet, nullptr, SDL_MapRGBA(sheet->format, 255, 255, 255, 0));
+        for (int c = FIRST_GLYPH; c <= LAST_GLYPH; ++c) {
+            SDL_Surface* surface = surfaces[c - FIRST_GLYPH];
+            if (!surface) continue;
+            SDL_Rect dest = glyphs[c - FIRST_GLYPH].src;
+            SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surface, nullptr, sheet, &dest);
+        }
+        atlas = SDL_CreateTextureFromSurface(renderer, sheet);
+        MemoryStats::textureCreated(MEM_UI_TEXTURES, atlas);
+        SDL_FreeSurface(sheet);
+    }
+
+    for (SDL_Surface* surface : surfaces) {
+        if (surface) SDL_FreeSurface(surface);
+    }
+
+    if (!atlas) return false;
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+const TextRenderer::Glyph& TextRenderer::glyphFor(char c) const {
+    int code = static_cast<unsigned char>(c);
+    if (code < FIRST_GLYPH || code > LAST_GLYPH) code = '?';
+    return glyphs[code - FIRST_GLYPH];
+}
+
+void TextRenderer::drawText(const std::string& text, int x, int y, SDL_Color color) {
+    if (!atlas) return;
+
+    vertices.clear();
+    indices.clear();
+
+    const float invW = 1.0f / atlasWidth;
+    const float invH = 1.0f / atlasHeight;
+    float penX = static_cast<float>(x);
+
+    for (char c : text) {
+        const Glyph& glyph = glyphFor(c);
+        if (glyph.src.w > 0) {
+            float x0 = penX, y0 = static_cast<float>(y);
+            float x1 = x0 + glyph.src.w, y1 = y0 + glyph.src.h;
+            float u0 = glyph.src.x * invW, v0 = glyph.src.y * invH;
+            float u1 = (glyph.src.x + glyph.src.w) * invW, v1 = (glyph.src.y + glyph.src.h) * invH;
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({ { x0, y0 }, color, { u0, v0 } });
+            vertices.push_back({ { x1, y0 }, color, { u1, v0 } });
+            vertices.push_back({ { x1, y1 }, color, { u1, v1 } });
+            vertices.push_back({ { x0, y1 }, color, { u0, v1 } });
+
+            indices.push_back(base);
+            indices.push_back(base + 1);
+            indices.push_back(base + 2);
+            indices.push_back(base);
+            indices.push_back(base + 2);
+            indices.push_back(base + 3);
+        }
+        penX += glyph.advance;
+    }
+
+    if (!vertices.empty()) {
+        SDL_RenderGeometry(renderer, atlas, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    }
+}
+
+void TextRenderer::drawCached(const std::string& text, int x, int y, SDL_Color color) {
+    std::string key = text;
+    key.push_back('\0');
+    key.push_back(static_cast<char>(color.r));
+    key.push_back(static_cast<char>(color.g));
+    key.push_back(static_cast<char>(color.b));
+    key.push_back(static_cast<char>(color.a));
+
+    auto found = cacheLookup.find(key);
+    if (found != cacheLookup.end()) {
+        cache.splice(cache.begin(), cache, found->second);
+    } else {
+        if (!font) return;
+
+        SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
+        if (!surface) {
+            std::cerr << "Failed to render text: " << TTF_GetError() << std::endl;
+            return;
+        }
+
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        int w = surface->w, h = surface->h;
+        SDL_FreeSurface(surface);
+        if (!texture) {
+            std::cerr << "Failed to create texture from surface: " << SDL_GetError() << std::endl;
+            return;
+        }
+        MemoryStats::textureCreated(MEM_UI_TEXTURES, texture);
+
+        if (cache.size() >= cacheCapacity) {
+            MemoryStats::textureDestroyed(MEM_UI_TEXTURES, cache.back().texture);
+            SDL_DestroyTexture(cache.back().texture);
+            cacheLookup.erase(cache.back().key);
+            cache.pop_back();
+        }
+
+        cache.push_front({ key, texture, w, h });
+        cacheLookup[key] = cache.begin();
+    }
+
+    const CachedText& entry = cache.front();
+    SDL_Rect destRect = { x, y, entry.w, entry.h };
+    SDL_RenderCopy(renderer, entry.texture, nullptr, &destRect);
+}
+
+void TextRenderer::clearCache() {
+    for (auto& entry : cache) {
+        MemoryStats::textureDestroyed(MEM_UI_TEXTURES, entry.texture);
+        SDL_DestroyTexture(entry.texture);
+    }
+    cache.clear();
+    cacheLookup.clear();
+}
@@ -0,0 +1,265 @@
+#include "TextureAtlas.h"
+#include "../../common/include/log.h"
+#include "MemoryStats.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    std::string directoryOf(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // "assets/atlas.txt", page 1 -> "atlas1.png"
+    std::string pageFileName(const std::string& metaPath, int page) {
+        size_t slash = metaPath.find_last_of("/\\");
+        std::string base = metaPath.substr(slash == std::string::npos ? 0 : slash + 1);
+        size_t dot = base.rfind('.');
+        if (dot != std::string::npos) base.erase(dot);
+        return base + std::to_string(page) + ".png";
+    }
+}
+
+TextureAtlas::TextureAtlas() {}
+
+TextureAtlas::~TextureAtlas() {
+    clear();
+}
+
+void TextureAtlas::addImage(const std::string& name, int width, int height, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    Image image;
+    image.name = name;
+    image.width = width;
+    image.height = height;
+    image.color = { r, g, b, a };
+    images.push_back(image);
+}
+
+// Shelf packing, tallest images first so each shelf wastes little height.
+// pageHeights receives the used height of every page so the textures can be
+// cut to size.
+bool TextureAtlas::place(std::vector<int>& pageHeights) {
+    std::vector<int> order(images.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        if (images[a].height != images[b].height) return images[a].height > images[b].height;
+        return images[a].width > images[b].width;
+    });
+
+    int page = 0, x = 0, y = 0, shelfHeight = 0;
+    pageHeights.assign(1, 0);
+
+    for (int index : order) {
+        const Image& image = images[index];
+        int paddedWidth = image.width + ATLAS_PADDING * 2;
+        int paddedHeight = image.height + ATLAS_PADDING * 2;
+        if (paddedWidth > ATLAS_PAGE_SIZE || paddedHeight > ATLAS_PAGE_SIZE) {
+            std::cerr << "Atlas image " << image.name << " (" << image.width << "x" << image.height
+                      << ") is larger than an atlas page" << std::endl;
+            return false;
+        }
+
+        if (x + paddedWidth > ATLAS_PAGE_SIZE) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if (y + paddedHeight > ATLAS_PAGE_SIZE) {
+            ++page;
+            pageHeights.push_back(0);
+            x = y = shelfHeight = 0;
+        }
+
+        Placement placement;
+        placement.page = page;
+        placement.rect = { x + ATLAS_PADDING, y + ATLAS_PADDING, image.width, image.height };
+        placements[image.name] = placement;
+
+        x += paddedWidth;
+        shelfHeight = std::max(shelfHeight, paddedHeight);
+        pageHeights[page] = std::max(pageHeights[page], y + paddedHeight);
+    }
+    return true;
+}
+
+bool TextureAtlas::upload(SDL_Renderer* renderer) {
+    for (SDL_Surface* surface : pageSurfaces) {
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if (!texture) {
+            std::cerr << "Atlas texture creation failed: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        MemoryStats::textureCreated(MEM_ASSET_TEXTURES, texture);
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        pages.push_back(texture);
+    }
+    return true;
+}
+
+bool TextureAtlas::load(SDL_Renderer* renderer, const std::string& metaPath) {
+    PROFILE_SCOPE("TextureAtlas::load");
+    clear();
+
+    std::ifstream file(metaPath);
+    if (!file) {
+        LOG_INFO(LOG_CAT_RENDER, "No prebuilt atlas at {}, packing at runtime", metaPath);
+        return false;
+    }
+
+    std::string directory = directoryOf(metaPath);
+    std::string line;
+    int lineNumber = 0;
+    bool valid = true;
+    while (valid && std::getline(file, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name) || name[0] == '#') continue;
+
+        if (name == "page") {
+            int index;
+            std::string imageFile;
+            valid = static_cast<bool>(fields >> index >> imageFile) && index == static_cast<int>(pageSurfaces.size());
+            if (!valid) break;
+            // Loaded as a surface and kept, like a packed page, so save() can
+            // bake the atlas again.
+            SDL_Surface* surface = IMG_Load((directory + imageFile).c_str());
+            if (!surface) {
+                std::cerr << "Atlas page " << imageFile << " failed to load: " << IMG_GetError() << std::endl;
+                clear();
+                return false;
+            }
+            pageSurfaces.push_back(surface);
+        } else {
+            Placement placement;
+            valid = static_cast<bool>(fields >> placement.page >> placement.rect.x >> placement.rect.y
+                                             >> placement.rect.w >> placement.rect.h);
+            placements[name] = placement;
+        }
+    }
+    if (!valid) {
+        std::cerr << "Malformed atlas metadata " << metaPath << " at line " << lineNumber << std::endl;
+        clear();
+        return false;
+    }
+
+    // A prebuilt atlas from an older image set falls back to runtime packing.
+    for (const Image& image : images) {
+        auto it = placements.find(image.name);
+        if (it == placements.end() || it->second.page < 0 || it->second.page >= static_cast<int>(pageSurfaces.size()) ||
+            it->second.rect.w != image.width || it->second.rect.h != image.height) {
+            LOG_INFO(LOG_CAT_RENDER, "Prebuilt atlas {} does not match image {}, packing at runtime", metaPath, image.name);
+            clear();
+            return false;
+        }
+    }
+
+    if (!upload(renderer)) {
+        clear();
+        return false;
+    }
+
+    LOG_INFO(LOG_CAT_RENDER, "Loaded atlas {} - {} images on {} pages", metaPath, placements.size(), pages.size());
+    return true;
+}
+
+bool TextureAtlas::pack(SDL_Renderer* renderer) {
+    PROFILE_SCOPE("TextureAtlas::pack");
+    clear();
+
+    std::vector<int> pageHeights;
+    if (!place(pageHeights)) {
+        clear();
+        return false;
+    }
+
+    for (int height : pageHeights) {
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_PAGE_SIZE, std::max(height, 1), 32, SDL_PIXELFORMAT_RGBA8888);
+        if (!surface) {
+            std::cerr << "Atlas surface creation failed: " << SDL_GetError() << std::endl;
+            clear();
+            return false;
+        }
+        SDL_FillRect(surface, nullptr, SDL_MapRGBA(surface->format, 0, 0, 0, 0));
+        pageSurfaces.push_back(surface);
+    }
+
+    // The padding takes the image colour too, so filtering at the edge of a
+    // region never blends in a neighbour.
+    for (const Image& image : images) {
+        const Placement& placement = placements[image.name];
+        SDL_Surface* surface = pageSurfaces[placement.page];
+        SDL_Rect padded = { placement.rect.x - ATLAS_PADDING, placement.rect.y - ATLAS_PADDING,
+                            image.width + ATLAS_PADDING * 2, image.height + ATLAS_PADDING * 2 };
+        SDL_FillRect(surface, &padded, SDL_MapRGBA(surface->format, image.color.r, image.color.g,
+                                                   image.color.b, image.color.a));
+    }
+
+    if (!upload(renderer)) {
+        clear();
+        return false;
+    }
+
+    LOG_INFO(LOG_CAT_RENDER, "Packed atlas - {} images on {} pages", images.size(), pages.size());
+    return true;
+}
+
+bool TextureAtlas::save(const std::string& metaPath) const {
+    if (pageSurfaces.empty()) {
+        std::cerr << "Atlas has no packed pages to save" << std::endl;
+        return false;
+    }
+
+    std::string directory = directoryOf(metaPath);
+    std::ofstream file(metaPath);
+    if (!file) {
+        std::cerr << "Could not write atlas metadata " << metaPath << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < pageSurfaces.size(); ++i) {
+        std::string imageFile = pageFileName(metaPath, static_cast<int>(i));
+        if (IMG_SavePNG(pageSurfaces[i], (directory + imageFile).c_str()) != 0) {
+            std::cerr << "Could not write atlas page " << imageFile << ": " << IMG_GetError() << std::endl;
+            return false;
+        }
+        file << "page " << i << " " << imageFile << "\n";
+    }
+    for (const Image& image : images) {
+        const Placement& placement = placements.at(image.name);
+        file << image.name << " " << placement.page << " " << placement.rect.x << " " << placement.rect.y
+             << " " << placement.rect.w << " " << placement.rect.h << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+void TextureAtlas::clear() {
+    for (SDL_Texture* texture : pages) {
+        MemoryStats::textureDestroyed(MEM_ASSET_TEXTURES, texture);
+        SDL_DestroyTexture(texture);
+    }
+    for (SDL_Surface* surface : pageSurfaces) SDL_FreeSurface(surface);
+    pages.clear();
+    pageSurfaces.clear();
+    placements.clear();
+}
+
+AtlasRegion TextureAtlas::find(const std::string& name) const {
+    AtlasRegion region = { nullptr, { 0, 0, 0, 0 } };
+    auto it = placements.find(name);
+    if (it == placements.end()) {
+        LOG_WARN(LOG_CAT_RENDER, "Atlas has no image {}", name);
+        return region;
+    }
+    if (it->second.page < static_cast<int>(pages.size())) {
+        region.texture = pages[it->second.page];
+    }
+    region.rect = it->second.rect;
+    return region;
+}
+
+int TextureAtlas::getPageCount() const {
+    return static_cast<int>(pages.size());
+}
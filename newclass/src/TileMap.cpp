@@ -1,91 +1,210 @@
 #include "TileMap.h"
+#include "../../common/include/log.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
+#include "../../common/include/collision.h"
+#include <algorithm>
 
-TileMap::TileMap(SDL_Texture* tiles, int width, int height, int tileSize) :
-    tileset(tiles), mapWidth(width), mapHeight(height), tileSize(tileSize) {
-    map.resize(mapHeight / tileSize);
-    for (auto& row : map) {
-        row.resize(mapWidth / tileSize, 0);
+TileMap::TileMap(const AtlasRegion tiles[], int width, int height, int tileSize, Uint32 seed) :
+    mapWidth(width), mapHeight(height), tileSize(tileSize), bakedCount(0), chunks(seed, OBSTACLE_TILE) {
+    cols = mapWidth / tileSize;
+    rows = mapHeight / tileSize;
+    chunkCols = (cols + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunkRows = (rows + CHUNK_TILES - 1) / CHUNK_TILES;
+
+    // Headless runs have no tile textures; the map data is still generated.
+    for (int i = 0; i < TILE_TYPES; ++i) tileSprites[i] = tiles[i];
+    LOG_DEBUG(LOG_CAT_TILEMAP, "World {}x{} chunks, seed {}", chunkCols, chunkRows, seed);
+}
+
+TileMap::~TileMap() {
+    chunks.forEach([](Chunk& chunk) {
+        MemoryStats::freed(MEM_TILEMAP, sizeof(Chunk));
+        if (chunk.texture) {
+            MemoryStats::textureDestroyed(MEM_CHUNK_TEXTURES, chunk.texture);
+            SDL_DestroyTexture(chunk.texture);
+        }
+    });
+}
+
+TileMap::Chunk* TileMap::ensureChunk(int cx, int cy) const {
+    return chunks.ensure(cx, cy, [](Chunk& chunk) {
+        MemoryStats::allocated(MEM_TILEMAP, sizeof(Chunk));
+        LOG_TRACE(LOG_CAT_TILEMAP, "Chunk ({}, {}) generated synchronously", chunk.cx, chunk.cy);
+    });
+}
+
+void TileMap::stream(const Rectangle& view) {
+    PROFILE_SCOPE("TileMap::stream");
+
+    int chunkPixels = CHUNK_TILES * tileSize;
+    int minX = std::max(0, static_cast<int>(view.x) / chunkPixels - CHUNK_PRELOAD_MARGIN);
+    int minY = std::max(0, static_cast<int>(view.y) / chunkPixels - CHUNK_PRELOAD_MARGIN);
+    int maxX = std::min(chunkCols - 1, static_cast<int>(view.x + view.w) / chunkPixels + CHUNK_PRELOAD_MARGIN);
+    int maxY = std::min(chunkRows - 1, static_cast<int>(view.y + view.h) / chunkPixels + CHUNK_PRELOAD_MARGIN);
+
+    chunks.stream(minX, minY, maxX, maxY, [](Chunk&) {
+        MemoryStats::allocated(MEM_TILEMAP, sizeof(Chunk));
+    });
+
+    if (chunks.size() > static_cast<size_t>(MAX_RESIDENT_CHUNKS)) {
+        chunks.evict(minX, minY, maxX, maxY, MAX_RESIDENT_CHUNKS, [this](Chunk& chunk) {
+            if (chunk.texture) {
+                MemoryStats::textureDestroyed(MEM_CHUNK_TEXTURES, chunk.texture);
+                SDL_DestroyTexture(chunk.texture);
+                --bakedCount;
+            }
+            MemoryStats::freed(MEM_TILEMAP, sizeof(Chunk));
+        });
+        LOG_TRACE(LOG_CAT_TILEMAP, "Evicted chunks, {} resident", chunks.size());
     }
+}
+
+int TileMap::getTile(int x, int y) const {
+    if (x < 0 || y < 0 || x >= cols || y >= rows) return 0;
+    const Chunk* chunk = ensureChunk(x / CHUNK_TILES, y / CHUNK_TILES);
+    return chunk->tiles[(y % CHUNK_TILES) * CHUNK_TILES + x % CHUNK_TILES];
+}
+
+void TileMap::setTile(int x, int y, int tile) {
+    if (x < 0 || y < 0 || x >= cols || y >= rows) return;
 
-    int tilesetWidth, tilesetHeight;
-    SDL_QueryTexture(tileset, nullptr, nullptr, &tilesetWidth, &tilesetHeight);
-    printf("Value is %d, Value is %d\n", tilesetWidth, tilesetHeight);
+    Chunk* chunk = ensureChunk(x / CHUNK_TILES, y / CHUNK_TILES);
+    int localX = x % CHUNK_TILES;
+    int localY = y % CHUNK_TILES;
+    chunk->tiles[localY * CHUNK_TILES + localX] = static_cast<Uint8>(tile);
+    Uint16 mask = static_cast<Uint16>(1u << localX);
+    if (tile == OBSTACLE_TILE) chunk->obstacleRows[localY] |= mask;
+    else chunk->obstacleRows[localY] &= ~mask;
+    chunk->textureDirty = true;
+    chunk->pinned = true;
+}
+
+void TileMap::drawTiles(SDL_Renderer* renderer, const Chunk& chunk, int offsetX, int offsetY) {
+    int baseX = chunk.cx * CHUNK_TILES;
+    int baseY = chunk.cy * CHUNK_TILES;
+    for (int y = 0; y < CHUNK_TILES; ++y) {
+        const Uint8* row = &chunk.tiles[y * CHUNK_TILES];
+        for (int x = 0; x < CHUNK_TILES; ++x) {
+            if (row[x] >= TILE_TYPES) continue;
+            const AtlasRegion& sprite = tileSprites[row[x]];
+            SDL_Rect destRect = { (baseX + x) * tileSize - offsetX, (baseY + y) * tileSize - offsetY, tileSize, tileSize };
+            SDL_RenderCopy(renderer, sprite.texture, &sprite.rect, &destRect);
+        }
+    }
+}
 
-    for (int y = 0; y < tilesetHeight; y += tileSize) {
-        for (int x = 0; x < tilesetWidth; x += tileSize) {
-            SDL_Rect rect = { x, y, tileSize, tileSize };
-            tileRects.push_back(rect);
+bool TileMap::bakeChunk(SDL_Renderer* renderer, Chunk& chunk) {
+    if (!chunk.texture) {
+        int chunkPixels = CHUNK_TILES * tileSize;
+        chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, chunkPixels, chunkPixels);
+        if (!chunk.texture) {
+            std::cerr << "Tile chunk texture creation failed: " << SDL_GetError() << std::endl;
+            return false;
         }
+        MemoryStats::textureCreated(MEM_CHUNK_TEXTURES, chunk.texture);
+        ++bakedCount;
     }
 
-    generateTerrain();
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, chunk.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+
+    drawTiles(renderer, chunk, chunk.cx * CHUNK_TILES * tileSize, chunk.cy * CHUNK_TILES * tileSize);
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    chunk.textureDirty = false;
+    return true;
 }
 
-void TileMap::generateTerrain() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> tileTypeDist(0, tileRects.size() - 1);
-    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
-
-    for (int y = 0; y < map.size(); ++y) {
-        for (int x = 0; x < map[y].size(); ++x) {
-            float prob = probDist(gen);
-            if (prob < 0.01f) {
-                map[y][x] = 2;
-            } else if (prob < 0.1f) {
-                map[y][x] = 1;
-            }
+// Frees the textures of chunks that were not drawn this frame, oldest first,
+// until at most MAX_BAKED_CHUNKS remain. The tile data stays resident.
+void TileMap::releaseTextures() {
+    std::vector<std::pair<Uint32, Chunk*>> candidates;
+    Uint32 stamp = chunks.stamp();
+    chunks.forEach([&candidates, stamp](Chunk& chunk) {
+        if (chunk.texture && chunk.lastRendered != stamp) {
+            candidates.push_back({ chunk.lastRendered, &chunk });
         }
+    });
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<Uint32, Chunk*>& a, const std::pair<Uint32, Chunk*>& b) { return a.first < b.first; });
+
+    for (size_t i = 0; i < candidates.size() && bakedCount > MAX_BAKED_CHUNKS; ++i) {
+        MemoryStats::textureDestroyed(MEM_CHUNK_TEXTURES, candidates[i].second->texture);
+        SDL_DestroyTexture(candidates[i].second->texture);
+        candidates[i].second->texture = nullptr;
+        candidates[i].second->textureDirty = true;
+        --bakedCount;
     }
 }
 
 void TileMap::render(SDL_Renderer* renderer, const Camera& camera) {
-    if (!tileset) {
-        std::cout << "Warning: TileMap has nullptr tileset texture." << std::endl;
+    PROFILE_SCOPE("TileMap::render");
+    if (!tileSprites[0].texture) {
+        LOG_WARN(LOG_CAT_TILEMAP, "TileMap has nullptr tile textures.");
         return;
     }
 
     SDL_Rect viewport = camera.getViewport();
-    int startX = viewport.x / tileSize;
-    int startY = viewport.y / tileSize;
-    int endX = (viewport.x + viewport.w) / tileSize + 1;
-    int endY = (viewport.y + viewport.h) / tileSize + 1;
-
-    startX = std::max(0, startX);
-    startY = std::max(0, startY);
-    endX = std::min(static_cast<int>(map[0].size()), endX);
-    endY = std::min(static_cast<int>(map.size()), endY);
-
-    for (int y = startY; y < endY; ++y) {
-        for (int x = startX; x < endX; ++x) {
-            int tileIndex = map[y][x];
-            SDL_Rect destRect = { x * tileSize - viewport.x, y * tileSize - viewport.y, tileSize, tileSize };
-            SDL_RenderCopy(renderer, tileset, &tileRects[tileIndex], &destRect);
+    int chunkPixels = CHUNK_TILES * tileSize;
+    int startX = std::max(0, viewport.x / chunkPixels);
+    int startY = std::max(0, viewport.y / chunkPixels);
+    int endX = std::min(chunkCols, (viewport.x + viewport.w) / chunkPixels + 1);
+    int endY = std::min(chunkRows, (viewport.y + viewport.h) / chunkPixels + 1);
+
+    for (int cy = startY; cy < endY; ++cy) {
+        for (int cx = startX; cx < endX; ++cx) {
+            // Chunks still on their way from the streamer are left black for
+            // a frame or two rather than generated here.
+            Chunk* chunk = chunks.find(cx, cy);
+            if (!chunk) continue;
+            chunk->lastRendered = chunks.stamp();
+
+            if (chunk->textureDirty && !bakeChunk(renderer, *chunk)) {
+                // No render target available, draw this chunk tile by tile.
+                drawTiles(renderer, *chunk, viewport.x, viewport.y);
+                continue;
+            }
+
+            SDL_Rect destRect = { cx * chunkPixels - viewport.x, cy * chunkPixels - viewport.y, chunkPixels, chunkPixels };
+            SDL_RenderCopy(renderer, chunk->texture, nullptr, &destRect);
         }
     }
+
+    if (bakedCount > MAX_BAKED_CHUNKS) {
+        releaseTextures();
+    }
 }
 
 bool TileMap::isObstacle(int x, int y) const {
-    if (x < 0 || y < 0 || y >= map.size() || x >= map[y].size()) {
+    if (x < 0 || y < 0 || x >= cols || y >= rows) {
         return true;
     }
-    return map[y][x] == 2;
+    const Chunk* chunk = ensureChunk(x / CHUNK_TILES, y / CHUNK_TILES);
+    return chunk->isObstacle(x % CHUNK_TILES, y % CHUNK_TILES);
 }
 
-bool TileMap::checkCollision(const Rectangle& rect) const {
-    int startTileX = static_cast<int>(rect.x) / tileSize;
-    int startTileY = static_cast<int>(rect.y) / tileSize;
-    int endTileX = static_cast<int>(rect.x + rect.w) / tileSize;
-    int endTileY = static_cast<int>(rect.y + rect.h) / tileSize;
-
-    for (int y = startTileY; y <= endTileY; ++y) {
-        for (int x = startTileX; x <= endTileX; ++x) {
-            if (isObstacle(x, y)) {
-                std::cout << "Collision detected at tile (" << x << ", " << y
-                          << ") for rect at (" << rect.x << ", " << rect.y << ")" << std::endl;
-                return true;
-            }
-        }
+bool TileMap::isResidentObstacle(int x, int y) const {
+    if (x < 0 || y < 0 || x >= cols || y >= rows) {
+        return true;
     }
-    return false;
+    const Chunk* chunk = chunks.find(x / CHUNK_TILES, y / CHUNK_TILES);
+    if (!chunk) return true;
+    return chunk->isObstacle(x % CHUNK_TILES, y % CHUNK_TILES);
+}
+
+bool TileMap::checkCollision(const Rectangle& rect) const {
+    batch_aabb::Box box = batch_aabb::makeBox(rect.x, rect.y, rect.w, rect.h);
+    return engine::hitsSolidTile(box, tileSize, [this, &rect](int x, int y) {
+        if (!isObstacle(x, y)) return false;
+        LOG_TRACE(LOG_CAT_TILEMAP, "Collision detected at tile ({}, {}) for rect at ({}, {})",
+                  x, y, rect.x, rect.y);
+        return true;
+    });
+}
+
+size_t TileMap::getResidentChunkCount() const {
+    return chunks.size();
 }
@@ -1,35 +1,53 @@
 #include "UIManager.h"
+#include "../../common/include/log.h"
+#include "MemoryStats.h"
+#include <algorithm>
+#include <cstdio>
+
+UIManager::UIManager(SDL_Renderer* ren, TTF_Font* f, const AtlasRegion& hpBar, const AtlasRegion& invPanel, GameState& state, Player& p, TimeOfDay& time) :
+    renderer(ren), font(f), hpBarSprite(hpBar), inventorySprite(invPanel), gameState(state), player(p), timeOfDay(time),
+    textRenderer(ren, f), hudTexture(nullptr), hudDirty(true), showProfiler(false) {
+    if (renderer) {
+        hudTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                       SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (hudTexture) {
+            MemoryStats::textureCreated(MEM_UI_TEXTURES, hudTexture);
+            SDL_SetTextureBlendMode(hudTexture, SDL_BLENDMODE_BLEND);
+        } else {
+            LOG_WARN(LOG_CAT_UI, "HUD target texture unavailable, drawing HUD every frame: {}", SDL_GetError());
+        }
+    }
+
+    player.setChangeListener([this]() { hudDirty = true; });
+}
 
-UIManager::UIManager(SDL_Renderer* ren, TTF_Font* f, SDL_Texture* hpBar, SDL_Texture* invTex, GameState& state, Player& p, TimeOfDay& time) :
-    renderer(ren), font(f), hpBarTexture(hpBar), inventoryTexture(invTex), gameState(state), player(p), timeOfDay(time) {}
+UIManager::~UIManager() {
+    if (hudTexture) {
+        MemoryStats::textureDestroyed(MEM_UI_TEXTURES, hudTexture);
+        SDL_DestroyTexture(hudTexture);
+    }
+}
+
+void UIManager::invalidateHud() {
+    hudDirty = true;
+}
 
 void UIManager::renderText(const std::string& text, int x, int y, SDL_Color color) {
     if (!font) {
-        std::cout << "Warning: UIManager has nullptr font, skipping text render." << std::endl;
+        LOG_WARN(LOG_CAT_UI, "UIManager has nullptr font, skipping text render.");
         return;
     }
 
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
-    if (!surface) {
-        std::cerr << "Failed to render text: " << TTF_GetError() << std::endl;
-        return;
-    }
+    textRenderer.drawText(text, x, y, color);
+}
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        std::cerr << "Failed to create texture from surface: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(surface);
+void UIManager::renderLabel(const std::string& text, int x, int y, SDL_Color color) {
+    if (!font) {
+        LOG_WARN(LOG_CAT_UI, "UIManager has nullptr font, skipping text render.");
         return;
     }
 
-    int w, h;
-    SDL_QueryTexture(texture, nullptr, nullptr, &w, &h);
-    SDL_Rect destRect = { x, y, w, h };
-
-    SDL_RenderCopy(renderer, texture, nullptr, &destRect);
-
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
+    textRenderer.drawCached(text, x, y, color);
 }
 
 void UIManager::renderHealthBar() {
@@ -70,22 +88,41 @@ void UIManager::renderTimeOfDay() {
         timeText = "Night";
     }
 
-    renderText(timeText, SCREEN_WIDTH - 100, 20, color);
+    renderLabel(timeText, SCREEN_WIDTH - 100, 20, color);
 }
 
 void UIManager::renderGameplay() {
+    if (!hudTexture) {
+        renderHud();
+        return;
+    }
+
+    if (hudDirty) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, hudTexture);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        renderHud();
+        SDL_SetRenderTarget(renderer, previousTarget);
+        hudDirty = false;
+    }
+
+    SDL_RenderCopy(renderer, hudTexture, nullptr, nullptr);
+}
+
+void UIManager::renderHud() {
     renderHealthBar();
     renderInventoryPreview();
     renderTimeOfDay();
 
     if (player.getHomeBase()) {
         SDL_Color green = { 0, 255, 0, 255 };
-        renderText("Home Base Set", SCREEN_WIDTH - 200, 50, green);
+        renderLabel("Home Base Set", SCREEN_WIDTH - 200, 50, green);
     }
 
     if (player.getIsInside()) {
         SDL_Color cyan = { 0, 255, 255, 255 };
-        renderText("Inside Building", SCREEN_WIDTH - 200, 80, cyan);
+        renderLabel("Inside Building", SCREEN_WIDTH - 200, 80, cyan);
     }
 }
 
@@ -96,12 +133,12 @@ void UIManager::renderInventoryScreen() {
     SDL_RenderFillRect(renderer, &bgRect);
 
     SDL_Color white = { 255, 255, 255, 255 };
-    renderText("Inventory", SCREEN_WIDTH / 2 - 100, 50, white);
+    renderLabel("Inventory", SCREEN_WIDTH / 2 - 100, 50, white);
 
     Inventory& inv = player.getInventory();
     int y = 120;
 
-    renderText("Resources:", 300, y, white); y += 40;
+    renderLabel("Resources:", 300, y, white); y += 40;
     renderText("Wood: " + std::to_string(inv.getItemCount(RESOURCE_WOOD)), 320, y, white); y += 30;
     renderText("Metal: " + std::to_string(inv.getItemCount(RESOURCE_METAL)), 320, y, white); y += 30;
     renderText("Food: " + std::to_string(inv.getItemCount(RESOURCE_FOOD)), 320, y, white); y += 30;
@@ -121,25 +158,25 @@ void UIManager::renderCraftingScreen() {
     SDL_RenderFillRect(renderer, &bgRect);
 
     SDL_Color white = { 255, 255, 255, 255 };
-    renderText("Crafting", SCREEN_WIDTH / 2 - 80, 50, white);
+    renderLabel("Crafting", SCREEN_WIDTH / 2 - 80, 50, white);
 
     Inventory& inv = player.getInventory();
     int y = 120;
 
-    renderText("Resources:", 200, y, white); y += 40;
+    renderLabel("Resources:", 200, y, white); y += 40;
     renderText("Wood: " + std::to_string(inv.getItemCount(RESOURCE_WOOD)), 220, y, white); y += 30;
     renderText("Metal: " + std::to_string(inv.getItemCount(RESOURCE_METAL)), 220, y, white); y += 30;
     renderText("Food: " + std::to_string(inv.getItemCount(RESOURCE_FOOD)), 220, y, white); y += 30;
     renderText("Cloth: " + std::to_string(inv.getItemCount(RESOURCE_CLOTH)), 220, y, white); y += 50;
 
     y = 120;
-    renderText("Crafting Options:", SCREEN_WIDTH - 600, y, white); y += 40;
-    renderText("1. Upgrade Weapon (5 Metal, 3 Wood) [Press 1]", SCREEN_WIDTH - 580, y, white); y += 30;
-    renderText("2. Upgrade Armor (8 Cloth, 2 Metal) [Press 2]", SCREEN_WIDTH - 580, y, white); y += 30;
-    renderText("3. Craft Health Pack (5 Food, 2 Cloth) [Press 3]", SCREEN_WIDTH - 580, y, white); y += 30;
-    renderText("4. Craft Ammo (3 Metal, 2 Wood) [Press 4]", SCREEN_WIDTH - 580, y, white); y += 30;
+    renderLabel("Crafting Options:", SCREEN_WIDTH - 600, y, white); y += 40;
+    renderLabel("1. Upgrade Weapon (5 Metal, 3 Wood) [Press 1]", SCREEN_WIDTH - 580, y, white); y += 30;
+    renderLabel("2. Upgrade Armor (8 Cloth, 2 Metal) [Press 2]", SCREEN_WIDTH - 580, y, white); y += 30;
+    renderLabel("3. Craft Health Pack (5 Food, 2 Cloth) [Press 3]", SCREEN_WIDTH - 580, y, white); y += 30;
+    renderLabel("4. Craft Ammo (3 Metal, 2 Wood) [Press 4]", SCREEN_WIDTH - 580, y, white); y += 30;
 
-    renderText("Press [C] to close crafting menu", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT - 50, white);
+    renderLabel("Press [C] to close crafting menu", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT - 50, white);
 }
 
 void UIManager::renderPauseScreen() {
@@ -163,20 +200,21 @@ void UIManager::renderMainMenu() {
     SDL_Color title = { 255, 200, 0, 255 };
     SDL_Color normal = { 200, 200, 200, 255 };
 
-    renderText("ZOMBIE SURVIVAL", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 4, title);
-    renderText("Press [ENTER] to start game", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT / 2, normal);
-    renderText("Press [ESC] to quit", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 50, normal);
+    renderLabel("ZOMBIE SURVIVAL", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 4, title);
+    renderLabel("Press [ENTER] to start game", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT / 2, normal);
+    renderLabel("Press [ESC] to quit", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 50, normal);
 
     int y = SCREEN_HEIGHT - 200;
-    renderText("Controls:", 100, y, normal); y += 30;
-    renderText("WASD - Move", 120, y, normal); y += 25;
-    renderText("E - Interact with buildings/items", 120, y, normal); y += 25;
-    renderText("I - Inventory", 120, y, normal); y += 25;
-    renderText("C - Crafting", 120, y, normal); y += 25;
-    renderText("H - Set current building as home base", 120, y, normal);
+    renderLabel("Controls:", 100, y, normal); y += 30;
+    renderLabel("WASD - Move", 120, y, normal); y += 25;
+    renderLabel("E - Interact with buildings/items", 120, y, normal); y += 25;
+    renderLabel("I - Inventory", 120, y, normal); y += 25;
+    renderLabel("C - Crafting", 120, y, normal); y += 25;
+    renderLabel("H - Set current building as home base", 120, y, normal);
 }
 
 void UIManager::render() {
+    PROFILE_SCOPE("UIManager::render");
     switch (gameState) {
         case MAIN_MENU:
             renderMainMenu();
@@ -200,4 +238,82 @@ void UIManager::render() {
             renderGameOverScreen();
             break;
     }
+
+    if (showProfiler) {
+        renderProfiler();
+    }
+}
+
+void UIManager::toggleProfiler() {
+    showProfiler = !showProfiler;
+}
+
+// Per-scope average and worst frame over the profiler history, plus a bar
+// per frame with the 60 FPS budget marked.
+void UIManager::renderProfiler() {
+    PROFILE_SCOPE("UIManager::renderProfiler");
+    Profiler::collectStats(profileStats);
+    Profiler::collectFrameTimes(frameTimes);
+    MemoryStats::collect(memoryStats);
+
+    const int x = 20;
+    const int y = 120;
+    const int graphHeight = 100;
+    const int width = Profiler::HISTORY * 2;
+    const int rowHeight = 26;
+    const float budgetMs = 1000.0f / MAX_FPS;
+    const float graphScaleMs = budgetMs * 2.0f;
+
+    int height = graphHeight + 100 + rowHeight * static_cast<int>(profileStats.size() + memoryStats.size());
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+    SDL_Rect bgRect = { x - 10, y - 10, width + 20, height };
+    SDL_RenderFillRect(renderer, &bgRect);
+
+    int graphBottom = y + graphHeight;
+    for (size_t i = 0; i < frameTimes.size(); ++i) {
+        int barHeight = static_cast<int>(std::min(frameTimes[i] / graphScaleMs, 1.0f) * graphHeight);
+        if (frameTimes[i] > budgetMs) SDL_SetRenderDrawColor(renderer, 255, 80, 80, 255);
+        else SDL_SetRenderDrawColor(renderer, 80, 200, 80, 255);
+        SDL_Rect bar = { x + static_cast<int>(i) * 2, graphBottom - barHeight, 2, barHeight };
+        SDL_RenderFillRect(renderer, &bar);
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+    SDL_RenderDrawLine(renderer, x, graphBottom - graphHeight / 2, x + width, graphBottom - graphHeight / 2);
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Color grey = { 180, 180, 180, 255 };
+    int rowY = graphBottom + 10;
+    renderLabel("Scope", x, rowY, grey);
+    renderLabel("avg ms", x + 380, rowY, grey);
+    renderLabel("max ms", x + 500, rowY, grey);
+    rowY += rowHeight + 4;
+
+    char value[32];
+    for (const Profiler::ScopeStats& row : profileStats) {
+        renderLabel(row.name, x + row.depth * 20, rowY, white);
+        snprintf(value, sizeof(value), "%.2f", row.averageMs);
+        renderText(value, x + 380, rowY, white);
+        snprintf(value, sizeof(value), "%.2f", row.maxMs);
+        renderText(value, x + 500, rowY, white);
+        rowY += rowHeight;
+    }
+
+    rowY += 10;
+    renderLabel("Memory", x, rowY, grey);
+    renderLabel("live KB", x + 260, rowY, grey);
+    renderLabel("peak KB", x + 380, rowY, grey);
+    renderLabel("allocs", x + 500, rowY, grey);
+    rowY += rowHeight + 4;
+
+    for (const MemoryStats::CategoryStats& row : memoryStats) {
+        renderLabel(row.vram ? std::string(row.name) + " (vram)" : std::string(row.name), x, rowY, white);
+        snprintf(value, sizeof(value), "%zu", row.liveBytes / 1024);
+        renderText(value, x + 260, rowY, white);
+        snprintf(value, sizeof(value), "%zu", row.peakBytes / 1024);
+        renderText(value, x + 380, rowY, white);
+        snprintf(value, sizeof(value), "%zu", row.frameAllocations);
+        renderText(value, x + 500, rowY, white);
+        rowY += rowHeight;
+    }
 }
@@ -1,35 +0,0 @@
-#include "Vector2D.h"
-#include <cmath>
-
-Vector2D::Vector2D() : x(0), y(0) {}
-Vector2D::Vector2D(float x, float y) : x(x), y(y) {}
-
-Vector2D& Vector2D::operator+=(const Vector2D& v) {
-    x += v.x;
-    y += v.y;
-    return *this;
-}
-
-Vector2D Vector2D::operator+(const Vector2D& v) const {
-    return Vector2D(x + v.x, y + v.y);
-}
-
-Vector2D Vector2D::operator-(const Vector2D& v) const {
-    return Vector2D(x - v.x, y - v.y);
-}
-
-Vector2D Vector2D::operator*(float scalar) const {
-    return Vector2D(x * scalar, y * scalar);
-}
-
-float Vector2D::magnitude() const {
-    return std::sqrt(x * x + y * y);
-}
-
-Vector2D Vector2D::normalize() const {
-    float mag = magnitude();
-    if (mag > 0) {
-        return Vector2D(x / mag, y / mag);
-    }
-    return Vector2D(0, 0);
-}
@@ -0,0 +1,308 @@
+#include "ZombiePool.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+#include "Player.h"
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Zombies per parallel job. A multiple of four so every zombie goes
+    // through the same SSE or scalar path whatever the thread count.
+    const size_t UPDATE_GRAIN = 256;
+
+    // Stateless per-zombie random number for the wander roll, so the result
+    // depends only on (time, slot) and not on which thread runs the slot.
+    Uint32 wanderHash(Uint32 now, Uint32 slot, Uint32 salt) {
+        Uint32 h = now * 0x9E3779B1u ^ slot * 0x85EBCA77u ^ salt * 0xC2B2AE3Du;
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        h *= 0x846CA68Bu;
+        h ^= h >> 16;
+        return h;
+    }
+}
+
+ZombiePool::ZombiePool() : wanderSeed(0) {}
+
+void ZombiePool::setWanderSeed(Uint32 seed) {
+    wanderSeed = seed;
+}
+
+void ZombiePool::reserve(size_t count) {
+    posX.reserve(count); posY.reserve(count);
+    prevX.reserve(count); prevY.reserve(count);
+    velX.reserve(count); velY.reserve(count);
+    speed.reserve(count);
+    detectionRangeSq.reserve(count);
+    attackRangeSq.reserve(count);
+    distSq.reserve(count);
+    health.reserve(count);
+    lastAttackTime.reserve(count);
+    attackDamage.reserve(count);
+    type.reserve(count);
+    state.reserve(count);
+}
+
+void ZombiePool::clear() {
+    posX.clear(); posY.clear();
+    prevX.clear(); prevY.clear();
+    velX.clear(); velY.clear();
+    speed.clear();
+    detectionRangeSq.clear();
+    attackRangeSq.clear();
+    distSq.clear();
+    health.clear();
+    lastAttackTime.clear();
+    attackDamage.clear();
+    type.clear();
+    state.clear();
+    attacks.clear();
+}
+
+int ZombiePool::spawn(const Vector2D& pos, ZombieType t) {
+    const ZombieStats& stats = ZOMBIE_STATS[t];
+
+    posX.push_back(pos.x);
+    posY.push_back(pos.y);
+    prevX.push_back(pos.x);
+    prevY.push_back(pos.y);
+    velX.push_back(0.0f);
+    velY.push_back(0.0f);
+    speed.push_back(stats.speed);
+    detectionRangeSq.push_back(stats.detectionRange * stats.detectionRange);
+    attackRangeSq.push_back(stats.attackRange * stats.attackRange);
+    distSq.push_back(0.0f);
+    health.push_back(stats.health);
+    lastAttackTime.push_back(0);
+    attackDamage.push_back(0);
+    type.push_back(static_cast<Uint8>(t));
+    state.push_back(ZOMBIE_ACTIVE);
+
+    return static_cast<int>(posX.size()) - 1;
+}
+
+// Pursuit pass: distance, normalize and velocity for every zombie with no
+// branches, so the SSE path and the scalar tail produce the same values.
+void ZombiePool::steer(size_t begin, size_t end, float targetX, float targetY) {
+    const float* __restrict x = posX.data();
+    const float* __restrict y = posY.data();
+    const float* __restrict spd = speed.data();
+    const float* __restrict detect = detectionRangeSq.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+    float* __restrict d2 = distSq.data();
+
+    size_t i = begin;
+#if defined(__SSE2__)
+    const __m128 tx = _mm_set1_ps(targetX);
+    const __m128 ty = _mm_set1_ps(targetY);
+    const __m128 epsilon = _mm_set1_ps(1e-6f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 dx = _mm_sub_ps(tx, _mm_loadu_ps(x + i));
+        __m128 dy = _mm_sub_ps(ty, _mm_loadu_ps(y + i));
+        __m128 distSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 scale = _mm_div_ps(_mm_loadu_ps(spd + i), _mm_max_ps(_mm_sqrt_ps(distSquared), epsilon));
+        __m128 chase = _mm_cmple_ps(distSquared, _mm_loadu_ps(detect + i));
+
+        __m128 newVx = _mm_mul_ps(dx, scale);
+        __m128 newVy = _mm_mul_ps(dy, scale);
+        _mm_storeu_ps(vx + i, _mm_or_ps(_mm_and_ps(chase, newVx), _mm_andnot_ps(chase, _mm_loadu_ps(vx + i))));
+        _mm_storeu_ps(vy + i, _mm_or_ps(_mm_and_ps(chase, newVy), _mm_andnot_ps(chase, _mm_loadu_ps(vy + i))));
+        _mm_storeu_ps(d2 + i, distSquared);
+    }
+#endif
+    for (; i < end; ++i) {
+        float dx = targetX - x[i];
+        float dy = targetY - y[i];
+        float distSquared = dx * dx + dy * dy;
+        float scale = spd[i] / std::max(std::sqrt(distSquared), 1e-6f);
+        bool chase = distSquared <= detect[i];
+        vx[i] = chase ? dx * scale : vx[i];
+        vy[i] = chase ? dy * scale : vy[i];
+        d2[i] = distSquared;
+    }
+}
+
+void ZombiePool::savePreviousState() {
+    prevX = posX;
+    prevY = posY;
+}
+
+void ZombiePool::updateAll(const Player& player, Uint32 now, const FlowField* flow, JobSystem* jobs) {
+    PROFILE_SCOPE("ZombiePool::updateAll");
+    Vector2D target = player.getPosition();
+    const size_t count = posX.size();
+
+    auto update = [&](size_t begin, size_t end) {
+        updateRange(begin, end, target.x, target.y, now, flow);
+    };
+    if (jobs) {
+        jobs->parallelFor(count, UPDATE_GRAIN, update);
+    } else {
+        update(0, count);
+    }
+
+    // Serial resolve: attack intents are gathered in slot order, so the
+    // player takes the same hits in the same order as a single-thread run.
+    attacks.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (attackDamage[i] > 0) attacks.push_back(attackDamage[i]);
+    }
+}
+
+// Everything here only touches slots in [begin, end) and reads shared state,
+// so disjoint ranges can run on different threads.
+void ZombiePool::updateRange(size_t begin, size_t end, float targetX, float targetY, Uint32 now, const FlowField* flow) {
+    steer(begin, end, targetX, targetY);
+
+    for (size_t i = begin; i < end; ++i) {
+        attackDamage[i] = 0;
+        if (state[i] != ZOMBIE_ACTIVE) continue;
+
+        if (distSq[i] > detectionRangeSq[i]) {
+            Uint32 roll = wanderHash(now ^ wanderSeed, static_cast<Uint32>(i), 0);
+            if (roll % 100 < 5) {
+                velX[i] = (static_cast<int>(wanderHash(now ^ wanderSeed, static_cast<Uint32>(i), 1) % 3) - 1) * speed[i] * 0.5f;
+                velY[i] = (static_cast<int>(wanderHash(now ^ wanderSeed, static_cast<Uint32>(i), 2) % 3) - 1) * speed[i] * 0.5f;
+            }
+        } else if (flow) {
+            float dirX, dirY;
+            if (flow->sample(posX[i] + TILE_SIZE / 2, posY[i] + TILE_SIZE / 2, dirX, dirY)) {
+                velX[i] = dirX * speed[i];
+                velY[i] = dirY * speed[i];
+            }
+        }
+
+        if (distSq[i] <= attackRangeSq[i]) {
+            const ZombieStats& stats = ZOMBIE_STATS[type[i]];
+            if (now - lastAttackTime[i] >= stats.attackCooldown) {
+                attackDamage[i] = stats.damage;
+                lastAttackTime[i] = now;
+                if (type[i] == EXPLODER) {
+                    state[i] = ZOMBIE_DEAD;
+                }
+            }
+        }
+
+        posX[i] += velX[i];
+        posY[i] += velY[i];
+    }
+}
+
+void ZombiePool::removeDead() {
+    size_t i = 0;
+    while (i < posX.size()) {
+        if (state[i] != ZOMBIE_DEAD) {
+            ++i;
+            continue;
+        }
+
+        size_t last = posX.size() - 1;
+        posX[i] = posX[last]; posX.pop_back();
+        posY[i] = posY[last]; posY.pop_back();
+        prevX[i] = prevX[last]; prevX.pop_back();
+        prevY[i] = prevY[last]; prevY.pop_back();
+        velX[i] = velX[last]; velX.pop_back();
+        velY[i] = velY[last]; velY.pop_back();
+        speed[i] = speed[last]; speed.pop_back();
+        detectionRangeSq[i] = detectionRangeSq[last]; detectionRangeSq.pop_back();
+        attackRangeSq[i] = attackRangeSq[last]; attackRangeSq.pop_back();
+        distSq[i] = distSq[last]; distSq.pop_back();
+        health[i] = health[last]; health.pop_back();
+        lastAttackTime[i] = lastAttackTime[last]; lastAttackTime.pop_back();
+        attackDamage[i] = attackDamage[last]; attackDamage.pop_back();
+        type[i] = type[last]; type.pop_back();
+        state[i] = state[last]; state.pop_back();
+    }
+}
+
+const std::vector<int>& ZombiePool::getAttacks() const {
+    return attacks;
+}
+
+void ZombiePool::collectOverlapping(const Rectangle& rect, std::vector<int>& out) const {
+    const size_t count = posX.size();
+    for (size_t i = 0; i < count; ++i) {
+        bool overlaps = posX[i] < rect.x + rect.w && posX[i] + TILE_SIZE > rect.x &&
+                        posY[i] < rect.y + rect.h && posY[i] + TILE_SIZE > rect.y;
+        if (overlaps && state[i] != ZOMBIE_DEAD) {
+            out.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+void ZombiePool::render(SpriteBatch& batch, const Camera& camera, const AtlasRegion sprites[], float alpha) const {
+    PROFILE_SCOPE("ZombiePool::render");
+    SDL_Rect viewport = camera.getViewport();
+
+    const size_t count = posX.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (state[i] == ZOMBIE_DEAD) continue;
+
+        float x = prevX[i] + (posX[i] - prevX[i]) * alpha;
+        float y = prevY[i] + (posY[i] - prevY[i]) * alpha;
+        int screenX = static_cast<int>(x - viewport.x);
+        int screenY = static_cast<int>(y - viewport.y);
+        if (screenX + TILE_SIZE <= 0 || screenX >= viewport.w ||
+            screenY + TILE_SIZE <= 0 || screenY >= viewport.h) {
+            continue;
+        }
+
+        SDL_Rect destRect = { screenX, screenY, TILE_SIZE, TILE_SIZE };
+        batch.draw(sprites[type[i]].texture, sprites[type[i]].rect, destRect, LAYER_ZOMBIES);
+    }
+}
+
+Uint64 ZombiePool::checksum() const {
+    // FNV-1a over the raw bits of the simulated fields.
+    Uint64 hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+    };
+    mix(posX.data(), posX.size() * sizeof(float));
+    mix(posY.data(), posY.size() * sizeof(float));
+    mix(velX.data(), velX.size() * sizeof(float));
+    mix(velY.data(), velY.size() * sizeof(float));
+    mix(health.data(), health.size() * sizeof(int));
+    mix(state.data(), state.size());
+    return hash;
+}
+
+size_t ZombiePool::size() const { return posX.size(); }
+
+Vector2D ZombiePool::getPosition(int index) const {
+    return Vector2D(posX[index], posY[index]);
+}
+
+void ZombiePool::setPosition(int index, const Vector2D& pos) {
+    posX[index] = pos.x;
+    posY[index] = pos.y;
+}
+
+Rectangle ZombiePool::getCollider(int index) const {
+    return Rectangle(posX[index], posY[index], TILE_SIZE, TILE_SIZE);
+}
+
+ZombieType ZombiePool::getType(int index) const { return static_cast<ZombieType>(type[index]); }
+int ZombiePool::getHealth(int index) const { return health[index]; }
+bool ZombiePool::isActive(int index) const { return state[index] != ZOMBIE_DEAD; }
+ZombieState ZombiePool::getState(int index) const { return static_cast<ZombieState>(state[index]); }
+
+void ZombiePool::setFrozen(int index, bool frozen) {
+    if (state[index] == ZOMBIE_DEAD) return;
+    state[index] = frozen ? ZOMBIE_FROZEN : ZOMBIE_ACTIVE;
+}
+
+void ZombiePool::takeDamage(int index, int amount) {
+    health[index] -= amount;
+    if (health[index] <= 0) {
+        state[index] = ZOMBIE_DEAD;
+    }
+}
@@ -1,25 +1,64 @@
 #include "Game.h"
-#include <stdio.h>
+#include "../../common/include/log.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
+#include <cstring>
 
 int main(int argc, char* argv[]) {
+    Log::start("game.log");
+
     Game game;
-    printf("About to do game.init\n");
+    LOG_INFO(LOG_CAT_GAME, "About to do game.init");
     if (!game.init("Zombie Survival", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, false)) {
         std::cerr << "Game initialization failed!" << std::endl;
+        Log::stop();
         return 1;
     }
-    printf("Game is about to be running\n");
+    // --record <file> saves this session's input for GameBench --replay.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--record") == 0 && !game.startRecording(argv[i + 1])) {
+            std::cerr << "Could not start recording to " << argv[i + 1] << std::endl;
+        }
+    }
+    // --bake-atlas writes the atlas packed at this startup as the prebuilt
+    // one loaded by later runs.
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bake-atlas") == 0 && !game.saveAtlas()) {
+            std::cerr << "Could not write the texture atlas" << std::endl;
+        }
+    }
+    LOG_INFO(LOG_CAT_GAME, "Game is about to be running");
+    // Fixed-timestep loop: real elapsed time is banked in an accumulator and
+    // spent in whole SIM_STEP_MS updates, capped so a long stall cannot spiral.
+    // Rendering is paced by vsync and interpolates between the last two steps.
+    const double counterToMs = 1000.0 / SDL_GetPerformanceFrequency();
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+
     while (game.isRunning()) {
-        Uint32 frameStart = SDL_GetTicks();
+        Profiler::beginFrame();
+        Uint64 counter = SDL_GetPerformanceCounter();
+        accumulator += (counter - previousCounter) * counterToMs;
+        previousCounter = counter;
 
         game.handleEvents();
-        printf("HandleEvents\n");
-        game.update();
-        printf("About to run game render\n");
-        game.render();
 
-        game.capFrameRate(frameStart);
+        int steps = 0;
+        while (accumulator >= SIM_STEP_MS && steps < MAX_SIM_STEPS_PER_FRAME) {
+            game.update();
+            accumulator -= SIM_STEP_MS;
+            ++steps;
+        }
+        if (steps == MAX_SIM_STEPS_PER_FRAME && accumulator >= SIM_STEP_MS) {
+            accumulator = 0.0;
+        }
+
+        game.render(static_cast<float>(accumulator / SIM_STEP_MS));
+        Profiler::endFrame();
+        MemoryStats::endFrame();
     }
 
+    game.stopRecording();
+    Log::stop();
     return 0;
 }
@@ -13,18 +13,43 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <list>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "../../common/include/section_file.h"
+#include "../../common/include/log.h"
+#include "../../common/include/chunk_world.h"
+#include "../../common/include/vec2.h"
+#include "../../common/include/camera.h"
+#include "../../common/include/collision.h"
 
 // Constants
 const int SCREEN_WIDTH = 1920;
 const int SCREEN_HEIGHT = 1080;
-const int MAP_WIDTH = 2000;
-const int MAP_HEIGHT = 2000;
 const int TILE_SIZE = 32;
+const int WORLD_CHUNK_TILES = chunk_world::CHUNK_TILES;
+const int WORLD_CHUNK_PIXELS = WORLD_CHUNK_TILES * TILE_SIZE;
+const int WORLD_CHUNKS = 128; // world edge in chunks
+const int MAP_WIDTH = WORLD_CHUNKS * WORLD_CHUNK_PIXELS;
+const int MAP_HEIGHT = WORLD_CHUNKS * WORLD_CHUNK_PIXELS;
+const int CHUNK_PRELOAD_MARGIN = 2; // chunks requested beyond the view on each side
+const int MAX_RESIDENT_CHUNKS = 512;
+const int SPAWN_RADIUS = 1500; // zombies and loose items appear this close to the player
 const int PLAYER_SPEED = 5;
 const int MAX_FPS = 60;
 const int FRAME_DELAY = 1000 / MAX_FPS;
 const int DAY_NIGHT_CYCLE_DURATION = 600000; // 10 minutes in milliseconds
 const float DAY_RATIO = 0.7f; // 70% day, 30% night
+const Uint32 AUTOSAVE_INTERVAL = 60000; // 1 minute in milliseconds
+const char* const AUTOSAVE_PATH = "autosave.zsav";
+const char* const QUICKSAVE_PATH = "quicksave.zsav";
 
 // Game States
 enum GameState {
@@ -79,49 +104,9 @@ class Item;
 class Building;
 class Game;
 
-// Utility functions
-float distance(float x1, float y1, float x2, float y2) {
-    return std::sqrt(std::pow(x2 - x1, 2) + std::pow(y2 - y1, 2));
-}
-
-// Vector2D struct for positions and velocities
-struct Vector2D {
-    float x;
-    float y;
-
-    Vector2D() : x(0), y(0) {}
-    Vector2D(float x, float y) : x(x), y(y) {}
-
-    Vector2D& operator+=(const Vector2D& v) {
-        x += v.x;
-        y += v.y;
-        return *this;
-    }
-
-    Vector2D operator+(const Vector2D& v) const {
-        return Vector2D(x + v.x, y + v.y);
-    }
-
-    Vector2D operator-(const Vector2D& v) const {
-        return Vector2D(x - v.x, y - v.y);
-    }
-
-    Vector2D operator*(float scalar) const {
-        return Vector2D(x * scalar, y * scalar);
-    }
-
-    float magnitude() const {
-        return std::sqrt(x * x + y * y);
-    }
-
-    Vector2D normalize() const {
-        float mag = magnitude();
-        if (mag > 0) {
-            return Vector2D(x / mag, y / mag);
-        }
-        return Vector2D(0, 0);
-    }
-};
+// Positions and velocities are the shared engine vector; length(),
+// normalize() and distance() are free functions in namespace engine.
+typedef engine::Vec2 Vector2D;
 
 // Rectangle struct for collision detection
 struct Rectangle {
@@ -130,11 +115,12 @@ struct Rectangle {
     Rectangle() : x(0), y(0), w(0), h(0) {}
     Rectangle(float x, float y, float w, float h) : x(x), y(y), w(w), h(h) {}
 
+    engine::Box box() const {
+        return batch_aabb::makeBox(x, y, w, h);
+    }
+
     bool intersects(const Rectangle& other) const {
-        return (x < other.x + other.w &&
-                x + w > other.x &&
-                y < other.y + other.h &&
-                y + h > other.y);
+        return engine::overlaps(box(), other.box());
     }
 
     bool contains(float px, float py) const {
@@ -142,50 +128,201 @@ struct Rectangle {
     }
 };
 
-// Camera class to handle viewport
+// Camera class to handle viewport: the shared engine camera, with the view
+// kept on whole pixels.
 class Camera {
 private:
-    SDL_Rect viewport;
-    int mapWidth, mapHeight;
+    engine::Camera view;
 
 public:
-    Camera(int mapWidth, int mapHeight) : mapWidth(mapWidth), mapHeight(mapHeight) {
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.w = SCREEN_WIDTH;
-        viewport.h = SCREEN_HEIGHT;
-    }
+    Camera(int mapWidth, int mapHeight) : view(SCREEN_WIDTH, SCREEN_HEIGHT, mapWidth, mapHeight) {}
 
     void update(const Vector2D& target) {
-        viewport.x = static_cast<int>(target.x - SCREEN_WIDTH / 2);
-        viewport.y = static_cast<int>(target.y - SCREEN_HEIGHT / 2);
-
-        if (viewport.x < 0) viewport.x = 0;
-        if (viewport.y < 0) viewport.y = 0;
-        if (viewport.x > mapWidth - viewport.w) viewport.x = mapWidth - viewport.w;
-        if (viewport.y > mapHeight - viewport.h) viewport.y = mapHeight - viewport.h;
+        view.follow(target);
+        Vector2D position = view.position();
+        view.moveTo(Vector2D(static_cast<int>(position.x), static_cast<int>(position.y)));
     }
 
     SDL_Rect getViewport() const {
+        Vector2D position = view.position();
+        SDL_Rect viewport = { static_cast<int>(position.x), static_cast<int>(position.y),
+                              SCREEN_WIDTH, SCREEN_HEIGHT };
         return viewport;
     }
 
     bool isVisible(const Rectangle& rect) const {
-        return (rect.x + rect.w > viewport.x &&
-                rect.x < viewport.x + viewport.w &&
-                rect.y + rect.h > viewport.y &&
-                rect.y < viewport.y + viewport.h);
+        return view.isVisible(rect.box());
     }
 
     Vector2D worldToScreen(const Vector2D& worldPos) const {
-        return Vector2D(worldPos.x - viewport.x, worldPos.y - viewport.y);
+        return view.worldToScreen(worldPos);
     }
 
     Vector2D screenToWorld(const Vector2D& screenPos) const {
-        return Vector2D(screenPos.x + viewport.x, screenPos.y + viewport.y);
+        return view.screenToWorld(screenPos);
+    }
+};
+
+// Draw order of world sprites; lower layers are drawn first.
+enum RenderLayer {
+    LAYER_BUILDINGS,
+    LAYER_ITEMS,
+    LAYER_ZOMBIES,
+    LAYER_PLAYER
+};
+
+// SpriteBatch collects textured quads for a frame and draws them sorted by
+// layer, then texture, with one SDL_RenderGeometry call per run of the same
+// texture. Sprites sharing a layer and texture keep their submission order.
+class SpriteBatch {
+private:
+    struct Sprite {
+        SDL_Texture* texture;
+        SDL_Rect src;
+        SDL_Rect dst;
+        int layer;
+        Uint32 order;
+    };
+
+    SDL_Renderer* renderer;
+    std::vector<Sprite> sprites;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    void drawRun(size_t begin, size_t end) {
+        SDL_Texture* texture = sprites[begin].texture;
+        int textureWidth = 0, textureHeight = 0;
+        SDL_QueryTexture(texture, nullptr, nullptr, &textureWidth, &textureHeight);
+        if (textureWidth <= 0 || textureHeight <= 0) return;
+
+        const float invW = 1.0f / textureWidth;
+        const float invH = 1.0f / textureHeight;
+        const SDL_Color white = { 255, 255, 255, 255 };
+
+        vertices.clear();
+        indices.clear();
+        for (size_t i = begin; i < end; ++i) {
+            const Sprite& sprite = sprites[i];
+            float x0 = static_cast<float>(sprite.dst.x), y0 = static_cast<float>(sprite.dst.y);
+            float x1 = x0 + sprite.dst.w, y1 = y0 + sprite.dst.h;
+            float u0 = sprite.src.x * invW, v0 = sprite.src.y * invH;
+            float u1 = (sprite.src.x + sprite.src.w) * invW, v1 = (sprite.src.y + sprite.src.h) * invH;
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({ { x0, y0 }, white, { u0, v0 } });
+            vertices.push_back({ { x1, y0 }, white, { u1, v0 } });
+            vertices.push_back({ { x1, y1 }, white, { u1, v1 } });
+            vertices.push_back({ { x0, y1 }, white, { u0, v1 } });
+
+            indices.push_back(base);
+            indices.push_back(base + 1);
+            indices.push_back(base + 2);
+            indices.push_back(base);
+            indices.push_back(base + 2);
+            indices.push_back(base + 3);
+        }
+
+        if (SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size())) != 0) {
+            // Renderer without geometry support: same order, one copy per sprite.
+            for (size_t i = begin; i < end; ++i) {
+                SDL_RenderCopy(renderer, texture, &sprites[i].src, &sprites[i].dst);
+            }
+        }
+    }
+
+public:
+    explicit SpriteBatch(SDL_Renderer* renderer) : renderer(renderer) {}
+
+    void draw(SDL_Texture* texture, const SDL_Rect& src, const SDL_Rect& dst, int layer) {
+        if (!texture) return;
+        sprites.push_back({ texture, src, dst, layer, static_cast<Uint32>(sprites.size()) });
+    }
+
+    void flush() {
+        std::sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) {
+            if (a.layer != b.layer) return a.layer < b.layer;
+            if (a.texture != b.texture) return a.texture < b.texture;
+            return a.order < b.order;
+        });
+
+        size_t begin = 0;
+        while (begin < sprites.size()) {
+            size_t end = begin + 1;
+            while (end < sprites.size() && sprites[end].texture == sprites[begin].texture &&
+                   sprites[end].layer == sprites[begin].layer) {
+                ++end;
+            }
+            drawRun(begin, end);
+            begin = end;
+        }
+
+        sprites.clear();
     }
 };
 
+// Save file layout. A save is a common/include/section_file.h file: one
+// header followed by flat arrays of the records below, which a loader maps
+// and reads in place. Records hold indices instead of pointers (home
+// base, building contents) and timers relative to the save moment; textures
+// and names are restored from the type. Terrain is not stored, it is rebuilt
+// from the world seed. Bump SAVE_VERSION whenever a record changes.
+const char SAVE_MAGIC[4] = { 'Z', 'S', 'A', 'V' };
+const uint32_t SAVE_VERSION = 2;
+const int SAVE_ITEM_TYPES = AMMO + 1;
+
+typedef section_file::Section SaveSection;
+
+struct PlayerRecord {
+    float x, y;
+    int32_t health, maxHealth, armor, weaponPower;
+    int32_t facing;
+    int32_t isInside;
+    int32_t homeBase; // building index, -1 for none
+    int32_t inventory[SAVE_ITEM_TYPES];
+};
+
+struct ZombieRecord {
+    float x, y, vx, vy;
+    int32_t type;
+    int32_t health;
+    uint32_t sinceAttack;
+    uint8_t active, exploded, padding[2];
+};
+
+struct ItemRecord {
+    float x, y;
+    int32_t type;
+    int32_t value;
+};
+
+struct BuildingRecord {
+    float x, y;
+    int32_t w, h;
+    int32_t style;      // buildingTextures index
+    uint32_t firstItem; // range in the stored items section
+    uint32_t itemCount;
+    int32_t storage[SAVE_ITEM_TYPES];
+};
+
+struct SaveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    uint32_t worldSeed;
+    uint32_t worldChunks; // world edge in chunks
+    uint32_t gameTime;
+    uint32_t timeOfDay;
+    uint32_t sinceZombieSpawn;
+    uint32_t sinceTimeUpdate;
+    SaveSection populatedChunks; // one byte per chunk, row-major
+    SaveSection zombies;
+    SaveSection buildings;
+    SaveSection items;       // lying in the world
+    SaveSection storedItems; // inside buildings
+    PlayerRecord player;
+};
+
 // Base Entity class
 class Entity {
 protected:
@@ -223,10 +360,11 @@ public:
         collider.y = position.y;
     }
 
-    virtual void render(SDL_Renderer* renderer, const Camera& camera) {
+    // Queues the sprite on the batch for this frame.
+    virtual void render(SpriteBatch& batch, const Camera& camera, int layer) {
         if (!active || !texture) {
             if (!texture) {
-                std::cout << "Warning: Entity at (" << position.x << ", " << position.y << ") has nullptr texture." << std::endl;
+                LOG_WARN(LOG_CAT_RENDER, "Entity at ({}, {}) has nullptr texture.", position.x, position.y);
             }
             return;
         }
@@ -235,7 +373,7 @@ public:
         destRect.x = static_cast<int>(screenPos.x);
         destRect.y = static_cast<int>(screenPos.y);
 
-        SDL_RenderCopy(renderer, texture, &srcRect, &destRect);
+        batch.draw(texture, srcRect, destRect, layer);
     }
 
     bool isActive() const { return active; }
@@ -270,6 +408,20 @@ public:
     std::string getName() const { return name; }
 };
 
+const char* itemTypeName(ItemType type) {
+    switch (type) {
+        case WEAPON: return "Weapon Upgrade";
+        case ARMOR: return "Armor Piece";
+        case HEALTH: return "Health Pack";
+        case RESOURCE_WOOD: return "Wood";
+        case RESOURCE_METAL: return "Metal";
+        case RESOURCE_FOOD: return "Food";
+        case RESOURCE_CLOTH: return "Cloth";
+        case AMMO: return "Ammo";
+    }
+    return "";
+}
+
 // Inventory class
 class Inventory {
 private:
@@ -318,6 +470,18 @@ public:
         return total;
     }
 
+    void writeCounts(int32_t* counts) const {
+        for (int type = 0; type < SAVE_ITEM_TYPES; ++type) {
+            counts[type] = getItemCount(static_cast<ItemType>(type));
+        }
+    }
+
+    void readCounts(const int32_t* counts) {
+        for (int type = 0; type < SAVE_ITEM_TYPES; ++type) {
+            items[static_cast<ItemType>(type)] = counts[type];
+        }
+    }
+
     void transferTo(Inventory& other, ItemType type, int amount) {
         int available = std::min(amount, items[type]);
         if (available <= 0) return;
@@ -348,8 +512,7 @@ public:
         facing(DOWN), homeBase(nullptr), isInside(false) {}
 
     void update() override {
-        std::cout << "Player position before update: ("
-                  << position.x << ", " << position.y << ")" << std::endl;
+        LOG_TRACE(LOG_CAT_PLAYER, "Player position before update: ({}, {})", position.x, position.y);
 
         Entity::update();
 
@@ -358,9 +521,8 @@ public:
         if (position.x > MAP_WIDTH - collider.w) position.x = MAP_WIDTH - collider.w;
         if (position.y > MAP_HEIGHT - collider.h) position.y = MAP_HEIGHT - collider.h;
 
-        std::cout << "Player position after update: ("
-                  << position.x << ", " << position.y << "), Health: "
-                  << health << "/" << maxHealth << std::endl;
+        LOG_TRACE(LOG_CAT_PLAYER, "Player position after update: ({}, {}), Health: {}/{}",
+                  position.x, position.y, health, maxHealth);
     }
 
     void handleInput(const Uint8* keystates) {
@@ -384,7 +546,7 @@ public:
         }
 
         if (velocity.x != 0 && velocity.y != 0) {
-            velocity = velocity.normalize() * PLAYER_SPEED;
+            velocity = engine::normalize(velocity) * PLAYER_SPEED;
         }
     }
 
@@ -413,6 +575,30 @@ public:
     void upgradeWeapon(int amount) { weaponPower += amount; }
     void upgradeArmor(int amount) { armor += amount; }
     void upgradeMaxHealth(int amount) { maxHealth += amount; health = std::min(health + amount, maxHealth); }
+
+    // The home base index is filled in by Game, which owns the buildings.
+    void writeRecord(PlayerRecord& record) const {
+        record.x = position.x;
+        record.y = position.y;
+        record.health = health;
+        record.maxHealth = maxHealth;
+        record.armor = armor;
+        record.weaponPower = weaponPower;
+        record.facing = facing;
+        record.isInside = isInside ? 1 : 0;
+        inventory.writeCounts(record.inventory);
+    }
+
+    void readRecord(const PlayerRecord& record) {
+        setPosition(Vector2D(record.x, record.y));
+        health = record.health;
+        maxHealth = record.maxHealth;
+        armor = record.armor;
+        weaponPower = record.weaponPower;
+        facing = static_cast<Direction>(record.facing);
+        isInside = record.isInside != 0;
+        inventory.readCounts(record.inventory);
+    }
 };
 
 // Zombie class
@@ -473,21 +659,20 @@ public:
         if (!active || exploded) return;
 
         Vector2D playerPos = player.getPosition();
-        float dist = distance(position.x, position.y, playerPos.x, playerPos.y);
+        float dist = engine::distance(position, playerPos);
 
-        std::cout << "Zombie type " << type << " at (" << position.x << ", " << position.y
-                  << "), Distance to player: " << dist << std::endl;
+        LOG_TRACE(LOG_CAT_ZOMBIE, "Zombie type {} at ({}, {}), Distance to player: {}",
+                  type, position.x, position.y, dist);
 
         if (dist <= detectionRange) {
-            Vector2D direction = (playerPos - position).normalize();
+            Vector2D direction = engine::normalize(playerPos - position);
             velocity = direction * speed;
-            std::cout << "Zombie pursuing player, Speed: " << speed << std::endl;
+            LOG_TRACE(LOG_CAT_ZOMBIE, "Zombie pursuing player, Speed: {}", speed);
         } else {
             if (rand() % 100 < 5) {
                 velocity.x = (rand() % 3 - 1) * speed * 0.5f;
                 velocity.y = (rand() % 3 - 1) * speed * 0.5f;
-                std::cout << "Zombie random movement: ("
-                          << velocity.x << ", " << velocity.y << ")" << std::endl;
+                LOG_TRACE(LOG_CAT_ZOMBIE, "Zombie random movement: ({}, {})", velocity.x, velocity.y);
             }
         }
 
@@ -522,6 +707,29 @@ public:
     ZombieType getType() const { return type; }
     int getHealth() const { return health; }
     int getDamage() const { return damage; }
+
+    void writeRecord(ZombieRecord& record, Uint32 now) const {
+        record.x = position.x;
+        record.y = position.y;
+        record.vx = velocity.x;
+        record.vy = velocity.y;
+        record.type = type;
+        record.health = health;
+        record.sinceAttack = now - lastAttackTime;
+        record.active = active ? 1 : 0;
+        record.exploded = exploded ? 1 : 0;
+        record.padding[0] = record.padding[1] = 0;
+    }
+
+    // The constructor has already set the per-type stats.
+    void readRecord(const ZombieRecord& record, Uint32 now) {
+        setPosition(Vector2D(record.x, record.y));
+        velocity = Vector2D(record.vx, record.vy);
+        health = record.health;
+        lastAttackTime = now - record.sinceAttack;
+        active = record.active != 0;
+        exploded = record.exploded != 0;
+    }
 };
 
 // Building class
@@ -579,28 +787,160 @@ public:
     Inventory& getStorage() { return storage; }
 };
 
-// TileMap class for the game world
+// Read-only bounding volume hierarchy over building colliders. Buildings
+// never move, so the tree is only rebuilt when chunks streaming in add new
+// ones, and queried in between. Nodes are packed depth-first into one array: a node's left child is
+// the next element, only the right child needs an index.
+class BuildingTree {
+private:
+    static const int LEAF_SIZE = 4;
+    static const int MAX_DEPTH = 64;
+
+    struct Node {
+        float minX, minY, maxX, maxY;
+        int32_t right; // internal nodes: index of the right child
+        int32_t first; // leaves: range in buildings
+        int32_t count; // 0 for internal nodes
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Building*> buildings;
+
+    int buildNode(int first, int count) {
+        Node node;
+        node.minX = node.minY = std::numeric_limits<float>::max();
+        node.maxX = node.maxY = -std::numeric_limits<float>::max();
+        for (int i = first; i < first + count; ++i) {
+            Rectangle rect = buildings[i]->getCollider();
+            node.minX = std::min(node.minX, rect.x);
+            node.minY = std::min(node.minY, rect.y);
+            node.maxX = std::max(node.maxX, rect.x + rect.w);
+            node.maxY = std::max(node.maxY, rect.y + rect.h);
+        }
+        node.right = -1;
+        node.first = first;
+        node.count = count;
+
+        int index = static_cast<int>(nodes.size());
+        nodes.push_back(node);
+        if (count <= LEAF_SIZE) return index;
+
+        // Split at the median centre along the longer side of the bounds.
+        bool splitX = node.maxX - node.minX >= node.maxY - node.minY;
+        int half = count / 2;
+        std::nth_element(buildings.begin() + first, buildings.begin() + first + half, buildings.begin() + first + count,
+                         [splitX](const Building* a, const Building* b) {
+                             Rectangle ra = a->getCollider();
+                             Rectangle rb = b->getCollider();
+                             return splitX ? ra.x + ra.w * 0.5f < rb.x + rb.w * 0.5f
+                                           : ra.y + ra.h * 0.5f < rb.y + rb.h * 0.5f;
+                         });
+
+        buildNode(first, half);
+        int right = buildNode(first + half, count - half);
+        nodes[index].right = right;
+        nodes[index].count = 0;
+        return index;
+    }
+
+public:
+    void build(const std::vector<std::unique_ptr<Building>>& all) {
+        clear();
+        if (all.empty()) return;
+
+        buildings.reserve(all.size());
+        for (const auto& building : all) {
+            buildings.push_back(building.get());
+        }
+        nodes.reserve(2 * all.size() / LEAF_SIZE + 1);
+        buildNode(0, static_cast<int>(buildings.size()));
+    }
+
+    void clear() {
+        nodes.clear();
+        buildings.clear();
+    }
+
+    // Appends every building whose collider intersects area.
+    void queryOverlap(const Rectangle& area, std::vector<Building*>& out) const {
+        if (nodes.empty()) return;
+
+        int stack[MAX_DEPTH];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (area.x >= node.maxX || area.x + area.w <= node.minX ||
+                area.y >= node.maxY || area.y + area.h <= node.minY) continue;
+
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    if (area.intersects(buildings[i]->getCollider())) out.push_back(buildings[i]);
+                }
+            } else {
+                stack[top++] = node.right;
+                stack[top++] = static_cast<int>(&node - nodes.data()) + 1;
+            }
+        }
+    }
+
+    // Building whose interior contains point, or nullptr. Buildings are
+    // placed with a gap between them, so there is at most one.
+    Building* findContaining(const Vector2D& point) const {
+        if (nodes.empty()) return nullptr;
+
+        int stack[MAX_DEPTH];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (point.x < node.minX || point.x > node.maxX ||
+                point.y < node.minY || point.y > node.maxY) continue;
+
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    if (buildings[i]->isInside(point)) return buildings[i];
+                }
+            } else {
+                stack[top++] = node.right;
+                stack[top++] = static_cast<int>(&node - nodes.data()) + 1;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// TileMap class for the game world. Terrain streams in chunks from a
+// common/include/chunk_world.h ChunkStore: stream() asks for the chunks
+// around the view and evicts the least recently used ones past
+// MAX_RESIDENT_CHUNKS, and a gameplay query into a chunk that hasn't
+// arrived yet generates it on the spot.
 class TileMap {
 private:
-    std::vector<std::vector<int>> map;
+    static const Uint8 OBSTACLE_TILE = 2;
+
     SDL_Texture* tileset;
     std::vector<SDL_Rect> tileRects;
     int mapWidth, mapHeight;
     int tileSize;
+    int cols, rows;
+    int chunkCols, chunkRows;
+    mutable chunk_world::ChunkStore<chunk_world::Chunk> chunks;
 
 public:
-    TileMap(SDL_Texture* tiles, int width, int height, int tileSize) :
-        tileset(tiles), mapWidth(width), mapHeight(height), tileSize(tileSize) {
+    TileMap(SDL_Texture* tiles, int width, int height, int tileSize, Uint32 seed) :
+        tileset(tiles), mapWidth(width), mapHeight(height), tileSize(tileSize), chunks(seed, OBSTACLE_TILE) {
 
-        map.resize(mapHeight / tileSize);
-        for (auto& row : map) {
-            row.resize(mapWidth / tileSize, 0);
-        }
+        cols = mapWidth / tileSize;
+        rows = mapHeight / tileSize;
+        chunkCols = (cols + WORLD_CHUNK_TILES - 1) / WORLD_CHUNK_TILES;
+        chunkRows = (rows + WORLD_CHUNK_TILES - 1) / WORLD_CHUNK_TILES;
 
         int tilesetWidth, tilesetHeight;
         SDL_QueryTexture(tileset, nullptr, nullptr, &tilesetWidth, &tilesetHeight);
 
-	printf("Value is %d, Value is %d/n", tilesetWidth, tilesetHeight);
+        LOG_DEBUG(LOG_CAT_TILEMAP, "Tileset size {}x{}, world {}x{} chunks, seed {}",
+                  tilesetWidth, tilesetHeight, chunkCols, chunkRows, seed);
 
         for (int y = 0; y < tilesetHeight; y += tileSize) {
             for (int x = 0; x < tilesetWidth; x += tileSize) {
@@ -608,84 +948,280 @@ public:
                 tileRects.push_back(rect);
             }
         }
-
-        generateTerrain();
     }
 
-    void generateTerrain() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<int> tileTypeDist(0, tileRects.size() - 1);
-        std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
-
-        for (int y = 0; y < map.size(); ++y) {
-            for (int x = 0; x < map[y].size(); ++x) {
-                float prob = probDist(gen);
-
-                if (prob < 0.01f) {
-                    map[y][x] = 2;
-                } else if (prob < 0.1f) {
-                    map[y][x] = 1;
-                }
-            }
+    // Call once per update with the area the camera is about to show.
+    void stream(const Rectangle& view) {
+        int chunkPixels = WORLD_CHUNK_TILES * tileSize;
+        int minX = std::max(0, static_cast<int>(view.x) / chunkPixels - CHUNK_PRELOAD_MARGIN);
+        int minY = std::max(0, static_cast<int>(view.y) / chunkPixels - CHUNK_PRELOAD_MARGIN);
+        int maxX = std::min(chunkCols - 1, static_cast<int>(view.x + view.w) / chunkPixels + CHUNK_PRELOAD_MARGIN);
+        int maxY = std::min(chunkRows - 1, static_cast<int>(view.y + view.h) / chunkPixels + CHUNK_PRELOAD_MARGIN);
+
+        chunks.stream(minX, minY, maxX, maxY, [](chunk_world::Chunk&) {});
+        if (chunks.size() > static_cast<size_t>(MAX_RESIDENT_CHUNKS)) {
+            chunks.evict(minX, minY, maxX, maxY, MAX_RESIDENT_CHUNKS, [](chunk_world::Chunk&) {});
+            LOG_TRACE(LOG_CAT_TILEMAP, "Evicted chunks, {} resident", chunks.size());
         }
     }
 
     void render(SDL_Renderer* renderer, const Camera& camera) {
         if (!tileset) {
-            std::cout << "Warning: TileMap has nullptr tileset texture." << std::endl;
+            LOG_WARN(LOG_CAT_TILEMAP, "TileMap has nullptr tileset texture.");
             return;
         }
 
         SDL_Rect viewport = camera.getViewport();
 
-        int startX = viewport.x / tileSize;
-        int startY = viewport.y / tileSize;
-        int endX = (viewport.x + viewport.w) / tileSize + 1;
-        int endY = (viewport.y + viewport.h) / tileSize + 1;
-
-        startX = std::max(0, startX);
-        startY = std::max(0, startY);
-        endX = std::min(static_cast<int>(map[0].size()), endX);
-        endY = std::min(static_cast<int>(map.size()), endY);
-
-        for (int y = startY; y < endY; ++y) {
-            for (int x = startX; x < endX; ++x) {
-                int tileIndex = map[y][x];
-                SDL_Rect destRect = {
-                    x * tileSize - viewport.x,
-                    y * tileSize - viewport.y,
-                    tileSize,
-                    tileSize
-                };
-                SDL_RenderCopy(renderer, tileset, &tileRects[tileIndex], &destRect);
+        int startX = std::max(0, viewport.x / tileSize);
+        int startY = std::max(0, viewport.y / tileSize);
+        int endX = std::min(cols, (viewport.x + viewport.w) / tileSize + 1);
+        int endY = std::min(rows, (viewport.y + viewport.h) / tileSize + 1);
+
+        // Chunks still on their way from the streamer are left black for a
+        // frame or two rather than generated here.
+        for (int cy = startY / WORLD_CHUNK_TILES; cy <= (endY - 1) / WORLD_CHUNK_TILES; ++cy) {
+            for (int cx = startX / WORLD_CHUNK_TILES; cx <= (endX - 1) / WORLD_CHUNK_TILES; ++cx) {
+                const chunk_world::Chunk* chunk = chunks.find(cx, cy);
+                if (!chunk) continue;
+
+                int baseX = cx * WORLD_CHUNK_TILES;
+                int baseY = cy * WORLD_CHUNK_TILES;
+                int fromX = std::max(startX, baseX), toX = std::min(endX, baseX + WORLD_CHUNK_TILES);
+                int fromY = std::max(startY, baseY), toY = std::min(endY, baseY + WORLD_CHUNK_TILES);
+                for (int y = fromY; y < toY; ++y) {
+                    for (int x = fromX; x < toX; ++x) {
+                        int tileIndex = chunk->tiles[(y - baseY) * WORLD_CHUNK_TILES + (x - baseX)];
+                        SDL_Rect destRect = {
+                            x * tileSize - viewport.x,
+                            y * tileSize - viewport.y,
+                            tileSize,
+                            tileSize
+                        };
+                        SDL_RenderCopy(renderer, tileset, &tileRects[tileIndex], &destRect);
+                    }
+                }
             }
         }
     }
 
     bool isObstacle(int x, int y) const {
-        if (x < 0 || y < 0 || y >= map.size() || x >= map[y].size()) {
+        if (x < 0 || y < 0 || x >= cols || y >= rows) {
             return true;
         }
-        return map[y][x] == 2;
+        const chunk_world::Chunk* chunk = chunks.ensure(x / WORLD_CHUNK_TILES, y / WORLD_CHUNK_TILES,
+                                                        [](chunk_world::Chunk&) {});
+        return chunk->isObstacle(x % WORLD_CHUNK_TILES, y % WORLD_CHUNK_TILES);
     }
 
     bool checkCollision(const Rectangle& rect) const {
-        int startTileX = static_cast<int>(rect.x) / tileSize;
-        int startTileY = static_cast<int>(rect.y) / tileSize;
-        int endTileX = static_cast<int>(rect.x + rect.w) / tileSize;
-        int endTileY = static_cast<int>(rect.y + rect.h) / tileSize;
-
-        for (int y = startTileY; y <= endTileY; ++y) {
-            for (int x = startTileX; x <= endTileX; ++x) {
-                if (isObstacle(x, y)) {
-                    std::cout << "Collision detected at tile (" << x << ", " << y
-                              << ") for rect at (" << rect.x << ", " << rect.y << ")" << std::endl;
-                    return true;
-                }
+        return engine::hitsSolidTile(rect.box(), tileSize, [this, &rect](int x, int y) {
+            if (!isObstacle(x, y)) return false;
+            LOG_TRACE(LOG_CAT_TILEMAP, "Collision detected at tile ({}, {}) for rect at ({}, {})",
+                      x, y, rect.x, rect.y);
+            return true;
+        });
+    }
+};
+
+// TextRenderer draws UI text without touching SDL_ttf per frame. Printable
+// ASCII is baked once into a glyph atlas and strings are drawn as one
+// SDL_RenderGeometry batch; fixed labels go through a small LRU cache of
+// fully rendered (text, color) textures.
+class TextRenderer {
+private:
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+    static const int ATLAS_WIDTH = 512;
+
+    struct Glyph {
+        SDL_Rect src;
+        int advance;
+    };
+
+    struct CachedText {
+        std::string key;
+        SDL_Texture* texture;
+        int w, h;
+    };
+
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    SDL_Texture* atlas;
+    int atlasWidth, atlasHeight;
+    Glyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    size_t cacheCapacity;
+    std::list<CachedText> cache;
+    std::unordered_map<std::string, std::list<CachedText>::iterator> cacheLookup;
+
+    bool buildAtlas() {
+        SDL_Color white = { 255, 255, 255, 255 };
+        std::vector<SDL_Surface*> surfaces(LAST_GLYPH - FIRST_GLYPH + 1, nullptr);
+
+        // Shelf-pack the glyphs left to right, starting a new row when full.
+        int penX = 0, penY = 0, rowHeight = 0;
+        for (int c = FIRST_GLYPH; c <= LAST_GLYPH; ++c) {
+            Glyph& glyph = glyphs[c - FIRST_GLYPH];
+            TTF_GlyphMetrics(font, static_cast<Uint16>(c), nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+
+            SDL_Surface* surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), white);
+            if (!surface) continue;
+
+            if (penX + surface->w > ATLAS_WIDTH) {
+                penX = 0;
+                penY += rowHeight + 1;
+                rowHeight = 0;
             }
+
+            glyph.src = { penX, penY, surface->w, surface->h };
+            penX += surface->w + 1;
+            rowHeight = std::max(rowHeight, surface->h);
+            surfaces[c - FIRST_GLYPH] = surface;
         }
-        return false;
+
+        atlasWidth = ATLAS_WIDTH;
+        atlasHeight = penY + rowHeight;
+
+        SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA8888);
+        if (sheet) {
+            SDL_FillRect(sheet, nullptr, SDL_MapRGBA(sheet->format, 255, 255, 255, 0));
+            for (int c = FIRST_GLYPH; c <= LAST_GLYPH; ++c) {
+                SDL_Surface* surface = surfaces[c - FIRST_GLYPH];
+                if (!surface) continue;
+                SDL_Rect dest = glyphs[c - FIRST_GLYPH].src;
+                SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(surface, nullptr, sheet, &dest);
+            }
+            atlas = SDL_CreateTextureFromSurface(renderer, sheet);
+            SDL_FreeSurface(sheet);
+        }
+
+        for (SDL_Surface* surface : surfaces) {
+            if (surface) SDL_FreeSurface(surface);
+        }
+
+        if (!atlas) return false;
+        SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+        return true;
+    }
+
+    const Glyph& glyphFor(char c) const {
+        int code = static_cast<unsigned char>(c);
+        if (code < FIRST_GLYPH || code > LAST_GLYPH) code = '?';
+        return glyphs[code - FIRST_GLYPH];
+    }
+
+public:
+    TextRenderer(SDL_Renderer* ren, TTF_Font* f, size_t cacheCapacity = 64) :
+        renderer(ren), font(f), atlas(nullptr), atlasWidth(0), atlasHeight(0), cacheCapacity(cacheCapacity) {
+        for (auto& glyph : glyphs) {
+            glyph.src = { 0, 0, 0, 0 };
+            glyph.advance = 0;
+        }
+
+        if (font && !buildAtlas()) {
+            std::cerr << "Failed to build glyph atlas: " << SDL_GetError() << std::endl;
+        }
+    }
+
+    ~TextRenderer() {
+        clearCache();
+        if (atlas) SDL_DestroyTexture(atlas);
+    }
+
+    void drawText(const std::string& text, int x, int y, SDL_Color color) {
+        if (!atlas) return;
+
+        vertices.clear();
+        indices.clear();
+
+        const float invW = 1.0f / atlasWidth;
+        const float invH = 1.0f / atlasHeight;
+        float penX = static_cast<float>(x);
+
+        for (char c : text) {
+            const Glyph& glyph = glyphFor(c);
+            if (glyph.src.w > 0) {
+                float x0 = penX, y0 = static_cast<float>(y);
+                float x1 = x0 + glyph.src.w, y1 = y0 + glyph.src.h;
+                float u0 = glyph.src.x * invW, v0 = glyph.src.y * invH;
+                float u1 = (glyph.src.x + glyph.src.w) * invW, v1 = (glyph.src.y + glyph.src.h) * invH;
+
+                int base = static_cast<int>(vertices.size());
+                vertices.push_back({ { x0, y0 }, color, { u0, v0 } });
+                vertices.push_back({ { x1, y0 }, color, { u1, v0 } });
+                vertices.push_back({ { x1, y1 }, color, { u1, v1 } });
+                vertices.push_back({ { x0, y1 }, color, { u0, v1 } });
+
+                indices.push_back(base);
+                indices.push_back(base + 1);
+                indices.push_back(base + 2);
+                indices.push_back(base);
+                indices.push_back(base + 2);
+                indices.push_back(base + 3);
+            }
+            penX += glyph.advance;
+        }
+
+        if (!vertices.empty()) {
+            SDL_RenderGeometry(renderer, atlas, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size()));
+        }
+    }
+
+    void drawCached(const std::string& text, int x, int y, SDL_Color color) {
+        std::string key = text;
+        key.push_back('\0');
+        key.push_back(static_cast<char>(color.r));
+        key.push_back(static_cast<char>(color.g));
+        key.push_back(static_cast<char>(color.b));
+        key.push_back(static_cast<char>(color.a));
+
+        auto found = cacheLookup.find(key);
+        if (found != cacheLookup.end()) {
+            cache.splice(cache.begin(), cache, found->second);
+        } else {
+            if (!font) return;
+
+            SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
+            if (!surface) {
+                std::cerr << "Failed to render text: " << TTF_GetError() << std::endl;
+                return;
+            }
+
+            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+            int w = surface->w, h = surface->h;
+            SDL_FreeSurface(surface);
+            if (!texture) {
+                std::cerr << "Failed to create texture from surface: " << SDL_GetError() << std::endl;
+                return;
+            }
+
+            if (cache.size() >= cacheCapacity) {
+                SDL_DestroyTexture(cache.back().texture);
+                cacheLookup.erase(cache.back().key);
+                cache.pop_back();
+            }
+
+            cache.push_front({ key, texture, w, h });
+            cacheLookup[key] = cache.begin();
+        }
+
+        const CachedText& entry = cache.front();
+        SDL_Rect destRect = { x, y, entry.w, entry.h };
+        SDL_RenderCopy(renderer, entry.texture, nullptr, &destRect);
+    }
+
+    void clearCache() {
+        for (auto& entry : cache) {
+            SDL_DestroyTexture(entry.texture);
+        }
+        cache.clear();
+        cacheLookup.clear();
     }
 };
 
@@ -699,38 +1235,29 @@ private:
     GameState& gameState;
     Player& player;
     TimeOfDay& timeOfDay;
+    TextRenderer textRenderer;
 
 public:
     UIManager(SDL_Renderer* ren, TTF_Font* f, SDL_Texture* hpBar, SDL_Texture* invTex, GameState& state, Player& p, TimeOfDay& time) :
-        renderer(ren), font(f), hpBarTexture(hpBar), inventoryTexture(invTex), gameState(state), player(p), timeOfDay(time) {}
+        renderer(ren), font(f), hpBarTexture(hpBar), inventoryTexture(invTex), gameState(state), player(p), timeOfDay(time),
+        textRenderer(ren, f) {}
 
     void renderText(const std::string& text, int x, int y, SDL_Color color) {
         if (!font) {
-            std::cout << "Warning: UIManager has nullptr font, skipping text render." << std::endl;
+            LOG_WARN(LOG_CAT_UI, "UIManager has nullptr font, skipping text render.");
             return;
         }
 
-        SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
-        if (!surface) {
-            std::cerr << "Failed to render text: " << TTF_GetError() << std::endl;
-            return;
-        }
+        textRenderer.drawText(text, x, y, color);
+    }
 
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-        if (!texture) {
-            std::cerr << "Failed to create texture from surface: " << SDL_GetError() << std::endl;
-            SDL_FreeSurface(surface);
+    void renderLabel(const std::string& text, int x, int y, SDL_Color color) {
+        if (!font) {
+            LOG_WARN(LOG_CAT_UI, "UIManager has nullptr font, skipping text render.");
             return;
         }
 
-        int w, h;
-        SDL_QueryTexture(texture, nullptr, nullptr, &w, &h);
-        SDL_Rect destRect = { x, y, w, h };
-
-        SDL_RenderCopy(renderer, texture, nullptr, &destRect);
-
-        SDL_FreeSurface(surface);
-        SDL_DestroyTexture(texture);
+        textRenderer.drawCached(text, x, y, color);
     }
 
     void renderHealthBar() {
@@ -772,7 +1299,7 @@ public:
             timeText = "Night";
         }
 
-        renderText(timeText, SCREEN_WIDTH - 100, 20, color);
+        renderLabel(timeText, SCREEN_WIDTH - 100, 20, color);
     }
 
     void renderGameplay() {
@@ -782,12 +1309,12 @@ public:
 
         if (player.getHomeBase()) {
             SDL_Color green = { 0, 255, 0, 255 };
-            renderText("Home Base Set", SCREEN_WIDTH - 200, 50, green);
+            renderLabel("Home Base Set", SCREEN_WIDTH - 200, 50, green);
         }
 
         if (player.getIsInside()) {
             SDL_Color cyan = { 0, 255, 255, 255 };
-            renderText("Inside Building", SCREEN_WIDTH - 200, 80, cyan);
+            renderLabel("Inside Building", SCREEN_WIDTH - 200, 80, cyan);
         }
     }
 
@@ -798,25 +1325,25 @@ public:
         SDL_RenderFillRect(renderer, &bgRect);
 
         SDL_Color white = { 255, 255, 255, 255 };
-        renderText("Inventory", SCREEN_WIDTH / 2 - 100, 50, white);
+        renderLabel("Inventory", SCREEN_WIDTH / 2 - 100, 50, white);
 
         Inventory& inv = player.getInventory();
         int y = 120;
 
-        //renderText("Resources:", 300, y, white); y += 40;
+        //renderLabel("Resources:", 300, y, white); y += 40;
         //renderText("Wood: " + std::to_string(inv.getItemCount(RESOURCE_WOOD)), 320, y, white); y += 30;
         //renderText("Metal: " + std::to_string(inv.getItemCount(RESOURCE_METAL)), 320, y, white); y += 30;
         //renderText("Food: " + std::to_string(inv.getItemCount(RESOURCE_FOOD)), 320, y, white); y += 30;
         //renderText("Cloth: " + std::to_string(inv.getItemCount(RESOURCE_CLOTH)), 320, y, white); y += 50;
 
-        //renderText("Combat:", 300, y, white); y += 40;
+        //renderLabel("Combat:", 300, y, white); y += 40;
         //renderText("Weapon Power: " + std::to_string(player.getWeaponPower()), 320, y, white); y += 30;
         //renderText("Armor: " + std::to_string(player.getArmor()), 320, y, white); y += 30;
         //renderText("Ammo: " + std::to_string(inv.getItemCount(AMMO)), 320, y, white); y += 30;
         //renderText("Health Items: " + std::to_string(inv.getItemCount(HEALTH)), 320, y, white); y += 50;
 
         if (player.getHomeBase() && player.getIsInside()) {
-            //renderText("Home Base Storage:", SCREEN_WIDTH - 500, 120, white);
+            //renderLabel("Home Base Storage:", SCREEN_WIDTH - 500, 120, white);
             Inventory& storage = player.getHomeBase()->getStorage();
 
             y = 160;
@@ -827,10 +1354,10 @@ public:
             renderText("Ammo: " + std::to_string(storage.getItemCount(AMMO)), SCREEN_WIDTH - 480, y, white); y += 30;
             //renderText("Health Items: " + std::to_string(storage.getItemCount(HEALTH)), SCREEN_WIDTH - 480, y, white); y += 50;
 
-          //  renderText("Press [T] to transfer items to/from storage", SCREEN_WIDTH / 2 - 200, SCREEN_HEIGHT - 100, white);
+          //  renderLabel("Press [T] to transfer items to/from storage", SCREEN_WIDTH / 2 - 200, SCREEN_HEIGHT - 100, white);
         }
 
-        //renderText("Press [I] to close inventory", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, white);
+        //renderLabel("Press [I] to close inventory", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, white);
     }
 
     void renderCraftingScreen() {
@@ -840,26 +1367,26 @@ public:
         SDL_RenderFillRect(renderer, &bgRect);
 
         SDL_Color white = { 255, 255, 255, 255 };
-        //renderText("Crafting", SCREEN_WIDTH / 2 - 80, 50, white);
+        //renderLabel("Crafting", SCREEN_WIDTH / 2 - 80, 50, white);
 
         Inventory& inv = player.getInventory();
         int y = 120;
 
-        //renderText("Resources:", 200, y, white); y += 40;
+        //renderLabel("Resources:", 200, y, white); y += 40;
         //renderText("Wood: " + std::to_string(inv.getItemCount(RESOURCE_WOOD)), 220, y, white); y += 30;
         //renderText("Metal: " + std::to_string(inv.getItemCount(RESOURCE_METAL)), 220, y, white); y += 30;
         //renderText("Food: " + std::to_string(inv.getItemCount(RESOURCE_FOOD)), 220, y, white); y += 30;
         //renderText("Cloth: " + std::to_string(inv.getItemCount(RESOURCE_CLOTH)), 220, y, white); y += 50;
 
         y = 120;
-        //renderText("Crafting Options:", SCREEN_WIDTH - 600, y, white); y += 40;
+        //renderLabel("Crafting Options:", SCREEN_WIDTH - 600, y, white); y += 40;
 
-        //renderText("1. Upgrade Weapon (5 Metal, 3 Wood) [Press 1]", SCREEN_WIDTH - 580, y, white); y += 30;
-        //renderText("2. Upgrade Armor (8 Cloth, 2 Metal) [Press 2]", SCREEN_WIDTH - 580, y, white); y += 30;
-        //renderText("3. Craft Health Pack (5 Food, 2 Cloth) [Press 3]", SCREEN_WIDTH - 580, y, white); y += 30;
-        //renderText("4. Craft Ammo (3 Metal, 2 Wood) [Press 4]", SCREEN_WIDTH - 580, y, white); y += 30;
+        //renderLabel("1. Upgrade Weapon (5 Metal, 3 Wood) [Press 1]", SCREEN_WIDTH - 580, y, white); y += 30;
+        //renderLabel("2. Upgrade Armor (8 Cloth, 2 Metal) [Press 2]", SCREEN_WIDTH - 580, y, white); y += 30;
+        //renderLabel("3. Craft Health Pack (5 Food, 2 Cloth) [Press 3]", SCREEN_WIDTH - 580, y, white); y += 30;
+        //renderLabel("4. Craft Ammo (3 Metal, 2 Wood) [Press 4]", SCREEN_WIDTH - 580, y, white); y += 30;
 
-        //renderText("Press [C] to close crafting menu", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT - 50, white);
+        //renderLabel("Press [C] to close crafting menu", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT - 50, white);
     }
 
     void renderPauseScreen() {
@@ -869,9 +1396,9 @@ public:
         SDL_RenderFillRect(renderer, &bgRect);
 
         SDL_Color white = { 255, 255, 255, 255 };
-        //renderText("GAME PAUSED", SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 - 100, white);
-        //renderText("Press [P] to resume", SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2, white);
-        //renderText("Press [ESC] to quit", SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2 + 50, white);
+        //renderLabel("GAME PAUSED", SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 - 100, white);
+        //renderLabel("Press [P] to resume", SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2, white);
+        //renderLabel("Press [ESC] to quit", SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2 + 50, white);
     }
 
     void renderGameOverScreen() {
@@ -882,9 +1409,9 @@ public:
         SDL_Color red = { 255, 0, 0, 255 };
         SDL_Color white = { 255, 255, 255, 255 };
 
-       // renderText("GAME OVER", SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 - 50, red);
-       // renderText("Press [R] to restart", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 50, white);
-       // renderText("Press [ESC] to quit", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 100, white);
+       // renderLabel("GAME OVER", SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 - 50, red);
+       // renderLabel("Press [R] to restart", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 50, white);
+       // renderLabel("Press [ESC] to quit", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 100, white);
     }
 
     void renderMainMenu() {
@@ -895,17 +1422,17 @@ public:
        // SDL_Color title = { 255, 200, 0, 255 };
        // SDL_Color normal = { 200, 200, 200, 255 };
 
-       // renderText("ZOMBIE SURVIVAL", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 4, title);
-       // renderText("Press [ENTER] to start game", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT / 2, normal);
-      //  renderText("Press [ESC] to quit", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 50, normal);
+       // renderLabel("ZOMBIE SURVIVAL", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 4, title);
+       // renderLabel("Press [ENTER] to start game", SCREEN_WIDTH / 2 - 180, SCREEN_HEIGHT / 2, normal);
+      //  renderLabel("Press [ESC] to quit", SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 + 50, normal);
 
        // int y = SCREEN_HEIGHT - 200;
-        //renderText("Controls:", 100, y, normal); y += 30;
-        //renderText("WASD - Move", 120, y, normal); y += 25;
-        //renderText("E - Interact with buildings/items", 120, y, normal); y += 25;
-        //renderText("I - Inventory", 120, y, normal); y += 25;
-        //renderText("C - Crafting", 120, y, normal); y += 25;
-        //renderText("H - Set current building as home base", 120, y, normal);
+        //renderLabel("Controls:", 100, y, normal); y += 30;
+        //renderLabel("WASD - Move", 120, y, normal); y += 25;
+        //renderLabel("E - Interact with buildings/items", 120, y, normal); y += 25;
+        //renderLabel("I - Inventory", 120, y, normal); y += 25;
+        //renderLabel("C - Crafting", 120, y, normal); y += 25;
+        //renderLabel("H - Set current building as home base", 120, y, normal);
     }
 
     void render() {
@@ -935,6 +1462,144 @@ public:
     }
 };
 
+// Everything a save needs, captured on the main thread in one pass of
+// plain copies. Writing the file touches nothing but this snapshot, so it
+// can run on another thread while the game keeps going.
+struct SaveSnapshot {
+    SaveHeader header;
+    std::vector<Uint8> populatedChunks;
+    std::vector<ZombieRecord> zombies;
+    std::vector<BuildingRecord> buildings;
+    std::vector<ItemRecord> items;
+    std::vector<ItemRecord> storedItems;
+};
+
+namespace Save {
+
+// Fills in the section table and writes the file. Goes through a temporary
+// file and a rename so a crash mid-write never leaves a torn save behind.
+bool write(SaveSnapshot& snapshot, const std::string& path) {
+    SaveHeader& header = snapshot.header;
+    section_file::Layout layout(sizeof(SaveHeader));
+    layout.place(header.populatedChunks, snapshot.populatedChunks.size(), 1);
+    layout.place(header.zombies, snapshot.zombies.size(), sizeof(ZombieRecord));
+    layout.place(header.buildings, snapshot.buildings.size(), sizeof(BuildingRecord));
+    layout.place(header.items, snapshot.items.size(), sizeof(ItemRecord));
+    layout.place(header.storedItems, snapshot.storedItems.size(), sizeof(ItemRecord));
+    header.fileSize = layout.size();
+
+    std::vector<char> buffer(header.fileSize, 0);
+    memcpy(buffer.data(), &header, sizeof(header));
+    section_file::copySection(buffer, header.populatedChunks, snapshot.populatedChunks.data(), 1);
+    section_file::copySection(buffer, header.zombies, snapshot.zombies.data(), sizeof(ZombieRecord));
+    section_file::copySection(buffer, header.buildings, snapshot.buildings.data(), sizeof(BuildingRecord));
+    section_file::copySection(buffer, header.items, snapshot.items.data(), sizeof(ItemRecord));
+    section_file::copySection(buffer, header.storedItems, snapshot.storedItems.data(), sizeof(ItemRecord));
+
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Could not open " << tempPath << " for writing" << std::endl;
+        return false;
+    }
+    bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    written = (fclose(file) == 0) && written;
+    if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Writing save " << path << " failed" << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Checks a mapped file before anything is read from it: magic, version, and
+// that every section is aligned and lies inside the file.
+const SaveHeader* validate(const section_file::MappedFile& file) {
+    if (file.getSize() < sizeof(SaveHeader)) return nullptr;
+
+    const SaveHeader* header = reinterpret_cast<const SaveHeader*>(file.getData());
+    if (memcmp(header->magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0) return nullptr;
+    if (header->version != SAVE_VERSION) {
+        std::cerr << "Save version " << header->version << " is not supported" << std::endl;
+        return nullptr;
+    }
+    if (header->fileSize != file.getSize()) return nullptr;
+
+    const SaveSection* sections[] = { &header->populatedChunks, &header->zombies, &header->buildings,
+                                      &header->items, &header->storedItems };
+    const size_t recordSizes[] = { 1, sizeof(ZombieRecord), sizeof(BuildingRecord),
+                                   sizeof(ItemRecord), sizeof(ItemRecord) };
+    for (int i = 0; i < 5; ++i) {
+        if (!section_file::fits(*sections[i], recordSizes[i], file.getSize())) return nullptr;
+    }
+    if (header->worldChunks != WORLD_CHUNKS || header->populatedChunks.count != WORLD_CHUNKS * WORLD_CHUNKS) {
+        return nullptr;
+    }
+    return header;
+}
+
+// Background save writer. submit() hands over a snapshot and returns at
+// once. Each path has one pending slot: a newer snapshot for the same file
+// replaces one the writer hasn't reached yet, while saves to different
+// files (quicksave, autosave) are all written.
+class Autosaver {
+private:
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::map<std::string, std::unique_ptr<SaveSnapshot>> pending;
+    bool stopping;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+
+            std::string path = pending.begin()->first;
+            std::unique_ptr<SaveSnapshot> snapshot = std::move(pending.begin()->second);
+            pending.erase(pending.begin());
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            bool saved = write(*snapshot, path);
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (saved) {
+                LOG_INFO(LOG_CAT_GAME, "Saved {} ({} bytes) in {}us", path.c_str(), snapshot->header.fileSize,
+                         static_cast<long long>(micros));
+            }
+
+            lock.lock();
+        }
+    }
+
+public:
+    Autosaver() : stopping(false) {
+        worker = std::thread(&Autosaver::run, this);
+    }
+
+    // Writes out the saves still waiting in the queue before returning.
+    ~Autosaver() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    void submit(std::unique_ptr<SaveSnapshot> snapshot, const std::string& path) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending[path] = std::move(snapshot);
+        }
+        wake.notify_one();
+    }
+};
+
+} // namespace Save
+
 // Game class - main game logic
 class Game {
 private:
@@ -959,14 +1624,21 @@ private:
     std::unique_ptr<Player> player;
     std::vector<std::unique_ptr<Zombie>> zombies;
     std::vector<std::unique_ptr<Building>> buildings;
+    BuildingTree buildingTree;
+    std::vector<Building*> nearbyBuildings;
     std::vector<std::unique_ptr<Item>> items;
     std::unique_ptr<TileMap> tileMap;
     std::unique_ptr<UIManager> uiManager;
+    std::unique_ptr<SpriteBatch> spriteBatch;
 
     std::mt19937 rng;
+    Uint32 worldSeed;
+    std::vector<Uint8> populatedChunks; // one byte per chunk, set once its buildings exist
 
     Uint32 lastZombieSpawn;
     Uint32 zombieSpawnInterval;
+    Uint32 lastAutosave;
+    Save::Autosaver autosaver;
 
 public:
     Game() :
@@ -984,7 +1656,9 @@ public:
         zombieSpawnInterval(5000),
         playerTexture(nullptr),
         tilesetTexture(nullptr),
-        font(nullptr) {
+        font(nullptr),
+        worldSeed(0),
+        lastAutosave(0) {
         std::random_device rd;
         rng = std::mt19937(rd());
         for (int i = 0; i < 4; ++i) zombieTextures[i] = nullptr;
@@ -1007,7 +1681,7 @@ public:
             std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
             return false;
         }
-        std::cout << "SDL initialized successfully" << std::endl;
+        LOG_INFO(LOG_CAT_GAME, "SDL initialized successfully");
 
         if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
             std::cerr << "SDL_image initialization failed: " << IMG_GetError() << std::endl;
@@ -1030,8 +1704,10 @@ public:
             std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
             return false;
         }
-        std::cout << "Game initialized - Window: " << width << "x" << height
-                  << ", Fullscreen: " << (fullscreen ? "Yes" : "No") << std::endl;
+        spriteBatch = std::make_unique<SpriteBatch>(renderer);
+
+        LOG_INFO(LOG_CAT_GAME, "Game initialized - Window: {}x{}, Fullscreen: {}",
+                 width, height, fullscreen ? "Yes" : "No");
 
         running = true;
         return loadMedia();
@@ -1129,13 +1805,20 @@ public:
     }
 
     void setupGame() {
+        // A restart starts from an empty world with a new seed.
+        clearWorld();
+
         player = std::make_unique<Player>(Vector2D(MAP_WIDTH / 2, MAP_HEIGHT / 2), playerTexture);
-        std::cout << "New game setup - Player spawned at ("
-                  << MAP_WIDTH / 2 << ", " << MAP_HEIGHT / 2 << ")" << std::endl;
+        LOG_INFO(LOG_CAT_GAME, "New game setup - Player spawned at ({}, {})", MAP_WIDTH / 2, MAP_HEIGHT / 2);
 
-        tileMap = std::make_unique<TileMap>(tilesetTexture, MAP_WIDTH, MAP_HEIGHT, TILE_SIZE);
+        worldSeed = rng();
+        tileMap = std::make_unique<TileMap>(tilesetTexture, MAP_WIDTH, MAP_HEIGHT, TILE_SIZE, worldSeed);
 
-        createBuildings();
+        // Buildings around the start have to exist before anything spawns so
+        // nothing lands inside one.
+        populatedChunks.assign(WORLD_CHUNKS * WORLD_CHUNKS, 0);
+        camera.update(player->getPosition());
+        streamWorld();
 
         for (int i = 0; i < 10; ++i) {
             spawnZombie();
@@ -1151,102 +1834,173 @@ public:
         lastFrameTime = SDL_GetTicks();
         lastTimeUpdate = lastFrameTime;
         lastZombieSpawn = lastFrameTime;
+        lastAutosave = lastFrameTime;
 
         gameState = GAMEPLAY;
         timeOfDay = DAY;
 
-        std::cout << "Game setup complete - Zombies: " << zombies.size()
-                  << ", Items: " << items.size() << ", Buildings: "
-                  << buildings.size() << std::endl;
+        LOG_INFO(LOG_CAT_GAME, "Game setup complete - World seed: {}, Zombies: {}, Items: {}, Buildings: {}",
+                 worldSeed, zombies.size(), items.size(), buildings.size());
     }
 
-    void createBuildings() {
-        std::uniform_int_distribution<int> xPosDist(TILE_SIZE * 5, MAP_WIDTH - TILE_SIZE * 10);
-        std::uniform_int_distribution<int> yPosDist(TILE_SIZE * 5, MAP_HEIGHT - TILE_SIZE * 10);
-        std::uniform_int_distribution<int> buildingTypeDist(0, 2);
-
-        for (int i = 0; i < 15; ++i) {
-            int type = buildingTypeDist(rng);
-            int width, height;
-
-            switch (type) {
-                case 0: width = TILE_SIZE * 4; height = TILE_SIZE * 3; break;
-                case 1: width = TILE_SIZE * 6; height = TILE_SIZE * 4; break;
-                case 2: width = TILE_SIZE * 8; height = TILE_SIZE * 6; break;
+    // Streams the terrain around the camera and populates every chunk within
+    // one chunk of it. Chunks are filled from their own seed, so the order
+    // they are reached in doesn't matter.
+    void streamWorld() {
+        SDL_Rect viewport = camera.getViewport();
+        tileMap->stream(Rectangle(viewport.x, viewport.y, viewport.w, viewport.h));
+
+        int minX = std::max(0, viewport.x / WORLD_CHUNK_PIXELS - 1);
+        int minY = std::max(0, viewport.y / WORLD_CHUNK_PIXELS - 1);
+        int maxX = std::min(WORLD_CHUNKS - 1, (viewport.x + viewport.w) / WORLD_CHUNK_PIXELS + 1);
+        int maxY = std::min(WORLD_CHUNKS - 1, (viewport.y + viewport.h) / WORLD_CHUNK_PIXELS + 1);
+
+        size_t buildingCount = buildings.size();
+        for (int cy = minY; cy <= maxY; ++cy) {
+            for (int cx = minX; cx <= maxX; ++cx) {
+                Uint8& populated = populatedChunks[cy * WORLD_CHUNKS + cx];
+                if (!populated) {
+                    populateChunk(cx, cy);
+                    populated = 1;
+                }
             }
+        }
+        if (buildings.size() != buildingCount) {
+            buildingTree.build(buildings);
+        }
+    }
 
-            bool validPosition = false;
-            Vector2D pos;
+    // Buildings only come in the three sizes loadMedia makes textures for.
+    static int buildingStyle(const Building& building) {
+        int width = static_cast<int>(building.getCollider().w);
+        if (width == TILE_SIZE * 8) return 2;
+        if (width == TILE_SIZE * 6) return 1;
+        return 0;
+    }
 
-            int attempts = 0;
-            while (!validPosition && attempts < 20) {
-                validPosition = true;
-                pos.x = xPosDist(rng);
-                pos.y = yPosDist(rng);
+    void clearWorld() {
+        for (auto& building : buildings) {
+            for (Item* item : building->getItems()) delete item;
+        }
+        buildingTree.clear();
+        buildings.clear();
+        zombies.clear();
+        items.clear();
+    }
+
+    std::unique_ptr<SaveSnapshot> captureSnapshot() {
+        Uint32 now = SDL_GetTicks();
+        auto snapshot = std::make_unique<SaveSnapshot>();
+
+        SaveHeader& header = snapshot->header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+        header.version = SAVE_VERSION;
+        header.worldSeed = worldSeed;
+        header.worldChunks = WORLD_CHUNKS;
+        header.gameTime = gameTime;
+        header.timeOfDay = timeOfDay;
+        header.sinceZombieSpawn = now - lastZombieSpawn;
+        header.sinceTimeUpdate = now - lastTimeUpdate;
+        player->writeRecord(header.player);
+        header.player.homeBase = -1;
+
+        snapshot->populatedChunks = populatedChunks;
+
+        snapshot->zombies.resize(zombies.size());
+        for (size_t i = 0; i < zombies.size(); ++i) {
+            zombies[i]->writeRecord(snapshot->zombies[i], now);
+        }
+
+        snapshot->buildings.resize(buildings.size());
+        for (size_t i = 0; i < buildings.size(); ++i) {
+            Building& building = *buildings[i];
+            BuildingRecord& record = snapshot->buildings[i];
+            Rectangle collider = building.getCollider();
+            record.x = collider.x;
+            record.y = collider.y;
+            record.w = static_cast<int32_t>(collider.w);
+            record.h = static_cast<int32_t>(collider.h);
+            record.style = buildingStyle(building);
+            record.firstItem = static_cast<uint32_t>(snapshot->storedItems.size());
+            record.itemCount = static_cast<uint32_t>(building.getItems().size());
+            building.getStorage().writeCounts(record.storage);
+            for (Item* item : building.getItems()) {
+                snapshot->storedItems.push_back({ 0.0f, 0.0f, item->getType(), item->getValue() });
+            }
+            if (player->getHomeBase() == &building) {
+                header.player.homeBase = static_cast<int32_t>(i);
+            }
+        }
 
-                Rectangle newRect(pos.x, pos.y, width, height);
+        snapshot->items.reserve(items.size());
+        for (const auto& item : items) {
+            Vector2D pos = item->getPosition();
+            snapshot->items.push_back({ pos.x, pos.y, item->getType(), item->getValue() });
+        }
+        return snapshot;
+    }
 
-                for (const auto& building : buildings) {
-                    Rectangle existingRect = building->getCollider();
+    void saveGame(const char* path) {
+        autosaver.submit(captureSnapshot(), path);
+    }
 
-                    existingRect.x -= TILE_SIZE * 2;
-                    existingRect.y -= TILE_SIZE * 2;
-                    existingRect.w += TILE_SIZE * 4;
-                    existingRect.h += TILE_SIZE * 4;
+    // Most chunks get one building. It stays two tiles clear of the chunk
+    // edge, which keeps the old spacing between buildings without looking at
+    // the neighbours.
+    void populateChunk(int cx, int cy) {
+        std::mt19937 chunkRng(chunk_world::chunkSeed(worldSeed, cx, cy, 1));
+        std::uniform_int_distribution<int> chanceDist(0, 99);
+        if (chanceDist(chunkRng) >= 60) return;
 
-                    if (existingRect.intersects(newRect)) {
-                        validPosition = false;
-                        break;
-                    }
-                }
+        std::uniform_int_distribution<int> buildingTypeDist(0, 2);
+        int type = buildingTypeDist(chunkRng);
+        int width, height;
 
-                attempts++;
-            }
+        switch (type) {
+            case 0: width = TILE_SIZE * 4; height = TILE_SIZE * 3; break;
+            case 1: width = TILE_SIZE * 6; height = TILE_SIZE * 4; break;
+            default: width = TILE_SIZE * 8; height = TILE_SIZE * 6; break;
+        }
 
-            if (validPosition) {
-                auto building = std::make_unique<Building>(pos, buildingTextures[type], width, height);
+        int margin = TILE_SIZE * 2;
+        std::uniform_int_distribution<int> xPosDist(margin, WORLD_CHUNK_PIXELS - margin - width);
+        std::uniform_int_distribution<int> yPosDist(margin, WORLD_CHUNK_PIXELS - margin - height);
+        Vector2D pos(cx * WORLD_CHUNK_PIXELS + xPosDist(chunkRng), cy * WORLD_CHUNK_PIXELS + yPosDist(chunkRng));
 
-                std::uniform_int_distribution<int> itemCountDist(1, 5);
-                int itemCount = itemCountDist(rng);
+        auto building = std::make_unique<Building>(pos, buildingTextures[type], width, height);
 
-                for (int j = 0; j < itemCount; ++j) {
-                    createItemInBuilding(*building);
-                }
+        std::uniform_int_distribution<int> itemCountDist(1, 5);
+        int itemCount = itemCountDist(chunkRng);
 
-                buildings.push_back(std::move(building));
-            }
+        for (int j = 0; j < itemCount; ++j) {
+            createItemInBuilding(*building, chunkRng);
         }
+
+        buildings.push_back(std::move(building));
+        LOG_TRACE(LOG_CAT_GAME, "Chunk ({}, {}) populated - building type {} at ({}, {})",
+                  cx, cy, type, pos.x, pos.y);
     }
 
-    void createItemInBuilding(Building& building) {
+    void createItemInBuilding(Building& building, std::mt19937& gen) {
         std::uniform_int_distribution<int> itemTypeDist(0, 7);
         std::uniform_int_distribution<int> valueDist(1, 5);
 
-        ItemType type = static_cast<ItemType>(itemTypeDist(rng));
-        int value = valueDist(rng);
-        std::string name;
-
-        switch (type) {
-            case WEAPON: name = "Weapon Upgrade"; break;
-            case ARMOR: name = "Armor Piece"; break;
-            case HEALTH: name = "Health Pack"; break;
-            case RESOURCE_WOOD: name = "Wood"; break;
-            case RESOURCE_METAL: name = "Metal"; break;
-            case RESOURCE_FOOD: name = "Food"; break;
-            case RESOURCE_CLOTH: name = "Cloth"; break;
-            case AMMO: name = "Ammo"; break;
-        }
+        ItemType type = static_cast<ItemType>(itemTypeDist(gen));
+        int value = valueDist(gen);
+        std::string name = itemTypeName(type);
 
         Item* item = new Item(Vector2D(0, 0), itemTextures[type], type, value, name);
         building.addItem(item);
     }
 
     void spawnZombie() {
-        std::uniform_real_distribution<float> xPosDist(0, MAP_WIDTH - TILE_SIZE);
-        std::uniform_real_distribution<float> yPosDist(0, MAP_HEIGHT - TILE_SIZE);
-        std::uniform_int_distribution<int> typeDist(0, 3);
-
         Vector2D playerPos = player->getPosition();
+        std::uniform_real_distribution<float> xPosDist(std::max(0.0f, playerPos.x - SPAWN_RADIUS),
+                                                       std::min<float>(MAP_WIDTH - TILE_SIZE, playerPos.x + SPAWN_RADIUS));
+        std::uniform_real_distribution<float> yPosDist(std::max(0.0f, playerPos.y - SPAWN_RADIUS),
+                                                       std::min<float>(MAP_HEIGHT - TILE_SIZE, playerPos.y + SPAWN_RADIUS));
+        std::uniform_int_distribution<int> typeDist(0, 3);
         Vector2D pos;
         bool validPosition = false;
 
@@ -1254,16 +2008,9 @@ public:
             pos.x = xPosDist(rng);
             pos.y = yPosDist(rng);
 
-            float dist = distance(pos.x, pos.y, playerPos.x, playerPos.y);
+            float dist = engine::distance(pos, playerPos);
             if (dist > 300) {
-                validPosition = true;
-
-                for (const auto& building : buildings) {
-                    if (building->isInside(pos)) {
-                        validPosition = false;
-                        break;
-                    }
-                }
+                validPosition = !buildingTree.findContaining(pos);
             }
         }
 
@@ -1282,14 +2029,16 @@ public:
         }
 
         zombies.push_back(std::make_unique<Zombie>(pos, zombieTextures[type], type));
-        std::cout << "Zombie spawned - Type: " << type << " at ("
-                  << pos.x << ", " << pos.y << "), Total zombies: "
-                  << zombies.size() << std::endl;
+        LOG_DEBUG(LOG_CAT_ZOMBIE, "Zombie spawned - Type: {} at ({}, {}), Total zombies: {}",
+                  type, pos.x, pos.y, zombies.size());
     }
 
     void spawnItem() {
-        std::uniform_real_distribution<float> xPosDist(TILE_SIZE, MAP_WIDTH - TILE_SIZE * 2);
-        std::uniform_real_distribution<float> yPosDist(TILE_SIZE, MAP_HEIGHT - TILE_SIZE * 2);
+        Vector2D playerPos = player->getPosition();
+        std::uniform_real_distribution<float> xPosDist(std::max<float>(TILE_SIZE, playerPos.x - SPAWN_RADIUS),
+                                                       std::min<float>(MAP_WIDTH - TILE_SIZE * 2, playerPos.x + SPAWN_RADIUS));
+        std::uniform_real_distribution<float> yPosDist(std::max<float>(TILE_SIZE, playerPos.y - SPAWN_RADIUS),
+                                                       std::min<float>(MAP_HEIGHT - TILE_SIZE * 2, playerPos.y + SPAWN_RADIUS));
         std::uniform_int_distribution<int> itemTypeDist(0, 7);
         std::uniform_int_distribution<int> valueDist(1, 5);
 
@@ -1319,17 +2068,7 @@ public:
         int value = valueDist(rng);
         if (timeOfDay == NIGHT) value = value * 2;
 
-        std::string name;
-        switch (type) {
-            case WEAPON: name = "Weapon Upgrade"; break;
-            case ARMOR: name = "Armor Piece"; break;
-            case HEALTH: name = "Health Pack"; break;
-            case RESOURCE_WOOD: name = "Wood"; break;
-            case RESOURCE_METAL: name = "Metal"; break;
-            case RESOURCE_FOOD: name = "Food"; break;
-            case RESOURCE_CLOTH: name = "Cloth"; break;
-            case AMMO: name = "Ammo"; break;
-        }
+        std::string name = itemTypeName(type);
 
         Vector2D pos;
         bool validPosition = false;
@@ -1345,11 +2084,8 @@ public:
                 continue;
             }
 
-            for (const auto& building : buildings) {
-                if (building->isInside(pos)) {
-                    validPosition = false;
-                    break;
-                }
+            if (buildingTree.findContaining(pos)) {
+                validPosition = false;
             }
         }
 
@@ -1429,14 +2165,18 @@ public:
             case SDLK_e:
                 handleInteraction();
                 break;
+            case SDLK_F5:
+                saveGame(QUICKSAVE_PATH);
+                break;
+            case SDLK_F9:
+                loadGame(QUICKSAVE_PATH);
+                break;
             case SDLK_h:
                 if (player->getIsInside()) {
-                    for (auto& building : buildings) {
-                        if (building->isInside(player->getPosition())) {
-                            player->setHomeBase(building.get());
-                            building->setHomeBase(true);
-                            break;
-                        }
+                    Building* building = buildingTree.findContaining(player->getPosition());
+                    if (building) {
+                        player->setHomeBase(building);
+                        building->setHomeBase(true);
                     }
                 }
                 break;
@@ -1503,37 +2243,26 @@ public:
     void handleInteraction() {
         bool enteredBuilding = false;
 
-        for (auto& building : buildings) {
-            if (building->isAtEntrance(player->getPosition())) {
-                player->setIsInside(!player->getIsInside());
-                enteredBuilding = true;
-                std::cout << "Player " << (player->getIsInside() ? "entered" : "exited")
-                          << " building at (" << building->getPosition().x
-                          << ", " << building->getPosition().y << ")" << std::endl;
-                break;
-            }
+        // Entrances lie inside their building's interior.
+        Building* current = buildingTree.findContaining(player->getPosition());
+        if (current && current->isAtEntrance(player->getPosition())) {
+            player->setIsInside(!player->getIsInside());
+            enteredBuilding = true;
+            LOG_DEBUG(LOG_CAT_PLAYER, "Player {} building at ({}, {})",
+                      player->getIsInside() ? "entered" : "exited",
+                      current->getPosition().x, current->getPosition().y);
         }
 
-        if (!enteredBuilding && player->getIsInside()) {
-            bool stillInside = false;
-            for (auto& building : buildings) {
-                if (building->isInside(player->getPosition())) {
-                    stillInside = true;
-                    break;
-                }
-            }
-
-            if (!stillInside) {
-                player->setIsInside(false);
-            }
+        if (!enteredBuilding && player->getIsInside() && !current) {
+            player->setIsInside(false);
         }
 
         if (!player->getIsInside()) {
             for (auto it = items.begin(); it != items.end(); ) {
                 if ((*it)->checkCollision(*player)) {
                     bool added = player->getInventory().addItem(**it);
-                    std::cout << "Item pickup attempted: " << (*it)->getName()
-                              << " - Success: " << (added ? "Yes" : "No") << std::endl;
+                    LOG_DEBUG(LOG_CAT_ITEM, "Item pickup attempted: {} - Success: {}",
+                              (*it)->getName(), added ? "Yes" : "No");
                     if (added) {
                         it = items.erase(it);
                     } else {
@@ -1543,19 +2272,14 @@ public:
                     ++it;
                 }
             }
-        } else {
-            for (auto& building : buildings) {
-                if (building->isInside(player->getPosition())) {
-                    auto& buildingItems = building->getItems();
-                    if (!buildingItems.empty()) {
-                        Item* item = buildingItems.front();
-                        bool added = player->getInventory().addItem(*item);
-                        if (added) {
-                            buildingItems.erase(buildingItems.begin());
-                            delete item;
-                        }
-                    }
-                    break;
+        } else if (current) {
+            auto& buildingItems = current->getItems();
+            if (!buildingItems.empty()) {
+                Item* item = buildingItems.front();
+                bool added = player->getInventory().addItem(*item);
+                if (added) {
+                    buildingItems.erase(buildingItems.begin());
+                    delete item;
                 }
             }
         }
@@ -1623,18 +2347,15 @@ public:
         Uint32 currentTime = SDL_GetTicks();
         Uint32 deltaTime = currentTime - lastFrameTime;
 
-        std::cout << "Game update - Time: " << gameTime
-                  << "ms, Delta: " << deltaTime << "ms" << std::endl;
+        LOG_TRACE(LOG_CAT_GAME, "Game update - Time: {}ms, Delta: {}ms", gameTime, deltaTime);
 
         lastFrameTime = currentTime;
 	
 	if (gameState != GAMEPLAY) {
-    printf("gamestate=%d, gameplay=%d\n", gameState, GAMEPLAY);
+    LOG_TRACE(LOG_CAT_GAME, "gamestate={}, gameplay={}", gameState, GAMEPLAY);
     return;
 }
 
-	printf("about to run gametime +=deltatime");
-
         gameTime += deltaTime;
 
         if (currentTime - lastTimeUpdate > 1000) {
@@ -1659,19 +2380,22 @@ public:
 
             lastTimeUpdate = currentTime;
         }
-        printf("before player update");
+
+        if (currentTime - lastAutosave >= AUTOSAVE_INTERVAL) {
+            saveGame(AUTOSAVE_PATH);
+            lastAutosave = currentTime;
+        }
         player->update();
-	printf("After player update");
         bool inBuilding = false;
 
-        for (auto& building : buildings) {
-            if (player->getIsInside()) {
-                if (building->isInside(player->getPosition())) {
-                    inBuilding = true;
-                }
-            } else {
+        if (player->getIsInside()) {
+            inBuilding = buildingTree.findContaining(player->getPosition()) != nullptr;
+        } else {
+            nearbyBuildings.clear();
+            buildingTree.queryOverlap(player->getCollider(), nearbyBuildings);
+            for (Building* building : nearbyBuildings) {
                 if (player->checkCollision(*building)) {
-                    Vector2D pushDirection = (player->getPosition() - building->getPosition()).normalize();
+                    Vector2D pushDirection = engine::normalize(player->getPosition() - building->getPosition());
                     player->setPosition(player->getPosition() + pushDirection * 5.0f);
                 }
             }
@@ -1683,20 +2407,16 @@ public:
 
         for (auto& zombie : zombies) {
             if (zombie->isActive()) {
-                bool zombieInBuilding = false;
-                for (auto& building : buildings) {
-                    if (building->isInside(zombie->getPosition())) {
-                        zombieInBuilding = true;
-                        break;
-                    }
-                }
+                bool zombieInBuilding = buildingTree.findContaining(zombie->getPosition()) != nullptr;
 
                 if (!zombieInBuilding) {
                     zombie->update(*player);
 
-                    for (auto& building : buildings) {
+                    nearbyBuildings.clear();
+                    buildingTree.queryOverlap(zombie->getCollider(), nearbyBuildings);
+                    for (Building* building : nearbyBuildings) {
                         if (zombie->checkCollision(*building)) {
-                            Vector2D pushDirection = (zombie->getPosition() - building->getPosition()).normalize();
+                            Vector2D pushDirection = engine::normalize(zombie->getPosition() - building->getPosition());
                             zombie->setPosition(zombie->getPosition() + pushDirection * 3.0f);
                         }
                     }
@@ -1744,10 +2464,11 @@ public:
 
         if (player->getHealth() <= 0) {
             gameState = GAME_OVER;
-            std::cout << "Game Over - Player health depleted" << std::endl;
+            LOG_INFO(LOG_CAT_GAME, "Game Over - Player health depleted");
         }
 
         camera.update(player->getPosition());
+        streamWorld();
     }
 
     void render() {
@@ -1764,42 +2485,48 @@ public:
 
         tileMap->render(renderer, camera);
 
-        for (auto& building : buildings) {
-            if (camera.isVisible(building->getCollider())) {
-                building->render(renderer, camera);
-
-                if (building->isHomeBase()) {
-                    Vector2D screenPos = camera.worldToScreen(building->getPosition());
-                    SDL_Rect outlineRect = {
-                        static_cast<int>(screenPos.x) - 2,
-                        static_cast<int>(screenPos.y) - 2,
-                        static_cast<int>(building->getCollider().w) + 4,
-                        static_cast<int>(building->getCollider().h) + 4
-                    };
-
-                    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-                    SDL_RenderDrawRect(renderer, &outlineRect);
-                }
-            }
+        nearbyBuildings.clear();
+        buildingTree.queryOverlap(Rectangle(viewport.x, viewport.y, viewport.w, viewport.h), nearbyBuildings);
+        for (Building* building : nearbyBuildings) {
+            building->render(*spriteBatch, camera, LAYER_BUILDINGS);
         }
 
         for (auto& item : items) {
             if (camera.isVisible(item->getCollider())) {
-                item->render(renderer, camera);
+                item->render(*spriteBatch, camera, LAYER_ITEMS);
             }
         }
 
         for (auto& zombie : zombies) {
             if (zombie->isActive() && camera.isVisible(zombie->getCollider())) {
-                zombie->render(renderer, camera);
+                zombie->render(*spriteBatch, camera, LAYER_ZOMBIES);
             }
         }
 
         if (!player->getIsInside()) {
-            player->render(renderer, camera);
+            player->render(*spriteBatch, camera, LAYER_PLAYER);
+        }
+
+        spriteBatch->flush();
+
+        // Outlines sit just outside the building, so drawing them after the
+        // whole batch only differs where a sprite overlaps the border.
+        for (Building* building : nearbyBuildings) {
+            if (building->isHomeBase()) {
+                Vector2D screenPos = camera.worldToScreen(building->getPosition());
+                SDL_Rect outlineRect = {
+                    static_cast<int>(screenPos.x) - 2,
+                    static_cast<int>(screenPos.y) - 2,
+                    static_cast<int>(building->getCollider().w) + 4,
+                    static_cast<int>(building->getCollider().h) + 4
+                };
+
+                SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+                SDL_RenderDrawRect(renderer, &outlineRect);
+            }
         }
 
-        // uiManager->render();
+        uiManager->render();
 
         SDL_RenderPresent(renderer);
     }
@@ -1839,6 +2566,112 @@ public:
         return running;
     }
 
+    // Replaces the running game with a save. The file is checked completely
+    // before any game state is touched, so a bad save leaves the game as it
+    // was.
+    bool loadGame(const char* path) {
+        section_file::MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "Could not open save " << path << std::endl;
+            return false;
+        }
+        const SaveHeader* header = Save::validate(file);
+        if (!header) {
+            std::cerr << "Save " << path << " is damaged or from another version" << std::endl;
+            return false;
+        }
+
+        const ZombieRecord* zombieRecords = section_file::records<ZombieRecord>(file, header->zombies);
+        const BuildingRecord* buildingRecords = section_file::records<BuildingRecord>(file, header->buildings);
+        const ItemRecord* itemRecords = section_file::records<ItemRecord>(file, header->items);
+        const ItemRecord* storedRecords = section_file::records<ItemRecord>(file, header->storedItems);
+
+        bool valid = header->timeOfDay <= NIGHT && header->player.homeBase >= -1 &&
+                     header->player.homeBase < static_cast<int32_t>(header->buildings.count);
+        for (uint32_t i = 0; valid && i < header->zombies.count; ++i) {
+            valid = zombieRecords[i].type >= NORMAL && zombieRecords[i].type <= EXPLODER;
+        }
+        for (uint32_t i = 0; valid && i < header->buildings.count; ++i) {
+            const BuildingRecord& record = buildingRecords[i];
+            valid = record.style >= 0 && record.style < 3 &&
+                    static_cast<uint64_t>(record.firstItem) + record.itemCount <= header->storedItems.count;
+        }
+        for (uint32_t i = 0; valid && i < header->items.count; ++i) {
+            valid = itemRecords[i].type >= 0 && itemRecords[i].type < SAVE_ITEM_TYPES;
+        }
+        for (uint32_t i = 0; valid && i < header->storedItems.count; ++i) {
+            valid = storedRecords[i].type >= 0 && storedRecords[i].type < SAVE_ITEM_TYPES;
+        }
+        if (!valid) {
+            std::cerr << "Save " << path << " has out of range records" << std::endl;
+            return false;
+        }
+
+        // From here on the save is known good; rebuild the world from it.
+        Uint32 now = SDL_GetTicks();
+        clearWorld();
+
+        worldSeed = header->worldSeed;
+        tileMap = std::make_unique<TileMap>(tilesetTexture, MAP_WIDTH, MAP_HEIGHT, TILE_SIZE, worldSeed);
+        const Uint8* populated = section_file::records<Uint8>(file, header->populatedChunks);
+        populatedChunks.assign(populated, populated + header->populatedChunks.count);
+
+        player = std::make_unique<Player>(Vector2D(header->player.x, header->player.y), playerTexture);
+        player->readRecord(header->player);
+
+        zombies.reserve(header->zombies.count);
+        for (uint32_t i = 0; i < header->zombies.count; ++i) {
+            const ZombieRecord& record = zombieRecords[i];
+            ZombieType type = static_cast<ZombieType>(record.type);
+            auto zombie = std::make_unique<Zombie>(Vector2D(record.x, record.y), zombieTextures[type], type);
+            zombie->readRecord(record, now);
+            zombies.push_back(std::move(zombie));
+        }
+
+        buildings.reserve(header->buildings.count);
+        for (uint32_t i = 0; i < header->buildings.count; ++i) {
+            const BuildingRecord& record = buildingRecords[i];
+            auto building = std::make_unique<Building>(Vector2D(record.x, record.y), buildingTextures[record.style],
+                                                       record.w, record.h);
+            for (uint32_t j = 0; j < record.itemCount; ++j) {
+                const ItemRecord& stored = storedRecords[record.firstItem + j];
+                ItemType type = static_cast<ItemType>(stored.type);
+                building->addItem(new Item(Vector2D(0, 0), itemTextures[type], type, stored.value, itemTypeName(type)));
+            }
+            building->getStorage().readCounts(record.storage);
+            if (header->player.homeBase == static_cast<int32_t>(i)) {
+                building->setHomeBase(true);
+                player->setHomeBase(building.get());
+            }
+            buildings.push_back(std::move(building));
+        }
+        buildingTree.build(buildings);
+        camera.update(player->getPosition());
+        streamWorld();
+
+        items.reserve(header->items.count);
+        for (uint32_t i = 0; i < header->items.count; ++i) {
+            const ItemRecord& record = itemRecords[i];
+            ItemType type = static_cast<ItemType>(record.type);
+            items.push_back(std::make_unique<Item>(Vector2D(record.x, record.y), itemTextures[type], type,
+                                                   record.value, itemTypeName(type)));
+        }
+
+        uiManager = std::make_unique<UIManager>(renderer, font, uiTextures[0], uiTextures[1], gameState, *player, timeOfDay);
+
+        gameTime = header->gameTime;
+        timeOfDay = static_cast<TimeOfDay>(header->timeOfDay);
+        lastFrameTime = now;
+        lastTimeUpdate = now - header->sinceTimeUpdate;
+        lastZombieSpawn = now - header->sinceZombieSpawn;
+        lastAutosave = now;
+        gameState = GAMEPLAY;
+
+        LOG_INFO(LOG_CAT_GAME, "Loaded {} - Zombies: {}, Items: {}, Buildings: {}",
+                 path, zombies.size(), items.size(), buildings.size());
+        return true;
+    }
+
     void capFrameRate(Uint32 frameStart) {
         Uint32 frameTime = SDL_GetTicks() - frameStart;
         if (frameTime < FRAME_DELAY) {
@@ -1849,25 +2682,30 @@ public:
 
 // Main function
 int main(int argc, char* argv[]) {
+    Log::start("game.log");
+
     Game game;
-    printf("About to do game. init");
+    LOG_INFO(LOG_CAT_GAME, "About to do game.init");
     //game.gameState=GAMEPLAY;
     if (!game.init("Zombie Survival", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, false)) {
         std::cerr << "Game initialization failed!" << std::endl;
+        Log::stop();
         return 1;
     }
-    printf("Game is about to be running");
+    if (argc > 1 && strcmp(argv[1], "--resume") == 0 && !game.loadGame(AUTOSAVE_PATH)) {
+        std::cerr << "Starting a new game instead" << std::endl;
+    }
+    LOG_INFO(LOG_CAT_GAME, "Game is about to be running");
     while (game.isRunning()) {
         Uint32 frameStart = SDL_GetTicks();
 
         game.handleEvents();
-	printf("HandleEvents");
         game.update();
-	printf("About to run game render");
         game.render();
 
         game.capFrameRate(frameStart);
     }
 
+    Log::stop();
     return 0;
 }
@@ -0,0 +1,630 @@
+#include "atlas.h"
+#include "../common/include/atlas_index.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define ATLAS_INDEX_NAME "atlas.idx"
+#define ATLAS_MIN_PAGE_SIZE 16
+#define ATLAS_MAX_PAGE_SIZE 16384 // sprite rects are stored as 16 bits
+#define ATLAS_MAX_PADDING 64
+
+typedef struct AtlasSprite {
+    const char *path;
+    std::string name;
+    Uint64 hash;
+    int sourceWidth, sourceHeight;
+    SDL_Rect trim;  // opaque bounds inside the source image
+    Image image;    // the trimmed pixels, once loaded
+    int page;
+    int x, y;
+} AtlasSprite;
+
+// Free space on one page, kept as the list of maximal empty rectangles
+typedef struct {
+    int width, height;
+    std::vector<SDL_Rect> freeRects;
+} MaxRectsBin;
+
+AtlasOptions defaultAtlasOptions(void) {
+    AtlasOptions options;
+    options.maxPageSize = 2048;
+    options.padding = 1;
+    options.masks = false;
+    options.force = false;
+    return options;
+}
+
+static bool isPowerOfTwo(int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+bool parseAtlasOptions(AtlasOptions *options, int argc, char *argv[]) {
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--masks") == 0) {
+            options->masks = true;
+        } else if (strcmp(argv[i], "--force") == 0) {
+            options->force = true;
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            options->maxPageSize = atoi(argv[++i]);
+            if (!isPowerOfTwo(options->maxPageSize) || options->maxPageSize < ATLAS_MIN_PAGE_SIZE || options->maxPageSize > ATLAS_MAX_PAGE_SIZE) {
+                printf("--max-size must be a power of two from %d to %d\n", ATLAS_MIN_PAGE_SIZE, ATLAS_MAX_PAGE_SIZE);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--padding") == 0 && i + 1 < argc) {
+            options->padding = atoi(argv[++i]);
+            if (options->padding < 0 || options->padding > ATLAS_MAX_PADDING) {
+                printf("--padding must be from 0 to %d\n", ATLAS_MAX_PADDING);
+                return false;
+            }
+        } else {
+            printf("Unknown atlas option %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static Uint64 hashOptions(const AtlasOptions *options) {
+    int settings[4] = {(int)atlas_index::VERSION, options->maxPageSize, options->padding, options->masks};
+    return atlas_index::hashBytes(settings, sizeof(settings));
+}
+
+static bool hashFile(const char *path, Uint64 *hash) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("Could not read %s\n", path);
+        return false;
+    }
+    static char buffer[65536];
+    Uint64 value = atlas_index::HASH_SEED;
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        value = atlas_index::hashBytes(buffer, length, value);
+    }
+    fclose(file);
+    *hash = value;
+    return true;
+}
+
+// File name without its directory and extension
+static std::string spriteName(const char *path) {
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    const char *dot = strrchr(name, '.');
+    return dot ? std::string(name, dot - name) : std::string(name);
+}
+
+static std::string joinPath(const char *dir, const std::string &name) {
+    return std::string(dir) + "/" + name;
+}
+
+static std::string pageName(int page, bool mask) {
+    char name[64];
+    snprintf(name, sizeof(name), mask ? "atlas_%d_mask.png" : "atlas_%d.png", page);
+    return name;
+}
+
+static bool fileExists(const std::string &path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file) {
+        fclose(file);
+    }
+    return file != NULL;
+}
+
+// True when the index in outputDir was built from exactly these files, with
+// the same contents and options, and its pages are still there
+static bool atlasUpToDate(const char *outputDir, const std::vector<AtlasSprite> &sprites, Uint64 optionsHash) {
+    atlas_index::File file;
+    if (!file.open(joinPath(outputDir, ATLAS_INDEX_NAME).c_str())) {
+        return false;
+    }
+    
+    const atlas_index::View &index = file.view();
+    if (index.optionsHash() != optionsHash || index.spriteCount() != sprites.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const atlas_index::Sprite *entry = index.find(sprites[i].name.c_str());
+        if (!entry || entry->sourceHash != sprites[i].hash) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < index.pageCount(); i++) {
+        if (!fileExists(joinPath(outputDir, index.pageImage(i)))) {
+            return false;
+        }
+        if (index.pageMask(i) && !fileExists(joinPath(outputDir, index.pageMask(i)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Bounds of the pixels with any alpha; empty when there are none
+static SDL_Rect opaqueBounds(const Image *image) {
+    int minX = image->width, minY = image->height, maxX = -1, maxY = -1;
+    for (int y = 0; y < image->height; y++) {
+        const Uint32 *row = (const Uint32 *)((const Uint8 *)image->surface->pixels + y * image->surface->pitch);
+        int first = 0;
+        while (first < image->width && (row[first] & 0xFF) == 0) {
+            first++;
+        }
+        if (first == image->width) {
+            continue;
+        }
+        int last = image->width - 1;
+        while ((row[last] & 0xFF) == 0) {
+            last--;
+        }
+        if (first < minX) minX = first;
+        if (last > maxX) maxX = last;
+        if (minY > y) minY = y;
+        maxY = y;
+    }
+    
+    SDL_Rect bounds = {0, 0, 0, 0};
+    if (maxX >= 0) {
+        bounds.x = minX;
+        bounds.y = minY;
+        bounds.w = maxX - minX + 1;
+        bounds.h = maxY - minY + 1;
+    }
+    return bounds;
+}
+
+// Copies rect of source to (x, y) on target, both RGBA8888, replacing what
+// was there rather than blending
+static void copyPixels(SDL_Surface *source, const SDL_Rect *rect, SDL_Surface *target, int x, int y) {
+    for (int row = 0; row < rect->h; row++) {
+        const Uint8 *src = (const Uint8 *)source->pixels + (rect->y + row) * source->pitch + rect->x * 4;
+        Uint8 *dst = (Uint8 *)target->pixels + (y + row) * target->pitch + x * 4;
+        memcpy(dst, src, rect->w * 4);
+    }
+}
+
+// Loads a sprite and keeps only its trimmed pixels
+static bool loadSprite(AtlasSprite *sprite) {
+    Image source = loadImage(sprite->path);
+    if (!source.surface) {
+        return false;
+    }
+    if (source.surface->format->format != SDL_PIXELFORMAT_RGBA8888) {
+        printf("Could not convert %s to RGBA8888: %s\n", sprite->path, SDL_GetError());
+        SDL_FreeSurface(source.surface);
+        return false;
+    }
+    if (source.width > ATLAS_MAX_PAGE_SIZE || source.height > ATLAS_MAX_PAGE_SIZE) {
+        printf("%s is larger than %d pixels\n", sprite->path, ATLAS_MAX_PAGE_SIZE);
+        SDL_FreeSurface(source.surface);
+        return false;
+    }
+    
+    sprite->sourceWidth = source.width;
+    sprite->sourceHeight = source.height;
+    sprite->trim = opaqueBounds(&source);
+    sprite->image.width = sprite->trim.w;
+    sprite->image.height = sprite->trim.h;
+    if (sprite->trim.w > 0) {
+        sprite->image.surface = SDL_CreateRGBSurfaceWithFormat(0, sprite->trim.w, sprite->trim.h, 32, SDL_PIXELFORMAT_RGBA8888);
+        if (!sprite->image.surface) {
+            printf("Error creating sprite surface: %s\n", SDL_GetError());
+            SDL_FreeSurface(source.surface);
+            return false;
+        }
+        sprite->image.pixels = (Uint32 *)sprite->image.surface->pixels;
+        copyPixels(source.surface, &sprite->trim, sprite->image.surface, 0, 0);
+    }
+    SDL_FreeSurface(source.surface);
+    return true;
+}
+
+static void initBin(MaxRectsBin *bin, int width, int height) {
+    bin->width = width;
+    bin->height = height;
+    bin->freeRects.clear();
+    SDL_Rect all = {0, 0, width, height};
+    bin->freeRects.push_back(all);
+}
+
+// Best short side fit: the free rectangle that leaves the least on its
+// shorter leftover side, ties going to the least on the longer side
+static bool findPosition(const MaxRectsBin *bin, int width, int height, SDL_Rect *placed) {
+    int bestShort = INT_MAX, bestLong = INT_MAX;
+    for (size_t i = 0; i < bin->freeRects.size(); i++) {
+        const SDL_Rect &free = bin->freeRects[i];
+        if (free.w < width || free.h < height) {
+            continue;
+        }
+        int leftoverX = free.w - width;
+        int leftoverY = free.h - height;
+        int shortSide = std::min(leftoverX, leftoverY);
+        int longSide = std::max(leftoverX, leftoverY);
+        if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+            placed->x = free.x;
+            placed->y = free.y;
+            placed->w = width;
+            placed->h = height;
+            bestShort = shortSide;
+            bestLong = longSide;
+        }
+    }
+    return bestShort != INT_MAX;
+}
+
+static bool containsRect(const SDL_Rect &outer, const SDL_Rect &inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+// Cuts used out of every free rectangle it overlaps, leaving the up to four
+// maximal rectangles around it, then drops the ones inside another
+static void placeRect(MaxRectsBin *bin, const SDL_Rect *used) {
+    std::vector<SDL_Rect> &rects = bin->freeRects;
+    size_t count = rects.size();
+    for (size_t i = 0; i < count;) {
+        SDL_Rect free = rects[i];
+        if (!SDL_HasIntersection(&free, used)) {
+            i++;
+            continue;
+        }
+        
+        if (used->x > free.x) {
+            SDL_Rect left = {free.x, free.y, used->x - free.x, free.h};
+            rects.push_back(left);
+        }
+        if (used->x + used->w < free.x + free.w) {
+            SDL_Rect right = {used->x + used->w, free.y, free.x + free.w - (used->x + used->w), free.h};
+            rects.push_back(right);
+        }
+        if (used->y > free.y) {
+            SDL_Rect top = {free.x, free.y, free.w, used->y - free.y};
+            rects.push_back(top);
+        }
+        if (used->y + used->h < free.y + free.h) {
+            SDL_Rect bottom = {free.x, used->y + used->h, free.w, free.y + free.h - (used->y + used->h)};
+            rects.push_back(bottom);
+        }
+        
+        // Swap-remove; the rect moved into i is looked at next
+        rects[i] = rects[count - 1];
+        rects[count - 1] = rects.back();
+        rects.pop_back();
+        count--;
+    }
+    
+    for (size_t i = 0; i < rects.size(); i++) {
+        for (size_t j = i + 1; j < rects.size();) {
+            if (containsRect(rects[i], rects[j])) {
+                rects[j] = rects.back();
+                rects.pop_back();
+            } else if (containsRect(rects[j], rects[i])) {
+                rects[i] = rects[j];
+                rects[j] = rects.back();
+                rects.pop_back();
+                j = i + 1;
+            } else {
+                j++;
+            }
+        }
+    }
+}
+
+// Packs as many of order as fit on a width x height page, in order. The
+// padding goes right of and below every sprite, and the bin is that much
+// larger than the page, so there is none past the page edges.
+static void packPage(const std::vector<AtlasSprite> &sprites, const std::vector<int> &order, int width, int height, int padding,
+                     std::vector<int> *placed, std::vector<SDL_Point> *positions, std::vector<int> *left) {
+    MaxRectsBin bin;
+    initBin(&bin, width + padding, height + padding);
+    placed->clear();
+    positions->clear();
+    left->clear();
+    for (size_t i = 0; i < order.size(); i++) {
+        const AtlasSprite &sprite = sprites[order[i]];
+        SDL_Rect rect;
+        if (findPosition(&bin, sprite.trim.w + padding, sprite.trim.h + padding, &rect)) {
+            placeRect(&bin, &rect);
+            SDL_Point position = {rect.x, rect.y};
+            placed->push_back(order[i]);
+            positions->push_back(position);
+        } else {
+            left->push_back(order[i]);
+        }
+    }
+}
+
+typedef struct {
+    int width, height;
+} PageSize;
+
+static bool smallerPage(const PageSize &a, const PageSize &b) {
+    long areaA = (long)a.width * a.height, areaB = (long)b.width * b.height;
+    if (areaA != areaB) return areaA < areaB;
+    return abs(a.width - a.height) < abs(b.width - b.height);
+}
+
+// Places every sprite, filling max-size pages in turn. The last page is then
+// repacked on the smallest power-of-two page that still takes all of it.
+static std::vector<PageSize> packSprites(std::vector<AtlasSprite> &sprites, const AtlasOptions *options) {
+    std::vector<int> remaining;
+    for (size_t i = 0; i < sprites.size(); i++) {
+        if (sprites[i].trim.w > 0) {
+            remaining.push_back((int)i);
+        }
+    }
+    // Longest side first, then largest, then by name so repacks of the same
+    // inputs come out the same
+    std::sort(remaining.begin(), remaining.end(), [&sprites](int a, int b) {
+        const SDL_Rect &ra = sprites[a].trim, &rb = sprites[b].trim;
+        int sideA = std::max(ra.w, ra.h), sideB = std::max(rb.w, rb.h);
+        if (sideA != sideB) return sideA > sideB;
+        if (ra.w * ra.h != rb.w * rb.h) return ra.w * ra.h > rb.w * rb.h;
+        return sprites[a].name < sprites[b].name;
+    });
+    
+    std::vector<PageSize> candidates;
+    for (int w = ATLAS_MIN_PAGE_SIZE; w <= options->maxPageSize; w *= 2) {
+        for (int h = ATLAS_MIN_PAGE_SIZE; h <= options->maxPageSize; h *= 2) {
+            if (w < options->maxPageSize || h < options->maxPageSize) {
+                PageSize size = {w, h};
+                candidates.push_back(size);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), smallerPage);
+    
+    std::vector<PageSize> pages;
+    std::vector<int> placed, left, trialPlaced, trialLeft;
+    std::vector<SDL_Point> positions, trialPositions;
+    int padding = options->padding;
+    while (!remaining.empty()) {
+        PageSize size = {options->maxPageSize, options->maxPageSize};
+        packPage(sprites, remaining, size.width, size.height, padding, &placed, &positions, &left);
+        
+        if (left.empty()) {
+            long needed = 0;
+            int widest = 0, tallest = 0;
+            for (size_t i = 0; i < placed.size(); i++) {
+                const SDL_Rect &trim = sprites[placed[i]].trim;
+                needed += (long)(trim.w + padding) * (trim.h + padding);
+                widest = std::max(widest, trim.w);
+                tallest = std::max(tallest, trim.h);
+            }
+            for (size_t i = 0; i < candidates.size(); i++) {
+                const PageSize &candidate = candidates[i];
+                if (candidate.width < widest || candidate.height < tallest ||
+                    (long)(candidate.width + padding) * (candidate.height + padding) < needed) {
+                    continue;
+                }
+                packPage(sprites, placed, candidate.width, candidate.height, padding, &trialPlaced, &trialPositions, &trialLeft);
+                if (trialLeft.empty()) {
+                    size = candidate;
+                    placed.swap(trialPlaced);
+                    positions.swap(trialPositions);
+                    break;
+                }
+            }
+        }
+        
+        for (size_t i = 0; i < placed.size(); i++) {
+            AtlasSprite &sprite = sprites[placed[i]];
+            sprite.page = (int)pages.size();
+            sprite.x = positions[i].x;
+            sprite.y = positions[i].y;
+        }
+        pages.push_back(size);
+        remaining.swap(left);
+    }
+    
+    // Fully transparent inputs still need a page to point at
+    if (pages.empty()) {
+        PageSize size = {ATLAS_MIN_PAGE_SIZE, ATLAS_MIN_PAGE_SIZE};
+        pages.push_back(size);
+    }
+    return pages;
+}
+
+static bool savePages(const std::vector<AtlasSprite> &sprites, const std::vector<PageSize> &pages, const char *outputDir, bool masks) {
+    for (size_t p = 0; p < pages.size(); p++) {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, pages[p].width, pages[p].height, 32, SDL_PIXELFORMAT_RGBA8888);
+        if (!surface) {
+            printf("Error creating page surface: %s\n", SDL_GetError());
+            return false;
+        }
+        
+        long used = 0;
+        int count = 0;
+        for (size_t i = 0; i < sprites.size(); i++) {
+            const AtlasSprite &sprite = sprites[i];
+            if (sprite.page == (int)p && sprite.image.surface) {
+                SDL_Rect all = {0, 0, sprite.image.width, sprite.image.height};
+                copyPixels(sprite.image.surface, &all, surface, sprite.x, sprite.y);
+                used += (long)all.w * all.h;
+                count++;
+            }
+        }
+        
+        std::string path = joinPath(outputDir, pageName((int)p, false));
+        bool ok = IMG_SavePNG(surface, path.c_str()) == 0;
+        if (ok && masks) {
+            Image page = {surface, (Uint32 *)surface->pixels, pages[p].width, pages[p].height};
+            Image mask = createMask(page);
+            std::string maskPath = joinPath(outputDir, pageName((int)p, true));
+            ok = mask.surface && IMG_SavePNG(mask.surface, maskPath.c_str()) == 0;
+            SDL_FreeSurface(mask.surface);
+        }
+        SDL_FreeSurface(surface);
+        if (!ok) {
+            printf("Failed to save atlas page %s: %s\n", path.c_str(), IMG_GetError());
+            return false;
+        }
+        
+        printf("Page %d: %d x %d, %d sprites, %.0f%% used\n", (int)p, pages[p].width, pages[p].height, count,
+               100.0 * used / ((double)pages[p].width * pages[p].height));
+    }
+    return true;
+}
+
+static Uint32 addString(std::vector<char> &strings, const std::string &text) {
+    Uint32 offset = (Uint32)strings.size();
+    strings.insert(strings.end(), text.c_str(), text.c_str() + text.size() + 1);
+    return offset;
+}
+
+// Writes the index next to the pages, through a temporary file so a game
+// mapping the old one never sees a half-written file
+static bool saveIndex(const std::vector<AtlasSprite> &sprites, const std::vector<PageSize> &pages, const char *outputDir,
+                      const AtlasOptions *options) {
+    std::vector<char> strings;
+    std::vector<atlas_index::Page> pageTable(pages.size());
+    for (size_t p = 0; p < pages.size(); p++) {
+        pageTable[p].image = addString(strings, pageName((int)p, false));
+        pageTable[p].mask = options->masks ? addString(strings, pageName((int)p, true)) : atlas_index::NO_STRING;
+        pageTable[p].width = (Uint16)pages[p].width;
+        pageTable[p].height = (Uint16)pages[p].height;
+        pageTable[p].reserved = 0;
+    }
+    
+    std::vector<atlas_index::Sprite> spriteTable(sprites.size());
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const AtlasSprite &sprite = sprites[i];
+        atlas_index::Sprite &entry = spriteTable[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.sourceHash = sprite.hash;
+        entry.nameHash = atlas_index::hashName(sprite.name.c_str());
+        entry.name = addString(strings, sprite.name);
+        entry.page = (Uint16)sprite.page;
+        entry.x = (Uint16)sprite.x;
+        entry.y = (Uint16)sprite.y;
+        entry.width = (Uint16)sprite.trim.w;
+        entry.height = (Uint16)sprite.trim.h;
+        entry.trimX = (Uint16)sprite.trim.x;
+        entry.trimY = (Uint16)sprite.trim.y;
+        entry.sourceWidth = (Uint16)sprite.sourceWidth;
+        entry.sourceHeight = (Uint16)sprite.sourceHeight;
+    }
+    std::sort(spriteTable.begin(), spriteTable.end(), [&strings](const atlas_index::Sprite &a, const atlas_index::Sprite &b) {
+        if (a.nameHash != b.nameHash) return a.nameHash < b.nameHash;
+        return strcmp(&strings[a.name], &strings[b.name]) < 0;
+    });
+    
+    atlas_index::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, atlas_index::MAGIC, sizeof(header.magic));
+    header.version = atlas_index::VERSION;
+    header.optionsHash = hashOptions(options);
+    header.pageCount = (Uint32)pageTable.size();
+    header.spriteCount = (Uint32)spriteTable.size();
+    header.pagesOffset = sizeof(header);
+    header.spritesOffset = header.pagesOffset + header.pageCount * sizeof(atlas_index::Page);
+    header.stringsOffset = header.spritesOffset + header.spriteCount * sizeof(atlas_index::Sprite);
+    header.stringsSize = (Uint32)strings.size();
+    
+    std::string path = joinPath(outputDir, ATLAS_INDEX_NAME);
+    std::string temporary = path + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        printf("Could not write %s\n", temporary.c_str());
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(pageTable.data(), sizeof(atlas_index::Page), pageTable.size(), file) == pageTable.size() &&
+              fwrite(spriteTable.data(), sizeof(atlas_index::Sprite), spriteTable.size(), file) == spriteTable.size() &&
+              fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+        printf("Could not write %s\n", path.c_str());
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Deletes pages left over from a larger earlier atlas, and its masks when
+// this one has none
+static void removeStalePages(const char *outputDir, int pageCount, bool masks) {
+    if (!masks) {
+        for (int p = 0; p < pageCount; p++) {
+            remove(joinPath(outputDir, pageName(p, true)).c_str());
+        }
+    }
+    for (int p = pageCount;; p++) {
+        bool removedPage = remove(joinPath(outputDir, pageName(p, false)).c_str()) == 0;
+        bool removedMask = remove(joinPath(outputDir, pageName(p, true)).c_str()) == 0;
+        if (!removedPage && !removedMask) {
+            break;
+        }
+    }
+}
+
+static void freeSprites(std::vector<AtlasSprite> &sprites) {
+    for (size_t i = 0; i < sprites.size(); i++) {
+        SDL_FreeSurface(sprites[i].image.surface);
+        sprites[i].image.surface = NULL;
+    }
+}
+
+bool buildAtlas(const image_batch::FileList *inputs, const char *outputDir, const AtlasOptions *options) {
+    // Hashing the files is much cheaper than decoding them, so that comes
+    // first and decides whether there is anything to do
+    std::vector<AtlasSprite> sprites(inputs->count);
+    for (int i = 0; i < inputs->count; i++) {
+        AtlasSprite &sprite = sprites[i];
+        sprite.path = inputs->paths[i];
+        sprite.name = spriteName(sprite.path);
+        sprite.image.surface = NULL;
+        sprite.page = sprite.x = sprite.y = 0;
+        if (!hashFile(sprite.path, &sprite.hash)) {
+            return false;
+        }
+    }
+    
+    std::vector<const AtlasSprite *> byName;
+    for (size_t i = 0; i < sprites.size(); i++) {
+        byName.push_back(&sprites[i]);
+    }
+    std::sort(byName.begin(), byName.end(), [](const AtlasSprite *a, const AtlasSprite *b) { return a->name < b->name; });
+    for (size_t i = 1; i < byName.size(); i++) {
+        if (byName[i]->name == byName[i - 1]->name) {
+            printf("%s and %s would both be named %s in the atlas\n", byName[i - 1]->path, byName[i]->path, byName[i]->name.c_str());
+            return false;
+        }
+    }
+    
+    Uint64 optionsHash = hashOptions(options);
+    if (!options->force && atlasUpToDate(outputDir, sprites, optionsHash)) {
+        printf("Atlas in %s is up to date (%d sprites)\n", outputDir, inputs->count);
+        return true;
+    }
+    
+    Uint32 start = SDL_GetTicks();
+    bool ok = true;
+    for (size_t i = 0; ok && i < sprites.size(); i++) {
+        ok = loadSprite(&sprites[i]);
+        if (ok && (sprites[i].trim.w > options->maxPageSize || sprites[i].trim.h > options->maxPageSize)) {
+            printf("%s is %d x %d after trimming and does not fit on a %d page\n", sprites[i].path,
+                   sprites[i].trim.w, sprites[i].trim.h, options->maxPageSize);
+            ok = false;
+        }
+    }
+    
+    if (ok) {
+        std::vector<PageSize> pages = packSprites(sprites, options);
+        ok = savePages(sprites, pages, outputDir, options->masks) && saveIndex(sprites, pages, outputDir, options);
+        if (ok) {
+            removeStalePages(outputDir, (int)pages.size(), options->masks);
+            printf("Atlas of %d sprites on %d pages written to %s in %u ms\n", inputs->count, (int)pages.size(), outputDir,
+                   SDL_GetTicks() - start);
+        }
+    }
+    
+    freeSprites(sprites);
+    return ok;
+}
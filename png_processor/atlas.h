@@ -0,0 +1,28 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "png_processor.h"
+
+// Settings for --atlas. They are hashed into the index, so changing any of
+// them forces a repack.
+typedef struct {
+    int maxPageSize; // pages are powers of two up to this on each side
+    int padding;     // transparent pixels between sprites
+    bool masks;      // also write a mask page per page
+    bool force;      // repack even when nothing has changed
+} AtlasOptions;
+
+AtlasOptions defaultAtlasOptions(void);
+
+// Parses the flags after --atlas <inputs> <output_dir>
+bool parseAtlasOptions(AtlasOptions *options, int argc, char *argv[]);
+
+// Trims the inputs' transparent borders, packs them with MaxRects onto
+// power-of-two pages and writes atlas_<n>.png (and atlas_<n>_mask.png) plus
+// the binary index atlas.idx, laid out as in common/include/atlas_index.h,
+// to outputDir. Sprites are named after their files without the extension.
+// When atlas.idx already lists exactly these inputs with the same content
+// hashes and options, nothing is rewritten.
+bool buildAtlas(const image_batch::FileList *inputs, const char *outputDir, const AtlasOptions *options);
+
+#endif // ATLAS_H
@@ -1,14 +1,9 @@
-#include <SDL2/SDL.h>
+#include "png_processor.h"
+#include "atlas.h"
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
-#include <stdbool.h>
-
-typedef struct {
-    SDL_Surface *surface;
-    Uint32 *pixels;
-    int width;
-    int height;
-} Image;
+#include <stdlib.h>
+#include <string.h>
 
 // Function to load a PNG and get its information
 Image loadImage(const char *filename) {
@@ -57,6 +52,17 @@ Image createMask(Image source) {
     Uint32 white = SDL_MapRGBA(mask.surface->format, 255, 255, 255, 255);
     Uint32 transparent = SDL_MapRGBA(mask.surface->format, 0, 0, 0, 0);
     
+    // Fast path: the layout loadImage() converts to, a row at a time
+    if (source.surface->format->format == SDL_PIXELFORMAT_RGBA8888) {
+        image_batch::MaskRowKernel maskRow = image_batch::maskRowKernel();
+        for (int y = 0; y < source.height; y++) {
+            const Uint32 *srcRow = (const Uint32 *)((const Uint8 *)source.surface->pixels + y * source.surface->pitch);
+            Uint32 *dstRow = (Uint32 *)((Uint8 *)mask.surface->pixels + y * mask.surface->pitch);
+            maskRow(srcRow, dstRow, source.width);
+        }
+        return mask;
+    }
+    
     // Process each pixel
     for (int y = 0; y < source.height; y++) {
         for (int x = 0; x < source.width; x++) {
@@ -106,16 +112,67 @@ bool saveSpritesheet(Image original, Image mask, const char *filename) {
     return (result == 0);
 }
 
+// Loads one image, builds its mask and saves the pair. Each call works on
+// its own surfaces only, so the batch workers can run it side by side.
+bool processImage(const char *inputFile, const char *outputFile, bool verbose) {
+    // Load the original image
+    Image original = loadImage(inputFile);
+    if (!original.surface) {
+        return false;
+    }
+    
+    if (verbose) {
+        printf("Image loaded: %s (%d x %d)\n", inputFile, original.width, original.height);
+    }
+    
+    // Create the mask
+    Image mask = createMask(original);
+    if (!mask.surface) {
+        SDL_FreeSurface(original.surface);
+        return false;
+    }
+    
+    if (verbose) {
+        printf("Mask created\n");
+    }
+    
+    // Save the spritesheet
+    bool saved = saveSpritesheet(original, mask, outputFile);
+    if (saved) {
+        if (verbose) {
+            printf("Spritesheet saved to %s\n", outputFile);
+        }
+    } else {
+        printf("Failed to save spritesheet %s: %s\n", outputFile, IMG_GetError());
+    }
+    
+    // Clean up
+    SDL_FreeSurface(original.surface);
+    SDL_FreeSurface(mask.surface);
+    
+    return saved;
+}
+
+// Batch jobs run quietly, the batch prints one summary at the end
+static bool processBatchImage(const char *inputFile, const char *outputFile) {
+    return processImage(inputFile, outputFile, false);
+}
+
 int main(int argc, char *argv[]) {
     // Check command line arguments
-    if (argc < 3) {
+    bool batchMode = argc >= 2 && strcmp(argv[1], "--batch") == 0;
+    bool atlasMode = argc >= 2 && strcmp(argv[1], "--atlas") == 0;
+    AtlasOptions atlasOptions = defaultAtlasOptions();
+    if (atlasMode && argc >= 4 && !parseAtlasOptions(&atlasOptions, argc - 4, argv + 4)) {
+        return 1;
+    }
+    if (argc < 3 || ((batchMode || atlasMode) && argc < 4)) {
         printf("Usage: %s <input_png> <output_spritesheet.png>\n", argv[0]);
+        printf("       %s --batch <input_dir|file_list> <output_dir> [threads]\n", argv[0]);
+        printf("       %s --atlas <input_dir|file_list> <output_dir> [--masks] [--max-size N] [--padding N] [--force]\n", argv[0]);
         return 1;
     }
     
-    const char *inputFile = argv[1];
-    const char *outputFile = argv[2];
-    
     // Initialize SDL and SDL_image
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("SDL initialization failed: %s\n", SDL_GetError());
@@ -129,39 +186,34 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    // Load the original image
-    Image original = loadImage(inputFile);
-    if (!original.surface) {
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-    
-    printf("Image loaded: %s (%d x %d)\n", inputFile, original.width, original.height);
-    
-    // Create the mask
-    Image mask = createMask(original);
-    if (!mask.surface) {
-        SDL_FreeSurface(original.surface);
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-    
-    printf("Mask created\n");
-    
-    // Save the spritesheet
-    if (saveSpritesheet(original, mask, outputFile)) {
-        printf("Spritesheet saved to %s\n", outputFile);
-    } else {
-        printf("Failed to save spritesheet: %s\n", IMG_GetError());
+    int result = 0;
+    if (batchMode) {
+        image_batch::Batch batch = {};
+        int threadCount = argc >= 5 ? atoi(argv[4]) : SDL_GetCPUCount();
+        if (!image_batch::buildBatch(&batch, argv[2], argv[3])) {
+            result = 1;
+        } else if (batch.count == 0) {
+            printf("No images found in %s\n", argv[2]);
+        } else if (image_batch::runBatch(&batch, processBatchImage, threadCount, "mask worker") > 0) {
+            result = 1;
+        }
+        image_batch::freeBatch(&batch);
+    } else if (atlasMode) {
+        image_batch::FileList inputs = {};
+        if (!image_batch::listInputs(&inputs, argv[2])) {
+            result = 1;
+        } else if (inputs.count == 0) {
+            printf("No images found in %s\n", argv[2]);
+        } else if (!buildAtlas(&inputs, argv[3], &atlasOptions)) {
+            result = 1;
+        }
+        image_batch::freeFileList(&inputs);
+    } else if (!processImage(argv[1], argv[2], true)) {
+        result = 1;
     }
     
-    // Clean up
-    SDL_FreeSurface(original.surface);
-    SDL_FreeSurface(mask.surface);
     IMG_Quit();
     SDL_Quit();
     
-    return 0;
+    return result;
 }
@@ -0,0 +1,23 @@
+#ifndef PNG_PROCESSOR_H
+#define PNG_PROCESSOR_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include "../common/include/image_batch.h"
+
+#define MAX_PATH_LENGTH 1024
+
+typedef struct {
+    SDL_Surface *surface;
+    Uint32 *pixels;
+    int width;
+    int height;
+} Image;
+
+// Loads a PNG, converted to SDL_PIXELFORMAT_RGBA8888 when possible
+Image loadImage(const char *filename);
+
+// Mask of an image: white where it is not transparent
+Image createMask(Image source);
+
+#endif // PNG_PROCESSOR_H
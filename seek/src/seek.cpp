@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include "terrain.h"
 
 // Game constants
 #define WINDOW_WIDTH 800
@@ -25,8 +26,7 @@
 #define BULLET_SPEED 10
 #define ENEMY_SPEED 2
 #define GRAVITY 0.5
-#define TERRAIN_SEGMENTS 100
-#define SEGMENT_WIDTH (WINDOW_WIDTH / TERRAIN_SEGMENTS)
+#define CRATER_RADIUS 12
 
 typedef struct {
     float x, y;
@@ -59,22 +59,15 @@ typedef struct {
     int fuel;
 } Player;
 
-typedef struct {
-    int heights[TERRAIN_SEGMENTS + 1];
-    int segments;
-} Terrain;
-
 // Function prototypes
 bool initialize(SDL_Window** window, SDL_Renderer** renderer);
 void cleanup(SDL_Window* window, SDL_Renderer* renderer);
 void handleInput(SDL_Event* event, bool* quit, Player* player);
 void updateGame(Player* player, Bullet bullets[], Enemy enemies[], Building buildings[], Terrain* terrain);
-void renderGame(SDL_Renderer* renderer, Player player, Bullet bullets[], Enemy enemies[], Building buildings[], Terrain terrain);
-void generateTerrain(Terrain* terrain);
+void renderGame(SDL_Renderer* renderer, const Player* player, Bullet bullets[], Enemy enemies[], Building buildings[], Terrain* terrain);
 void spawnEnemy(Enemy enemies[]);
-void spawnBuilding(Building buildings[], Terrain terrain);
+void spawnBuilding(Building buildings[], const Terrain* terrain);
 bool checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2);
-int getTerrainHeight(float x, Terrain terrain);
 
 int main(int argc, char* argv[]) {
     SDL_Window* window = NULL;
@@ -85,7 +78,7 @@ int main(int argc, char* argv[]) {
     Bullet bullets[MAX_BULLETS] = {0};
     Enemy enemies[MAX_ENEMIES] = {0};
     Building buildings[MAX_BUILDINGS] = {0};
-    Terrain terrain = {0};
+    Terrain terrain = {};
     
     srand(time(NULL));
     
@@ -93,6 +86,10 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (!initTerrain(&terrain, renderer, WINDOW_WIDTH, WINDOW_HEIGHT, TERRAIN_HEIGHT / 2)) {
+        cleanup(window, renderer);
+        return 1;
+    }
     generateTerrain(&terrain);
     
     // Initialize some enemies and buildings
@@ -101,7 +98,7 @@ int main(int argc, char* argv[]) {
     }
     
     for (int i = 0; i < 8; i++) {
-        spawnBuilding(buildings, terrain);
+        spawnBuilding(buildings, &terrain);
     }
     
     Uint32 lastTime = SDL_GetTicks();
@@ -121,7 +118,7 @@ int main(int argc, char* argv[]) {
         updateGame(&player, bullets, enemies, buildings, &terrain);
         
         // Render the game
-        renderGame(renderer, player, bullets, enemies, buildings, terrain);
+        renderGame(renderer, &player, bullets, enemies, buildings, &terrain);
         
         // Cap the frame rate
         SDL_Delay(16); // ~60 FPS
@@ -141,6 +138,7 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    destroyTerrain(&terrain);
     cleanup(window, renderer);
     return 0;
 }
@@ -234,7 +232,7 @@ void updateGame(Player* player, Bullet bullets[], Enemy enemies[], Building buil
     if (player->y > WINDOW_HEIGHT - PLAYER_HEIGHT) player->y = WINDOW_HEIGHT - PLAYER_HEIGHT;
     
     // Check player collision with terrain
-    int terrainHeightAtPlayer = getTerrainHeight(player->x + PLAYER_WIDTH / 2, *terrain);
+    float terrainHeightAtPlayer = getTerrainHeight(terrain, player->x + PLAYER_WIDTH / 2);
     if (player->y + PLAYER_HEIGHT > WINDOW_HEIGHT - terrainHeightAtPlayer) {
         player->health = 0; // Crash!
     }
@@ -271,10 +269,11 @@ void updateGame(Player* player, Bullet bullets[], Enemy enemies[], Building buil
                 continue;
             }
             
-            // Check bullet collision with terrain
-            int terrainHeightAtBullet = getTerrainHeight(bullets[i].x, *terrain);
+            // Check bullet collision with terrain, which leaves a crater
+            float terrainHeightAtBullet = getTerrainHeight(terrain, bullets[i].x);
             if (bullets[i].y + BULLET_HEIGHT > WINDOW_HEIGHT - terrainHeightAtBullet) {
                 bullets[i].active = false;
+                addCrater(terrain, bullets[i].x + BULLET_WIDTH / 2, CRATER_RADIUS);
                 continue;
             }
             
@@ -329,7 +328,7 @@ void updateGame(Player* player, Bullet bullets[], Enemy enemies[], Building buil
             
             // Keep ground units on the ground
             if (enemies[i].type == 0) {
-                int terrainHeight = getTerrainHeight(enemies[i].x + ENEMY_WIDTH / 2, *terrain);
+                float terrainHeight = getTerrainHeight(terrain, enemies[i].x + ENEMY_WIDTH / 2);
                 enemies[i].y = WINDOW_HEIGHT - terrainHeight - ENEMY_HEIGHT;
             }
             
@@ -379,6 +378,14 @@ void updateGame(Player* player, Bullet bullets[], Enemy enemies[], Building buil
         }
     }
     
+    // Buildings settle into craters dug under them
+    for (int i = 0; i < MAX_BUILDINGS; i++) {
+        if (buildings[i].active) {
+            float terrainHeight = getTerrainHeight(terrain, buildings[i].x + buildings[i].width / 2);
+            buildings[i].y = WINDOW_HEIGHT - terrainHeight - buildings[i].height;
+        }
+    }
+    
     // Occasionally add fuel
     if (rand() % 1000 < 5) {
         player->fuel += 100;
@@ -386,22 +393,13 @@ void updateGame(Player* player, Bullet bullets[], Enemy enemies[], Building buil
     }
 }
 
-void renderGame(SDL_Renderer* renderer, Player player, Bullet bullets[], Enemy enemies[], Building buildings[], Terrain terrain) {
+void renderGame(SDL_Renderer* renderer, const Player* player, Bullet bullets[], Enemy enemies[], Building buildings[], Terrain* terrain) {
     // Clear screen
     SDL_SetRenderDrawColor(renderer, 135, 206, 235, 255); // Sky blue
     SDL_RenderClear(renderer);
     
     // Draw terrain
-    SDL_SetRenderDrawColor(renderer, 34, 139, 34, 255); // Forest green
-    for (int i = 0; i < terrain.segments; i++) {
-        SDL_Rect terrainRect = {
-            i * SEGMENT_WIDTH,
-            WINDOW_HEIGHT - terrain.heights[i],
-            SEGMENT_WIDTH + 1, // +1 to avoid gaps
-            terrain.heights[i]
-        };
-        SDL_RenderFillRect(renderer, &terrainRect);
-    }
+    renderTerrain(renderer, terrain);
     
     // Draw buildings
     SDL_SetRenderDrawColor(renderer, 169, 169, 169, 255); // Dark gray
@@ -453,8 +451,8 @@ void renderGame(SDL_Renderer* renderer, Player player, Bullet bullets[], Enemy e
     // Draw player helicopter
     SDL_SetRenderDrawColor(renderer, 0, 100, 0, 255); // Dark green
     SDL_Rect playerRect = {
-        (int)player.x,
-        (int)player.y,
+        (int)player->x,
+        (int)player->y,
         PLAYER_WIDTH,
         PLAYER_HEIGHT
     };
@@ -463,8 +461,8 @@ void renderGame(SDL_Renderer* renderer, Player player, Bullet bullets[], Enemy e
     // Draw rotor
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_Rect rotorRect = {
-        (int)player.x + PLAYER_WIDTH / 4,
-        (int)player.y - 5,
+        (int)player->x + PLAYER_WIDTH / 4,
+        (int)player->y - 5,
         PLAYER_WIDTH / 2,
         5
     };
@@ -476,10 +474,10 @@ void renderGame(SDL_Renderer* renderer, Player player, Bullet bullets[], Enemy e
     char ammoText[32];
     char fuelText[32];
     
-    sprintf(scoreText, "Score: %d", player.score);
-    sprintf(healthText, "Health: %d", player.health);
-    sprintf(ammoText, "Ammo: %d", player.ammo);
-    sprintf(fuelText, "Fuel: %d", player.fuel);
+    sprintf(scoreText, "Score: %d", player->score);
+    sprintf(healthText, "Health: %d", player->health);
+    sprintf(ammoText, "Ammo: %d", player->ammo);
+    sprintf(fuelText, "Fuel: %d", player->fuel);
     
     // We would use SDL_ttf to render text, but for simplicity we'll just use rectangles as placeholders
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 128);
@@ -490,25 +488,6 @@ void renderGame(SDL_Renderer* renderer, Player player, Bullet bullets[], Enemy e
     SDL_RenderPresent(renderer);
 }
 
-void generateTerrain(Terrain* terrain) {
-    terrain->segments = TERRAIN_SEGMENTS;
-    
-    // Generate a simple hilly terrain
-    int baseHeight = TERRAIN_HEIGHT / 4;
-    int prevHeight = baseHeight;
-    
-    for (int i = 0; i <= terrain->segments; i++) {
-        int newHeight = prevHeight + (rand() % 21 - 10);
-        
-        // Keep within bounds
-        if (newHeight < baseHeight / 2) newHeight = baseHeight / 2;
-        if (newHeight > baseHeight * 2) newHeight = baseHeight * 2;
-        
-        terrain->heights[i] = newHeight;
-        prevHeight = newHeight;
-    }
-}
-
 void spawnEnemy(Enemy enemies[]) {
     for (int i = 0; i < MAX_ENEMIES; i++) {
         if (!enemies[i].active) {
@@ -535,7 +514,7 @@ void spawnEnemy(Enemy enemies[]) {
     }
 }
 
-void spawnBuilding(Building buildings[], Terrain terrain) {
+void spawnBuilding(Building buildings[], const Terrain* terrain) {
     for (int i = 0; i < MAX_BUILDINGS; i++) {
         if (!buildings[i].active) {
             buildings[i].active = true;
@@ -545,7 +524,7 @@ void spawnBuilding(Building buildings[], Terrain terrain) {
             buildings[i].x = rand() % (WINDOW_WIDTH - BUILDING_WIDTH);
             
             // Place on terrain
-            int terrainHeight = getTerrainHeight(buildings[i].x + BUILDING_WIDTH / 2, terrain);
+            float terrainHeight = getTerrainHeight(terrain, buildings[i].x + BUILDING_WIDTH / 2);
             buildings[i].y = WINDOW_HEIGHT - terrainHeight - BUILDING_HEIGHT;
             
             // Random size variation
@@ -560,14 +539,3 @@ void spawnBuilding(Building buildings[], Terrain terrain) {
 bool checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2) {
     return (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2);
 }
-
-int getTerrainHeight(float x, Terrain terrain) {
-    if (x < 0) return terrain.heights[0];
-    if (x >= WINDOW_WIDTH) return terrain.heights[terrain.segments];
-    
-    int segment = (int)(x / SEGMENT_WIDTH);
-    float t = (x - segment * SEGMENT_WIDTH) / SEGMENT_WIDTH;
-    
-    // Linear interpolation between segments
-    return terrain.heights[segment] * (1 - t) + terrain.heights[segment + 1] * t;
-}
@@ -0,0 +1,132 @@
+#include "terrain.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define TERRAIN_COLOR 0x228B22FF // forest green, RGBA8888
+
+static void markDirty(Terrain* terrain, int start, int end) {
+    if (start < 0) start = 0;
+    if (end > terrain->width) end = terrain->width;
+    if (start >= end) return;
+    
+    if (terrain->dirtyStart >= terrain->dirtyEnd) {
+        terrain->dirtyStart = start;
+        terrain->dirtyEnd = end;
+    } else {
+        if (start < terrain->dirtyStart) terrain->dirtyStart = start;
+        if (end > terrain->dirtyEnd) terrain->dirtyEnd = end;
+    }
+}
+
+bool initTerrain(Terrain* terrain, SDL_Renderer* renderer, int width, int screenHeight, int maxHeight) {
+    terrain->segments = TERRAIN_SEGMENTS;
+    terrain->segmentWidth = (float)width / TERRAIN_SEGMENTS;
+    terrain->width = width;
+    terrain->screenHeight = screenHeight;
+    terrain->maxHeight = maxHeight;
+    terrain->dirtyStart = terrain->dirtyEnd = 0;
+    for (int i = 0; i <= TERRAIN_SEGMENTS; i++) {
+        terrain->heights[i] = 0;
+    }
+    
+    terrain->pixels = (Uint32*)malloc(width * maxHeight * sizeof(Uint32));
+    if (terrain->pixels == NULL) {
+        printf("Could not allocate terrain pixels!\n");
+        return false;
+    }
+    
+    terrain->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, width, maxHeight);
+    if (terrain->texture == NULL) {
+        printf("Terrain texture could not be created! SDL_Error: %s\n", SDL_GetError());
+        free(terrain->pixels);
+        terrain->pixels = NULL;
+        return false;
+    }
+    SDL_SetTextureBlendMode(terrain->texture, SDL_BLENDMODE_BLEND);
+    
+    markDirty(terrain, 0, width);
+    return true;
+}
+
+void destroyTerrain(Terrain* terrain) {
+    if (terrain->texture != NULL) {
+        SDL_DestroyTexture(terrain->texture);
+        terrain->texture = NULL;
+    }
+    free(terrain->pixels);
+    terrain->pixels = NULL;
+}
+
+void generateTerrain(Terrain* terrain) {
+    // Generate a simple hilly terrain
+    int baseHeight = terrain->maxHeight / 2;
+    int prevHeight = baseHeight;
+    
+    for (int i = 0; i <= terrain->segments; i++) {
+        int newHeight = prevHeight + (rand() % 21 - 10);
+        
+        // Keep within bounds
+        if (newHeight < baseHeight / 2) newHeight = baseHeight / 2;
+        if (newHeight > baseHeight * 2) newHeight = baseHeight * 2;
+        
+        terrain->heights[i] = newHeight;
+        prevHeight = newHeight;
+    }
+    
+    markDirty(terrain, 0, terrain->width);
+}
+
+float getTerrainHeight(const Terrain* terrain, float x) {
+    if (x < 0) return terrain->heights[0];
+    if (x >= terrain->width) return terrain->heights[terrain->segments];
+    
+    int segment = (int)(x / terrain->segmentWidth);
+    if (segment >= terrain->segments) segment = terrain->segments - 1;
+    float t = (x - segment * terrain->segmentWidth) / terrain->segmentWidth;
+    
+    // Linear interpolation between segments
+    return terrain->heights[segment] * (1 - t) + terrain->heights[segment + 1] * t;
+}
+
+void addCrater(Terrain* terrain, float x, float radius) {
+    float centre = getTerrainHeight(terrain, x);
+    int first = (int)ceilf((x - radius) / terrain->segmentWidth);
+    int last = (int)floorf((x + radius) / terrain->segmentWidth);
+    if (first < 0) first = 0;
+    if (last > terrain->segments) last = terrain->segments;
+    if (first > last) return;
+    
+    for (int i = first; i <= last; i++) {
+        float dx = i * terrain->segmentWidth - x;
+        float bottom = centre - sqrtf(radius * radius - dx * dx);
+        if (bottom < TERRAIN_MIN_HEIGHT) bottom = TERRAIN_MIN_HEIGHT;
+        if (terrain->heights[i] > bottom) terrain->heights[i] = bottom;
+    }
+    
+    // The columns between the neighbouring samples are interpolated from the
+    // changed ones, so they are redrawn too
+    markDirty(terrain, (int)floorf((first - 1) * terrain->segmentWidth), (int)ceilf((last + 1) * terrain->segmentWidth));
+}
+
+void renderTerrain(SDL_Renderer* renderer, Terrain* terrain) {
+    if (terrain->dirtyStart < terrain->dirtyEnd) {
+        int start = terrain->dirtyStart;
+        int end = terrain->dirtyEnd;
+        for (int x = start; x < end; x++) {
+            int top = terrain->maxHeight - (int)getTerrainHeight(terrain, x + 0.5f);
+            if (top < 0) top = 0;
+            Uint32* column = &terrain->pixels[x];
+            for (int y = 0; y < terrain->maxHeight; y++) {
+                column[y * terrain->width] = y >= top ? TERRAIN_COLOR : 0;
+            }
+        }
+        
+        SDL_Rect span = {start, 0, end - start, terrain->maxHeight};
+        SDL_UpdateTexture(terrain->texture, &span, &terrain->pixels[start], terrain->width * sizeof(Uint32));
+        terrain->dirtyStart = terrain->dirtyEnd = 0;
+    }
+    
+    SDL_Rect strip = {0, terrain->screenHeight - terrain->maxHeight, terrain->width, terrain->maxHeight};
+    SDL_RenderCopy(renderer, terrain->texture, NULL, &strip);
+}
@@ -0,0 +1,38 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#define TERRAIN_SEGMENTS 100
+#define TERRAIN_MIN_HEIGHT 10 // craters never dig below this
+
+// The ground: a heightfield of TERRAIN_SEGMENTS + 1 samples spread across the
+// screen, heights measured up from the bottom edge. It is drawn from a cached
+// strip texture along the bottom of the screen, maxHeight tall, holding one
+// column per pixel. Changing the heights only marks the columns they cover
+// as dirty, and renderTerrain() re-uploads just that span.
+typedef struct {
+    float heights[TERRAIN_SEGMENTS + 1];
+    int segments;
+    float segmentWidth;
+    int width, screenHeight, maxHeight;
+    SDL_Texture* texture;
+    Uint32* pixels; // CPU copy of the texture, width x maxHeight
+    int dirtyStart, dirtyEnd; // columns to re-upload, none when start >= end
+} Terrain;
+
+bool initTerrain(Terrain* terrain, SDL_Renderer* renderer, int width, int screenHeight, int maxHeight);
+void destroyTerrain(Terrain* terrain);
+void generateTerrain(Terrain* terrain);
+
+// Height of the ground at x, interpolated between samples and clamped to the
+// first and last sample off the edges
+float getTerrainHeight(const Terrain* terrain, float x);
+
+// Blasts a round crater of the given radius into the ground at x
+void addCrater(Terrain* terrain, float x, float radius);
+
+void renderTerrain(SDL_Renderer* renderer, Terrain* terrain);
+
+#endif // TERRAIN_H
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <random>
 #include <algorithm>
+#include "../../common/include/batch_aabb.h"
 
 // Game constants
 const int SCREEN_WIDTH = 800;
@@ -59,6 +60,11 @@ SDL_Texture* gBackgroundTexture = nullptr;
 std::random_device rd;
 std::mt19937 gen(rd());
 
+// Enemy boxes for the batched collision tests, rebuilt every frame; kept
+// global so the arrays are not reallocated
+batch_aabb::BoxArray gEnemyBoxes;
+std::vector<uint64_t> gHitMask;
+
 int main(int argc, char* args[]) {
     if (!init()) {
         std::cout << "Failed to initialize!" << std::endl;
@@ -332,48 +338,43 @@ void spawnEnemy(std::vector<Enemy>& enemies) {
 }
 
 void checkCollisions(Player& player, std::vector<Bullet>& bullets, std::vector<Enemy>& enemies) {
-    // Check bullet-enemy collisions
+    // One box per enemy, empty for inactive ones, so box i is enemies[i]
+    gEnemyBoxes.clear();
+    for (const auto& enemy : enemies) {
+        if (enemy.active) {
+            gEnemyBoxes.push(batch_aabb::makeBox(enemy.x, enemy.y, enemy.width, enemy.height));
+        } else {
+            gEnemyBoxes.pushEmpty();
+        }
+    }
+    gHitMask.resize(gEnemyBoxes.maskWords());
+    if (gHitMask.empty()) return;
+    
+    // Check bullet-enemy collisions; a bullet hits the first enemy it overlaps
     for (auto& bullet : bullets) {
         if (!bullet.active) continue;
         
-        for (auto& enemy : enemies) {
-            if (!enemy.active) continue;
+        batch_aabb::overlapMask(batch_aabb::makeBox(bullet.x, bullet.y, bullet.width, bullet.height), gEnemyBoxes, gHitMask.data());
+        int hit = batch_aabb::firstHit(gHitMask.data(), gHitMask.size());
+        if (hit >= 0) {
+            Enemy& enemy = enemies[hit];
+            bullet.active = false;
+            enemy.health--;
             
-            // Simple AABB collision detection
-            bool collision = (bullet.x < enemy.x + enemy.width &&
-                             bullet.x + bullet.width > enemy.x &&
-                             bullet.y < enemy.y + enemy.height &&
-                             bullet.y + bullet.height > enemy.y);
-                             
-            if (collision) {
-                bullet.active = false;
-                enemy.health--;
-                
-                if (enemy.health <= 0) {
-                    enemy.active = false;
-                    player.score += 10;
-                }
-                
-                break;
+            if (enemy.health <= 0) {
+                enemy.active = false;
+                gEnemyBoxes.remove(hit);
+                player.score += 10;
             }
         }
     }
     
     // Check player-enemy collisions
-    for (auto& enemy : enemies) {
-        if (!enemy.active) continue;
-        
-        // Simple AABB collision detection
-        bool collision = (player.x < enemy.x + enemy.width &&
-                         player.x + player.width > enemy.x &&
-                         player.y < enemy.y + enemy.height &&
-                         player.y + player.height > enemy.y);
-                         
-        if (collision) {
-            player.health -= 10;
-            enemy.active = false;
-            break;
-        }
+    batch_aabb::overlapMask(batch_aabb::makeBox(player.x, player.y, player.width, player.height), gEnemyBoxes, gHitMask.data());
+    int hit = batch_aabb::firstHit(gHitMask.data(), gHitMask.size());
+    if (hit >= 0) {
+        player.health -= 10;
+        enemies[hit].active = false;
     }
 }
 
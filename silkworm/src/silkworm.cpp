@@ -3,7 +3,9 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "../../common/include/batch_aabb.h"
 
 // Game constants
 #define SCREEN_WIDTH 800
@@ -14,6 +16,12 @@
 #define MAX_ENEMIES 10
 #define ENEMY_SPEED 3
 #define SCROLL_SPEED 2
+#define LEVEL_DIRECTORY "levels/level1/"
+#define STRIP_WIDTH 200
+#define STRIPS_VISIBLE (SCREEN_WIDTH / STRIP_WIDTH + 1)
+#define STRIP_RING 8 // GPU strip textures: the visible ones plus the next few
+#define STRIP_TREES 6 // per procedural strip
+#define STRIP_PRELOAD_TIMEOUT 2000 // ms to wait for the first screen
 
 // Game states
 typedef enum {
@@ -40,11 +48,36 @@ typedef struct {
     float velocity_x, velocity_y;
 } Entity;
 
+// Streams the level background from disk as vertical strips,
+// levels/level1/strip0000.png, strip0001.png and so on, each STRIP_WIDTH x
+// SCREEN_HEIGHT. A decode thread loads strips ahead of the scroll into
+// surfaces, and the main thread copies them into a fixed ring of STRIP_RING
+// textures, strip k into texture k % STRIP_RING, one upload per frame at
+// most. Memory is the same for any level length. The level repeats after
+// its last strip; with no strips on disk, procedural strips are streamed
+// instead.
+typedef struct {
+    SDL_Texture* textures[STRIP_RING];
+    int resident[STRIP_RING]; // strip in each texture, -1 for none
+    int scroll; // pixels scrolled since the level start
+    int strip_count; // strips on disk, 0 for procedural
+    char directory[128];
+    
+    // Shared with the decode thread, guarded by lock
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_cond* wake;
+    bool quit;
+    int wanted[STRIP_RING]; // strip the main thread wants in each slot
+    int decoded_strip[STRIP_RING]; // strip last decoded for each slot
+    SDL_Surface* decoded[STRIP_RING]; // waiting for upload, NULL once taken
+} StripStreamer;
+
 // Game structure
 typedef struct {
     SDL_Window* window;
     SDL_Renderer* renderer;
-    SDL_Texture* background;
+    StripStreamer background;
     SDL_Texture* helicopter;
     SDL_Texture* jeep;
     SDL_Texture* enemy;
@@ -53,7 +86,6 @@ typedef struct {
     Entity player_jeep;
     Entity bullets[MAX_BULLETS];
     Entity enemies[MAX_ENEMIES];
-    int bg_scroll_offset;
     Uint32 last_enemy_spawn;
     GameState state;
     int score;
@@ -67,7 +99,11 @@ void update_game(Game* game);
 void render_game(Game* game);
 void spawn_enemy(Game* game);
 void spawn_bullet(Game* game, Entity* player);
-bool check_collision(Entity* a, Entity* b);
+batch_aabb::Box entity_box(const Entity* entity);
+bool init_strip_streamer(StripStreamer* streamer, SDL_Renderer* renderer, const char* directory);
+void update_strip_streamer(StripStreamer* streamer, int upload_budget);
+void render_strip_streamer(StripStreamer* streamer, SDL_Renderer* renderer);
+void destroy_strip_streamer(StripStreamer* streamer);
 
 int main(int argc, char* argv[]) {
     Game game;
@@ -134,22 +170,11 @@ bool initialize_game(Game* game) {
     // Load textures (In a real game, you would load actual image files)
     // We'll create colored rectangles for demonstration purposes
     
-    // Create background texture
-    game->background = SDL_CreateTexture(game->renderer, SDL_PIXELFORMAT_RGBA8888,
-                                       SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT * 2);
-    SDL_SetRenderTarget(game->renderer, game->background);
-    SDL_SetRenderDrawColor(game->renderer, 50, 100, 50, 255); // Green background
-    SDL_RenderClear(game->renderer);
-    
-    // Draw some background elements (trees, etc.)
-    SDL_SetRenderDrawColor(game->renderer, 30, 80, 30, 255);
-    for (int i = 0; i < 50; i++) {
-        SDL_Rect rect = {rand() % SCREEN_WIDTH, rand() % (SCREEN_HEIGHT * 2), 20, 40};
-        SDL_RenderFillRect(game->renderer, &rect);
+    // Start streaming the background
+    if (!init_strip_streamer(&game->background, game->renderer, LEVEL_DIRECTORY)) {
+        return false;
     }
     
-    SDL_SetRenderTarget(game->renderer, NULL);
-    
     // Create helicopter texture
     game->helicopter = SDL_CreateTexture(game->renderer, SDL_PIXELFORMAT_RGBA8888,
                                       SDL_TEXTUREACCESS_TARGET, 50, 30);
@@ -218,7 +243,6 @@ bool initialize_game(Game* game) {
     }
     
     // Initialize game state
-    game->bg_scroll_offset = 0;
     game->last_enemy_spawn = 0;
     game->state = GAME_RUNNING;
     game->score = 0;
@@ -227,7 +251,7 @@ bool initialize_game(Game* game) {
 }
 
 void clean_up(Game* game) {
-    SDL_DestroyTexture(game->background);
+    destroy_strip_streamer(&game->background);
     SDL_DestroyTexture(game->helicopter);
     SDL_DestroyTexture(game->jeep);
     SDL_DestroyTexture(game->enemy);
@@ -297,7 +321,8 @@ void handle_input(Game* game, bool* quit) {
 
 void update_game(Game* game) {
     // Update background scroll
-    game->bg_scroll_offset = (game->bg_scroll_offset + SCROLL_SPEED) % SCREEN_HEIGHT;
+    game->background.scroll += SCROLL_SPEED;
+    update_strip_streamer(&game->background, 1);
     
     // Spawn enemies
     if (SDL_GetTicks() - game->last_enemy_spawn > 1000) {
@@ -305,6 +330,18 @@ void update_game(Game* game) {
         game->last_enemy_spawn = SDL_GetTicks();
     }
     
+    // Enemy boxes for the batched collision tests; box j is enemies[j],
+    // empty while the enemy is inactive
+    static batch_aabb::BoxArray enemy_boxes;
+    enemy_boxes.clear();
+    for (int j = 0; j < MAX_ENEMIES; j++) {
+        if (game->enemies[j].active) {
+            enemy_boxes.push(entity_box(&game->enemies[j]));
+        } else {
+            enemy_boxes.pushEmpty();
+        }
+    }
+    
     // Update bullets
     for (int i = 0; i < MAX_BULLETS; i++) {
         if (game->bullets[i].active) {
@@ -315,51 +352,58 @@ void update_game(Game* game) {
                 game->bullets[i].active = false;
             }
             
-            // Check for collisions with enemies
-            for (int j = 0; j < MAX_ENEMIES; j++) {
-                if (game->enemies[j].active && check_collision(&game->bullets[i], &game->enemies[j])) {
-                    game->enemies[j].health--;
-                    game->bullets[i].active = false;
-                    
-                    if (game->enemies[j].health <= 0) {
-                        game->enemies[j].active = false;
-                        game->score += 100;
-                    }
-                    
-                    break;
+            // Check for collisions with enemies, the first one overlapped
+            // takes the bullet
+            int j = batch_aabb::firstHit(batch_aabb::overlapMask64(entity_box(&game->bullets[i]), enemy_boxes));
+            if (j >= 0) {
+                game->enemies[j].health--;
+                game->bullets[i].active = false;
+                
+                if (game->enemies[j].health <= 0) {
+                    game->enemies[j].active = false;
+                    enemy_boxes.remove(j);
+                    game->score += 100;
                 }
             }
         }
     }
     
-    // Update enemies
+    // Update enemies; every enemy that was active at the start of the pass
+    // is tested against the players, even if it just left the screen
+    enemy_boxes.clear();
     for (int i = 0; i < MAX_ENEMIES; i++) {
         if (game->enemies[i].active) {
             game->enemies[i].x -= ENEMY_SPEED;
+            enemy_boxes.push(entity_box(&game->enemies[i]));
             
             // Remove enemies that go off-screen
             if (game->enemies[i].x + game->enemies[i].width < 0) {
                 game->enemies[i].active = false;
             }
-            
-            // Check for collisions with players
-            if (check_collision(&game->enemies[i], &game->player_helicopter)) {
-                game->player_helicopter.health--;
-                game->enemies[i].active = false;
-                
-                if (game->player_helicopter.health <= 0) {
-                    game->player_helicopter.active = false;
-                }
-            }
-            
-            if (check_collision(&game->enemies[i], &game->player_jeep)) {
-                game->player_jeep.health--;
-                game->enemies[i].active = false;
-                
-                if (game->player_jeep.health <= 0) {
-                    game->player_jeep.active = false;
-                }
-            }
+        } else {
+            enemy_boxes.pushEmpty();
+        }
+    }
+    
+    // Check for collisions with players; an enemy touching both hurts both
+    uint64_t helicopter_hits = batch_aabb::overlapMask64(entity_box(&game->player_helicopter), enemy_boxes);
+    uint64_t jeep_hits = batch_aabb::overlapMask64(entity_box(&game->player_jeep), enemy_boxes);
+    for (int i = batch_aabb::firstHit(helicopter_hits); i >= 0; i = batch_aabb::firstHit(helicopter_hits)) {
+        helicopter_hits &= helicopter_hits - 1;
+        game->player_helicopter.health--;
+        game->enemies[i].active = false;
+        
+        if (game->player_helicopter.health <= 0) {
+            game->player_helicopter.active = false;
+        }
+    }
+    for (int i = batch_aabb::firstHit(jeep_hits); i >= 0; i = batch_aabb::firstHit(jeep_hits)) {
+        jeep_hits &= jeep_hits - 1;
+        game->player_jeep.health--;
+        game->enemies[i].active = false;
+        
+        if (game->player_jeep.health <= 0) {
+            game->player_jeep.active = false;
         }
     }
     
@@ -375,10 +419,7 @@ void render_game(Game* game) {
     SDL_RenderClear(game->renderer);
     
     // Render scrolling background
-    SDL_Rect bg_rect1 = {0, game->bg_scroll_offset, SCREEN_WIDTH, SCREEN_HEIGHT};
-    SDL_Rect bg_rect2 = {0, game->bg_scroll_offset - SCREEN_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT};
-    SDL_RenderCopy(game->renderer, game->background, &bg_rect1, NULL);
-    SDL_RenderCopy(game->renderer, game->background, &bg_rect2, NULL);
+    render_strip_streamer(&game->background, game->renderer);
     
     // Render players
     if (game->player_helicopter.active) {
@@ -463,9 +504,247 @@ void spawn_bullet(Game* game, Entity* player) {
     }
 }
 
-bool check_collision(Entity* a, Entity* b) {
-    return (a->x < b->x + b->width &&
-            a->x + a->width > b->x &&
-            a->y < b->y + b->height &&
-            a->y + a->height > b->y);
+batch_aabb::Box entity_box(const Entity* entity) {
+    return batch_aabb::makeBox(entity->x, entity->y, entity->width, entity->height);
+}
+
+// Where strip k of the level lives on disk
+static void strip_path(const StripStreamer* streamer, int strip, char* path, size_t size) {
+    snprintf(path, size, "%sstrip%04d.png", streamer->directory, strip);
+}
+
+// The stand-in art used when the level has no strips on disk: grass with a
+// few trees, seeded by the strip index so a strip looks the same every time
+// it streams back in
+static SDL_Surface* make_procedural_strip(int strip) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, STRIP_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (surface == NULL) {
+        return NULL;
+    }
+    SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, 50, 100, 50, 255)); // Green background
+    
+    // Small LCG instead of rand(): this runs on the decode thread
+    Uint32 seed = (Uint32)strip * 2654435761u + 1;
+    for (int i = 0; i < STRIP_TREES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int x = (seed >> 8) % STRIP_WIDTH;
+        seed = seed * 1664525u + 1013904223u;
+        int y = (seed >> 8) % SCREEN_HEIGHT;
+        SDL_Rect rect = {x, y, 20, 40};
+        SDL_FillRect(surface, &rect, SDL_MapRGBA(surface->format, 30, 80, 30, 255));
+    }
+    return surface;
+}
+
+static SDL_Surface* decode_strip(const StripStreamer* streamer, int strip) {
+    if (streamer->strip_count == 0) {
+        return make_procedural_strip(strip);
+    }
+    
+    char path[256];
+    strip_path(streamer, strip % streamer->strip_count, path, sizeof(path));
+    SDL_Surface* loaded = IMG_Load(path);
+    if (loaded == NULL) {
+        printf("Background strip %s could not be loaded! SDL_image Error: %s\n", path, IMG_GetError());
+        return make_procedural_strip(strip);
+    }
+    
+    // Converted here so the upload on the main thread is a plain copy
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA8888, 0);
+    SDL_FreeSurface(loaded);
+    if (surface != NULL && (surface->w != STRIP_WIDTH || surface->h != SCREEN_HEIGHT)) {
+        printf("Background strip %s is %dx%d, expected %dx%d\n", path, surface->w, surface->h, STRIP_WIDTH, SCREEN_HEIGHT);
+        SDL_FreeSurface(surface);
+        return make_procedural_strip(strip);
+    }
+    return surface;
+}
+
+// Decodes the nearest wanted strip that is not decoded yet, sleeping while
+// there is none. The lock is dropped while decoding.
+static int strip_decode_thread(void* data) {
+    StripStreamer* streamer = (StripStreamer*)data;
+    
+    SDL_LockMutex(streamer->lock);
+    while (!streamer->quit) {
+        int slot = -1;
+        for (int i = 0; i < STRIP_RING; i++) {
+            if (streamer->wanted[i] >= 0 && streamer->decoded_strip[i] != streamer->wanted[i] &&
+                (slot < 0 || streamer->wanted[i] < streamer->wanted[slot])) {
+                slot = i;
+            }
+        }
+        if (slot < 0) {
+            SDL_CondWait(streamer->wake, streamer->lock);
+            continue;
+        }
+        
+        int strip = streamer->wanted[slot];
+        SDL_UnlockMutex(streamer->lock);
+        SDL_Surface* surface = decode_strip(streamer, strip);
+        SDL_LockMutex(streamer->lock);
+        
+        // The slot may have been handed a further strip meanwhile
+        if (streamer->wanted[slot] == strip) {
+            SDL_FreeSurface(streamer->decoded[slot]);
+            streamer->decoded[slot] = surface;
+            streamer->decoded_strip[slot] = strip;
+        } else {
+            SDL_FreeSurface(surface);
+        }
+    }
+    SDL_UnlockMutex(streamer->lock);
+    return 0;
+}
+
+bool init_strip_streamer(StripStreamer* streamer, SDL_Renderer* renderer, const char* directory) {
+    memset(streamer, 0, sizeof(*streamer));
+    snprintf(streamer->directory, sizeof(streamer->directory), "%s", directory);
+    for (int i = 0; i < STRIP_RING; i++) {
+        streamer->resident[i] = -1;
+        streamer->wanted[i] = -1;
+        streamer->decoded_strip[i] = -1;
+    }
+    
+    // Count the strips on disk; a level without any streams procedural art
+    char path[256];
+    for (;;) {
+        strip_path(streamer, streamer->strip_count, path, sizeof(path));
+        FILE* file = fopen(path, "rb");
+        if (file == NULL) {
+            break;
+        }
+        fclose(file);
+        streamer->strip_count++;
+    }
+    
+    for (int i = 0; i < STRIP_RING; i++) {
+        streamer->textures[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC,
+                                                  STRIP_WIDTH, SCREEN_HEIGHT);
+        if (streamer->textures[i] == NULL) {
+            printf("Background strip texture could not be created! SDL_Error: %s\n", SDL_GetError());
+            return false;
+        }
+    }
+    
+    streamer->lock = SDL_CreateMutex();
+    streamer->wake = SDL_CreateCond();
+    if (streamer->lock == NULL || streamer->wake == NULL) {
+        printf("Background streamer could not be created! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    streamer->thread = SDL_CreateThread(strip_decode_thread, "strip_decoder", streamer);
+    if (streamer->thread == NULL) {
+        printf("Background decode thread could not be created! SDL_Error: %s\n", SDL_GetError());
+        return false;
+    }
+    
+    // Load the first screen before the game starts so it does not open on
+    // placeholder grass
+    Uint32 start = SDL_GetTicks();
+    bool visible = false;
+    while (!visible && SDL_GetTicks() - start < STRIP_PRELOAD_TIMEOUT) {
+        update_strip_streamer(streamer, STRIP_RING);
+        visible = true;
+        for (int strip = 0; strip < STRIPS_VISIBLE; strip++) {
+            if (streamer->resident[strip % STRIP_RING] != strip) {
+                visible = false;
+            }
+        }
+        if (!visible) {
+            SDL_Delay(1);
+        }
+    }
+    
+    printf("Background: %s, ring of %d strips (%d KB)\n",
+           streamer->strip_count > 0 ? directory : "procedural", STRIP_RING,
+           STRIP_RING * STRIP_WIDTH * SCREEN_HEIGHT * 4 / 1024);
+    return true;
+}
+
+// Asks for the strips from the left edge of the screen to the end of the
+// ring and uploads at most upload_budget decoded ones, nearest first
+void update_strip_streamer(StripStreamer* streamer, int upload_budget) {
+    int first = streamer->scroll / STRIP_WIDTH;
+    
+    SDL_LockMutex(streamer->lock);
+    bool requested = false;
+    for (int strip = first; strip < first + STRIP_RING; strip++) {
+        int slot = strip % STRIP_RING;
+        if (streamer->wanted[slot] != strip) {
+            streamer->wanted[slot] = strip;
+            requested = true;
+        }
+    }
+    if (requested) {
+        SDL_CondSignal(streamer->wake);
+    }
+    SDL_UnlockMutex(streamer->lock);
+    
+    for (int strip = first; strip < first + STRIP_RING && upload_budget > 0; strip++) {
+        int slot = strip % STRIP_RING;
+        if (streamer->resident[slot] == strip) {
+            continue;
+        }
+        
+        // Take the surface out under the lock, upload outside it
+        SDL_Surface* surface = NULL;
+        SDL_LockMutex(streamer->lock);
+        if (streamer->decoded_strip[slot] == strip) {
+            surface = streamer->decoded[slot];
+            streamer->decoded[slot] = NULL;
+        }
+        SDL_UnlockMutex(streamer->lock);
+        if (surface == NULL) {
+            continue;
+        }
+        
+        SDL_UpdateTexture(streamer->textures[slot], NULL, surface->pixels, surface->pitch);
+        SDL_FreeSurface(surface);
+        streamer->resident[slot] = strip;
+        upload_budget--;
+    }
+}
+
+// Draws the visible strips; one that has not arrived yet is drawn as plain
+// grass rather than stalling the frame
+void render_strip_streamer(StripStreamer* streamer, SDL_Renderer* renderer) {
+    int first = streamer->scroll / STRIP_WIDTH;
+    for (int strip = first; strip < first + STRIPS_VISIBLE; strip++) {
+        int slot = strip % STRIP_RING;
+        SDL_Rect strip_rect = {strip * STRIP_WIDTH - streamer->scroll, 0, STRIP_WIDTH, SCREEN_HEIGHT};
+        if (streamer->resident[slot] == strip) {
+            SDL_RenderCopy(renderer, streamer->textures[slot], NULL, &strip_rect);
+        } else {
+            SDL_SetRenderDrawColor(renderer, 50, 100, 50, 255);
+            SDL_RenderFillRect(renderer, &strip_rect);
+        }
+    }
+}
+
+void destroy_strip_streamer(StripStreamer* streamer) {
+    if (streamer->thread != NULL) {
+        SDL_LockMutex(streamer->lock);
+        streamer->quit = true;
+        SDL_CondSignal(streamer->wake);
+        SDL_UnlockMutex(streamer->lock);
+        SDL_WaitThread(streamer->thread, NULL);
+        streamer->thread = NULL;
+    }
+    for (int i = 0; i < STRIP_RING; i++) {
+        SDL_FreeSurface(streamer->decoded[i]);
+        streamer->decoded[i] = NULL;
+        if (streamer->textures[i] != NULL) {
+            SDL_DestroyTexture(streamer->textures[i]);
+            streamer->textures[i] = NULL;
+        }
+    }
+    if (streamer->wake != NULL) {
+        SDL_DestroyCond(streamer->wake);
+        streamer->wake = NULL;
+    }
+    if (streamer->lock != NULL) {
+        SDL_DestroyMutex(streamer->lock);
+        streamer->lock = NULL;
+    }
 }
@@ -10,7 +10,9 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <time.h>
+#include "../../common/include/batch_aabb.h"
 
 // Game constants
 #define SCREEN_WIDTH 640
@@ -31,10 +33,18 @@
 #define ENEMY_MAX_SPEED 4
 #define MAX_ENEMIES 8
 #define ROAD_SPEED 5
-#define ROAD_SEGMENT_HEIGHT 200
-#define MAX_ROAD_SEGMENTS 5
-#define ROAD_WIDTH 400
-#define GRASS_WIDTH ((SCREEN_WIDTH - ROAD_WIDTH) / 2)
+#define ROAD_WIDTH 400 // widest road, and the width at the start
+#define ROAD_MIN_WIDTH 200
+#define ROAD_MARGIN 20 // grass always left at the screen edges
+#define ROAD_FORK_GAP 80 // widest island in a fork
+#define ROAD_LOOKAHEAD 128 // rows generated above the top of the screen
+#define ROAD_TABLE_ROWS 1024 // more than SCREEN_HEIGHT + ROAD_LOOKAHEAD
+#define ROAD_STRIP_STEP 8 // rows between road strip vertices
+#define ROAD_DASH_PERIOD 80
+#define ROAD_DASH_LENGTH 40
+#define ROAD_BATCH_QUADS (SCREEN_HEIGHT / ROAD_STRIP_STEP + SCREEN_HEIGHT / ROAD_DASH_PERIOD + 4)
+#define ROAD_MAX_VERTICES (ROAD_BATCH_QUADS * 4)
+#define ROAD_MAX_INDICES (ROAD_BATCH_QUADS * 12) // a strip step may add a road and an island quad
 #define SPAWN_INTERVAL 2000 // milliseconds
 
 // Game object structures
@@ -50,13 +60,35 @@ typedef struct {
     float speed;
     bool active;
     bool civilian; // true for civilian cars, false for enemy cars
+    float lane; // 0 at the left edge of the road, 1 at the right
     SDL_Rect rect;
 } Enemy;
 
+// One scanline of road. A fork splits the road around a grass island from
+// islandLeft to islandRight; without one both are the road centre.
 typedef struct {
-    float x, y;
-    SDL_Rect rect;
-} RoadSegment;
+    Sint16 left, right;
+    Sint16 islandLeft, islandRight;
+    bool fork;
+} RoadRow;
+
+typedef enum {
+    SECTION_STRAIGHT,
+    SECTION_CURVE,
+    SECTION_WIDTH, // narrows or widens
+    SECTION_FORK
+} RoadSectionType;
+
+// Produces road rows ahead of the scroll a section at a time. Within a
+// section the centre and width ease from where the last one ended to the
+// section's targets.
+typedef struct {
+    int nextRow; // first row not generated yet
+    RoadSectionType section;
+    int sectionRow, sectionLength;
+    float startCentre, targetCentre;
+    float startWidth, targetWidth;
+} RoadGenerator;
 
 // Game state
 typedef struct {
@@ -73,8 +105,11 @@ typedef struct {
     int enemyCount;
     Uint32 lastEnemySpawn;
     
-    // Road
-    RoadSegment roadSegments[MAX_ROAD_SEGMENTS];
+    // Road, counted in rows from the start; row r is kept in
+    // road[r % ROAD_TABLE_ROWS]
+    RoadRow road[ROAD_TABLE_ROWS];
+    RoadGenerator roadGenerator;
+    int roadScroll; // row at the bottom edge of the screen
     
     // Score
     int score;
@@ -93,7 +128,13 @@ void updateGame(GameState* game);
 void renderGame(SDL_Renderer* renderer, GameState* game);
 void spawnEnemy(GameState* game);
 void fireBullet(GameState* game);
-bool checkCollision(SDL_Rect* a, SDL_Rect* b);
+batch_aabb::Box rectBox(const SDL_Rect* rect);
+void resetRoad(GameState* game);
+void startRoadSection(RoadGenerator* generator);
+void generateRoad(GameState* game);
+const RoadRow* roadRowAt(const GameState* game, float y);
+void roadLimits(const GameState* game, float x, float y, int width, int height, float* minX, float* maxX);
+void renderRoad(SDL_Renderer* renderer, GameState* game);
 
 int main(int argc, char* argv[]) {
     // Initialize random number generator
@@ -208,14 +249,8 @@ void initGame(GameState* game) {
     game->enemyCount = 0;
     game->lastEnemySpawn = 0;
     
-    // Initialize road segments
-    for (int i = 0; i < MAX_ROAD_SEGMENTS; i++) {
-        game->roadSegments[i].y = i * ROAD_SEGMENT_HEIGHT - ROAD_SEGMENT_HEIGHT;
-        game->roadSegments[i].rect.x = GRASS_WIDTH;
-        game->roadSegments[i].rect.y = (int)game->roadSegments[i].y;
-        game->roadSegments[i].rect.w = ROAD_WIDTH;
-        game->roadSegments[i].rect.h = ROAD_SEGMENT_HEIGHT;
-    }
+    // Initialize road
+    resetRoad(game);
     
     // Initialize score
     game->score = 0;
@@ -249,6 +284,10 @@ void updateGame(GameState* game) {
         return;
     }
     
+    // Scroll the road first so the cars are kept on the rows drawn this frame
+    game->roadScroll += ROAD_SPEED;
+    generateRoad(game);
+    
     const Uint8* keystates = SDL_GetKeyboardState(NULL);
     
     // Update player position based on keyboard input
@@ -266,12 +305,6 @@ void updateGame(GameState* game) {
     }
     
     // Keep player within screen bounds
-    if (game->playerX < GRASS_WIDTH) {
-        game->playerX = GRASS_WIDTH;
-    }
-    if (game->playerX > SCREEN_WIDTH - GRASS_WIDTH - PLAYER_WIDTH) {
-        game->playerX = SCREEN_WIDTH - GRASS_WIDTH - PLAYER_WIDTH;
-    }
     if (game->playerY < 0) {
         game->playerY = 0;
     }
@@ -279,6 +312,16 @@ void updateGame(GameState* game) {
         game->playerY = SCREEN_HEIGHT - PLAYER_HEIGHT;
     }
     
+    // Keep player on the road
+    float minX, maxX;
+    roadLimits(game, game->playerX, game->playerY, PLAYER_WIDTH, PLAYER_HEIGHT, &minX, &maxX);
+    if (game->playerX < minX) {
+        game->playerX = minX;
+    }
+    if (game->playerX > maxX) {
+        game->playerX = maxX;
+    }
+    
     // Update player rectangle
     game->playerRect.x = (int)game->playerX;
     game->playerRect.y = (int)game->playerY;
@@ -304,89 +347,82 @@ void updateGame(GameState* game) {
         game->lastEnemySpawn = currentTime;
     }
     
+    // Boxes for the batched collision tests. Box j of bulletBoxes is
+    // bullets[j], empty once the bullet is spent; box i of enemyBoxes is
+    // enemies[i] after it moved, empty if it was not active.
+    static batch_aabb::BoxArray bulletBoxes;
+    static batch_aabb::BoxArray enemyBoxes;
+    bulletBoxes.clear();
+    enemyBoxes.clear();
+    for (int j = 0; j < MAX_BULLETS; j++) {
+        if (game->bullets[j].active) {
+            bulletBoxes.push(rectBox(&game->bullets[j].rect));
+        } else {
+            bulletBoxes.pushEmpty();
+        }
+    }
+    
     // Update enemies
     for (int i = 0; i < MAX_ENEMIES; i++) {
         if (game->enemies[i].active) {
             game->enemies[i].y += game->enemies[i].speed;
             game->enemies[i].rect.y = (int)game->enemies[i].y;
             
+            // Follow the road, keeping to the same lane
+            const RoadRow* row = roadRowAt(game, game->enemies[i].y + ENEMY_HEIGHT / 2);
+            float x = row->left + game->enemies[i].lane * (row->right - row->left - ENEMY_WIDTH);
+            float minX, maxX;
+            roadLimits(game, x, game->enemies[i].y, ENEMY_WIDTH, ENEMY_HEIGHT, &minX, &maxX);
+            game->enemies[i].x = x < minX ? minX : (x > maxX ? maxX : x);
+            game->enemies[i].rect.x = (int)game->enemies[i].x;
+            batch_aabb::Box enemyBox = rectBox(&game->enemies[i].rect);
+            enemyBoxes.push(enemyBox);
+            
             // Deactivate enemies that go off-screen
             if (game->enemies[i].y > SCREEN_HEIGHT) {
                 game->enemies[i].active = false;
                 game->enemyCount--;
             }
             
-            // Check for collision with player
-            if (checkCollision(&game->playerRect, &game->enemies[i].rect)) {
+            // Check for collision with bullets, all of them in one batch
+            uint64_t hits = batch_aabb::overlapMask64(enemyBox, bulletBoxes);
+            for (int j = batch_aabb::firstHit(hits); j >= 0; j = batch_aabb::firstHit(hits)) {
+                hits &= hits - 1;
+                bulletBoxes.remove(j);
+                game->bullets[j].active = false;
+                game->bulletCount--;
+                
                 if (!game->enemies[i].civilian) {
-                    game->gameOver = true;
-                }
-            }
-            
-            // Check for collision with bullets
-            for (int j = 0; j < MAX_BULLETS; j++) {
-                if (game->bullets[j].active && checkCollision(&game->bullets[j].rect, &game->enemies[i].rect)) {
-                    game->bullets[j].active = false;
-                    game->bulletCount--;
-                    
-                    if (!game->enemies[i].civilian) {
-                        game->score += 100;
-                        game->enemies[i].active = false;
-                        game->enemyCount--;
-                    } else {
-                        // Penalty for shooting civilian cars
-                        game->score -= 200;
-                    }
+                    game->score += 100;
+                    game->enemies[i].active = false;
+                    game->enemyCount--;
+                } else {
+                    // Penalty for shooting civilian cars
+                    game->score -= 200;
                 }
             }
+        } else {
+            enemyBoxes.pushEmpty();
         }
     }
     
-    // Update road segments
-    for (int i = 0; i < MAX_ROAD_SEGMENTS; i++) {
-        game->roadSegments[i].y += ROAD_SPEED;
-        game->roadSegments[i].rect.y = (int)game->roadSegments[i].y;
-        
-        // Reset road segment when it goes off-screen
-        if (game->roadSegments[i].y >= SCREEN_HEIGHT) {
-            game->roadSegments[i].y = -ROAD_SEGMENT_HEIGHT + (game->roadSegments[i].y - SCREEN_HEIGHT);
-            game->roadSegments[i].rect.y = (int)game->roadSegments[i].y;
+    // Check for collision with player; only enemy cars end the game
+    uint64_t playerHits = batch_aabb::overlapMask64(rectBox(&game->playerRect), enemyBoxes);
+    for (int i = batch_aabb::firstHit(playerHits); i >= 0; i = batch_aabb::firstHit(playerHits)) {
+        playerHits &= playerHits - 1;
+        if (!game->enemies[i].civilian) {
+            game->gameOver = true;
         }
     }
 }
 
 void renderGame(SDL_Renderer* renderer, GameState* game) {
-    // Clear screen
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    // Clear screen to grass
+    SDL_SetRenderDrawColor(renderer, 0, 128, 0, 255);
     SDL_RenderClear(renderer);
     
-    // Render road segments and grass
-    for (int i = 0; i < MAX_ROAD_SEGMENTS; i++) {
-        // Left grass
-        SDL_SetRenderDrawColor(renderer, 0, 128, 0, 255);
-        SDL_Rect grassLeftRect = {0, game->roadSegments[i].rect.y, GRASS_WIDTH, ROAD_SEGMENT_HEIGHT};
-        SDL_RenderFillRect(renderer, &grassLeftRect);
-        
-        // Right grass
-        SDL_Rect grassRightRect = {SCREEN_WIDTH - GRASS_WIDTH, game->roadSegments[i].rect.y, GRASS_WIDTH, ROAD_SEGMENT_HEIGHT};
-        SDL_RenderFillRect(renderer, &grassRightRect);
-        
-        // Road
-        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-        SDL_RenderFillRect(renderer, &game->roadSegments[i].rect);
-        
-        // Road markings
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        int roadCenter = GRASS_WIDTH + ROAD_WIDTH / 2;
-        SDL_Rect lineRect = {roadCenter - 5, game->roadSegments[i].rect.y, 10, ROAD_SEGMENT_HEIGHT / 5};
-        
-        for (int j = 0; j < 5; j++) {
-            if (j % 2 == 0) {
-                SDL_RenderFillRect(renderer, &lineRect);
-            }
-            lineRect.y += ROAD_SEGMENT_HEIGHT / 5;
-        }
-    }
+    // Render road
+    renderRoad(renderer, game);
     
     // Render bullets
     SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
@@ -446,9 +482,9 @@ void spawnEnemy(GameState* game) {
     game->enemies[index].active = true;
     
     // Randomly position on the road
-    int roadMin = GRASS_WIDTH + ENEMY_WIDTH / 2;
-    int roadMax = SCREEN_WIDTH - GRASS_WIDTH - ENEMY_WIDTH;
-    game->enemies[index].x = roadMin + rand() % (roadMax - roadMin);
+    const RoadRow* row = roadRowAt(game, -ENEMY_HEIGHT / 2);
+    game->enemies[index].lane = (float)rand() / RAND_MAX;
+    game->enemies[index].x = row->left + game->enemies[index].lane * (row->right - row->left - ENEMY_WIDTH);
     game->enemies[index].y = -ENEMY_HEIGHT;
     
     // Set speed
@@ -499,10 +535,221 @@ void fireBullet(GameState* game) {
     game->bulletCount++;
 }
 
-bool checkCollision(SDL_Rect* a, SDL_Rect* b) {
-    // Check if two rectangles overlap
-    return (a->x < b->x + b->w &&
-            a->x + a->w > b->x &&
-            a->y < b->y + b->h &&
-            a->y + a->h > b->y);
+batch_aabb::Box rectBox(const SDL_Rect* rect) {
+    return batch_aabb::makeBox((float)rect->x, (float)rect->y, (float)rect->w, (float)rect->h);
+}
+
+// Starts the next section of road from where the last one ended
+void startRoadSection(RoadGenerator* generator) {
+    generator->startCentre = generator->targetCentre;
+    generator->startWidth = generator->targetWidth;
+    generator->sectionRow = 0;
+    generator->section = (RoadSectionType)(rand() % 4);
+    
+    // Only a full-width road forks; widen it first otherwise
+    bool widenForFork = generator->section == SECTION_FORK && generator->startWidth < ROAD_WIDTH;
+    if (widenForFork) {
+        generator->section = SECTION_WIDTH;
+    }
+    
+    switch (generator->section) {
+        case SECTION_STRAIGHT:
+            generator->sectionLength = 200 + rand() % 200;
+            break;
+        case SECTION_CURVE: {
+            float minCentre = ROAD_MARGIN + generator->startWidth / 2;
+            float maxCentre = SCREEN_WIDTH - ROAD_MARGIN - generator->startWidth / 2;
+            generator->targetCentre = minCentre + (float)rand() / RAND_MAX * (maxCentre - minCentre);
+            generator->sectionLength = 400 + rand() % 300;
+            break;
+        }
+        case SECTION_WIDTH: {
+            generator->targetWidth = widenForFork || rand() % 2 == 0 ? ROAD_WIDTH :
+                ROAD_MIN_WIDTH + rand() % (ROAD_WIDTH - ROAD_MIN_WIDTH);
+            
+            // Keep both edges on screen at the new width
+            float minCentre = ROAD_MARGIN + generator->targetWidth / 2;
+            float maxCentre = SCREEN_WIDTH - ROAD_MARGIN - generator->targetWidth / 2;
+            if (generator->targetCentre < minCentre) generator->targetCentre = minCentre;
+            if (generator->targetCentre > maxCentre) generator->targetCentre = maxCentre;
+            generator->sectionLength = 200 + rand() % 200;
+            break;
+        }
+        case SECTION_FORK:
+            generator->sectionLength = 400 + rand() % 300;
+            break;
+    }
+}
+
+// Fills the road table up to ROAD_LOOKAHEAD rows above the top of the
+// screen; once running that is ROAD_SPEED rows a frame
+void generateRoad(GameState* game) {
+    RoadGenerator* generator = &game->roadGenerator;
+    int lastRow = game->roadScroll + SCREEN_HEIGHT + ROAD_LOOKAHEAD;
+    
+    while (generator->nextRow <= lastRow) {
+        if (generator->sectionRow >= generator->sectionLength) {
+            startRoadSection(generator);
+        }
+        generator->sectionRow++;
+        
+        // Smoothstep, so sections join without a kink
+        float t = (float)generator->sectionRow / generator->sectionLength;
+        float ease = t * t * (3 - 2 * t);
+        float centre = generator->startCentre + (generator->targetCentre - generator->startCentre) * ease;
+        float width = generator->startWidth + (generator->targetWidth - generator->startWidth) * ease;
+        
+        // The island of a fork opens and closes along half a sine
+        float island = 0;
+        if (generator->section == SECTION_FORK) {
+            island = ROAD_FORK_GAP / 2 * sinf(3.14159265f * t);
+        }
+        
+        RoadRow* row = &game->road[generator->nextRow % ROAD_TABLE_ROWS];
+        row->left = (Sint16)(centre - width / 2);
+        row->right = (Sint16)(centre + width / 2);
+        row->islandLeft = (Sint16)(centre - island);
+        row->islandRight = (Sint16)(centre + island);
+        row->fork = island >= 1;
+        generator->nextRow++;
+    }
+}
+
+void resetRoad(GameState* game) {
+    RoadGenerator* generator = &game->roadGenerator;
+    generator->nextRow = 0;
+    
+    // Open on a straight full-width road
+    generator->section = SECTION_STRAIGHT;
+    generator->sectionRow = 0;
+    generator->sectionLength = SCREEN_HEIGHT + ROAD_LOOKAHEAD;
+    generator->startCentre = generator->targetCentre = SCREEN_WIDTH / 2;
+    generator->startWidth = generator->targetWidth = ROAD_WIDTH;
+    
+    game->roadScroll = 0;
+    generateRoad(game);
+}
+
+// The road row under screen line y, clamped to the generated rows
+const RoadRow* roadRowAt(const GameState* game, float y) {
+    if (y < -ROAD_LOOKAHEAD) y = -ROAD_LOOKAHEAD;
+    if (y > SCREEN_HEIGHT) y = SCREEN_HEIGHT;
+    int row = game->roadScroll + SCREEN_HEIGHT - (int)y;
+    return &game->road[row % ROAD_TABLE_ROWS];
+}
+
+// Range of x a car at (x, y) can take without touching grass, from the rows
+// under its front and back. In a fork it keeps to the side of the island its
+// centre is on.
+void roadLimits(const GameState* game, float x, float y, int width, int height, float* minX, float* maxX) {
+    const RoadRow* ends[2] = {roadRowAt(game, y), roadRowAt(game, y + height - 1)};
+    float centre = x + width / 2.0f;
+    
+    *minX = 0;
+    *maxX = SCREEN_WIDTH - width;
+    for (int i = 0; i < 2; i++) {
+        float low = ends[i]->left;
+        float high = ends[i]->right - width;
+        if (ends[i]->fork) {
+            if (centre < (ends[i]->islandLeft + ends[i]->islandRight) / 2.0f) {
+                high = ends[i]->islandLeft - width;
+            } else {
+                low = ends[i]->islandRight;
+            }
+        }
+        if (low > *minX) *minX = low;
+        if (high < *maxX) *maxX = high;
+    }
+    
+    if (*maxX < *minX) {
+        *maxX = *minX;
+    }
+}
+
+static void addRoadQuad(int* indices, int* indexCount, int a, int b, int c, int d) {
+    indices[(*indexCount)++] = a;
+    indices[(*indexCount)++] = b;
+    indices[(*indexCount)++] = c;
+    indices[(*indexCount)++] = c;
+    indices[(*indexCount)++] = d;
+    indices[(*indexCount)++] = a;
+}
+
+static void setRoadVertex(SDL_Vertex* vertex, float x, float y, SDL_Color color) {
+    vertex->position.x = x;
+    vertex->position.y = y;
+    vertex->color = color;
+    vertex->tex_coord.x = 0;
+    vertex->tex_coord.y = 0;
+}
+
+// Draws the road over the grass as one geometry batch: a strip sampled every
+// ROAD_STRIP_STEP rows, fork islands on top of it, then the centre line
+void renderRoad(SDL_Renderer* renderer, GameState* game) {
+    static SDL_Vertex vertices[ROAD_MAX_VERTICES];
+    static int indices[ROAD_MAX_INDICES];
+    int vertexCount = 0;
+    int indexCount = 0;
+    
+    SDL_Color asphalt = {100, 100, 100, 255};
+    SDL_Color grass = {0, 128, 0, 255};
+    SDL_Color paint = {255, 255, 255, 255};
+    
+    // Rows from the bottom of the screen to the top; the samples in between
+    // sit on a fixed grid so the outline does not crawl as it scrolls
+    int bottom = game->roadScroll;
+    int top = game->roadScroll + SCREEN_HEIGHT;
+    int row = bottom;
+    bool forkBelow = false;
+    while (true) {
+        const RoadRow* edges = &game->road[row % ROAD_TABLE_ROWS];
+        float y = (float)(top - row);
+        setRoadVertex(&vertices[vertexCount], edges->left, y, asphalt);
+        setRoadVertex(&vertices[vertexCount + 1], edges->right, y, asphalt);
+        setRoadVertex(&vertices[vertexCount + 2], edges->islandLeft, y, grass);
+        setRoadVertex(&vertices[vertexCount + 3], edges->islandRight, y, grass);
+        
+        if (row > bottom) {
+            int below = vertexCount - 4;
+            addRoadQuad(indices, &indexCount, below, below + 1, vertexCount + 1, vertexCount);
+            if (forkBelow || edges->fork) {
+                addRoadQuad(indices, &indexCount, below + 2, below + 3, vertexCount + 3, vertexCount + 2);
+            }
+        }
+        vertexCount += 4;
+        forkBelow = edges->fork;
+        
+        if (row == top) {
+            break;
+        }
+        row = (row / ROAD_STRIP_STEP + 1) * ROAD_STRIP_STEP;
+        if (row > top) {
+            row = top;
+        }
+    }
+    
+    // Centre line dashes, left out where an island splits the road
+    for (int dash = bottom - bottom % ROAD_DASH_PERIOD; dash <= top; dash += ROAD_DASH_PERIOD) {
+        int start = dash < bottom ? bottom : dash;
+        int end = dash + ROAD_DASH_LENGTH > top ? top : dash + ROAD_DASH_LENGTH;
+        if (start >= end) {
+            continue;
+        }
+        
+        const RoadRow* low = &game->road[start % ROAD_TABLE_ROWS];
+        const RoadRow* high = &game->road[end % ROAD_TABLE_ROWS];
+        if (low->fork || high->fork) {
+            continue;
+        }
+        float lowCentre = (low->left + low->right) / 2.0f;
+        float highCentre = (high->left + high->right) / 2.0f;
+        setRoadVertex(&vertices[vertexCount], lowCentre - 5, (float)(top - start), paint);
+        setRoadVertex(&vertices[vertexCount + 1], lowCentre + 5, (float)(top - start), paint);
+        setRoadVertex(&vertices[vertexCount + 2], highCentre + 5, (float)(top - end), paint);
+        setRoadVertex(&vertices[vertexCount + 3], highCentre - 5, (float)(top - end), paint);
+        addRoadQuad(indices, &indexCount, vertexCount, vertexCount + 1, vertexCount + 2, vertexCount + 3);
+        vertexCount += 4;
+    }
+    
+    SDL_RenderGeometry(renderer, NULL, vertices, vertexCount, indices, indexCount);
 }
@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 
@@ -16,6 +17,12 @@
 #define MAX_ENEMIES 10
 #define MAX_ENEMY_BULLETS 50
 #define ENEMY_SPAWN_DELAY 60 // frames
+#define HELL_MAX_BULLETS 65536 // enemy bullets in bullet-hell mode
+#define HELL_BULLET_SIZE 6
+#define HELL_EMITTERS 6
+#define STRESS_FRAMES 600 // default length of a --stress run
+#define STRESS_REPORT 60 // frames between --stress reports
+#define TWO_PI 6.28318530718f
 
 typedef struct {
     float x, y;
@@ -39,11 +46,47 @@ typedef struct {
     float dx, dy;
 } Enemy;
 
+// Bullets are kept as a structure of arrays. Spawning appends at count and
+// removing moves the last bullet into the freed slot, so the live bullets are
+// always the first count entries and no loop ever visits a dead one.
 typedef struct {
-    Entity entity;
-    float dx, dy;
-    int damage;
-} Bullet;
+    float* x;
+    float* y;
+    float* dx;
+    float* dy;
+    int count;
+    int capacity;
+    int width, height; // shared by every bullet in the pool
+    SDL_Color color;
+} BulletPool;
+
+enum EmitterPattern {
+    PATTERN_RING,   // evenly spaced all around, turning by spin each burst
+    PATTERN_SPIRAL, // a ring with few arms, fired every frame with a fast spin
+    PATTERN_FAN     // spread across an arc centred on the player
+};
+
+// A fixed bullet source for bullet-hell mode. Each burst is written to the
+// pool in one pass.
+typedef struct {
+    float x, y;
+    int pattern;
+    int bullets; // per burst
+    int interval; // frames between bursts
+    int timer;
+    float angle; // radians
+    float spin; // added to angle after each burst
+    float spread; // arc of a fan, radians
+    float speed;
+} Emitter;
+
+// Vertex and index buffers for drawing every bullet with one
+// SDL_RenderGeometry call. The indices never change and are built once.
+typedef struct {
+    SDL_Vertex* vertices;
+    int* indices;
+    int capacity; // in bullets
+} BulletBatch;
 
 typedef struct {
     int y;
@@ -57,20 +100,28 @@ void handleInput(SDL_Event* event, Player* player, bool* quit);
 void updatePlayer(Player* player);
 void spawnEnemy(Enemy enemies[], int maxEnemies);
 void updateEnemies(Enemy enemies[], int maxEnemies);
-void shootPlayerBullet(Player* player, Bullet bullets[], int maxBullets);
-void shootEnemyBullet(Enemy* enemy, Bullet bullets[], int maxBullets, Player* player);
-void updateBullets(Bullet bullets[], int maxBullets);
-void checkCollisions(Player* player, Enemy enemies[], int maxEnemies, Bullet playerBullets[], int maxPlayerBullets, Bullet enemyBullets[], int maxEnemyBullets);
+bool initBulletPool(BulletPool* pool, int capacity, int width, int height, SDL_Color color);
+void freeBulletPool(BulletPool* pool);
+bool spawnBullet(BulletPool* pool, float x, float y, float dx, float dy);
+void removeBullet(BulletPool* pool, int index);
+void shootPlayerBullet(Player* player, BulletPool* bullets);
+void shootEnemyBullet(Enemy* enemy, BulletPool* bullets, Player* player);
+void initEmitters(Emitter emitters[], int count);
+void updateEmitters(Emitter emitters[], int count, BulletPool* bullets, Player* player);
+void fireEmitter(Emitter* emitter, BulletPool* bullets, Player* player);
+void updateBullets(BulletPool* bullets);
+void checkCollisions(Player* player, Enemy enemies[], int maxEnemies, BulletPool* playerBullets, BulletPool* enemyBullets);
 void updateBackground(Background* background);
-void renderGame(SDL_Renderer* renderer, SDL_Texture* textures[], Player* player, Enemy enemies[], int maxEnemies, Bullet playerBullets[], int maxPlayerBullets, Bullet enemyBullets[], int maxEnemyBullets, Background* background);
+bool initBulletBatch(BulletBatch* batch, int capacity);
+void freeBulletBatch(BulletBatch* batch);
+int appendBulletVertices(BulletBatch* batch, int used, BulletPool* bullets);
+void renderGame(SDL_Renderer* renderer, SDL_Texture* textures[], Player* player, Enemy enemies[], int maxEnemies, BulletPool* playerBullets, BulletPool* enemyBullets, BulletBatch* batch, Background* background);
 
 enum TextureTypes {
     TEXTURE_BACKGROUND,
     TEXTURE_PLAYER,
     TEXTURE_ENEMY1,
     TEXTURE_ENEMY2,
-    TEXTURE_PLAYER_BULLET,
-    TEXTURE_ENEMY_BULLET,
     TEXTURE_COUNT // Total number of textures
 };
 
@@ -79,6 +130,25 @@ int main(int argc, char* argv[]) {
     SDL_Renderer* renderer = NULL;
     SDL_Texture* textures[TEXTURE_COUNT] = {NULL};
     
+    // --hell plays bullet-hell mode; --stress [frames] runs it uncapped with
+    // an invincible player and prints per-frame timings
+    bool hellMode = false;
+    int stressFrames = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hell") == 0) {
+            hellMode = true;
+        } else if (strcmp(argv[i], "--stress") == 0) {
+            hellMode = true;
+            stressFrames = STRESS_FRAMES;
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                stressFrames = atoi(argv[++i]);
+            }
+        } else {
+            printf("Usage: %s [--hell] [--stress [frames]]\n", argv[0]);
+            return 1;
+        }
+    }
+    
     if (!init(&window, &renderer)) {
         return 1;
     }
@@ -103,15 +173,31 @@ int main(int argc, char* argv[]) {
     SDL_FillRect(tempSurface, NULL, SDL_MapRGB(tempSurface->format, 255, 0, 255));
     textures[TEXTURE_ENEMY2] = SDL_CreateTextureFromSurface(renderer, tempSurface);
     
-    // Player bullet (cyan)
-    SDL_FillRect(tempSurface, NULL, SDL_MapRGB(tempSurface->format, 0, 255, 255));
-    textures[TEXTURE_PLAYER_BULLET] = SDL_CreateTextureFromSurface(renderer, tempSurface);
+    SDL_FreeSurface(tempSurface);
     
-    // Enemy bullet (yellow)
-    SDL_FillRect(tempSurface, NULL, SDL_MapRGB(tempSurface->format, 255, 255, 0));
-    textures[TEXTURE_ENEMY_BULLET] = SDL_CreateTextureFromSurface(renderer, tempSurface);
+    // Bullets are untextured quads: player bullets cyan, enemy bullets yellow
+    SDL_Color playerBulletColor = {0, 255, 255, 255};
+    SDL_Color enemyBulletColor = {255, 255, 0, 255};
+    BulletPool playerBullets = {};
+    BulletPool enemyBullets = {};
+    BulletBatch bulletBatch = {};
+    bool poolsReady = initBulletPool(&playerBullets, MAX_PLAYER_BULLETS, 10, 20, playerBulletColor) &&
+        (hellMode ? initBulletPool(&enemyBullets, HELL_MAX_BULLETS, HELL_BULLET_SIZE, HELL_BULLET_SIZE, enemyBulletColor)
+                  : initBulletPool(&enemyBullets, MAX_ENEMY_BULLETS, 10, 10, enemyBulletColor)) &&
+        initBulletBatch(&bulletBatch, playerBullets.capacity + enemyBullets.capacity);
+    if (!poolsReady) {
+        printf("Could not allocate bullet storage!\n");
+        freeBulletPool(&playerBullets);
+        freeBulletPool(&enemyBullets);
+        freeBulletBatch(&bulletBatch);
+        cleanup(window, renderer, textures);
+        return 1;
+    }
     
-    SDL_FreeSurface(tempSurface);
+    Emitter emitters[HELL_EMITTERS] = {};
+    if (hellMode) {
+        initEmitters(emitters, HELL_EMITTERS);
+    }
     
     // Initialize game objects
     Player player = {
@@ -128,9 +214,12 @@ int main(int argc, char* argv[]) {
         .invincibility = 0
     };
     
+    // The stress run measures the bullets, not how long the player lasts
+    if (stressFrames > 0) {
+        player.health = 1 << 30;
+    }
+    
     Enemy enemies[MAX_ENEMIES] = {0};
-    Bullet playerBullets[MAX_PLAYER_BULLETS] = {0};
-    Bullet enemyBullets[MAX_ENEMY_BULLETS] = {0};
     
     Background background = {
         .y = 0,
@@ -145,10 +234,16 @@ int main(int argc, char* argv[]) {
     Uint32 frameStart;
     int frameTime;
     int enemySpawnTimer = 0;
+    int frame = 0;
+    int peakBullets = 0;
+    Uint64 updateTicks = 0, renderTicks = 0; // since the last stress report
+    Uint64 totalUpdateTicks = 0, totalRenderTicks = 0;
+    double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
     
     // Game loop
     while (!quit) {
         frameStart = SDL_GetTicks();
+        Uint64 updateStart = SDL_GetPerformanceCounter();
         
         // Process events
         while (SDL_PollEvent(&event) != 0) {
@@ -172,7 +267,7 @@ int main(int argc, char* argv[]) {
         
         // Auto-shooting for player
         if (player.cooldown <= 0 && player.entity.active) {
-            shootPlayerBullet(&player, playerBullets, MAX_PLAYER_BULLETS);
+            shootPlayerBullet(&player, &playerBullets);
             player.cooldown = 10; // Shoot every 10 frames
         } else {
             player.cooldown--;
@@ -182,7 +277,7 @@ int main(int argc, char* argv[]) {
         for (int i = 0; i < MAX_ENEMIES; i++) {
             if (enemies[i].entity.active) {
                 if (enemies[i].cooldown <= 0) {
-                    shootEnemyBullet(&enemies[i], enemyBullets, MAX_ENEMY_BULLETS, &player);
+                    shootEnemyBullet(&enemies[i], &enemyBullets, &player);
                     enemies[i].cooldown = 60 + rand() % 60; // Random cooldown between 60-120 frames
                 } else {
                     enemies[i].cooldown--;
@@ -190,14 +285,42 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        updateBullets(playerBullets, MAX_PLAYER_BULLETS);
-        updateBullets(enemyBullets, MAX_ENEMY_BULLETS);
+        if (hellMode) {
+            updateEmitters(emitters, HELL_EMITTERS, &enemyBullets, &player);
+        }
+        
+        updateBullets(&playerBullets);
+        updateBullets(&enemyBullets);
         updateBackground(&background);
         
-        checkCollisions(&player, enemies, MAX_ENEMIES, playerBullets, MAX_PLAYER_BULLETS, enemyBullets, MAX_ENEMY_BULLETS);
+        checkCollisions(&player, enemies, MAX_ENEMIES, &playerBullets, &enemyBullets);
         
         // Render
-        renderGame(renderer, textures, &player, enemies, MAX_ENEMIES, playerBullets, MAX_PLAYER_BULLETS, enemyBullets, MAX_ENEMY_BULLETS, &background);
+        Uint64 renderStart = SDL_GetPerformanceCounter();
+        renderGame(renderer, textures, &player, enemies, MAX_ENEMIES, &playerBullets, &enemyBullets, &bulletBatch, &background);
+        Uint64 renderEnd = SDL_GetPerformanceCounter();
+        
+        if (stressFrames > 0) {
+            // Uncapped; report the averages every STRESS_REPORT frames
+            frame++;
+            updateTicks += renderStart - updateStart;
+            renderTicks += renderEnd - renderStart;
+            if (enemyBullets.count > peakBullets) {
+                peakBullets = enemyBullets.count;
+            }
+            if (frame % STRESS_REPORT == 0) {
+                printf("Frame %d: %d bullets, update %.3f ms, render %.3f ms\n", frame,
+                       playerBullets.count + enemyBullets.count,
+                       updateTicks * msPerTick / STRESS_REPORT, renderTicks * msPerTick / STRESS_REPORT);
+                totalUpdateTicks += updateTicks;
+                totalRenderTicks += renderTicks;
+                updateTicks = renderTicks = 0;
+            }
+            if (frame >= stressFrames) {
+                quit = true;
+            }
+            continue;
+        }
         
         // Cap the frame rate
         frameTime = SDL_GetTicks() - frameStart;
@@ -206,6 +329,16 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (stressFrames > 0 && frame > 0) {
+        totalUpdateTicks += updateTicks;
+        totalRenderTicks += renderTicks;
+        printf("Stress: %d frames, peak %d enemy bullets, update %.3f ms, render %.3f ms per frame\n", frame,
+               peakBullets, totalUpdateTicks * msPerTick / frame, totalRenderTicks * msPerTick / frame);
+    }
+    
+    freeBulletPool(&playerBullets);
+    freeBulletPool(&enemyBullets);
+    freeBulletBatch(&bulletBatch);
     cleanup(window, renderer, textures);
     return 0;
 }
@@ -347,107 +480,197 @@ void updateEnemies(Enemy enemies[], int maxEnemies) {
     }
 }
 
-void shootPlayerBullet(Player* player, Bullet bullets[], int maxBullets) {
-    for (int i = 0; i < maxBullets; i++) {
-        if (!bullets[i].entity.active) {
-            bullets[i].entity.x = player->entity.x + player->entity.width / 2 - 5;
-            bullets[i].entity.y = player->entity.y;
-            bullets[i].entity.width = 10;
-            bullets[i].entity.height = 20;
-            bullets[i].entity.active = true;
-            bullets[i].dx = 0;
-            bullets[i].dy = -BULLET_SPEED;
-            bullets[i].damage = 1;
-            break;
-        }
+bool initBulletPool(BulletPool* pool, int capacity, int width, int height, SDL_Color color) {
+    pool->x = (float*)malloc(capacity * sizeof(float));
+    pool->y = (float*)malloc(capacity * sizeof(float));
+    pool->dx = (float*)malloc(capacity * sizeof(float));
+    pool->dy = (float*)malloc(capacity * sizeof(float));
+    pool->count = 0;
+    pool->capacity = capacity;
+    pool->width = width;
+    pool->height = height;
+    pool->color = color;
+    return pool->x != NULL && pool->y != NULL && pool->dx != NULL && pool->dy != NULL;
+}
+
+void freeBulletPool(BulletPool* pool) {
+    free(pool->x);
+    free(pool->y);
+    free(pool->dx);
+    free(pool->dy);
+    pool->x = pool->y = pool->dx = pool->dy = NULL;
+    pool->count = pool->capacity = 0;
+}
+
+// Returns false, dropping the bullet, when the pool is full
+bool spawnBullet(BulletPool* pool, float x, float y, float dx, float dy) {
+    if (pool->count >= pool->capacity) {
+        return false;
     }
+    int i = pool->count++;
+    pool->x[i] = x;
+    pool->y[i] = y;
+    pool->dx[i] = dx;
+    pool->dy[i] = dy;
+    return true;
 }
 
-void shootEnemyBullet(Enemy* enemy, Bullet bullets[], int maxBullets, Player* player) {
-    for (int i = 0; i < maxBullets; i++) {
-        if (!bullets[i].entity.active) {
-            bullets[i].entity.x = enemy->entity.x + enemy->entity.width / 2 - 5;
-            bullets[i].entity.y = enemy->entity.y + enemy->entity.height;
-            bullets[i].entity.width = 10;
-            bullets[i].entity.height = 10;
-            bullets[i].entity.active = true;
-            
-            // Aim at player
-            float dx = player->entity.x + player->entity.width / 2 - bullets[i].entity.x;
-            float dy = player->entity.y + player->entity.height / 2 - bullets[i].entity.y;
-            float length = sqrt(dx * dx + dy * dy);
-            
-            bullets[i].dx = (dx / length) * (BULLET_SPEED * 0.7f);
-            bullets[i].dy = (dy / length) * (BULLET_SPEED * 0.7f);
-            bullets[i].damage = 1;
-            break;
+// Moves the last bullet into index, so callers walking the pool must look at
+// index again instead of advancing
+void removeBullet(BulletPool* pool, int index) {
+    int last = --pool->count;
+    pool->x[index] = pool->x[last];
+    pool->y[index] = pool->y[last];
+    pool->dx[index] = pool->dx[last];
+    pool->dy[index] = pool->dy[last];
+}
+
+void shootPlayerBullet(Player* player, BulletPool* bullets) {
+    spawnBullet(bullets, player->entity.x + player->entity.width / 2 - bullets->width / 2, player->entity.y, 0, -BULLET_SPEED);
+}
+
+void shootEnemyBullet(Enemy* enemy, BulletPool* bullets, Player* player) {
+    float x = enemy->entity.x + enemy->entity.width / 2 - bullets->width / 2;
+    float y = enemy->entity.y + enemy->entity.height;
+    
+    // Aim at player
+    float dx = player->entity.x + player->entity.width / 2 - x;
+    float dy = player->entity.y + player->entity.height / 2 - y;
+    float length = sqrt(dx * dx + dy * dy);
+    if (length == 0) {
+        return;
+    }
+    
+    spawnBullet(bullets, x, y, (dx / length) * (BULLET_SPEED * 0.7f), (dy / length) * (BULLET_SPEED * 0.7f));
+}
+
+void initEmitters(Emitter emitters[], int count) {
+    // Two spirals turning opposite ways, two slow rings behind them and two
+    // fans aimed at the player from the top corners
+    const Emitter layout[HELL_EMITTERS] = {
+        {WINDOW_WIDTH * 0.25f, 220, PATTERN_SPIRAL, 12, 1, 0, 0.0f, 0.13f, 0, 2.0f},
+        {WINDOW_WIDTH * 0.75f, 220, PATTERN_SPIRAL, 12, 1, 0, 0.0f, -0.13f, 0, 2.0f},
+        {WINDOW_WIDTH * 0.5f, 140, PATTERN_RING, 192, 2, 0, 0.0f, 0.02f, 0, 1.6f},
+        {WINDOW_WIDTH * 0.5f, 400, PATTERN_RING, 192, 2, 1, 0.0f, -0.02f, 0, 1.4f},
+        {40, 40, PATTERN_FAN, 32, 6, 0, 0.0f, 0, 1.5f, 2.4f},
+        {WINDOW_WIDTH - 40, 40, PATTERN_FAN, 32, 6, 3, 0.0f, 0, 1.5f, 2.4f}
+    };
+    for (int i = 0; i < count && i < HELL_EMITTERS; i++) {
+        emitters[i] = layout[i];
+    }
+}
+
+void updateEmitters(Emitter emitters[], int count, BulletPool* bullets, Player* player) {
+    for (int i = 0; i < count; i++) {
+        if (emitters[i].timer <= 0) {
+            fireEmitter(&emitters[i], bullets, player);
+            emitters[i].timer = emitters[i].interval;
         }
+        emitters[i].timer--;
     }
 }
 
-void updateBullets(Bullet bullets[], int maxBullets) {
-    for (int i = 0; i < maxBullets; i++) {
-        if (bullets[i].entity.active) {
-            bullets[i].entity.x += bullets[i].dx;
-            bullets[i].entity.y += bullets[i].dy;
-            
-            // Remove if off screen
-            if (bullets[i].entity.y < -bullets[i].entity.height || 
-                bullets[i].entity.y > WINDOW_HEIGHT ||
-                bullets[i].entity.x < -bullets[i].entity.width ||
-                bullets[i].entity.x > WINDOW_WIDTH) {
-                bullets[i].entity.active = false;
-            }
+// Writes a whole burst to the end of the pool in one pass, clipped to the
+// space left
+void fireEmitter(Emitter* emitter, BulletPool* bullets, Player* player) {
+    float base = emitter->angle;
+    float step = TWO_PI / emitter->bullets;
+    if (emitter->pattern == PATTERN_FAN) {
+        float aim = atan2f(player->entity.y + player->entity.height / 2 - emitter->y,
+                           player->entity.x + player->entity.width / 2 - emitter->x);
+        base = aim - emitter->spread / 2;
+        step = emitter->bullets > 1 ? emitter->spread / (emitter->bullets - 1) : 0;
+    }
+    
+    int burst = emitter->bullets;
+    if (burst > bullets->capacity - bullets->count) {
+        burst = bullets->capacity - bullets->count;
+    }
+    
+    int first = bullets->count;
+    float x = emitter->x - bullets->width / 2.0f;
+    float y = emitter->y - bullets->height / 2.0f;
+    for (int i = 0; i < burst; i++) {
+        float angle = base + step * i;
+        bullets->x[first + i] = x;
+        bullets->y[first + i] = y;
+        bullets->dx[first + i] = cosf(angle) * emitter->speed;
+        bullets->dy[first + i] = sinf(angle) * emitter->speed;
+    }
+    bullets->count += burst;
+    
+    emitter->angle = fmodf(emitter->angle + emitter->spin, TWO_PI);
+}
+
+void updateBullets(BulletPool* bullets) {
+    float* x = bullets->x;
+    float* y = bullets->y;
+    
+    // Move everything first; a plain loop over the arrays the compiler can
+    // vectorise
+    for (int i = 0; i < bullets->count; i++) {
+        x[i] += bullets->dx[i];
+        y[i] += bullets->dy[i];
+    }
+    
+    // Then compact: remove if off screen
+    for (int i = 0; i < bullets->count;) {
+        if (y[i] < -bullets->height || y[i] > WINDOW_HEIGHT || x[i] < -bullets->width || x[i] > WINDOW_WIDTH) {
+            removeBullet(bullets, i);
+        } else {
+            i++;
         }
     }
 }
 
-void checkCollisions(Player* player, Enemy enemies[], int maxEnemies, Bullet playerBullets[], int maxPlayerBullets, Bullet enemyBullets[], int maxEnemyBullets) {
+static bool bulletHits(BulletPool* bullets, int i, Entity* target) {
+    return bullets->x[i] < target->x + target->width &&
+           bullets->x[i] + bullets->width > target->x &&
+           bullets->y[i] < target->y + target->height &&
+           bullets->y[i] + bullets->height > target->y;
+}
+
+void checkCollisions(Player* player, Enemy enemies[], int maxEnemies, BulletPool* playerBullets, BulletPool* enemyBullets) {
     // Check player bullets vs enemies
-    for (int i = 0; i < maxPlayerBullets; i++) {
-        if (playerBullets[i].entity.active) {
-            for (int j = 0; j < maxEnemies; j++) {
-                if (enemies[j].entity.active) {
-                    if (playerBullets[i].entity.x < enemies[j].entity.x + enemies[j].entity.width &&
-                        playerBullets[i].entity.x + playerBullets[i].entity.width > enemies[j].entity.x &&
-                        playerBullets[i].entity.y < enemies[j].entity.y + enemies[j].entity.height &&
-                        playerBullets[i].entity.y + playerBullets[i].entity.height > enemies[j].entity.y) {
-                        
-                        // Collision detected
-                        enemies[j].health -= playerBullets[i].damage;
-                        playerBullets[i].entity.active = false;
-                        
-                        if (enemies[j].health <= 0) {
-                            enemies[j].entity.active = false;
-                            player->score += 100;
-                        }
-                        
-                        break;
-                    }
+    for (int i = 0; i < playerBullets->count;) {
+        bool hit = false;
+        for (int j = 0; j < maxEnemies; j++) {
+            if (enemies[j].entity.active && bulletHits(playerBullets, i, &enemies[j].entity)) {
+                // Collision detected
+                enemies[j].health--;
+                
+                if (enemies[j].health <= 0) {
+                    enemies[j].entity.active = false;
+                    player->score += 100;
                 }
+                
+                hit = true;
+                break;
             }
         }
+        
+        if (hit) {
+            removeBullet(playerBullets, i);
+        } else {
+            i++;
+        }
     }
     
-    // Check enemy bullets vs player
+    // Check enemy bullets vs player. One hit per frame: the invincibility it
+    // starts covers the rest.
     if (player->entity.active && player->invincibility <= 0) {
-        for (int i = 0; i < maxEnemyBullets; i++) {
-            if (enemyBullets[i].entity.active) {
-                if (enemyBullets[i].entity.x < player->entity.x + player->entity.width &&
-                    enemyBullets[i].entity.x + enemyBullets[i].entity.width > player->entity.x &&
-                    enemyBullets[i].entity.y < player->entity.y + player->entity.height &&
-                    enemyBullets[i].entity.y + enemyBullets[i].entity.height > player->entity.y) {
-                    
-                    // Collision detected
-                    player->health--;
-                    enemyBullets[i].entity.active = false;
-                    player->invincibility = 60; // 1 second invincibility
-                    
-                    if (player->health <= 0) {
-                        player->entity.active = false;
-                        printf("Game Over! Final Score: %d\n", player->score);
-                    }
+        for (int i = 0; i < enemyBullets->count; i++) {
+            if (bulletHits(enemyBullets, i, &player->entity)) {
+                // Collision detected
+                player->health--;
+                removeBullet(enemyBullets, i);
+                player->invincibility = 60; // 1 second invincibility
+                
+                if (player->health <= 0) {
+                    player->entity.active = false;
+                    printf("Game Over! Final Score: %d\n", player->score);
                 }
+                break;
             }
         }
     }
@@ -476,6 +699,62 @@ void checkCollisions(Player* player, Enemy enemies[], int maxEnemies, Bullet pla
     }
 }
 
+bool initBulletBatch(BulletBatch* batch, int capacity) {
+    batch->vertices = (SDL_Vertex*)calloc(capacity * 4, sizeof(SDL_Vertex));
+    batch->indices = (int*)malloc(capacity * 6 * sizeof(int));
+    batch->capacity = capacity;
+    if (batch->vertices == NULL || batch->indices == NULL) {
+        return false;
+    }
+    
+    // Two triangles per quad
+    for (int i = 0; i < capacity; i++) {
+        int* quad = &batch->indices[i * 6];
+        quad[0] = i * 4;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4 + 2;
+        quad[4] = i * 4 + 3;
+        quad[5] = i * 4;
+    }
+    return true;
+}
+
+void freeBulletBatch(BulletBatch* batch) {
+    free(batch->vertices);
+    free(batch->indices);
+    batch->vertices = NULL;
+    batch->indices = NULL;
+    batch->capacity = 0;
+}
+
+// Writes a quad per bullet after the first used quads and returns the new
+// number of quads. Texture coordinates stay zero; the quads are untextured.
+int appendBulletVertices(BulletBatch* batch, int used, BulletPool* bullets) {
+    int count = bullets->count;
+    if (count > batch->capacity - used) {
+        count = batch->capacity - used;
+    }
+    
+    float w = (float)bullets->width;
+    float h = (float)bullets->height;
+    SDL_Vertex* v = &batch->vertices[used * 4];
+    for (int i = 0; i < count; i++, v += 4) {
+        float x = bullets->x[i];
+        float y = bullets->y[i];
+        v[0].position.x = x;
+        v[0].position.y = y;
+        v[1].position.x = x + w;
+        v[1].position.y = y;
+        v[2].position.x = x + w;
+        v[2].position.y = y + h;
+        v[3].position.x = x;
+        v[3].position.y = y + h;
+        v[0].color = v[1].color = v[2].color = v[3].color = bullets->color;
+    }
+    return used + count;
+}
+
 void updateBackground(Background* background) {
     background->y += background->speed;
     
@@ -484,7 +763,7 @@ void updateBackground(Background* background) {
     }
 }
 
-void renderGame(SDL_Renderer* renderer, SDL_Texture* textures[], Player* player, Enemy enemies[], int maxEnemies, Bullet playerBullets[], int maxPlayerBullets, Bullet enemyBullets[], int maxEnemyBullets, Background* background) {
+void renderGame(SDL_Renderer* renderer, SDL_Texture* textures[], Player* player, Enemy enemies[], int maxEnemies, BulletPool* playerBullets, BulletPool* enemyBullets, BulletBatch* batch, Background* background) {
     // Clear screen
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
@@ -512,20 +791,11 @@ void renderGame(SDL_Renderer* renderer, SDL_Texture* textures[], Player* player,
         }
     }
     
-    // Render player bullets
-    for (int i = 0; i < maxPlayerBullets; i++) {
-        if (playerBullets[i].entity.active) {
-            SDL_Rect bulletRect = {(int)playerBullets[i].entity.x, (int)playerBullets[i].entity.y, playerBullets[i].entity.width, playerBullets[i].entity.height};
-            SDL_RenderCopy(renderer, textures[TEXTURE_PLAYER_BULLET], NULL, &bulletRect);
-        }
-    }
-    
-    // Render enemy bullets
-    for (int i = 0; i < maxEnemyBullets; i++) {
-        if (enemyBullets[i].entity.active) {
-            SDL_Rect bulletRect = {(int)enemyBullets[i].entity.x, (int)enemyBullets[i].entity.y, enemyBullets[i].entity.width, enemyBullets[i].entity.height};
-            SDL_RenderCopy(renderer, textures[TEXTURE_ENEMY_BULLET], NULL, &bulletRect);
-        }
+    // Render every bullet in one draw
+    int batched = appendBulletVertices(batch, 0, playerBullets);
+    batched = appendBulletVertices(batch, batched, enemyBullets);
+    if (batched > 0) {
+        SDL_RenderGeometry(renderer, NULL, batch->vertices, batched * 4, batch->indices, batched * 6);
     }
     
     // Present the rendered frame
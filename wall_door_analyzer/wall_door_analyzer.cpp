@@ -1,19 +1,28 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <math.h>
+#include "../common/include/image_batch.h"
 
 // Define constants
 #define MAX_DOORS 20
 #define WALL_FILENAME "wall_tile.png"
 #define DOOR_FILENAME_PREFIX "door_tile_"
+#define WINDOW_FILENAME_PREFIX "window_tile_"
 #define WALL_COLOR_R 100
 #define WALL_COLOR_G 100
 #define WALL_COLOR_B 100
 #define WALL_THRESHOLD 50
 #define DOOR_THRESHOLD 40
 #define MIN_DOOR_WIDTH 20
+#define MIN_DOOR_HEIGHT 20
+#define DOOR_SCALE_STEP 1.25f     // window size growth between search scales
+#define DOOR_STRIDE_DIVISOR 4     // search windows move by 1/4 of their size
+#define DOOR_GROUND_TOLERANCE 4   // openings this close to the bottom are doors
+#define DOOR_REFINE_STEPS 64      // edge nudges allowed per detection
 #define MIN_TILE_WIDTH 32
 #define TILE_HEIGHT 64  // Assuming a fixed height for tiles
 
@@ -24,14 +33,32 @@ typedef struct {
     int height;
 } Image;
 
+typedef enum {
+    OPENING_DOOR,
+    OPENING_WINDOW
+} OpeningKind;
+
 typedef struct {
     int x;
     int y;
     int width;
     int height;
     SDL_Rect rect;
+    OpeningKind kind;  // doors reach the bottom of the image, windows do not
+    int number;        // 1-based among openings of the same kind
 } DoorPosition;
 
+// Summed-area tables over an image: entry (x, y) holds the red, green and
+// blue sums and the count of the non-transparent pixels above and left of
+// it, so any rectangle's sums take four lookups. The sums are Uint32 and
+// allowed to wrap; differences of them are still exact for regions of up
+// to 2^32 / 255 (about 16 million) pixels.
+typedef struct {
+    int width;
+    int height;
+    Uint32 *sums;  // (width + 1) x (height + 1) entries of {r, g, b, count}
+} SummedAreaTable;
+
 // Function to load an image
 Image loadImage(const char *filename) {
     Image img = {0};
@@ -74,31 +101,90 @@ bool isWallPixel(Uint8 r, Uint8 g, Uint8 b) {
     return isColorSimilar(r, g, b, WALL_COLOR_R, WALL_COLOR_G, WALL_COLOR_B, WALL_THRESHOLD);
 }
 
-// Function to calculate the average color of a region
-void getAverageColor(Image img, int start_x, int start_y, int width, int height, Uint8 *avg_r, Uint8 *avg_g, Uint8 *avg_b) {
-    long sum_r = 0, sum_g = 0, sum_b = 0;
-    int count = 0;
-    
-    for (int y = start_y; y < start_y + height && y < img.height; y++) {
-        for (int x = start_x; x < start_x + width && x < img.width; x++) {
-            int index = y * img.width + x;
-            
+// Function to build the summed-area tables for an image
+bool buildSummedAreaTable(SummedAreaTable *table, Image img) {
+    int stride = (img.width + 1) * 4;
+    table->width = img.width;
+    table->height = img.height;
+    table->sums = (Uint32 *)malloc((size_t)stride * (img.height + 1) * sizeof(Uint32));
+    if (!table->sums) {
+        printf("Could not allocate summed-area tables for %d x %d\n", img.width, img.height);
+        return false;
+    }
+    memset(table->sums, 0, stride * sizeof(Uint32));
+    
+    bool rgba8888 = img.surface->format->format == SDL_PIXELFORMAT_RGBA8888;
+    for (int y = 0; y < img.height; y++) {
+        const Uint32 *pixels = (const Uint32 *)((const Uint8 *)img.surface->pixels + y * img.surface->pitch);
+        const Uint32 *above = &table->sums[y * stride];
+        Uint32 *row = &table->sums[(y + 1) * stride];
+        Uint32 rowSum[4] = {0, 0, 0, 0};
+        row[0] = row[1] = row[2] = row[3] = 0;
+        
+        for (int x = 0; x < img.width; x++) {
             Uint8 r, g, b, a;
-            SDL_GetRGBA(img.pixels[index], img.surface->format, &r, &g, &b, &a);
+            if (rgba8888) {
+                r = pixels[x] >> 24;
+                g = pixels[x] >> 16;
+                b = pixels[x] >> 8;
+                a = pixels[x];
+            } else {
+                SDL_GetRGBA(pixels[x], img.surface->format, &r, &g, &b, &a);
+            }
             
             if (a > 0) {  // Only count non-transparent pixels
-                sum_r += r;
-                sum_g += g;
-                sum_b += b;
-                count++;
+                rowSum[0] += r;
+                rowSum[1] += g;
+                rowSum[2] += b;
+                rowSum[3]++;
             }
+            
+            int i = (x + 1) * 4;
+            row[i] = above[i] + rowSum[0];
+            row[i + 1] = above[i + 1] + rowSum[1];
+            row[i + 2] = above[i + 2] + rowSum[2];
+            row[i + 3] = above[i + 3] + rowSum[3];
         }
     }
     
-    if (count > 0) {
-        *avg_r = sum_r / count;
-        *avg_g = sum_g / count;
-        *avg_b = sum_b / count;
+    return true;
+}
+
+void freeSummedAreaTable(SummedAreaTable *table) {
+    free(table->sums);
+    table->sums = NULL;
+}
+
+// Sums of a region clipped to the image: r, g, b and non-transparent count
+static void getRegionSums(const SummedAreaTable *table, int x, int y, int width, int height, Uint32 sums[4]) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + width > table->width ? table->width : x + width;
+    int y1 = y + height > table->height ? table->height : y + height;
+    if (x1 <= x0 || y1 <= y0) {
+        sums[0] = sums[1] = sums[2] = sums[3] = 0;
+        return;
+    }
+    
+    int stride = (table->width + 1) * 4;
+    const Uint32 *topLeft = &table->sums[y0 * stride + x0 * 4];
+    const Uint32 *topRight = &table->sums[y0 * stride + x1 * 4];
+    const Uint32 *bottomLeft = &table->sums[y1 * stride + x0 * 4];
+    const Uint32 *bottomRight = &table->sums[y1 * stride + x1 * 4];
+    for (int c = 0; c < 4; c++) {
+        sums[c] = bottomRight[c] - topRight[c] - bottomLeft[c] + topLeft[c];
+    }
+}
+
+// Function to calculate the average color of a region
+void getAverageColor(const SummedAreaTable *table, int start_x, int start_y, int width, int height, Uint8 *avg_r, Uint8 *avg_g, Uint8 *avg_b) {
+    Uint32 sums[4];
+    getRegionSums(table, start_x, start_y, width, height, sums);
+    
+    if (sums[3] > 0) {
+        *avg_r = sums[0] / sums[3];
+        *avg_g = sums[1] / sums[3];
+        *avg_b = sums[2] / sums[3];
     } else {
         *avg_r = 0;
         *avg_g = 0;
@@ -106,123 +192,267 @@ void getAverageColor(Image img, int start_x, int start_y, int width, int height,
     }
 }
 
-// Function to find the doors in the image
-int findDoors(Image source, DoorPosition doors[MAX_DOORS]) {
-    int door_count = 0;
+// Same distance isColorSimilar() uses, from the average of some sums
+static float colorDistance(const Uint32 sums[4], Uint8 r, Uint8 g, Uint8 b) {
+    float count = (float)sums[3];
+    return fabsf(sums[0] / count - r) + fabsf(sums[1] / count - g) + fabsf(sums[2] / count - b);
+}
+
+// How much a rectangle looks like an opening in the wall: its average must
+// differ from the wall colour while a ring around it (clipped to the image)
+// still matches the wall. The score is the first difference less the
+// second, so a rectangle that fits the opening tightly beats one that also
+// takes in wall or falls inside the opening. Negative when it is not an
+// opening at all.
+static float getOpeningScore(const SummedAreaTable *table, SDL_Rect rect, Uint8 wall_r, Uint8 wall_g, Uint8 wall_b) {
+    Uint32 inner[4];
+    getRegionSums(table, rect.x, rect.y, rect.w, rect.h, inner);
+    if (inner[3] * 2 < (Uint32)(rect.w * rect.h)) {
+        return -1;  // mostly transparent
+    }
     
-    // First, try to determine what might be a door by looking for regions that differ from the wall
-    // We'll look for horizontal regions that are different from the wall texture
+    float innerDistance = colorDistance(inner, wall_r, wall_g, wall_b);
+    if (innerDistance < DOOR_THRESHOLD) {
+        return -1;
+    }
+    
+    int margin = (rect.w < rect.h ? rect.w : rect.h) / 4;
+    if (margin < 2) margin = 2;
+    Uint32 outer[4], ring[4];
+    getRegionSums(table, rect.x - margin, rect.y - margin, rect.w + 2 * margin, rect.h + 2 * margin, outer);
+    for (int c = 0; c < 4; c++) {
+        ring[c] = outer[c] - inner[c];
+    }
+    if (ring[3] == 0) {
+        return -1;  // nothing around it to be a wall
+    }
+    
+    float ringDistance = colorDistance(ring, wall_r, wall_g, wall_b);
+    if (ringDistance >= DOOR_THRESHOLD) {
+        return -1;
+    }
+    return innerDistance - ringDistance;
+}
+
+// Nudges each edge of a detection a pixel at a time while that raises its
+// score, taking it from the search grid to the opening's real edges
+static float refineOpening(const SummedAreaTable *table, SDL_Rect *rect, float score, Uint8 wall_r, Uint8 wall_g, Uint8 wall_b) {
+    for (int step = 0; step < DOOR_REFINE_STEPS; step++) {
+        bool improved = false;
+        for (int edge = 0; edge < 4; edge++) {
+            for (int delta = -1; delta <= 1; delta += 2) {
+                SDL_Rect moved = *rect;
+                switch (edge) {
+                    case 0: moved.x += delta; moved.w -= delta; break;  // left
+                    case 1: moved.w += delta; break;                    // right
+                    case 2: moved.y += delta; moved.h -= delta; break;  // top
+                    default: moved.h += delta; break;                   // bottom
+                }
+                if (moved.x < 0 || moved.y < 0 || moved.x + moved.w > table->width || moved.y + moved.h > table->height ||
+                    moved.w < MIN_DOOR_WIDTH || moved.h < MIN_DOOR_HEIGHT) {
+                    continue;
+                }
+                float movedScore = getOpeningScore(table, moved, wall_r, wall_g, wall_b);
+                if (movedScore > score) {
+                    *rect = moved;
+                    score = movedScore;
+                    improved = true;
+                }
+            }
+        }
+        if (!improved) {
+            break;
+        }
+    }
+    return score;
+}
+
+typedef struct {
+    SDL_Rect rect;
+    float score;
+} OpeningCandidate;
+
+static int compareCandidates(const void *a, const void *b) {
+    const OpeningCandidate *first = (const OpeningCandidate *)a;
+    const OpeningCandidate *second = (const OpeningCandidate *)b;
+    if (first->score != second->score) {
+        return first->score > second->score ? -1 : 1;
+    }
+    return second->rect.w * second->rect.h - first->rect.w * first->rect.h;
+}
+
+static int compareOpenings(const void *a, const void *b) {
+    const DoorPosition *first = (const DoorPosition *)a;
+    const DoorPosition *second = (const DoorPosition *)b;
+    if (first->x != second->x) {
+        return first->x - second->x;
+    }
+    return first->y - second->y;
+}
+
+// Function to find the doors and windows in the image
+int findDoors(Image source, const SummedAreaTable *table, DoorPosition doors[MAX_DOORS], bool verbose) {
+    Uint32 start = SDL_GetTicks();
+    int door_count = 0;
     
     // First, get a reference wall color by sampling several wall regions
     Uint8 wall_avg_r, wall_avg_g, wall_avg_b;
-    getAverageColor(source, 0, 0, source.width / 4, TILE_HEIGHT, &wall_avg_r, &wall_avg_g, &wall_avg_b);
+    getAverageColor(table, 0, 0, source.width / 4, TILE_HEIGHT, &wall_avg_r, &wall_avg_g, &wall_avg_b);
     
-    printf("Reference wall color: RGB(%d, %d, %d)\n", wall_avg_r, wall_avg_g, wall_avg_b);
+    if (verbose) {
+        printf("Reference wall color: RGB(%d, %d, %d)\n", wall_avg_r, wall_avg_g, wall_avg_b);
+    }
     
-    // Scan for doors (regions that differ significantly from the wall color)
-    bool in_door = false;
-    int door_start_x = 0;
+    // Slide windows of every size over the image, from the minimum opening
+    // up to the whole image, keeping each one that scores as an opening.
+    // Every score is a handful of table lookups.
+    OpeningCandidate *candidates = NULL;
+    int candidate_count = 0;
+    int candidate_capacity = 0;
+    for (float scaled_h = MIN_DOOR_HEIGHT; (int)scaled_h <= source.height; scaled_h *= DOOR_SCALE_STEP) {
+        int h = (int)scaled_h;
+        for (float scaled_w = MIN_DOOR_WIDTH; (int)scaled_w <= source.width; scaled_w *= DOOR_SCALE_STEP) {
+            int w = (int)scaled_w;
+            int stride_x = w / DOOR_STRIDE_DIVISOR > 1 ? w / DOOR_STRIDE_DIVISOR : 1;
+            int stride_y = h / DOOR_STRIDE_DIVISOR > 1 ? h / DOOR_STRIDE_DIVISOR : 1;
+            
+            for (int y = 0; y + h <= source.height; y += stride_y) {
+                for (int x = 0; x + w <= source.width; x += stride_x) {
+                    SDL_Rect rect = {x, y, w, h};
+                    float score = getOpeningScore(table, rect, wall_avg_r, wall_avg_g, wall_avg_b);
+                    if (score < 0) {
+                        continue;
+                    }
+                    
+                    if (candidate_count == candidate_capacity) {
+                        int capacity = candidate_capacity ? candidate_capacity * 2 : 256;
+                        OpeningCandidate *grown = (OpeningCandidate *)realloc(candidates, capacity * sizeof(OpeningCandidate));
+                        if (!grown) {
+                            printf("Out of memory collecting door candidates\n");
+                            free(candidates);
+                            return 0;
+                        }
+                        candidates = grown;
+                        candidate_capacity = capacity;
+                    }
+                    candidates[candidate_count].rect = rect;
+                    candidates[candidate_count].score = score;
+                    candidate_count++;
+                }
+            }
+        }
+    }
     
-    for (int x = 0; x < source.width; x++) {
-        // Sample a vertical strip to determine if it's part of a door
-        Uint8 strip_avg_r, strip_avg_g, strip_avg_b;
-        getAverageColor(source, x, 0, 1, source.height, &strip_avg_r, &strip_avg_g, &strip_avg_b);
-        
-        bool is_door_pixel = !isColorSimilar(strip_avg_r, strip_avg_g, strip_avg_b, 
-                                           wall_avg_r, wall_avg_g, wall_avg_b, 
-                                           DOOR_THRESHOLD);
+    // Best first, each one kept only if it overlaps none already kept
+    if (candidate_count > 0) {
+        qsort(candidates, candidate_count, sizeof(OpeningCandidate), compareCandidates);
+    }
+    for (int i = 0; i < candidate_count && door_count < MAX_DOORS; i++) {
+        SDL_Rect rect = candidates[i].rect;
+        bool overlaps = false;
+        for (int j = 0; j < door_count && !overlaps; j++) {
+            overlaps = SDL_HasIntersection(&rect, &doors[j].rect);
+        }
+        if (overlaps) {
+            continue;
+        }
         
-        // Starting a new door
-        if (!in_door && is_door_pixel) {
-            in_door = true;
-            door_start_x = x;
+        refineOpening(table, &rect, candidates[i].score, wall_avg_r, wall_avg_g, wall_avg_b);
+        for (int j = 0; j < door_count && !overlaps; j++) {
+            overlaps = SDL_HasIntersection(&rect, &doors[j].rect);
         }
-        // Ending a door
-        else if (in_door && (!is_door_pixel || x == source.width - 1)) {
-            in_door = false;
-            
-            // Calculate door width
-            int door_width = x - door_start_x;
-            if (x == source.width - 1 && is_door_pixel) {
-                door_width++;  // Include the last pixel
-            }
-            
-            // Only add if it's wide enough to be a door and we have space
-            if (door_width >= MIN_DOOR_WIDTH && door_count < MAX_DOORS) {
-                doors[door_count].x = door_start_x;
-                doors[door_count].y = 0;
-                doors[door_count].width = door_width;
-                doors[door_count].height = source.height;
-                doors[door_count].rect = (SDL_Rect){door_start_x, 0, door_width, source.height};
-                door_count++;
-                
-                printf("Door found at x=%d with width=%d\n", door_start_x, door_width);
-            }
+        if (overlaps) {
+            continue;
+        }
+        
+        doors[door_count].x = rect.x;
+        doors[door_count].y = rect.y;
+        doors[door_count].width = rect.w;
+        doors[door_count].height = rect.h;
+        doors[door_count].rect = rect;
+        doors[door_count].kind = rect.y + rect.h >= source.height - DOOR_GROUND_TOLERANCE ? OPENING_DOOR : OPENING_WINDOW;
+        door_count++;
+    }
+    free(candidates);
+    
+    // Left to right, numbering doors and windows separately
+    qsort(doors, door_count, sizeof(DoorPosition), compareOpenings);
+    int door_number = 0, window_number = 0;
+    for (int i = 0; i < door_count; i++) {
+        doors[i].number = doors[i].kind == OPENING_DOOR ? ++door_number : ++window_number;
+        if (verbose) {
+            printf("%s found at x=%d y=%d with size %dx%d\n", doors[i].kind == OPENING_DOOR ? "Door" : "Window",
+                   doors[i].x, doors[i].y, doors[i].width, doors[i].height);
         }
     }
     
+    if (verbose) {
+        printf("Searched %d x %d in %u ms\n", source.width, source.height, SDL_GetTicks() - start);
+    }
     return door_count;
 }
 
-// Function to extract a wall tile
-bool extractWallTile(Image source, DoorPosition doors[], int door_count) {
-    // Find a good section of wall to use as a tile (between doors or at the edges)
+// File name of an extracted door or window tile
+static void getOpeningFilename(const DoorPosition *door, char *filename, size_t size) {
+    snprintf(filename, size, "%s%d.png", door->kind == OPENING_DOOR ? DOOR_FILENAME_PREFIX : WINDOW_FILENAME_PREFIX, door->number);
+}
+
+// Function to find a full-height section of wall clear of every opening
+bool findWallTileRect(Image source, DoorPosition doors[], int door_count, SDL_Rect *rect) {
     int tile_x = 0;
-    int tile_width = MIN_TILE_WIDTH;
     bool tile_found = false;
     
-    // Try to find a section of wall between doors
-    for (int i = 0; i < door_count - 1; i++) {
-        int space_between = doors[i+1].x - (doors[i].x + doors[i].width);
-        if (space_between >= MIN_TILE_WIDTH) {
-            tile_x = doors[i].x + doors[i].width;
-            tile_width = MIN_TILE_WIDTH;  // Or use a larger value if you want
+    // Openings are sorted by x, but a window above a door can overlap it in
+    // x, so track how far right the openings so far reach.
+    int covered_end = 0;
+    for (int i = 0; i < door_count && !tile_found; i++) {
+        if (doors[i].x - covered_end >= MIN_TILE_WIDTH) {
+            tile_x = covered_end;
             tile_found = true;
-            break;
+        }
+        if (doors[i].x + doors[i].width > covered_end) {
+            covered_end = doors[i].x + doors[i].width;
         }
     }
     
-    // If no suitable space between doors, check the beginning or end
-    if (!tile_found) {
-        if (door_count > 0) {
-            if (doors[0].x >= MIN_TILE_WIDTH) {
-                // Use beginning of wall
-                tile_x = 0;
-                tile_width = MIN_TILE_WIDTH;
-                tile_found = true;
-            } else if (source.width - (doors[door_count-1].x + doors[door_count-1].width) >= MIN_TILE_WIDTH) {
-                // Use end of wall
-                tile_x = doors[door_count-1].x + doors[door_count-1].width;
-                tile_width = MIN_TILE_WIDTH;
-                tile_found = true;
-            }
-        } else {
-            // No doors, use beginning of wall
-            tile_x = 0;
-            tile_width = MIN_TILE_WIDTH;
-            tile_found = true;
-        }
+    // If no suitable space before or between openings, use the end of the wall
+    if (!tile_found && (door_count == 0 || source.width - covered_end >= MIN_TILE_WIDTH)) {
+        tile_x = covered_end;
+        tile_found = true;
     }
     
-    if (!tile_found) {
+    *rect = (SDL_Rect){tile_x, 0, MIN_TILE_WIDTH, source.height};
+    return tile_found;
+}
+
+// Function to copy a region of the source into a new surface
+SDL_Surface *copyTile(Image source, SDL_Rect rect) {
+    SDL_Surface *tile_surface = SDL_CreateRGBSurfaceWithFormat(0, rect.w, rect.h, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!tile_surface) {
+        printf("Error creating tile surface: %s\n", SDL_GetError());
+        return NULL;
+    }
+    SDL_BlitSurface(source.surface, &rect, tile_surface, NULL);
+    return tile_surface;
+}
+
+// Function to extract a wall tile
+bool extractWallTile(Image source, DoorPosition doors[], int door_count) {
+    // Find a good section of wall to use as a tile (between doors or at the edges)
+    SDL_Rect src_rect;
+    if (!findWallTileRect(source, doors, door_count, &src_rect)) {
         printf("Could not find a suitable wall section to extract a tile from.\n");
         return false;
     }
     
-    printf("Extracting wall tile from x=%d with width=%d\n", tile_x, tile_width);
+    printf("Extracting wall tile from x=%d with width=%d\n", src_rect.x, src_rect.w);
     
-    // Create a surface for the wall tile
-    SDL_Surface *tile_surface = SDL_CreateRGBSurfaceWithFormat(0, tile_width, source.height, 
-                                                              32, SDL_PIXELFORMAT_RGBA8888);
+    // Copy the wall section to a tile
+    SDL_Surface *tile_surface = copyTile(source, src_rect);
     if (!tile_surface) {
-        printf("Error creating wall tile surface: %s\n", SDL_GetError());
         return false;
     }
     
-    // Copy the wall section to the tile
-    SDL_Rect src_rect = {tile_x, 0, tile_width, source.height};
-    SDL_BlitSurface(source.surface, &src_rect, tile_surface, NULL);
-    
     // Save the wall tile
     int result = IMG_SavePNG(tile_surface, WALL_FILENAME);
     SDL_FreeSurface(tile_surface);
@@ -239,21 +469,15 @@ bool extractWallTile(Image source, DoorPosition doors[], int door_count) {
 // Function to extract door tiles
 bool extractDoorTiles(Image source, DoorPosition doors[], int door_count) {
     for (int i = 0; i < door_count; i++) {
-        // Create a surface for the door tile
-        SDL_Surface *door_surface = SDL_CreateRGBSurfaceWithFormat(0, doors[i].width, source.height, 
-                                                                 32, SDL_PIXELFORMAT_RGBA8888);
+        // Copy the door to a tile
+        SDL_Surface *door_surface = copyTile(source, doors[i].rect);
         if (!door_surface) {
-            printf("Error creating door tile surface: %s\n", SDL_GetError());
             continue;
         }
         
-        // Copy the door to the tile
-        SDL_Rect src_rect = {doors[i].x, 0, doors[i].width, source.height};
-        SDL_BlitSurface(source.surface, &src_rect, door_surface, NULL);
-        
         // Create the filename
         char filename[256];
-        snprintf(filename, sizeof(filename), "%s%d.png", DOOR_FILENAME_PREFIX, i + 1);
+        getOpeningFilename(&doors[i], filename, sizeof(filename));
         
         // Save the door tile
         int result = IMG_SavePNG(door_surface, filename);
@@ -297,12 +521,12 @@ bool createTestImage(Image source, DoorPosition doors[], int door_count, const c
     // Place doors at new positions
     for (int i = 0; i < door_count && i < 2; i++) {  // Place up to 2 doors in the test image
         char door_filename[256];
-        snprintf(door_filename, sizeof(door_filename), "%s%d.png", DOOR_FILENAME_PREFIX, i + 1);
+        getOpeningFilename(&doors[i], door_filename, sizeof(door_filename));
         
         Image door_tile = loadImage(door_filename);
         if (door_tile.surface) {
-            // Place door at a new position
-            SDL_Rect dest_rect = {(i + 1) * test_width / 3, 0, door_tile.width, door_tile.height};
+            // Place door at a new position, at its original height
+            SDL_Rect dest_rect = {(i + 1) * test_width / 3, doors[i].y, door_tile.width, door_tile.height};
             SDL_BlitSurface(door_tile.surface, NULL, test_surface, &dest_rect);
             
             SDL_FreeSurface(door_tile.surface);
@@ -325,10 +549,362 @@ bool createTestImage(Image source, DoorPosition doors[], int door_count, const c
     }
 }
 
+// Batch mode: every image in a directory or list file is analyzed on a pool
+// of threads, and the tiles found are collapsed into one shared tile set.
+// A tile is a duplicate of an earlier one when its pixels hash the same, or
+// when it is a near duplicate: same kind, about the same size and colour,
+// and a difference hash within TILE_PHASH_DISTANCE bits.
+
+#define MAX_PATH_LENGTH 1024
+#define MAX_IMAGE_TILES (MAX_DOORS + 1)  // the wall tile and every opening
+#define TILE_PHASH_DISTANCE 6            // of 64 bits
+#define TILE_PHASH_MARGIN 8.0f           // grey levels
+#define TILE_SIZE_TOLERANCE 2            // pixels either way
+#define TILE_COLOR_THRESHOLD 24          // mean colours closer than this match
+#define MANIFEST_FILENAME "manifest.txt"
+#define TILE_FILENAME_FORMAT "tile_%04d.png"
+
+typedef enum {
+    TILE_WALL,
+    TILE_DOOR,
+    TILE_WINDOW
+} TileKind;
+
+static const char *tileKindNames[] = {"wall", "door", "window"};
+
+// One tile cut from one image, and the shared tile it ended up as
+typedef struct {
+    TileKind kind;
+    SDL_Rect rect;
+    Uint64 exactHash;
+    Uint64 perceptualHash;
+    Uint8 r, g, b;  // mean colour
+    int tileId;
+} ImageTile;
+
+typedef struct {
+    const char *path;
+    bool loaded;
+    ImageTile tiles[MAX_IMAGE_TILES];
+    int tileCount;
+} ImageResult;
+
+// A tile in the shared set; the first image to have it owns it
+typedef struct {
+    TileKind kind;
+    int width, height;
+    Uint64 exactHash;
+    Uint64 perceptualHash;
+    Uint8 r, g, b;
+} SharedTile;
+
+typedef struct {
+    image_batch::FileList inputs;
+    int count;
+    ImageResult *results;
+    const char *outputDir;
+    SDL_atomic_t nextJob;
+    
+    // Images join the tile set strictly in input order, so tile IDs and the
+    // choice of which copy to keep do not depend on thread timing
+    SDL_mutex *lock;
+    SDL_cond *turn;
+    int nextToRegister;
+    SharedTile *tiles;
+    int tileCount;
+    int tileCapacity;
+    int exactDuplicates;
+    int nearDuplicates;
+    int failedSaves;
+} TileBatch;
+
+// FNV-1a over the tile's size and pixels
+static Uint64 hashTilePixels(Image source, SDL_Rect rect) {
+    Uint64 hash = 14695981039346656037ULL;
+    int size[2] = {rect.w, rect.h};
+    const Uint8 *bytes = (const Uint8 *)size;
+    for (size_t i = 0; i < sizeof(size); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    for (int y = rect.y; y < rect.y + rect.h; y++) {
+        bytes = (const Uint8 *)source.surface->pixels + y * source.surface->pitch + rect.x * 4;
+        for (int i = 0; i < rect.w * 4; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// Difference hash: the tile shrunk to 9x8 grey cells, one bit per cell for
+// whether it is brighter than its right neighbour by more than
+// TILE_PHASH_MARGIN. The margin keeps noise on flat areas, which is most of
+// a wall, from flipping bits at random. The cell averages come from the
+// summed-area tables.
+static Uint64 hashTilePerceptual(const SummedAreaTable *table, SDL_Rect rect) {
+    Uint64 hash = 0;
+    for (int row = 0; row < 8; row++) {
+        int y0 = rect.y + rect.h * row / 8;
+        int y1 = rect.y + rect.h * (row + 1) / 8;
+        float previous = 0;
+        for (int column = 0; column < 9; column++) {
+            int x0 = rect.x + rect.w * column / 9;
+            int x1 = rect.x + rect.w * (column + 1) / 9;
+            Uint32 sums[4];
+            getRegionSums(table, x0, y0, x1 - x0, y1 - y0, sums);
+            float grey = sums[3] > 0 ? (sums[0] + sums[1] + sums[2]) / (3.0f * sums[3]) : 0;
+            if (column > 0) {
+                hash = (hash << 1) | (previous > grey + TILE_PHASH_MARGIN);
+            }
+            previous = grey;
+        }
+    }
+    return hash;
+}
+
+static int countBits(Uint64 value) {
+    int bits = 0;
+    for (; value; value &= value - 1) {
+        bits++;
+    }
+    return bits;
+}
+
+static void describeTile(Image source, const SummedAreaTable *table, TileKind kind, SDL_Rect rect, ImageTile *tile) {
+    tile->kind = kind;
+    tile->rect = rect;
+    tile->exactHash = hashTilePixels(source, rect);
+    tile->perceptualHash = hashTilePerceptual(table, rect);
+    getAverageColor(table, rect.x, rect.y, rect.w, rect.h, &tile->r, &tile->g, &tile->b);
+    tile->tileId = -1;
+}
+
+static bool isNearDuplicate(const SharedTile *shared, const ImageTile *tile) {
+    return shared->kind == tile->kind &&
+           abs(shared->width - tile->rect.w) <= TILE_SIZE_TOLERANCE &&
+           abs(shared->height - tile->rect.h) <= TILE_SIZE_TOLERANCE &&
+           isColorSimilar(shared->r, shared->g, shared->b, tile->r, tile->g, tile->b, TILE_COLOR_THRESHOLD) &&
+           countBits(shared->perceptualHash ^ tile->perceptualHash) <= TILE_PHASH_DISTANCE;
+}
+
+// Finds each tile in the shared set or adds it. Returns how many were new;
+// call with the lock held.
+static int registerTiles(TileBatch *batch, ImageResult *result) {
+    int added = 0;
+    for (int i = 0; i < result->tileCount; i++) {
+        ImageTile *tile = &result->tiles[i];
+        for (int j = 0; j < batch->tileCount && tile->tileId < 0; j++) {
+            const SharedTile *shared = &batch->tiles[j];
+            if (shared->exactHash == tile->exactHash && shared->width == tile->rect.w && shared->height == tile->rect.h) {
+                tile->tileId = j;
+                batch->exactDuplicates++;
+            }
+        }
+        for (int j = 0; j < batch->tileCount && tile->tileId < 0; j++) {
+            if (isNearDuplicate(&batch->tiles[j], tile)) {
+                tile->tileId = j;
+                batch->nearDuplicates++;
+            }
+        }
+        if (tile->tileId >= 0) {
+            continue;
+        }
+        
+        if (batch->tileCount == batch->tileCapacity) {
+            int capacity = batch->tileCapacity ? batch->tileCapacity * 2 : 256;
+            SharedTile *grown = (SharedTile *)realloc(batch->tiles, capacity * sizeof(SharedTile));
+            if (!grown) {
+                printf("Out of memory growing the tile set\n");
+                continue;
+            }
+            batch->tiles = grown;
+            batch->tileCapacity = capacity;
+        }
+        SharedTile *shared = &batch->tiles[batch->tileCount];
+        shared->kind = tile->kind;
+        shared->width = tile->rect.w;
+        shared->height = tile->rect.h;
+        shared->exactHash = tile->exactHash;
+        shared->perceptualHash = tile->perceptualHash;
+        shared->r = tile->r;
+        shared->g = tile->g;
+        shared->b = tile->b;
+        tile->tileId = batch->tileCount++;
+        added++;
+    }
+    return added;
+}
+
+static void getTileFilename(int tileId, char *filename, size_t size) {
+    snprintf(filename, size, TILE_FILENAME_FORMAT, tileId);
+}
+
+// Loads, analyzes and hashes one image, waits for its turn to join the tile
+// set, then saves the tiles it was first to have
+static void analyzeBatchImage(TileBatch *batch, int job) {
+    ImageResult *result = &batch->results[job];
+    result->path = batch->inputs.paths[job];
+    
+    Image source = loadImage(result->path);
+    SummedAreaTable table = {};
+    if (source.surface && buildSummedAreaTable(&table, source)) {
+        result->loaded = true;
+        DoorPosition doors[MAX_DOORS];
+        int door_count = findDoors(source, &table, doors, false);
+        
+        SDL_Rect wall_rect;
+        if (findWallTileRect(source, doors, door_count, &wall_rect)) {
+            describeTile(source, &table, TILE_WALL, wall_rect, &result->tiles[result->tileCount++]);
+        }
+        for (int i = 0; i < door_count; i++) {
+            TileKind kind = doors[i].kind == OPENING_DOOR ? TILE_DOOR : TILE_WINDOW;
+            describeTile(source, &table, kind, doors[i].rect, &result->tiles[result->tileCount++]);
+        }
+        freeSummedAreaTable(&table);
+    }
+    
+    SDL_LockMutex(batch->lock);
+    while (batch->nextToRegister != job) {
+        SDL_CondWait(batch->turn, batch->lock);
+    }
+    int first_new = batch->tileCount;
+    registerTiles(batch, result);
+    batch->nextToRegister++;
+    SDL_CondBroadcast(batch->turn);
+    SDL_UnlockMutex(batch->lock);
+    
+    // Tile IDs from first_new on were added by this image
+    for (int i = 0; i < result->tileCount; i++) {
+        const ImageTile *tile = &result->tiles[i];
+        if (tile->tileId < first_new) {
+            continue;
+        }
+        char name[64], path[MAX_PATH_LENGTH];
+        getTileFilename(tile->tileId, name, sizeof(name));
+        snprintf(path, sizeof(path), "%s/%s", batch->outputDir, name);
+        SDL_Surface *surface = copyTile(source, tile->rect);
+        if (!surface || IMG_SavePNG(surface, path) != 0) {
+            printf("Failed to save tile %s: %s\n", path, IMG_GetError());
+            SDL_LockMutex(batch->lock);
+            batch->failedSaves++;
+            SDL_UnlockMutex(batch->lock);
+        }
+        SDL_FreeSurface(surface);
+    }
+    
+    SDL_FreeSurface(source.surface);
+}
+
+static int tileBatchWorker(void *data) {
+    TileBatch *batch = (TileBatch *)data;
+    for (;;) {
+        int job = SDL_AtomicAdd(&batch->nextJob, 1);
+        if (job >= batch->count) {
+            return 0;
+        }
+        analyzeBatchImage(batch, job);
+    }
+}
+
+// The manifest lists the shared tiles, then each source image in input
+// order with the tiles it is made of:
+//
+//   tile <id> <kind> <file> <width> <height>
+//   source <path>
+//     <kind> <tile id> <x> <y> <width> <height>
+static bool writeManifest(const TileBatch *batch) {
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s/%s", batch->outputDir, MANIFEST_FILENAME);
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("Could not write %s\n", path);
+        return false;
+    }
+    
+    fprintf(file, "# wall_door_analyzer tile manifest: %d sources, %d tiles\n", batch->count, batch->tileCount);
+    for (int i = 0; i < batch->tileCount; i++) {
+        char name[64];
+        getTileFilename(i, name, sizeof(name));
+        fprintf(file, "tile %d %s %s %d %d\n", i, tileKindNames[batch->tiles[i].kind], name,
+                batch->tiles[i].width, batch->tiles[i].height);
+    }
+    for (int i = 0; i < batch->count; i++) {
+        const ImageResult *result = &batch->results[i];
+        if (!result->loaded) {
+            continue;
+        }
+        fprintf(file, "source %s\n", result->path);
+        for (int j = 0; j < result->tileCount; j++) {
+            const ImageTile *tile = &result->tiles[j];
+            if (tile->tileId < 0) {
+                continue;
+            }
+            fprintf(file, "  %s %d %d %d %d %d\n", tileKindNames[tile->kind], tile->tileId,
+                    tile->rect.x, tile->rect.y, tile->rect.w, tile->rect.h);
+        }
+    }
+    
+    bool ok = fclose(file) == 0;
+    if (ok) {
+        printf("Manifest saved to %s\n", path);
+    }
+    return ok;
+}
+
+static void freeTileBatch(TileBatch *batch) {
+    image_batch::freeFileList(&batch->inputs);
+    free(batch->results);
+    free(batch->tiles);
+    if (batch->turn) SDL_DestroyCond(batch->turn);
+    if (batch->lock) SDL_DestroyMutex(batch->lock);
+}
+
+int runBatch(const char *source, const char *outputDir, int threadCount) {
+    TileBatch batch = {};
+    batch.outputDir = outputDir;
+    if (!image_batch::listInputs(&batch.inputs, source)) {
+        freeTileBatch(&batch);
+        return 1;
+    }
+    batch.count = batch.inputs.count;
+    if (batch.count == 0) {
+        printf("No images found in %s\n", source);
+        freeTileBatch(&batch);
+        return 0;
+    }
+    
+    batch.results = (ImageResult *)calloc(batch.count, sizeof(ImageResult));
+    batch.lock = SDL_CreateMutex();
+    batch.turn = SDL_CreateCond();
+    if (!batch.results || !batch.lock || !batch.turn) {
+        printf("Could not set up the batch: %s\n", SDL_GetError());
+        freeTileBatch(&batch);
+        return 1;
+    }
+    
+    Uint32 start = SDL_GetTicks();
+    int threads = image_batch::runWorkers(tileBatchWorker, &batch, batch.count, threadCount, "tile worker");
+    
+    int failed = 0, extracted = 0;
+    for (int i = 0; i < batch.count; i++) {
+        failed += !batch.results[i].loaded;
+        extracted += batch.results[i].tileCount;
+    }
+    printf("Analyzed %d of %d images on %d threads in %u ms\n", batch.count - failed, batch.count,
+           threads, SDL_GetTicks() - start);
+    printf("%d tiles extracted, %d unique (%d exact and %d near duplicates collapsed)\n",
+           extracted, batch.tileCount, batch.exactDuplicates, batch.nearDuplicates);
+    
+    bool ok = writeManifest(&batch) && failed == 0 && batch.failedSaves == 0;
+    freeTileBatch(&batch);
+    return ok ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
     // Check command line arguments
-    if (argc < 2) {
+    bool batchMode = argc >= 2 && strcmp(argv[1], "--batch") == 0;
+    if (argc < 2 || (batchMode && argc < 4)) {
         printf("Usage: %s <input_image.png> [test_output.png]\n", argv[0]);
+        printf("       %s --batch <input_dir|file_list> <output_dir> [threads]\n", argv[0]);
         return 1;
     }
     
@@ -348,6 +924,13 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    if (batchMode) {
+        int result = runBatch(argv[2], argv[3], argc >= 5 ? atoi(argv[4]) : SDL_GetCPUCount());
+        IMG_Quit();
+        SDL_Quit();
+        return result;
+    }
+    
     // Load the source image
     Image source = loadImage(inputFile);
     if (!source.surface) {
@@ -358,11 +941,21 @@ int main(int argc, char *argv[]) {
     
     printf("Image loaded: %s (%d x %d)\n", inputFile, source.width, source.height);
     
+    // Build the region sums once; every average after this is O(1)
+    SummedAreaTable table;
+    if (!buildSummedAreaTable(&table, source)) {
+        SDL_FreeSurface(source.surface);
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    
     // Find doors in the image
     DoorPosition doors[MAX_DOORS];
-    int door_count = findDoors(source, doors);
+    int door_count = findDoors(source, &table, doors, true);
+    freeSummedAreaTable(&table);
     
-    printf("Found %d door(s) in the image.\n", door_count);
+    printf("Found %d door(s) and window(s) in the image.\n", door_count);
     
     // Extract wall tile
     if (!extractWallTile(source, doors, door_count)) {
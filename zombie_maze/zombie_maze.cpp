@@ -7,6 +7,18 @@
 #include <algorithm>
 #include <string>
 #include <iostream>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <cstdint>
+#include <queue>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // Constants
 const int SCREEN_WIDTH = 800;
@@ -114,15 +126,340 @@ private:
     int keys;
 };
 
+// PCG32 random generator: 16 bytes of state and a handful of instructions
+// per number, cheap enough to draw from every frame. Each stream number
+// gives an independent sequence for the same seed, so level generation and
+// zombie AI never disturb each other. Usable with the <random>
+// distributions and std::shuffle.
+class Rng {
+public:
+    typedef uint32_t result_type;
+    
+    // Streams drawn from the game seed
+    static constexpr uint64_t LEVEL_STREAM = 1;
+    static constexpr uint64_t AI_STREAM = 2;
+    
+    explicit Rng(uint64_t seedValue = 0, uint64_t stream = 0) {
+        seed(seedValue, stream);
+    }
+    
+    void seed(uint64_t seedValue, uint64_t stream) {
+        state = 0;
+        increment = (stream << 1) | 1;
+        (*this)();
+        state += seedValue;
+        (*this)();
+    }
+    
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+    
+    result_type operator()() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    
+    // Uniform in [0, bound), by multiply-and-reject without a division in
+    // the common case
+    uint32_t nextInt(uint32_t bound) {
+        uint64_t product = static_cast<uint64_t>((*this)()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>((*this)()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+    
+    // Seed for one level of a run, so every level differs but a fixed game
+    // seed reproduces them all
+    static uint64_t levelSeed(uint64_t gameSeed, int levelNumber) {
+        uint64_t z = gameSeed + static_cast<uint64_t>(levelNumber) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    
+private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+// Hierarchical A* (HPA*) over a level grid. The grid is cut into
+// CLUSTER_SIZE square clusters and every open stretch of a border between
+// two clusters gets an entrance: a pair of abstract nodes, one on each
+// side, joined by a step of cost 1. Within a cluster the entrances are
+// joined by their exact walking distance, found once per level with a
+// breadth-first search that stays inside the cluster. A query links the
+// start and goal cells into that graph the same way and runs A* over it;
+// the result is the list of abstract nodes to pass, and every leg between
+// two of them is refined into single steps with refine() only when a
+// zombie reaches it.
+class PathFinder {
+public:
+    static constexpr int CLUSTER_SIZE = 8;
+    static constexpr int ENTRANCE_SPLIT = 6; // longer openings get an entrance at each end
+    
+    // blocked is row-major with nonzero for walls, as Level stores it
+    void build(int gridWidth, int gridHeight, const std::vector<Uint8>& blocked) {
+        width = gridWidth;
+        height = gridHeight;
+        clustersX = (width + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+        clustersY = (height + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+        walls = blocked;
+        nodes.clear();
+        nodeAt.assign(width * height, -1);
+        clusterNodes.assign(clustersX * clustersY, std::vector<int>());
+        
+        // Entrances across the vertical and horizontal cluster borders
+        for (int cy = 0; cy < clustersY; cy++) {
+            for (int cx = 0; cx < clustersX; cx++) {
+                int x0 = cx * CLUSTER_SIZE, y0 = cy * CLUSTER_SIZE;
+                int x1 = std::min(x0 + CLUSTER_SIZE, width), y1 = std::min(y0 + CLUSTER_SIZE, height);
+                if (x1 < width) addEntrances(index(x1 - 1, y0), 1, width, y1 - y0);
+                if (y1 < height) addEntrances(index(x0, y1 - 1), width, 1, x1 - x0);
+            }
+        }
+        
+        // Walking distances between the entrances of each cluster
+        std::vector<int> dist, parent, queue;
+        for (int cluster = 0; cluster < clustersX * clustersY; cluster++) {
+            const std::vector<int>& members = clusterNodes[cluster];
+            for (int from : members) {
+                clusterSearch(nodes[from].cell, dist, parent, queue);
+                for (int to : members) {
+                    int d = dist[localIndex(nodes[to].cell)];
+                    if (to != from && d > 0) nodes[from].edges.push_back({to, d});
+                }
+            }
+        }
+    }
+    
+    bool isFloor(int cell) const {
+        return cell >= 0 && cell < width * height && walls[cell] == 0;
+    }
+    
+    // Cell under a point in pixels, or -1 outside the grid
+    int cellAt(const Position& pos) const {
+        int x = static_cast<int>(std::floor(pos.x / TILE_SIZE));
+        int y = static_cast<int>(std::floor(pos.y / TILE_SIZE));
+        if (x < 0 || x >= width || y < 0 || y >= height) return -1;
+        return index(x, y);
+    }
+    
+    Position cellPosition(int cell) const {
+        return {static_cast<float>(cell % width * TILE_SIZE), static_cast<float>(cell / width * TILE_SIZE)};
+    }
+    
+    int clusterOf(int cell) const {
+        return (cell / width) / CLUSTER_SIZE * clustersX + (cell % width) / CLUSTER_SIZE;
+    }
+    
+    // Abstract path from start to goal, written to waypoints in walking
+    // order without the start cell and ending with goal. Consecutive
+    // waypoints are neighbours or share a cluster.
+    bool findPath(int start, int goal, std::vector<int>& waypoints) {
+        waypoints.clear();
+        if (!isFloor(start) || !isFloor(goal)) return false;
+        if (start == goal) {
+            waypoints.push_back(goal);
+            return true;
+        }
+        
+        // Two virtual nodes past the real ones stand for the query ends
+        const int goalNode = static_cast<int>(nodes.size());
+        const int startNode = goalNode + 1;
+        g.assign(nodes.size() + 2, INT_MAX);
+        cameFrom.assign(nodes.size() + 2, -1);
+        open = std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>>();
+        
+        clusterSearch(goal, goalDist, parent, queue);
+        int goalCluster = clusterOf(goal);
+        
+        clusterSearch(start, dist, parent, queue);
+        if (clusterOf(start) == goalCluster && dist[localIndex(goal)] >= 0) {
+            relax(goalNode, startNode, dist[localIndex(goal)], goal);
+        }
+        for (int node : clusterNodes[clusterOf(start)]) {
+            int d = dist[localIndex(nodes[node].cell)];
+            if (d >= 0) relax(node, startNode, d, goal);
+        }
+        
+        while (!open.empty()) {
+            std::pair<int, int> top = open.top();
+            open.pop();
+            int node = top.second;
+            if (node == goalNode) break;
+            if (top.first != g[node] + heuristic(nodes[node].cell, goal)) continue; // stale entry
+            
+            for (const Edge& edge : nodes[node].edges) {
+                relax(edge.to, node, g[node] + edge.cost, goal);
+            }
+            if (nodes[node].cluster == goalCluster) {
+                int d = goalDist[localIndex(nodes[node].cell)];
+                if (d >= 0) relax(goalNode, node, g[node] + d, goal);
+            }
+        }
+        if (cameFrom[goalNode] < 0) return false;
+        
+        waypoints.push_back(goal);
+        for (int node = cameFrom[goalNode]; node != startNode; node = cameFrom[node]) {
+            if (nodes[node].cell != start) waypoints.push_back(nodes[node].cell);
+        }
+        std::reverse(waypoints.begin(), waypoints.end());
+        return true;
+    }
+    
+    // Single steps from one waypoint to the next, without from itself
+    bool refine(int from, int to, std::vector<int>& steps) {
+        steps.clear();
+        if (!isFloor(from) || !isFloor(to)) return false;
+        if (from == to) return true;
+        if (std::abs(from % width - to % width) + std::abs(from / width - to / width) == 1) {
+            steps.push_back(to);
+            return true;
+        }
+        if (clusterOf(from) != clusterOf(to)) return false;
+        
+        clusterSearch(from, dist, parent, queue);
+        if (dist[localIndex(to)] < 0) return false;
+        for (int cell = to; cell != from; cell = parent[localIndex(cell)]) {
+            steps.push_back(cell);
+        }
+        std::reverse(steps.begin(), steps.end());
+        return true;
+    }
+    
+    int getNodeCount() const { return static_cast<int>(nodes.size()); }
+    
+private:
+    struct Edge {
+        int to;
+        int cost;
+    };
+    
+    struct Node {
+        int cell;
+        int cluster;
+        std::vector<Edge> edges;
+    };
+    
+    int index(int x, int y) const {
+        return y * width + x;
+    }
+    
+    // Position of a cell inside its cluster, for the per-cluster arrays
+    int localIndex(int cell) const {
+        return (cell / width) % CLUSTER_SIZE * CLUSTER_SIZE + (cell % width) % CLUSTER_SIZE;
+    }
+    
+    int heuristic(int cell, int goal) const {
+        return std::abs(cell % width - goal % width) + std::abs(cell / width - goal / width);
+    }
+    
+    int nodeFor(int cell) {
+        if (nodeAt[cell] < 0) {
+            nodeAt[cell] = static_cast<int>(nodes.size());
+            nodes.push_back({cell, clusterOf(cell), std::vector<Edge>()});
+            clusterNodes[clusterOf(cell)].push_back(nodeAt[cell]);
+        }
+        return nodeAt[cell];
+    }
+    
+    // Walks a border of length cells starting at first, stepping by along;
+    // across is the offset to the matching cell in the neighbouring cluster
+    void addEntrances(int first, int across, int along, int length) {
+        int runStart = -1;
+        for (int i = 0; i <= length; i++) {
+            int cell = first + i * along;
+            bool passable = i < length && walls[cell] == 0 && walls[cell + across] == 0;
+            if (passable && runStart < 0) runStart = i;
+            if (passable || runStart < 0) continue;
+            
+            int runLength = i - runStart;
+            if (runLength >= ENTRANCE_SPLIT) {
+                linkAcross(first + runStart * along, across);
+                linkAcross(first + (i - 1) * along, across);
+            } else {
+                linkAcross(first + (runStart + runLength / 2) * along, across);
+            }
+            runStart = -1;
+        }
+    }
+    
+    void linkAcross(int cell, int across) {
+        int a = nodeFor(cell);
+        int b = nodeFor(cell + across);
+        nodes[a].edges.push_back({b, 1});
+        nodes[b].edges.push_back({a, 1});
+    }
+    
+    // Breadth-first search from cell that never leaves its cluster. out and
+    // via are indexed by localIndex(); out is -1 where unreached and via
+    // holds the previous cell on a shortest walk
+    void clusterSearch(int cell, std::vector<int>& out, std::vector<int>& via, std::vector<int>& pending) const {
+        int cx = (cell % width) / CLUSTER_SIZE * CLUSTER_SIZE;
+        int cy = (cell / width) / CLUSTER_SIZE * CLUSTER_SIZE;
+        int cx1 = std::min(cx + CLUSTER_SIZE, width), cy1 = std::min(cy + CLUSTER_SIZE, height);
+        out.assign(CLUSTER_SIZE * CLUSTER_SIZE, -1);
+        via.assign(CLUSTER_SIZE * CLUSTER_SIZE, -1);
+        pending.clear();
+        
+        out[localIndex(cell)] = 0;
+        pending.push_back(cell);
+        for (size_t head = 0; head < pending.size(); head++) {
+            int current = pending[head];
+            int x = current % width, y = current / width;
+            int next[4] = {current - 1, current + 1, current - width, current + width};
+            bool inside[4] = {x > cx, x < cx1 - 1, y > cy, y < cy1 - 1};
+            for (int dir = 0; dir < 4; dir++) {
+                if (!inside[dir] || walls[next[dir]] != 0 || out[localIndex(next[dir])] >= 0) continue;
+                out[localIndex(next[dir])] = out[localIndex(current)] + 1;
+                via[localIndex(next[dir])] = current;
+                pending.push_back(next[dir]);
+            }
+        }
+    }
+    
+    void relax(int node, int from, int cost, int goal) {
+        if (cost >= g[node]) return;
+        g[node] = cost;
+        cameFrom[node] = from;
+        int cell = node < static_cast<int>(nodes.size()) ? nodes[node].cell : goal;
+        open.push({cost + heuristic(cell, goal), node});
+    }
+    
+    int width = 0;
+    int height = 0;
+    int clustersX = 0;
+    int clustersY = 0;
+    std::vector<Uint8> walls;
+    std::vector<Node> nodes;
+    std::vector<int> nodeAt;                   // node id per cell, -1 for none
+    std::vector<std::vector<int>> clusterNodes; // node ids per cluster
+    
+    // Query scratch, kept between calls to avoid reallocating
+    std::vector<int> g, cameFrom;
+    std::vector<int> dist, goalDist, parent, queue;
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> open;
+};
+
 // Zombie entity
 class Zombie : public Entity {
 public:
-    Zombie(Position pos, int level)
+    // rng is the level's AI stream and must outlive the zombie
+    Zombie(Position pos, int level, Rng& rng)
         : Entity(EntityType::ZOMBIE, pos, TILE_SIZE, TILE_SIZE),
           velocity({0, 0}), state(ZombieState::PATROL),
           patrolTimer(0), respawnTimer(0), respawning(false),
           health(level * 2), maxHealth(level * 2),
-          spawnPosition(pos) {}
+          spawnPosition(pos), rng(&rng), legStart(-1), goalCell(-1) {}
     
     enum class ZombieState {
         PATROL,
@@ -154,10 +491,7 @@ public:
             if (patrolTimer > 120) { // Change direction every 2 seconds
                 patrolTimer = 0;
                 // Random direction change
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<> dirDist(0, 3);
-                int direction = dirDist(gen);
+                int direction = rng->nextInt(4);
                 
                 velocity = {0, 0};
                 switch (direction) {
@@ -202,21 +536,58 @@ public:
         SDL_RenderFillRect(renderer, &healthRect);
     }
     
-    void chase(const Position& targetPos) {
+    // Follows a cached HPA* path to the target. The path is planned again
+    // only when the target enters another cluster; moves inside its cluster
+    // just retarget the last leg. Without a path (target on a wall or off
+    // the grid) the zombie steers straight at it as before.
+    void chase(const Position& targetPos, PathFinder& paths) {
         if (!active || respawning) return;
         
         state = ZombieState::CHASE;
         
-        float dx = targetPos.x - position.x;
-        float dy = targetPos.y - position.y;
-        float length = std::sqrt(dx * dx + dy * dy);
+        Position centre(position.x + TILE_SIZE / 2, position.y + TILE_SIZE / 2);
+        int here = paths.cellAt(centre);
+        int goal = paths.cellAt(Position(targetPos.x + TILE_SIZE / 2, targetPos.y + TILE_SIZE / 2));
+        if (!paths.isFloor(here) || !paths.isFloor(goal)) {
+            clearPath();
+            steerTowards(targetPos);
+            return;
+        }
         
-        if (length > 0) {
-            dx /= length;
-            dy /= length;
-            
-            velocity.x = dx * ZOMBIE_SPEED;
-            velocity.y = dy * ZOMBIE_SPEED;
+        if (goalCell < 0 || paths.clusterOf(goal) != paths.clusterOf(goalCell)) {
+            replan(paths, here, goal);
+        } else if (goal != goalCell) {
+            // The final leg already ends in the goal cluster, so only its
+            // end moves; if the zombie is walking that leg, walk it afresh
+            goalCell = goal;
+            if (!waypoints.empty()) {
+                waypoints.front() = goal;
+            } else {
+                waypoints.push_back(goal);
+                steps.clear();
+                legStart = here;
+            }
+        }
+        
+        // Arrived on the current step: take the next one, refining the next
+        // leg when this one is used up
+        while (!steps.empty() && position.distance(paths.cellPosition(steps.back())) <= ZOMBIE_SPEED) {
+            legStart = steps.back();
+            steps.pop_back();
+        }
+        if (steps.empty() && !waypoints.empty()) {
+            if (paths.refine(legStart, waypoints.back(), steps)) {
+                std::reverse(steps.begin(), steps.end());
+                waypoints.pop_back();
+            } else {
+                replan(paths, here, goal);
+            }
+        }
+        
+        if (steps.empty()) {
+            steerTowards(targetPos);
+        } else {
+            steerTowards(paths.cellPosition(steps.back()));
         }
     }
     
@@ -224,6 +595,7 @@ public:
         if (!active || respawning) return;
         
         state = ZombieState::PATROL;
+        clearPath();
     }
     
     void takeDamage(int amount) {
@@ -237,12 +609,44 @@ public:
         active = false;
         respawning = true;
         respawnTimer = 0;
+        clearPath();
     }
     
     bool isRespawning() const { return respawning; }
     ZombieState getState() const { return state; }
     
 private:
+    void replan(PathFinder& paths, int here, int goal) {
+        goalCell = goal;
+        legStart = here;
+        steps.clear();
+        if (paths.findPath(here, goal, waypoints)) {
+            // Kept reversed so the next waypoint is popped off the back
+            std::reverse(waypoints.begin(), waypoints.end());
+        }
+    }
+    
+    void clearPath() {
+        waypoints.clear();
+        steps.clear();
+        goalCell = -1;
+    }
+    
+    // Moves at ZOMBIE_SPEED but never past the target
+    void steerTowards(const Position& targetPos) {
+        float dx = targetPos.x - position.x;
+        float dy = targetPos.y - position.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        
+        if (length > 0) {
+            float speed = std::min(length, static_cast<float>(ZOMBIE_SPEED));
+            velocity.x = dx / length * speed;
+            velocity.y = dy / length * speed;
+        } else {
+            velocity = {0, 0};
+        }
+    }
+    
     Velocity velocity;
     ZombieState state;
     int patrolTimer;
@@ -251,6 +655,13 @@ private:
     int health;
     int maxHealth;
     Position spawnPosition;
+    Rng* rng;
+    
+    // Cached chase path, both lists reversed so the next entry is at the back
+    std::vector<int> waypoints; // abstract path still to walk, goal at the front
+    std::vector<int> steps;     // refined cells of the current leg
+    int legStart;               // cell the current leg starts from
+    int goalCell;               // target cell the path was planned for, -1 for none
 };
 
 // Key entity
@@ -310,52 +721,85 @@ private:
     int lifetime;
 };
 
+// Union-find over grid cells, with union by size and path halving.
+class DisjointSet {
+public:
+    void reset(int count) {
+        parent.resize(count);
+        size.assign(count, 1);
+        for (int i = 0; i < count; i++) {
+            parent[i] = i;
+        }
+    }
+    
+    int find(int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+    
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (size[a] < size[b]) std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+    }
+    
+private:
+    std::vector<int> parent;
+    std::vector<int> size;
+};
+
 // Level generator
 class Level {
 public:
-    Level(int levelNumber)
+    static constexpr Uint8 FLOOR = 0;
+    static constexpr Uint8 WALL = 1;
+    
+    Level(int levelNumber) : Level(levelNumber, std::random_device()()) {}
+    
+    Level(int levelNumber, uint64_t seed)
         : levelNumber(levelNumber),
           width(20 + levelNumber),
           height(15 + levelNumber),
           totalKeys(3 + levelNumber / 2),
-          totalZombies(2 + levelNumber) {
-        
-        // Initialize grid with empty spaces
-        grid.resize(height, std::vector<int>(width, 0));
+          totalZombies(2 + levelNumber),
+          gen(seed, Rng::LEVEL_STREAM) {
         generateMaze();
     }
     
     void generateMaze() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        
-        // Fill with walls
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                grid[y][x] = 1; // Wall
-            }
-        }
+        // Start from solid rock; every carve() also joins the new floor cell
+        // to its floor neighbours, so connectivity is known without a search
+        grid.assign(width * height, WALL);
+        cells.reset(width * height);
         
         // Start carving from the center
         int startX = width / 2;
         int startY = height / 2;
-        grid[startY][startX] = 0; // Empty space
+        carve(startX, startY);
         
-        // Recursive backtracking maze generation
-        std::vector<std::pair<int, int>> stack;
-        stack.push_back({startX, startY});
+        // Recursive backtracking maze generation. A cell is pushed only when
+        // it is carved, so the stack never holds more than one entry per cell
+        // on the start cell's lattice and can be sized up front
+        std::vector<int> stack;
+        stack.reserve(((width + 1) / 2) * ((height + 1) / 2));
+        stack.push_back(index(startX, startY));
+        
+        // Define directions: right, left, down, up
+        const int dx[4] = {2, -2, 0, 0};
+        const int dy[4] = {0, 0, 2, -2};
+        int directions[4] = {0, 1, 2, 3};
         
         while (!stack.empty()) {
-            int x = stack.back().first;
-            int y = stack.back().second;
-            
-            // Define directions: right, left, down, up
-            int dx[4] = {2, -2, 0, 0};
-            int dy[4] = {0, 0, 2, -2};
+            int x = stack.back() % width;
+            int y = stack.back() / width;
             
-            // Shuffle directions
-            std::vector<int> directions = {0, 1, 2, 3};
-            std::shuffle(directions.begin(), directions.end(), gen);
+            std::shuffle(directions, directions + 4, gen);
             
             bool moved = false;
             
@@ -363,12 +807,12 @@ public:
                 int nx = x + dx[dir];
                 int ny = y + dy[dir];
                 
-                if (nx >= 0 && nx < width && ny >= 0 && ny < height && grid[ny][nx] == 1) {
+                if (nx >= 0 && nx < width && ny >= 0 && ny < height && grid[index(nx, ny)] == WALL) {
                     // Carve path
-                    grid[y + dy[dir]/2][x + dx[dir]/2] = 0;
-                    grid[ny][nx] = 0;
+                    carve(x + dx[dir] / 2, y + dy[dir] / 2);
+                    carve(nx, ny);
                     
-                    stack.push_back({nx, ny});
+                    stack.push_back(index(nx, ny));
                     moved = true;
                     break;
                 }
@@ -383,8 +827,8 @@ public:
         std::uniform_int_distribution<> roomDist(0, 100);
         for (int y = 1; y < height - 1; y++) {
             for (int x = 1; x < width - 1; x++) {
-                if (grid[y][x] == 1 && roomDist(gen) < 20) {
-                    grid[y][x] = 0;
+                if (grid[index(x, y)] == WALL && roomDist(gen) < 20) {
+                    carve(x, y);
                 }
             }
         }
@@ -398,112 +842,76 @@ public:
         do {
             playerX = edgeDist(gen);
             playerY = edgeDist(gen);
-        } while (grid[playerY][playerX] != 0);
+        } while (grid[index(playerX, playerY)] != FLOOR);
         
-        playerPosition = {playerX * TILE_SIZE, playerY * TILE_SIZE};
+        playerPosition = {static_cast<float>(playerX * TILE_SIZE), static_cast<float>(playerY * TILE_SIZE)};
         
         // Place keys in random locations
-        placeEntities(2, totalKeys, keyPositions); // type 2 = key
+        placeEntities(totalKeys, keyPositions);
         
         // Place zombies in random locations
-        placeEntities(3, totalZombies, zombiePositions); // type 3 = zombie
+        placeEntities(totalZombies, zombiePositions);
     }
     
     void ensureConnectivity() {
-        // Find all connected components and connect them
-        std::vector<std::vector<bool>> visited(height, std::vector<bool>(width, false));
-        std::vector<std::vector<std::pair<int, int>>> components;
-        
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                if (grid[y][x] == 0 && !visited[y][x]) {
-                    std::vector<std::pair<int, int>> component;
-                    std::vector<std::pair<int, int>> stack = {{x, y}};
-                    visited[y][x] = true;
-                    
-                    while (!stack.empty()) {
-                        auto [cx, cy] = stack.back();
-                        stack.pop_back();
-                        component.push_back({cx, cy});
-                        
-                        int dx[4] = {1, -1, 0, 0};
-                        int dy[4] = {0, 0, 1, -1};
-                        
-                        for (int dir = 0; dir < 4; dir++) {
-                            int nx = cx + dx[dir];
-                            int ny = cy + dy[dir];
-                            
-                            if (nx >= 0 && nx < width && ny >= 0 && ny < height && 
-                                grid[ny][nx] == 0 && !visited[ny][nx]) {
-                                stack.push_back({nx, ny});
-                                visited[ny][nx] = true;
-                            }
-                        }
-                    }
-                    
-                    components.push_back(component);
-                }
+        // Every floor cell outside the start cell's set is an island left by
+        // the room pass; tunnel from it to a random cell of the main set
+        int start = index(width / 2, height / 2);
+        std::uniform_int_distribution<> xDist(0, width - 1);
+        std::uniform_int_distribution<> yDist(0, height - 1);
+        
+        for (int i = 0; i < width * height; i++) {
+            if (grid[i] != FLOOR || cells.find(i) == cells.find(start)) continue;
+            
+            int target;
+            do {
+                target = index(xDist(gen), yDist(gen));
+            } while (grid[target] != FLOOR || cells.find(target) != cells.find(start));
+            
+            // Connect these two points
+            int x1 = target % width, y1 = target / width;
+            int x2 = i % width, y2 = i / width;
+            
+            for (int x = std::min(x1, x2); x <= std::max(x1, x2); x++) {
+                if (grid[index(x, y1)] == WALL) carve(x, y1);
             }
-        }
-        
-        // If there's more than one component, connect them
-        if (components.size() > 1) {
-            std::random_device rd;
-            std::mt19937 gen(rd());
             
-            for (size_t i = 1; i < components.size(); i++) {
-                std::uniform_int_distribution<> dist1(0, components[0].size() - 1);
-                std::uniform_int_distribution<> dist2(0, components[i].size() - 1);
-                
-                auto [x1, y1] = components[0][dist1(gen)];
-                auto [x2, y2] = components[i][dist2(gen)];
-                
-                // Connect these two points
-                int sx = x1 < x2 ? x1 : x2;
-                int ex = x1 < x2 ? x2 : x1;
-                int sy = y1 < y2 ? y1 : y2;
-                int ey = y1 < y2 ? y2 : y1;
-                
-                for (int x = sx; x <= ex; x++) {
-                    grid[y1][x] = 0;
-                }
-                
-                for (int y = sy; y <= ey; y++) {
-                    grid[y][x2] = 0;
-                }
+            for (int y = std::min(y1, y2); y <= std::max(y1, y2); y++) {
+                if (grid[index(x2, y)] == WALL) carve(x2, y);
             }
         }
     }
     
-    void placeEntities(int entityType, int count, std::vector<Position>& positions) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
+    void placeEntities(int count, std::vector<Position>& positions) {
         std::uniform_int_distribution<> xDist(1, width - 2);
         std::uniform_int_distribution<> yDist(1, height - 2);
         
         for (int i = 0; i < count; i++) {
             int x, y;
+            float dist;
             do {
                 x = xDist(gen);
                 y = yDist(gen);
                 
                 // Check if it's far enough from player start
-                float dist = std::sqrt(std::pow(x * TILE_SIZE - playerPosition.x, 2) + 
-                                      std::pow(y * TILE_SIZE - playerPosition.y, 2));
+                float dx = x * TILE_SIZE - playerPosition.x;
+                float dy = y * TILE_SIZE - playerPosition.y;
+                dist = std::sqrt(dx * dx + dy * dy);
                 
-            } while (grid[y][x] != 0 || dist < 5 * TILE_SIZE);
+            } while (grid[index(x, y)] != FLOOR || dist < 5 * TILE_SIZE);
             
-            positions.push_back({x * TILE_SIZE, y * TILE_SIZE});
+            positions.push_back({static_cast<float>(x * TILE_SIZE), static_cast<float>(y * TILE_SIZE)});
         }
     }
     
-    std::vector<std::shared_ptr<Entity>> createEntities() const {
+    // Zombies draw from ai, which must outlive them
+    std::vector<std::shared_ptr<Entity>> createEntities(Rng& ai) const {
         std::vector<std::shared_ptr<Entity>> entities;
         
         // Add walls
         for (int y = 0; y < height; y++) {
             for (int x = 0; x < width; x++) {
-                if (grid[y][x] == 1) {
+                if (grid[index(x, y)] == WALL) {
                     entities.push_back(std::make_shared<Wall>(Position(x * TILE_SIZE, y * TILE_SIZE)));
                 }
             }
@@ -516,7 +924,7 @@ public:
         
         // Add zombies
         for (const auto& pos : zombiePositions) {
-            entities.push_back(std::make_shared<Zombie>(pos, levelNumber));
+            entities.push_back(std::make_shared<Zombie>(pos, levelNumber, ai));
         }
         
         return entities;
@@ -530,24 +938,143 @@ public:
         return totalKeys;
     }
     
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const std::vector<Uint8>& getGrid() const { return grid; }
+    
 private:
+    int index(int x, int y) const {
+        return y * width + x;
+    }
+    
+    void carve(int x, int y) {
+        int i = index(x, y);
+        grid[i] = FLOOR;
+        if (x > 0 && grid[i - 1] == FLOOR) cells.unite(i, i - 1);
+        if (x < width - 1 && grid[i + 1] == FLOOR) cells.unite(i, i + 1);
+        if (y > 0 && grid[i - width] == FLOOR) cells.unite(i, i - width);
+        if (y < height - 1 && grid[i + width] == FLOOR) cells.unite(i, i + width);
+    }
+    
     int levelNumber;
     int width;
     int height;
     int totalKeys;
     int totalZombies;
-    std::vector<std::vector<int>> grid; // 0 = empty, 1 = wall
+    Rng gen;
+    std::vector<Uint8> grid; // row-major, FLOOR or WALL
+    DisjointSet cells;       // floor cells joined through floor neighbours
     Position playerPosition;
     std::vector<Position> keyPositions;
     std::vector<Position> zombiePositions;
 };
 
+// A generated level together with its path graph, ready to be played
+struct PreparedLevel {
+    PreparedLevel(int levelNumber, uint64_t seed) : level(levelNumber, seed) {
+        paths.build(level.getWidth(), level.getHeight(), level.getGrid());
+    }
+    
+    Level level;
+    PathFinder paths;
+};
+
+// Generates the levels after the current one on a worker thread and keeps
+// up to LEVEL_QUEUE_SIZE of them ready, so a level switch only takes one
+// off the queue. Levels are delivered in order; asking for any other level
+// (a restart) builds it on the calling thread and restarts the sequence
+// after it. Level n is always generated from Rng::levelSeed(gameSeed, n).
+class LevelQueue {
+public:
+    static constexpr size_t LEVEL_QUEUE_SIZE = 2;
+    
+    LevelQueue() : gameSeed(0), nextToBuild(1), nextToTake(1), epoch(0), stopping(false) {}
+    
+    ~LevelQueue() {
+        stop();
+    }
+    
+    LevelQueue(const LevelQueue&) = delete;
+    LevelQueue& operator=(const LevelQueue&) = delete;
+    
+    void start(int firstLevel, uint64_t seed) {
+        stop();
+        gameSeed = seed;
+        nextToBuild = nextToTake = firstLevel;
+        stopping = false;
+        worker = std::thread(&LevelQueue::run, this);
+    }
+    
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        if (worker.joinable()) worker.join();
+        ready.clear();
+    }
+    
+    std::unique_ptr<PreparedLevel> take(int levelNumber) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (levelNumber == nextToTake && worker.joinable()) {
+            // Normally already queued; otherwise the worker is building it
+            changed.wait(lock, [this] { return !ready.empty(); });
+            std::unique_ptr<PreparedLevel> level = std::move(ready.front());
+            ready.pop_front();
+            nextToTake++;
+            lock.unlock();
+            changed.notify_all();
+            return level;
+        }
+        
+        epoch++;
+        ready.clear();
+        nextToBuild = nextToTake = levelNumber + 1;
+        lock.unlock();
+        changed.notify_all();
+        return std::unique_ptr<PreparedLevel>(new PreparedLevel(levelNumber, Rng::levelSeed(gameSeed, levelNumber)));
+    }
+    
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this] { return stopping || ready.size() < LEVEL_QUEUE_SIZE; });
+            if (stopping) return;
+            
+            int levelNumber = nextToBuild++;
+            unsigned int startEpoch = epoch;
+            lock.unlock();
+            std::unique_ptr<PreparedLevel> level(new PreparedLevel(levelNumber, Rng::levelSeed(gameSeed, levelNumber)));
+            lock.lock();
+            
+            // A restart while building makes this level stale
+            if (epoch == startEpoch) {
+                ready.push_back(std::move(level));
+                changed.notify_all();
+            }
+        }
+    }
+    
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::unique_ptr<PreparedLevel>> ready;
+    uint64_t gameSeed;
+    int nextToBuild;
+    int nextToTake;
+    unsigned int epoch;
+    bool stopping;
+};
+
 // Game class
 class Game {
 public:
-    Game()
+    // The same seed replays the same levels and zombie movement
+    explicit Game(uint64_t gameSeed)
         : window(nullptr), renderer(nullptr), running(false),
-          state(GameState::PLAYING), currentLevel(1) {}
+          state(GameState::PLAYING), currentLevel(1), seed(gameSeed) {}
     
     bool init() {
         if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -582,21 +1109,26 @@ public:
             return false;
         }
         
+        // Start building levels in the background, the first one included
+        levels.start(currentLevel, seed);
         loadLevel(currentLevel);
         running = true;
         
         return true;
     }
     
+    // The level is normally waiting in the queue already, so this is only a
+    // pointer swap plus creating its entities
     void loadLevel(int level) {
-        Level levelGenerator(level);
-        entities = levelGenerator.createEntities();
+        current = levels.take(level);
+        aiRng.seed(Rng::levelSeed(seed, level), Rng::AI_STREAM);
+        entities = current->level.createEntities(aiRng);
         
         // Create player
-        player = std::make_shared<Player>(levelGenerator.getPlayerStartPosition());
+        player = std::make_shared<Player>(current->level.getPlayerStartPosition());
         entities.push_back(player);
         
-        keysRequired = levelGenerator.getKeyCount();
+        keysRequired = current->level.getKeyCount();
     }
     
     void handleEvents() {
@@ -679,7 +1211,7 @@ public:
                 
                 float distance = playerPos.distance(zombie->getPosition());
                 if (distance <= DETECTION_RADIUS) {
-                    zombie->chase(playerPos);
+                    zombie->chase(playerPos, current->paths);
                 } else if (zombie->getState() == Zombie::ZombieState::CHASE) {
                     zombie->patrol();
                 }
@@ -840,6 +1372,8 @@ public:
     }
     
     void close() {
+        levels.stop();
+        
         SDL_DestroyTexture(texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
@@ -860,9 +1394,13 @@ private:
     GameState state;
     int currentLevel;
     int keysRequired;
+    uint64_t seed;
+    Rng aiRng; // declared before entities so it outlives the zombies
     
     std::vector<std::shared_ptr<Entity>> entities;
     std::shared_ptr<Player> player;
+    LevelQueue levels;
+    std::unique_ptr<PreparedLevel> current;
 SDL_Texture* loadTexture(const std::string& path) {
         // In a real implementation, you would load the texture from file
         // For this example, we'll create a simple texture programmatically
@@ -900,9 +1438,50 @@ SDL_Texture* loadTexture(const std::string& path) {
     }
 };
 
+// Times Level(n) for levels doubling up to maxLevel, with fixed seeds so
+// runs are comparable, and prints one line per level size
+int runGenerationBenchmark(int maxLevel, int runs) {
+    for (int level = 1; level <= maxLevel; level = level < maxLevel && level * 2 > maxLevel ? maxLevel : level * 2) {
+        double totalMs = 0.0;
+        double bestMs = 0.0;
+        int width = 0, height = 0;
+        
+        for (int run = 0; run < runs; run++) {
+            auto start = std::chrono::steady_clock::now();
+            Level generated(level, 1234u + run);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            
+            width = generated.getWidth();
+            height = generated.getHeight();
+            totalMs += ms;
+            if (run == 0 || ms < bestMs) bestMs = ms;
+        }
+        
+        std::printf("level %5d  %5dx%-5d  avg %9.3f ms  min %9.3f ms\n",
+                    level, width, height, totalMs / runs, bestMs);
+        if (level == maxLevel) break;
+    }
+    return 0;
+}
+
 // Main function
 int main(int argc, char* argv[]) {
-    Game game;
+    // --bench-generation [maxLevel] [runs] times level generation and exits
+    // without opening a window
+    if (argc > 1 && std::string(argv[1]) == "--bench-generation") {
+        int maxLevel = argc > 2 ? std::atoi(argv[2]) : 1024;
+        int runs = argc > 3 ? std::atoi(argv[3]) : 5;
+        return runGenerationBenchmark(std::max(1, maxLevel), std::max(1, runs));
+    }
+    
+    // --seed N fixes every level and all zombie movement, for benchmarking
+    std::random_device rd;
+    uint64_t seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--seed") seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    
+    Game game(seed);
     
     if (!game.init()) {
         std::cerr << "Failed to initialize game!" << std::endl;